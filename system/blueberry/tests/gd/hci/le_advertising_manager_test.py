@@ -210,6 +210,30 @@ class LeAdvertisingManagerTest(gd_base_test.GdBaseTestClass):
                                                        create_response.advertiser_id, AdvertisingStatus.ADV_SUCCESS,
                                                        0x00))
 
+    def test_disable_multiple_advertisers_callback(self):
+        self.set_address_policy_with_static_address()
+        create_responses = [self.create_advertiser(), self.create_advertiser()]
+        counts = self.dut.hci_le_advertising_manager.GetCommandCounts(empty_proto.Empty())
+        for create_response in create_responses:
+            disable_advertiser_request = le_advertising_facade.EnableAdvertiserRequest(
+                advertiser_id=create_response.advertiser_id, enable=False)
+            self.dut.hci_le_advertising_manager.EnableAdvertiser(disable_advertiser_request)
+
+        for create_response in create_responses:
+            assertThat(self.dut.callback_event_stream).emits(
+                AdvertisingMatchers.AdvertisingCallbackMsg(AdvertisingCallbackMsgType.ADVERTISING_ENABLED,
+                                                           create_response.advertiser_id,
+                                                           AdvertisingStatus.ADV_SUCCESS, 0x00))
+
+        # Each set is disabled once, by one command per batch of requests that reached the DUT together
+        new_counts = self.dut.hci_le_advertising_manager.GetCommandCounts(empty_proto.Empty())
+        sets_disabled = new_counts.sets_enabled - counts.sets_enabled
+        enable_commands = new_counts.enable_commands - counts.enable_commands
+        assertThat(sets_disabled).isEqualTo(len(create_responses))
+        asserts.assert_true(1 <= enable_commands <= sets_disabled,
+                            "%d commands sent to disable %d sets" % (enable_commands, sets_disabled))
+        assertThat(new_counts.commands_sent - counts.commands_sent).isEqualTo(enable_commands)
+
     def test_set_advertising_data_callback(self):
         self.set_address_policy_with_static_address()
         create_response = self.create_advertiser()
@@ -225,6 +249,74 @@ class LeAdvertisingManagerTest(gd_base_test.GdBaseTestClass):
             AdvertisingMatchers.AdvertisingCallbackMsg(AdvertisingCallbackMsgType.ADVERTISING_DATA_SET,
                                                        create_response.advertiser_id, AdvertisingStatus.ADV_SUCCESS))
 
+    def test_set_same_advertising_data_callback(self):
+        self.set_address_policy_with_static_address()
+        create_response = self.create_advertiser()
+        gap_name = hci.GapData(data_type=hci.GapDataType.COMPLETE_LOCAL_NAME, data=list(bytes(b'Im_The_DUT2')))
+        gap_data = le_advertising_facade.GapDataMsg(data=gap_name.serialize())
+
+        set_data_request = le_advertising_facade.SetDataRequest(advertiser_id=create_response.advertiser_id,
+                                                                set_scan_rsp=False,
+                                                                data=[gap_data])
+        # The second update does not change the data, but is still reported
+        counts = self.dut.hci_le_advertising_manager.GetCommandCounts(empty_proto.Empty())
+        self.dut.hci_le_advertising_manager.SetData(set_data_request)
+        self.dut.hci_le_advertising_manager.SetData(set_data_request)
+
+        assertThat(self.dut.callback_event_stream).emits(
+            AdvertisingMatchers.AdvertisingCallbackMsg(AdvertisingCallbackMsgType.ADVERTISING_DATA_SET,
+                                                       create_response.advertiser_id, AdvertisingStatus.ADV_SUCCESS),
+            at_least_times=2)
+
+        # It is either not sent or sent as Unchanged Data, in which case it is one more command
+        new_counts = self.dut.hci_le_advertising_manager.GetCommandCounts(empty_proto.Empty())
+        skipped = new_counts.data_updates_skipped - counts.data_updates_skipped
+        unchanged = new_counts.unchanged_data_updates - counts.unchanged_data_updates
+        assertThat(skipped + unchanged).isEqualTo(1)
+        assertThat(new_counts.commands_sent - counts.commands_sent).isEqualTo(1 + unchanged)
+
+    def test_le_ad_scan_dut_advertises_updated_data(self):
+        self.set_address_policy_with_static_address()
+        self.cert_hci.register_for_le_events(hci.SubeventCode.ADVERTISING_REPORT,
+                                             hci.SubeventCode.EXTENDED_ADVERTISING_REPORT)
+
+        # CERT Scans
+        self.cert_hci.send_command(hci.LeSetRandomAddress(random_address=bluetooth.Address('0C:05:04:03:02:01')))
+
+        self.cert_hci.send_command(
+            hci.LeSetExtendedScanParameters(own_address_type=hci.OwnAddressType.RANDOM_DEVICE_ADDRESS,
+                                            scanning_filter_policy=hci.LeScanningFilterPolicy.ACCEPT_ALL,
+                                            scanning_phys=1,
+                                            parameters=[
+                                                hci.PhyScanParameters(le_scan_type=hci.LeScanType.ACTIVE,
+                                                                      le_scan_interval=40,
+                                                                      le_scan_window=20)
+                                            ]))
+
+        self.cert_hci.send_command(
+            hci.LeSetExtendedScanEnable(enable=hci.Enable.ENABLED,
+                                        filter_duplicates=hci.FilterDuplicates.DISABLED,
+                                        duration=0,
+                                        period=0))
+
+        create_response = self.create_advertiser()
+        assertThat(self.cert_hci.get_le_event_stream()).emits(lambda packet: b'Im_The_DUT' in packet.payload)
+
+        gap_name = hci.GapData(data_type=hci.GapDataType.COMPLETE_LOCAL_NAME, data=list(bytes(b'Im_The_New_DUT')))
+        gap_data = le_advertising_facade.GapDataMsg(data=gap_name.serialize())
+        set_data_request = le_advertising_facade.SetDataRequest(advertiser_id=create_response.advertiser_id,
+                                                                set_scan_rsp=False,
+                                                                data=[gap_data])
+        self.dut.hci_le_advertising_manager.SetData(set_data_request)
+        self.dut.hci_le_advertising_manager.SetData(set_data_request)
+
+        assertThat(self.cert_hci.get_le_event_stream()).emits(lambda packet: b'Im_The_New_DUT' in packet.payload)
+
+        remove_request = le_advertising_facade.RemoveAdvertiserRequest(advertiser_id=create_response.advertiser_id)
+        self.dut.hci_le_advertising_manager.RemoveAdvertiser(remove_request)
+        self.cert_hci.send_command(
+            hci.LeSetScanEnable(le_scan_enable=hci.Enable.DISABLED, filter_duplicates=hci.Enable.DISABLED))
+
     def test_set_scan_response_data_callback(self):
         self.set_address_policy_with_static_address()
         create_response = self.create_advertiser()
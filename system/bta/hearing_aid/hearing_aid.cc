@@ -1366,6 +1366,7 @@ class HearingAidImpl : public HearingAid {
 
     std::vector<uint16_t> chan_left;
     std::vector<uint16_t> chan_right;
+    std::vector<int16_t> chan_both;
     if (left == nullptr || right == nullptr) {
       for (int i = 0; i < num_samples; i++) {
         const uint8_t* sample = data.data() + i * 4;
@@ -1380,15 +1381,11 @@ class HearingAidImpl : public HearingAid {
         chan_right.push_back(mono_data);
       }
     } else {
-      for (int i = 0; i < num_samples; i++) {
-        const uint8_t* sample = data.data() + i * 4;
-
-        uint16_t left = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_left.push_back(left);
-
-        sample += 2;
-        uint16_t right = (int16_t)((*(sample + 1) << 8) + *sample) >> 1;
-        chan_right.push_back(right);
+      // Both channels are encoded in one pass over the interleaved samples
+      chan_both.reserve(2 * num_samples);
+      for (int i = 0; i < 2 * num_samples; i++) {
+        const uint8_t* sample = data.data() + i * 2;
+        chan_both.push_back((int16_t)((*(sample + 1) << 8) + *sample) >> 1);
       }
     }
 
@@ -1400,8 +1397,20 @@ class HearingAidImpl : public HearingAid {
     // reallocations
     // TODO: this should basically fit the encoded data, tune the size later
     std::vector<uint8_t> encoded_data_left;
+    std::vector<uint8_t> encoded_data_right;
     auto time_point = std::chrono::steady_clock::now();
-    if (left) {
+    if (left && right) {
+      // TODO: instead of a magic number, we need to figure out the correct
+      // buffer size
+      encoded_data_left.resize(4000);
+      encoded_data_right.resize(4000);
+      int encoded_size = g722_encode_stereo(
+          encoder_state_left, encoder_state_right, encoded_data_left.data(),
+          encoded_data_right.data(), chan_both.data(), num_samples);
+      // Both channels get the same number of bytes
+      encoded_data_left.resize(encoded_size / 2);
+      encoded_data_right.resize(encoded_size / 2);
+    } else if (left) {
       // TODO: instead of a magic number, we need to figure out the correct
       // buffer size
       encoded_data_left.resize(4000);
@@ -1409,7 +1418,17 @@ class HearingAidImpl : public HearingAid {
           g722_encode(encoder_state_left, encoded_data_left.data(),
                       (const int16_t*)chan_left.data(), chan_left.size());
       encoded_data_left.resize(encoded_size);
+    } else {
+      // TODO: instead of a magic number, we need to figure out the correct
+      // buffer size
+      encoded_data_right.resize(4000);
+      int encoded_size =
+          g722_encode(encoder_state_right, encoded_data_right.data(),
+                      (const int16_t*)chan_right.data(), chan_right.size());
+      encoded_data_right.resize(encoded_size);
+    }
 
+    if (left) {
       uint16_t cid = GAP_ConnGetL2CAPCid(left->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans) {
@@ -1434,16 +1453,7 @@ class HearingAidImpl : public HearingAid {
       check_and_do_rssi_read(left);
     }
 
-    std::vector<uint8_t> encoded_data_right;
     if (right) {
-      // TODO: instead of a magic number, we need to figure out the correct
-      // buffer size
-      encoded_data_right.resize(4000);
-      int encoded_size =
-          g722_encode(encoder_state_right, encoded_data_right.data(),
-                      (const int16_t*)chan_right.data(), chan_right.size());
-      encoded_data_right.resize(encoded_size);
-
       uint16_t cid = GAP_ConnGetL2CAPCid(right->gap_handle);
       uint16_t packets_in_chans = L2CA_FlushChannel(cid, L2CAP_FLUSH_CHANS_GET);
       if (packets_in_chans) {
@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "btif/include/btif_sock_util.h"
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "stack/include/bt_hdr.h"
+
+using ::benchmark::State;
+
+namespace {
+
+constexpr uint16_t kHeadroom = 13;
+// MTU-sized RFCOMM frames, as queued by bta_co_rfc_data_incoming()
+constexpr uint16_t kFrameLen = 990;
+
+BT_HDR* AllocateFrame(uint16_t len) {
+  BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + kHeadroom + len);
+  p_buf->offset = kHeadroom;
+  p_buf->len = len;
+  memset(p_buf->data + p_buf->offset, 0x5a, len);
+  return p_buf;
+}
+
+void DrainSocket(int fd) {
+  uint8_t chunk[16384];
+  while (recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT) > 0) {
+  }
+}
+
+}  // namespace
+
+// Writes state.range(0) queued frames to the app socket per iteration, either
+// one send() per frame or gathered by sock_send_bt_hdr_queue().
+class BM_BtifSockSend : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    socketpair(AF_LOCAL, SOCK_STREAM, 0, fds_);
+    queue_ = list_new(osi_free);
+  }
+
+  void TearDown(State& st) override {
+    list_free(queue_);
+    close(fds_[0]);
+    close(fds_[1]);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  int fds_[2];
+  list_t* queue_ = nullptr;
+};
+
+BENCHMARK_DEFINE_F(BM_BtifSockSend, send_per_frame)(State& state) {
+  const int frames = state.range(0);
+  for (auto _ : state) {
+    for (int i = 0; i < frames; i++) {
+      BT_HDR* p_buf = AllocateFrame(kFrameLen);
+      send(fds_[0], p_buf->data + p_buf->offset, p_buf->len,
+           MSG_DONTWAIT | MSG_NOSIGNAL);
+      osi_free(p_buf);
+    }
+    DrainSocket(fds_[1]);
+  }
+  state.SetBytesProcessed(state.iterations() * frames * kFrameLen);
+}
+
+BENCHMARK_DEFINE_F(BM_BtifSockSend, send_gathered)(State& state) {
+  const int frames = state.range(0);
+  for (auto _ : state) {
+    for (int i = 0; i < frames; i++) {
+      list_append(queue_, AllocateFrame(kFrameLen));
+    }
+    sock_send_bt_hdr_queue(fds_[0], queue_);
+    DrainSocket(fds_[1]);
+  }
+  state.SetBytesProcessed(state.iterations() * frames * kFrameLen);
+}
+
+BENCHMARK_REGISTER_F(BM_BtifSockSend, send_per_frame)->Arg(1)->Arg(16);
+BENCHMARK_REGISTER_F(BM_BtifSockSend, send_gathered)->Arg(1)->Arg(16);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -29,8 +29,24 @@
 
 #include <stdint.h>
 
+#include "osi/include/list.h"
+
+typedef enum {
+  SOCK_SEND_FAILED,
+  SOCK_SEND_NONE,
+  SOCK_SEND_PARTIAL,
+  SOCK_SEND_ALL,
+} sock_send_status_t;
+
 int sock_send_fd(int sock_fd, const uint8_t* buffer, int len, int send_fd);
 int sock_send_all(int sock_fd, const uint8_t* buf, int len);
 int sock_recv_all(int sock_fd, uint8_t* buf, int len);
 
+// Writes the BT_HDR buffers queued in |queue| to the non-blocking socket
+// |sock_fd|, gathering up to SOCK_SEND_MAX_IOV buffers per sendmsg() call.
+// Buffers that were written completely are removed from |queue| (and freed by
+// the list's free callback); a buffer that was written partially stays at the
+// front of |queue| with its offset and length advanced past the written bytes.
+sock_send_status_t sock_send_bt_hdr_queue(int sock_fd, list_t* queue);
+
 #endif
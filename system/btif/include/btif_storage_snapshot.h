@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "stack/include/bt_octets.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+/* Everything btif_storage decodes from the config for one bonded device when
+ * the stack starts. A field is empty if the key is missing from the config. */
+struct BondedDeviceRecord {
+  RawAddress bd_addr;
+
+  std::optional<LinkKey> link_key;
+  std::optional<int> link_key_type;
+  std::optional<int> pin_length;
+  std::optional<int> dev_class;
+  std::optional<int> dev_type;
+  std::optional<int> addr_type;
+
+  /* Stored LE keys by BTM_LE_KEY_* type, as read into a tBTA_LE_KEY_VALUE */
+  std::map<uint8_t, std::vector<uint8_t>> le_keys;
+
+  std::optional<std::string> name;
+  std::optional<std::string> alias;
+  std::optional<std::string> model_num;
+  std::optional<std::vector<bluetooth::Uuid>> uuids;
+  std::optional<int> appearance;
+
+  struct VendorProductInfo {
+    int vendor_id_src;
+    int vendor_id;
+    int product_id;
+    int version;
+  };
+  std::optional<VendorProductInfo> vendor_product_info;
+
+  bool operator==(const BondedDeviceRecord& other) const;
+};
+
+/* Returns the FNV-1a hash of |data|, used to tie a snapshot to the contents
+ * of the config file it was decoded from. */
+uint64_t btif_storage_snapshot_checksum(const std::string& data);
+
+/* Returns the path of the snapshot that belongs to the config at
+ * |config_path|, e.g. "bt_config.conf" to "bt_config.snapshot". */
+std::string btif_storage_snapshot_path(const std::string& config_path);
+
+/* Encodes |records| into a versioned binary snapshot of the config whose
+ * checksum is |config_checksum|. */
+std::string btif_storage_snapshot_serialize(
+    uint64_t config_checksum, const std::vector<BondedDeviceRecord>& records);
+
+/* Decodes a snapshot produced by btif_storage_snapshot_serialize().
+ *
+ * Returns false, leaving |records| unchanged, if |data| is truncated or
+ * corrupted, was written by another version of the format or was taken from a
+ * config whose checksum is not |config_checksum|. */
+bool btif_storage_snapshot_parse(const std::string& data,
+                                 uint64_t config_checksum,
+                                 std::vector<BondedDeviceRecord>* records);
@@ -110,6 +110,7 @@
 #include "stack/include/hfp_msbc_encoder.h"
 #include "stack/include/hidh_api.h"
 #include "stack/include/pan_api.h"
+#include "stack/include/sdp_api.h"
 #include "stack_config.h"
 #include "types/raw_address.h"
 
@@ -795,6 +796,7 @@ static void dump(int fd, const char** arguments) {
   connection_manager::dump(fd);
   bluetooth::bqr::DebugDump(fd);
   PAN_Dumpsys(fd);
+  SDP_Dumpsys(fd);
   DumpsysHid(fd);
   DumpsysBtaDm(fd);
   bluetooth::shim::Dump(fd, arguments);
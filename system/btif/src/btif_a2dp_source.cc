@@ -185,6 +185,7 @@ class BtifA2dpSource {
   BtifA2dpSource()
       : tx_audio_queue(nullptr),
         tx_flush(false),
+        tx_queue_overflow(false),
         encoder_interface(nullptr),
         encoder_interval_ms(0),
         state_(kStateOff) {}
@@ -193,6 +194,7 @@ class BtifA2dpSource {
     fixed_queue_free(tx_audio_queue, nullptr);
     tx_audio_queue = nullptr;
     tx_flush = false;
+    tx_queue_overflow = false;
     media_alarm.CancelAndWait();
     wakelock_release();
     encoder_interface = nullptr;
@@ -220,6 +222,7 @@ class BtifA2dpSource {
 
   fixed_queue_t* tx_audio_queue;
   bool tx_flush; /* Discards any outgoing data when true */
+  bool tx_queue_overflow; /* Dropping the oldest packets to make room */
   RepeatingTimer media_alarm;
   const tA2DP_ENCODER_INTERFACE* encoder_interface;
   uint64_t encoder_interval_ms; /* Local copy of the encoder interval */
@@ -925,6 +928,20 @@ static void btif_a2dp_source_audio_handle_timer(void) {
     btif_a2dp_source_cb.encoder_interface->set_transmit_queue_length(
         transmit_queue_length);
   }
+  if (btif_a2dp_source_cb.encoder_interface->set_transmit_queue_delay !=
+      nullptr) {
+    // The queue only drains when the link has ACL credits for the next
+    // packet: the time since it last did is how long the link has stalled.
+    uint64_t last_dequeue_us =
+        btif_a2dp_source_cb.stats.tx_queue_dequeue_stats.last_update_us;
+    uint64_t transmit_queue_delay_us = 0;
+    if (transmit_queue_length > 0 && last_dequeue_us != 0 &&
+        stats_timestamp_us > last_dequeue_us) {
+      transmit_queue_delay_us = stats_timestamp_us - last_dequeue_us;
+    }
+    btif_a2dp_source_cb.encoder_interface->set_transmit_queue_delay(
+        transmit_queue_delay_us);
+  }
   btif_a2dp_source_cb.encoder_interface->send_frames(timestamp_us);
   bta_av_ci_src_data_ready(BTA_AV_CHNL_AUDIO);
   update_scheduling_stats(&btif_a2dp_source_cb.stats.tx_queue_enqueue_stats,
@@ -983,22 +1000,22 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
 
   // Check for TX queue overflow
   // TODO: Using frames_n here is probably wrong: should be "+ 1" instead.
-  if (fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue) + frames_n >
-      btif_a2dp_source_dynamic_audio_buffer_size) {
+  size_t queue_length = fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+  if (queue_length + frames_n > btif_a2dp_source_dynamic_audio_buffer_size) {
     LOG_WARN("%s: TX queue buffer size now=%u adding=%u max=%d", __func__,
-             (uint32_t)fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue),
-             (uint32_t)frames_n, btif_a2dp_source_dynamic_audio_buffer_size);
-    // Keep track of drop-outs
-    btif_a2dp_source_cb.stats.tx_queue_dropouts++;
-    btif_a2dp_source_cb.stats.tx_queue_last_dropouts_us = now_us;
-
-    // Flush all queued buffers
-    size_t drop_n = fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue);
+             (uint32_t)queue_length, (uint32_t)frames_n,
+             btif_a2dp_source_dynamic_audio_buffer_size);
+
+    // Drop the oldest buffers, just enough to make room: the peer only
+    // misses the audio that is already late rather than the whole queue.
+    size_t drop_n = std::min(
+        queue_length,
+        queue_length + frames_n - btif_a2dp_source_dynamic_audio_buffer_size);
     btif_a2dp_source_cb.stats.tx_queue_max_dropped_messages = std::max(
         drop_n, btif_a2dp_source_cb.stats.tx_queue_max_dropped_messages);
     int num_dropped_encoded_bytes = 0;
     int num_dropped_encoded_frames = 0;
-    while (fixed_queue_length(btif_a2dp_source_cb.tx_audio_queue)) {
+    for (size_t i = 0; i < drop_n; i++) {
       btif_a2dp_source_cb.stats.tx_queue_total_dropped_messages++;
       void* p_data =
           fixed_queue_try_dequeue(btif_a2dp_source_cb.tx_audio_queue);
@@ -1009,37 +1026,48 @@ static bool btif_a2dp_source_enqueue_callback(BT_HDR* p_buf, size_t frames_n,
         osi_free(p_data);
       }
     }
-    log_a2dp_audio_overrun_event(
-        btif_av_source_active_peer(), btif_a2dp_source_cb.encoder_interval_ms,
-        drop_n, num_dropped_encoded_frames, num_dropped_encoded_bytes);
-
-    // Intel controllers don't handle ReadRSSI, ReadFailedContactCounter, and
-    // ReadTxPower very well, it sends back Hardware Error event which will
-    // crash the daemon. So temporarily disable this for Floss.
-    // TODO(b/249876976): Intel controllers to handle this command correctly.
-    // And if the need for disabling metrics-related HCI call grows, consider
-    // creating a framework to avoid ifdefs.
+
+    if (!btif_a2dp_source_cb.tx_queue_overflow) {
+      // A congested link overflows the queue on every tick until it recovers:
+      // count that as one drop-out.
+      btif_a2dp_source_cb.tx_queue_overflow = true;
+      btif_a2dp_source_cb.stats.tx_queue_dropouts++;
+      btif_a2dp_source_cb.stats.tx_queue_last_dropouts_us = now_us;
+
+      log_a2dp_audio_overrun_event(
+          btif_av_source_active_peer(), btif_a2dp_source_cb.encoder_interval_ms,
+          drop_n, num_dropped_encoded_frames, num_dropped_encoded_bytes);
+
+      // Intel controllers don't handle ReadRSSI, ReadFailedContactCounter, and
+      // ReadTxPower very well, it sends back Hardware Error event which will
+      // crash the daemon. So temporarily disable this for Floss.
+      // TODO(b/249876976): Intel controllers to handle this command correctly.
+      // And if the need for disabling metrics-related HCI call grows, consider
+      // creating a framework to avoid ifdefs.
 #ifndef TARGET_FLOSS
-    // Request additional debug info if we had to flush buffers
-    RawAddress peer_bda = btif_av_source_active_peer();
-    tBTM_STATUS status = BTM_ReadRSSI(peer_bda, btm_read_rssi_cb);
-    if (status != BTM_CMD_STARTED) {
-      LOG_WARN("%s: Cannot read RSSI: status %d", __func__, status);
-    }
+      // Request additional debug info if we had to drop buffers
+      RawAddress peer_bda = btif_av_source_active_peer();
+      tBTM_STATUS status = BTM_ReadRSSI(peer_bda, btm_read_rssi_cb);
+      if (status != BTM_CMD_STARTED) {
+        LOG_WARN("%s: Cannot read RSSI: status %d", __func__, status);
+      }
 
-    status = BTM_ReadFailedContactCounter(peer_bda,
-                                          btm_read_failed_contact_counter_cb);
-    if (status != BTM_CMD_STARTED) {
-      LOG_WARN("%s: Cannot read Failed Contact Counter: status %d", __func__,
-               status);
-    }
+      status = BTM_ReadFailedContactCounter(peer_bda,
+                                            btm_read_failed_contact_counter_cb);
+      if (status != BTM_CMD_STARTED) {
+        LOG_WARN("%s: Cannot read Failed Contact Counter: status %d", __func__,
+                 status);
+      }
 
-    status =
-        BTM_ReadTxPower(peer_bda, BT_TRANSPORT_BR_EDR, btm_read_tx_power_cb);
-    if (status != BTM_CMD_STARTED) {
-      LOG_WARN("%s: Cannot read Tx Power: status %d", __func__, status);
-    }
+      status =
+          BTM_ReadTxPower(peer_bda, BT_TRANSPORT_BR_EDR, btm_read_tx_power_cb);
+      if (status != BTM_CMD_STARTED) {
+        LOG_WARN("%s: Cannot read Tx Power: status %d", __func__, status);
+      }
 #endif
+    }
+  } else {
+    btif_a2dp_source_cb.tx_queue_overflow = false;
   }
 
   /* Update the statistics */
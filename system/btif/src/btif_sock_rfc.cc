@@ -801,55 +801,21 @@ static void jv_dm_cback(tBTA_JV_EVT event, tBTA_JV* p_data, uint32_t id) {
   }
 }
 
-typedef enum {
-  SENT_FAILED,
-  SENT_NONE,
-  SENT_PARTIAL,
-  SENT_ALL,
-} sent_status_t;
-
-static sent_status_t send_data_to_app(int fd, BT_HDR* p_buf) {
-  if (p_buf->len == 0) return SENT_ALL;
-
-  ssize_t sent;
-  OSI_NO_INTR(
-      sent = send(fd, p_buf->data + p_buf->offset, p_buf->len, MSG_DONTWAIT));
-
-  if (sent == -1) {
-    if (errno == EAGAIN || errno == EWOULDBLOCK) return SENT_NONE;
-    LOG_ERROR("%s error writing RFCOMM data back to app: %s", __func__,
-              strerror(errno));
-    return SENT_FAILED;
-  }
-
-  if (sent == 0) return SENT_FAILED;
-
-  if (sent == p_buf->len) return SENT_ALL;
-
-  p_buf->offset += sent;
-  p_buf->len -= sent;
-  return SENT_PARTIAL;
-}
-
 static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
-  while (!list_is_empty(slot->incoming_queue)) {
-    BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
-    switch (send_data_to_app(slot->fd, p_buf)) {
-      case SENT_NONE:
-      case SENT_PARTIAL:
-        // monitor the fd to get callback when app is ready to receive data
-        btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR,
-                             slot->id);
-        return true;
+  switch (sock_send_bt_hdr_queue(slot->fd, slot->incoming_queue)) {
+    case SOCK_SEND_NONE:
+    case SOCK_SEND_PARTIAL:
+      // monitor the fd to get callback when app is ready to receive data
+      btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR,
+                           slot->id);
+      return true;
 
-      case SENT_ALL:
-        list_remove(slot->incoming_queue, p_buf);
-        break;
+    case SOCK_SEND_ALL:
+      break;
 
-      case SENT_FAILED:
-        list_remove(slot->incoming_queue, p_buf);
-        return false;
-    }
+    case SOCK_SEND_FAILED:
+      LOG_ERROR("%s error writing RFCOMM data back to app", __func__);
+      return false;
   }
 
   // app is ready to receive data, tell stack to start the data flow
@@ -916,25 +882,27 @@ int bta_co_rfc_data_incoming(uint32_t id, BT_HDR* p_buf) {
   bytes_rx = p_buf->len;
 
   if (list_is_empty(slot->incoming_queue)) {
-    switch (send_data_to_app(slot->fd, p_buf)) {
-      case SENT_NONE:
-      case SENT_PARTIAL:
-        list_append(slot->incoming_queue, p_buf);
+    list_append(slot->incoming_queue, p_buf);
+    switch (sock_send_bt_hdr_queue(slot->fd, slot->incoming_queue)) {
+      case SOCK_SEND_NONE:
+      case SOCK_SEND_PARTIAL:
         btsock_thread_add_fd(pth, slot->fd, BTSOCK_RFCOMM, SOCK_THREAD_FD_WR,
                              slot->id);
         break;
 
-      case SENT_ALL:
-        osi_free(p_buf);
+      case SOCK_SEND_ALL:
         ret = 1;  // Enable data flow.
         break;
 
-      case SENT_FAILED:
-        osi_free(p_buf);
+      case SOCK_SEND_FAILED:
+        LOG_ERROR("%s error writing RFCOMM data back to app", __func__);
+        // Frees the queued buffer along with the slot.
         cleanup_rfc_slot(slot);
         break;
     }
   } else {
+    // A write signal is already pending; the buffer goes out with the next
+    // gathered batch.
     list_append(slot->incoming_queue, p_buf);
   }
 
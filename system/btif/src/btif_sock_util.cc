@@ -30,6 +30,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
@@ -39,6 +40,10 @@
 #include "bt_target.h"
 #include "btif_util.h"
 #include "osi/include/osi.h"
+#include "stack/include/bt_hdr.h"
+
+// Maximum number of queued buffers gathered into a single sendmsg() call.
+#define SOCK_SEND_MAX_IOV 32
 
 #define asrt(s)                                                              \
   do {                                                                       \
@@ -132,3 +137,62 @@ int sock_send_fd(int sock_fd, const uint8_t* buf, int len, int send_fd) {
   close(send_fd);
   return ret_len;
 }
+
+sock_send_status_t sock_send_bt_hdr_queue(int sock_fd, list_t* queue) {
+  bool sent_any = false;
+
+  while (!list_is_empty(queue)) {
+    struct iovec iov[SOCK_SEND_MAX_IOV];
+    int iovcnt = 0;
+    size_t batch_len = 0;
+
+    for (const list_node_t* node = list_begin(queue);
+         node != list_end(queue) && iovcnt < SOCK_SEND_MAX_IOV;
+         node = list_next(node)) {
+      BT_HDR* p_buf = (BT_HDR*)list_node(node);
+      if (p_buf->len == 0) continue;
+      iov[iovcnt].iov_base = p_buf->data + p_buf->offset;
+      iov[iovcnt].iov_len = p_buf->len;
+      batch_len += p_buf->len;
+      iovcnt++;
+    }
+
+    ssize_t sent = 0;
+    if (iovcnt) {
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = iov;
+      msg.msg_iovlen = iovcnt;
+
+      OSI_NO_INTR(sent = sendmsg(sock_fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL));
+      if (sent == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+          return sent_any ? SOCK_SEND_PARTIAL : SOCK_SEND_NONE;
+        BTIF_TRACE_ERROR("%s fd:%d sendmsg errno:%d, %s", __func__, sock_fd,
+                         errno, strerror(errno));
+        return SOCK_SEND_FAILED;
+      }
+      if (sent == 0) return SOCK_SEND_FAILED;
+      sent_any = true;
+    }
+
+    // Release the buffers covered by this write, including any empty buffers
+    // in between, and advance a partially written one.
+    size_t remaining = sent;
+    while (!list_is_empty(queue)) {
+      BT_HDR* p_buf = (BT_HDR*)list_front(queue);
+      if (p_buf->len > remaining) {
+        p_buf->offset += remaining;
+        p_buf->len -= remaining;
+        break;
+      }
+      remaining -= p_buf->len;
+      list_remove(queue, p_buf);
+    }
+
+    // The socket buffer is full, wait for the next write signal.
+    if ((size_t)sent < batch_len) return SOCK_SEND_PARTIAL;
+  }
+
+  return SOCK_SEND_ALL;
+}
@@ -39,6 +39,9 @@
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -48,10 +51,13 @@
 #include "btif_hd.h"
 #include "btif_hh.h"
 #include "btif_storage.h"
+#include "btif_storage_snapshot.h"
 #include "btif_util.h"
 #include "core_callbacks.h"
 #include "device/include/controller.h"
 #include "gd/common/init_flags.h"
+#include "gd/os/files.h"
+#include "gd/os/parameter_provider.h"
 #include "osi/include/allocator.h"
 #include "osi/include/compat.h"
 #include "osi/include/config.h"
@@ -59,6 +65,7 @@
 #include "osi/include/osi.h"
 #include "stack/include/bt_octets.h"
 #include "stack/include/btu.h"
+#include "stack/include/sdp_api.h"
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
 
@@ -125,7 +132,9 @@ void btif_gatts_add_bonded_dev_from_nv(const RawAddress& bda);
  *  Internal Functions
  ******************************************************************************/
 
-static bool btif_has_ble_keys(const std::string& bdstr);
+static bt_status_t btif_in_fetch_bonded_devices(
+    btif_bonded_devices_t* p_bonded_devices, int add);
+static void btif_remove_bonded_device_snapshot();
 
 /*******************************************************************************
  *  Static functions
@@ -393,124 +402,6 @@ static int cfg2prop(const RawAddress* remote_bd_addr, bt_property_t* prop) {
   return ret;
 }
 
-/*******************************************************************************
- *
- * Function         btif_in_fetch_bonded_devices
- *
- * Description      Helper function to fetch the bonded devices
- *                  from NVRAM
- *
- * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
- *
- ******************************************************************************/
-bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr) {
-  bool bt_linkkey_file_found = false;
-
-  LinkKey link_key;
-  size_t size = link_key.size();
-  if (btif_config_get_bin(bdstr, "LinkKey", link_key.data(), &size)) {
-    int linkkey_type;
-    if (btif_config_get_int(bdstr, "LinkKeyType", &linkkey_type)) {
-      bt_linkkey_file_found = true;
-    } else {
-      bt_linkkey_file_found = false;
-    }
-  }
-  if ((btif_in_fetch_bonded_ble_device(bdstr, false, NULL) !=
-       BT_STATUS_SUCCESS) &&
-      (!bt_linkkey_file_found)) {
-    return BT_STATUS_FAIL;
-  }
-  return BT_STATUS_SUCCESS;
-}
-
-/*******************************************************************************
- *
- * Function         btif_in_fetch_bonded_devices
- *
- * Description      Internal helper function to fetch the bonded devices
- *                  from NVRAM
- *
- * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
- *
- ******************************************************************************/
-static bt_status_t btif_in_fetch_bonded_devices(
-    btif_bonded_devices_t* p_bonded_devices, int add) {
-  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
-
-  bool bt_linkkey_file_found = false;
-  int device_type;
-
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
-    BTIF_TRACE_DEBUG("Remote device:%s", ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
-    LinkKey link_key;
-    size_t size = sizeof(link_key);
-    if (btif_config_get_bin(name, "LinkKey", link_key.data(), &size)) {
-      int linkkey_type;
-      if (btif_config_get_int(name, "LinkKeyType", &linkkey_type)) {
-        if (add) {
-          DEV_CLASS dev_class = {0, 0, 0};
-          int cod;
-          int pin_length = 0;
-          if (btif_config_get_int(name, "DevClass", &cod))
-            uint2devclass((uint32_t)cod, dev_class);
-          btif_config_get_int(name, "PinLength", &pin_length);
-          BTA_DmAddDevice(bd_addr, dev_class, link_key, (uint8_t)linkkey_type,
-                          pin_length);
-
-          if (btif_config_get_int(name, "DevType", &device_type) &&
-              (device_type == BT_DEVICE_TYPE_DUMO)) {
-            btif_gatts_add_bonded_dev_from_nv(bd_addr);
-          }
-        }
-        bt_linkkey_file_found = true;
-        if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
-          p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
-        } else {
-          BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
-                             __func__);
-        }
-      } else {
-        bt_linkkey_file_found = false;
-      }
-    }
-    if (!btif_in_fetch_bonded_ble_device(name, add, p_bonded_devices) &&
-        !bt_linkkey_file_found) {
-      LOG_VERBOSE("No link key or ble key found for device:%s", name.c_str());
-    }
-  }
-  return BT_STATUS_SUCCESS;
-}
-
-static void btif_read_le_key(const uint8_t key_type, const size_t key_len,
-                             RawAddress bd_addr, const tBLE_ADDR_TYPE addr_type,
-                             const bool add_key, bool* device_added,
-                             bool* key_found) {
-  CHECK(device_added);
-  CHECK(key_found);
-
-  tBTA_LE_KEY_VALUE key;
-  memset(&key, 0, sizeof(key));
-
-  if (btif_storage_get_ble_bonding_key(bd_addr, key_type, (uint8_t*)&key,
-                                       key_len) == BT_STATUS_SUCCESS) {
-    if (add_key) {
-      if (!*device_added) {
-        BTA_DmAddBleDevice(bd_addr, addr_type, BT_DEVICE_TYPE_BLE);
-        *device_added = true;
-      }
-
-      BTIF_TRACE_DEBUG("%s() Adding key type %d for %s", __func__, key_type,
-                       ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
-      BTA_DmAddBleKey(bd_addr, &key, key_type);
-    }
-
-    *key_found = true;
-  }
-}
-
 /*******************************************************************************
  * Functions
  *
@@ -883,6 +774,9 @@ bt_status_t btif_storage_remove_bonded_device(
   if (btif_config_exist(bdstr, BTIF_STORAGE_KEY_GATT_SERVER_SUPPORTED)) {
     ret &= btif_config_remove(bdstr, BTIF_STORAGE_KEY_GATT_SERVER_SUPPORTED);
   }
+  SDP_InvalidateDiscoveryCache(*remote_bd_addr);
+  // Do not keep the keys of the device until the snapshot is written again
+  btif_remove_bonded_device_snapshot();
 
   /* Check the length of the paired devices, and if 0 then reset IRK */
   auto paired_devices = btif_config_get_paired_devices();
@@ -894,6 +788,432 @@ bt_status_t btif_storage_remove_bonded_device(
   return ret ? BT_STATUS_SUCCESS : BT_STATUS_FAIL;
 }
 
+/*******************************************************************************
+ *  Bonded device table
+ *
+ *  The bonded devices are decoded from the config once per stack start and
+ *  shared by btif_storage_load_le_devices() and
+ *  btif_storage_load_bonded_devices(). With the bonded_devices_snapshot init
+ *  flag the decoded table is also kept in a binary snapshot next to the config
+ *  and loaded from there for as long as the config file is unchanged.
+ *
+ *  Whatever the stack changes in the config between reading the file and
+ *  loading the bonded devices is derived from the file itself, or changes the
+ *  set of paired devices which is checked against the snapshot, so the
+ *  snapshot matches what would be decoded from the config.
+ *
+ *  The other lookups of the bonded devices decode the same records from the
+ *  config, without the properties sent to the upper layers.
+ ******************************************************************************/
+
+typedef struct {
+  uint8_t type;
+  size_t len;
+} btif_le_key_info_t;
+
+/* In the order the keys are added to BTA */
+static const btif_le_key_info_t btif_le_keys[] = {
+    {BTM_LE_KEY_PENC, sizeof(tBTM_LE_PENC_KEYS)},
+    {BTM_LE_KEY_PID, sizeof(tBTM_LE_PID_KEYS)},
+    {BTM_LE_KEY_LID, sizeof(tBTM_LE_PID_KEYS)},
+    {BTM_LE_KEY_PCSRK, sizeof(tBTM_LE_PCSRK_KEYS)},
+    {BTM_LE_KEY_LENC, sizeof(tBTM_LE_LENC_KEYS)},
+    {BTM_LE_KEY_LCSRK, sizeof(tBTM_LE_LCSRK_KEYS)},
+};
+
+/* Decoded by btif_storage_load_le_devices() for
+ * btif_storage_load_bonded_devices() */
+static std::optional<std::vector<BondedDeviceRecord>> bonded_device_records;
+
+static std::optional<int> get_config_int(const std::string& section,
+                                         const std::string& key) {
+  int value;
+  if (!btif_config_get_int(section, key, &value)) return std::nullopt;
+  return value;
+}
+
+static std::optional<std::string> get_remote_name_prop(
+    RawAddress* bd_addr, bt_property_type_t type) {
+  bt_bdname_t name;
+  bt_property_t prop;
+  if (btif_storage_get_remote_prop(bd_addr, type, &name, sizeof(name),
+                                   &prop) != BT_STATUS_SUCCESS) {
+    return std::nullopt;
+  }
+  return std::string((const char*)name.name, prop.len);
+}
+
+/* Same as btif_storage_get_ble_bonding_key() for |key_len| octets */
+static bool get_record_le_key(const BondedDeviceRecord& record,
+                              uint8_t key_type, size_t key_len,
+                              tBTA_LE_KEY_VALUE* key) {
+  auto it = record.le_keys.find(key_type);
+  if (it == record.le_keys.end()) return false;
+  memset(key, 0, sizeof(*key));
+  memcpy(key, it->second.data(), std::min(key_len, it->second.size()));
+  return true;
+}
+
+/* Reads the keys of the bond to |bd_addr|, leaving the properties sent to the
+ * upper layers empty */
+static BondedDeviceRecord read_bonded_device_keys(const RawAddress& bd_addr) {
+  BondedDeviceRecord record;
+  record.bd_addr = bd_addr;
+  auto bdstr = bd_addr.ToString();
+
+  LinkKey link_key = {};
+  size_t size = sizeof(link_key);
+  if (btif_config_get_bin(bdstr, "LinkKey", link_key.data(), &size)) {
+    record.link_key = link_key;
+  }
+  record.link_key_type = get_config_int(bdstr, "LinkKeyType");
+  record.pin_length = get_config_int(bdstr, "PinLength");
+  record.dev_class = get_config_int(bdstr, BTIF_STORAGE_PATH_REMOTE_DEVCLASS);
+  record.dev_type = get_config_int(bdstr, BTIF_STORAGE_PATH_REMOTE_DEVTYPE);
+  record.addr_type = get_config_int(bdstr, "AddrType");
+
+  for (const auto& le_key : btif_le_keys) {
+    tBTA_LE_KEY_VALUE key;
+    memset(&key, 0, sizeof(key));
+    if (btif_storage_get_ble_bonding_key(bd_addr, le_key.type, (uint8_t*)&key,
+                                         sizeof(key)) == BT_STATUS_SUCCESS) {
+      record.le_keys[le_key.type].assign((uint8_t*)&key,
+                                         (uint8_t*)&key + sizeof(key));
+    }
+  }
+  return record;
+}
+
+static BondedDeviceRecord read_bonded_device_record(RawAddress bd_addr) {
+  BondedDeviceRecord record = read_bonded_device_keys(bd_addr);
+  auto bdstr = bd_addr.ToString();
+
+  record.name = get_remote_name_prop(&bd_addr, BT_PROPERTY_BDNAME);
+  record.alias =
+      get_remote_name_prop(&bd_addr, BT_PROPERTY_REMOTE_FRIENDLY_NAME);
+  record.model_num =
+      get_remote_name_prop(&bd_addr, BT_PROPERTY_REMOTE_MODEL_NUM);
+
+  Uuid uuids[BT_MAX_NUM_UUIDS];
+  bt_property_t prop;
+  if (btif_storage_get_remote_prop(&bd_addr, BT_PROPERTY_UUIDS, uuids,
+                                   sizeof(uuids),
+                                   &prop) == BT_STATUS_SUCCESS) {
+    record.uuids.emplace(uuids, uuids + prop.len / sizeof(Uuid));
+  }
+  record.appearance = get_config_int(bdstr, BTIF_STORAGE_PATH_REMOTE_APPEARANCE);
+
+#if TARGET_FLOSS
+  bt_vendor_product_info_t vp_info;
+  if (btif_storage_get_remote_prop(&bd_addr, BT_PROPERTY_VENDOR_PRODUCT_INFO,
+                                   &vp_info, sizeof(vp_info),
+                                   &prop) == BT_STATUS_SUCCESS) {
+    record.vendor_product_info = BondedDeviceRecord::VendorProductInfo{
+        vp_info.vendor_id_src, vp_info.vendor_id, vp_info.product_id,
+        vp_info.version};
+  }
+#endif
+
+  return record;
+}
+
+static bool same_devices(const std::vector<BondedDeviceRecord>& records,
+                         const std::vector<RawAddress>& paired_devices) {
+  if (records.size() != paired_devices.size()) return false;
+  for (size_t i = 0; i < records.size(); i++) {
+    if (records[i].bd_addr != paired_devices[i]) return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_read_bonded_device_records
+ *
+ * Description      Internal helper function to decode the bonded devices from
+ *                  the snapshot if it is up to date, or from the config
+ *
+ * Returns          The bonded devices in the order of the config
+ *
+ ******************************************************************************/
+static std::vector<BondedDeviceRecord> btif_read_bonded_device_records() {
+  std::vector<RawAddress> paired_devices = btif_config_get_paired_devices();
+  std::string config_path = bluetooth::os::ParameterProvider::ConfigFilePath();
+  std::string snapshot_path = btif_storage_snapshot_path(config_path);
+
+  // Link keys are only stored encrypted in common criteria mode
+  if (!bluetooth::common::init_flags::bonded_devices_snapshot_is_enabled() ||
+      bluetooth::os::ParameterProvider::IsCommonCriteriaMode()) {
+    if (bluetooth::os::FileExists(snapshot_path)) {
+      bluetooth::os::RemoveFile(snapshot_path);
+    }
+    snapshot_path.clear();
+  }
+
+  std::optional<uint64_t> config_checksum;
+  if (!snapshot_path.empty()) {
+    auto config = bluetooth::os::ReadSmallFile(config_path);
+    if (config) config_checksum = btif_storage_snapshot_checksum(*config);
+    auto snapshot = bluetooth::os::ReadSmallFile(snapshot_path);
+
+    std::vector<BondedDeviceRecord> records;
+    if (config_checksum && snapshot &&
+        btif_storage_snapshot_parse(*snapshot, *config_checksum, &records) &&
+        same_devices(records, paired_devices)) {
+      LOG_INFO("Loaded %zu bonded devices from %s", records.size(),
+               snapshot_path.c_str());
+      return records;
+    }
+  }
+
+  std::vector<BondedDeviceRecord> records;
+  records.reserve(paired_devices.size());
+  for (const auto& bd_addr : paired_devices) {
+    records.push_back(read_bonded_device_record(bd_addr));
+  }
+
+  if (config_checksum &&
+      !bluetooth::os::WriteToFile(
+          snapshot_path,
+          btif_storage_snapshot_serialize(*config_checksum, records))) {
+    LOG_WARN("Unable to write %s", snapshot_path.c_str());
+  }
+  return records;
+}
+
+static void btif_remove_bonded_device_snapshot() {
+  std::string snapshot_path = btif_storage_snapshot_path(
+      bluetooth::os::ParameterProvider::ConfigFilePath());
+  if (bluetooth::os::FileExists(snapshot_path)) {
+    bluetooth::os::RemoveFile(snapshot_path);
+  }
+}
+
+static void btif_add_bonded_device(btif_bonded_devices_t* p_bonded_devices,
+                                   const RawAddress& bd_addr) {
+  if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
+    p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
+  } else {
+    BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
+                       __func__);
+  }
+}
+
+/* Adds the LE keys of |record| to BTA if |add| is set, and then the device to
+ * |p_bonded_devices|. Returns true if the device has any LE key stored. */
+static bool btif_in_add_bonded_ble_device(
+    const BondedDeviceRecord& record, int add,
+    btif_bonded_devices_t* p_bonded_devices) {
+  if (!record.dev_type) return false;
+  if ((*record.dev_type & BT_DEVICE_TYPE_BLE) != BT_DEVICE_TYPE_BLE &&
+      record.le_keys.count(BTM_LE_KEY_PENC) == 0) {
+    return false;
+  }
+
+  const RawAddress& bd_addr = record.bd_addr;
+  BTIF_TRACE_DEBUG("%s Found a LE device: %s", __func__,
+                   ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+
+  tBLE_ADDR_TYPE addr_type = BLE_ADDR_PUBLIC;
+  if (record.addr_type) {
+    addr_type = static_cast<tBLE_ADDR_TYPE>(*record.addr_type);
+  } else {
+    btif_storage_set_remote_addr_type(&bd_addr, BLE_ADDR_PUBLIC);
+  }
+
+  bool device_added = false;
+  bool key_found = false;
+  for (const auto& le_key : btif_le_keys) {
+    tBTA_LE_KEY_VALUE key;
+    if (!get_record_le_key(record, le_key.type, le_key.len, &key)) continue;
+
+    if (add) {
+      if (!device_added) {
+        BTA_DmAddBleDevice(bd_addr, addr_type, BT_DEVICE_TYPE_BLE);
+        device_added = true;
+      }
+      BTIF_TRACE_DEBUG("%s() Adding key type %d for %s", __func__,
+                       le_key.type, ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+      BTA_DmAddBleKey(bd_addr, &key, le_key.type);
+    }
+    key_found = true;
+  }
+
+  if (device_added) {
+    btif_add_bonded_device(p_bonded_devices, bd_addr);
+    btif_gatts_add_bonded_dev_from_nv(bd_addr);
+  }
+  return key_found;
+}
+
+/* Returns true if |record| holds a complete BR/EDR link key */
+static bool has_link_key(const BondedDeviceRecord& record) {
+  return record.link_key && record.link_key_type;
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_in_add_bonded_devices
+ *
+ * Description      Internal helper function to list the bonded devices in
+ *                  |records| and, if |add| is set, add their keys to BTA
+ *
+ ******************************************************************************/
+static void btif_in_add_bonded_devices(
+    const std::vector<BondedDeviceRecord>& records, int add,
+    btif_bonded_devices_t* p_bonded_devices) {
+  memset(p_bonded_devices, 0, sizeof(btif_bonded_devices_t));
+
+  for (const auto& record : records) {
+    const RawAddress& bd_addr = record.bd_addr;
+    BTIF_TRACE_DEBUG("Remote device:%s", ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+
+    if (has_link_key(record)) {
+      if (add) {
+        DEV_CLASS dev_class = {0, 0, 0};
+        if (record.dev_class) {
+          uint2devclass((uint32_t)*record.dev_class, dev_class);
+        }
+        BTA_DmAddDevice(bd_addr, dev_class, *record.link_key,
+                        (uint8_t)*record.link_key_type,
+                        record.pin_length.value_or(0));
+
+        if (record.dev_type == BT_DEVICE_TYPE_DUMO) {
+          btif_gatts_add_bonded_dev_from_nv(bd_addr);
+        }
+      }
+      btif_add_bonded_device(p_bonded_devices, bd_addr);
+    }
+    if (!btif_in_add_bonded_ble_device(record, add, p_bonded_devices) &&
+        !has_link_key(record)) {
+      LOG_VERBOSE("No link key or ble key found for device:%s",
+                  ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    }
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_in_fetch_bonded_device
+ *
+ * Description      Helper function to fetch the bonded devices
+ *                  from NVRAM
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+bt_status_t btif_in_fetch_bonded_device(const std::string& bdstr) {
+  RawAddress bd_addr;
+  RawAddress::FromString(bdstr, bd_addr);
+  BondedDeviceRecord record = read_bonded_device_keys(bd_addr);
+
+  if (!btif_in_add_bonded_ble_device(record, false, NULL) &&
+      !has_link_key(record)) {
+    return BT_STATUS_FAIL;
+  }
+  return BT_STATUS_SUCCESS;
+}
+
+/*******************************************************************************
+ *
+ * Function         btif_in_fetch_bonded_devices
+ *
+ * Description      Internal helper function to fetch the bonded devices
+ *                  from NVRAM
+ *
+ * Returns          BT_STATUS_SUCCESS if successful, BT_STATUS_FAIL otherwise
+ *
+ ******************************************************************************/
+static bt_status_t btif_in_fetch_bonded_devices(
+    btif_bonded_devices_t* p_bonded_devices, int add) {
+  std::vector<BondedDeviceRecord> records;
+  for (const auto& bd_addr : btif_config_get_paired_devices()) {
+    records.push_back(read_bonded_device_keys(bd_addr));
+  }
+  btif_in_add_bonded_devices(records, add, p_bonded_devices);
+  return BT_STATUS_SUCCESS;
+}
+
+bt_status_t btif_in_fetch_bonded_ble_device(
+    const std::string& remote_bd_addr, int add,
+    btif_bonded_devices_t* p_bonded_devices) {
+  RawAddress bd_addr;
+  RawAddress::FromString(remote_bd_addr, bd_addr);
+  BondedDeviceRecord record = read_bonded_device_keys(bd_addr);
+
+  return btif_in_add_bonded_ble_device(record, add, p_bonded_devices)
+             ? BT_STATUS_SUCCESS
+             : BT_STATUS_FAIL;
+}
+
+/* Sends the properties btif_storage_get_remote_prop() would read for the
+ * device */
+static void btif_remote_properties_from_record(
+    const BondedDeviceRecord& record) {
+  bt_property_t remote_properties[10];
+  uint32_t num_props = 0;
+  RawAddress bd_addr = record.bd_addr;
+  bt_bdname_t name, alias, model_name;
+  Uuid remote_uuids[BT_MAX_NUM_UUIDS];
+
+  memset(remote_properties, 0, sizeof(remote_properties));
+  auto add_prop = [&](bt_property_type_t type, void* val, int len) {
+    remote_properties[num_props++] = {type, len, val};
+  };
+  auto add_name = [&](bt_property_type_t type, bt_bdname_t* buf,
+                      const std::optional<std::string>& value) {
+    size_t len = 0;
+    if (value) {
+      len = std::min(value->size(), sizeof(buf->name) - 1);
+      memcpy(buf->name, value->data(), len);
+      buf->name[len] = '\0';
+    }
+    add_prop(type, buf, len);
+  };
+
+  /*
+   * TODO: improve handling of missing fields in NVRAM.
+   */
+  uint32_t cod = record.dev_class.value_or(0);
+  uint32_t devtype = record.dev_type.value_or(0);
+
+  add_name(BT_PROPERTY_BDNAME, &name, record.name);
+  add_name(BT_PROPERTY_REMOTE_FRIENDLY_NAME, &alias, record.alias);
+  add_prop(BT_PROPERTY_CLASS_OF_DEVICE, &cod, sizeof(cod));
+  add_prop(BT_PROPERTY_TYPE_OF_DEVICE, &devtype, sizeof(devtype));
+  if (record.uuids) {
+    size_t num_uuids = std::min(record.uuids->size(), (size_t)BT_MAX_NUM_UUIDS);
+    std::copy_n(record.uuids->begin(), num_uuids, remote_uuids);
+    add_prop(BT_PROPERTY_UUIDS, remote_uuids, num_uuids * sizeof(Uuid));
+  } else {
+    add_prop(BT_PROPERTY_UUIDS, NULL, 0);
+  }
+
+  // Floss needs appearance for metrics purposes
+  uint16_t appearance = 0;
+  if (record.appearance) {
+    appearance = (uint16_t)*record.appearance;
+    add_prop(BT_PROPERTY_APPEARANCE, &appearance, sizeof(appearance));
+  }
+
+#if TARGET_FLOSS
+  // Floss needs VID:PID for metrics purposes
+  bt_vendor_product_info_t vp_info;
+  if (record.vendor_product_info) {
+    vp_info.vendor_id_src = (uint8_t)record.vendor_product_info->vendor_id_src;
+    vp_info.vendor_id = (uint16_t)record.vendor_product_info->vendor_id;
+    vp_info.product_id = (uint16_t)record.vendor_product_info->product_id;
+    vp_info.version = (uint16_t)record.vendor_product_info->version;
+    add_prop(BT_PROPERTY_VENDOR_PRODUCT_INFO, &vp_info, sizeof(vp_info));
+  }
+#endif
+
+  add_name(BT_PROPERTY_REMOTE_MODEL_NUM, &model_name, record.model_num);
+
+  btif_remote_properties_evt(BT_STATUS_SUCCESS, &bd_addr, num_props,
+                             remote_properties);
+}
+
 /* Some devices hardcode sample LTK value from spec, instead of generating one.
  * Treat such devices as insecure, and remove such bonds when bluetooth
  * restarts. Removing them after disconnection is handled separately.
@@ -901,20 +1221,15 @@ bt_status_t btif_storage_remove_bonded_device(
  * We still allow such devices to bond in order to give the user a chance to
  * update firmware.
  */
-static void remove_devices_with_sample_ltk() {
+static void remove_devices_with_sample_ltk(
+    std::vector<BondedDeviceRecord>* records) {
   std::vector<RawAddress> bad_ltk;
-  for (const auto& bd_addr : btif_config_get_paired_devices()) {
-    auto name = bd_addr.ToString();
-
+  for (const auto& record : *records) {
     tBTA_LE_KEY_VALUE key;
-    memset(&key, 0, sizeof(key));
-
-    if (btif_storage_get_ble_bonding_key(
-            bd_addr, BTM_LE_KEY_PENC, (uint8_t*)&key,
-            sizeof(tBTM_LE_PENC_KEYS)) == BT_STATUS_SUCCESS) {
-      if (is_sample_ltk(key.penc_key.ltk)) {
-        bad_ltk.push_back(bd_addr);
-      }
+    if (get_record_le_key(record, BTM_LE_KEY_PENC, sizeof(tBTM_LE_PENC_KEYS),
+                          &key) &&
+        is_sample_ltk(key.penc_key.ltk)) {
+      bad_ltk.push_back(record.bd_addr);
     }
   }
 
@@ -923,6 +1238,11 @@ static void remove_devices_with_sample_ltk() {
                << ADDRESS_TO_LOGGABLE_STR(address);
 
     btif_storage_remove_bonded_device(&address);
+    records->erase(std::remove_if(records->begin(), records->end(),
+                                  [&](const BondedDeviceRecord& record) {
+                                    return record.bd_addr == address;
+                                  }),
+                   records->end());
   }
 }
 
@@ -940,19 +1260,23 @@ static void remove_devices_with_sample_ltk() {
  ******************************************************************************/
 void btif_storage_load_le_devices(void) {
   btif_bonded_devices_t bonded_devices;
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  bonded_device_records = btif_read_bonded_device_records();
+  btif_in_add_bonded_devices(*bonded_device_records, true, &bonded_devices);
   std::unordered_set<RawAddress> bonded_addresses;
   for (uint16_t i = 0; i < bonded_devices.num_devices; i++) {
     bonded_addresses.insert(bonded_devices.devices[i]);
   }
 
+  std::unordered_map<RawAddress, const BondedDeviceRecord*> records;
+  for (const auto& record : *bonded_device_records) {
+    records.emplace(record.bd_addr, &record);
+  }
+
   std::vector<std::pair<RawAddress, RawAddress>> consolidated_devices;
   for (uint16_t i = 0; i < bonded_devices.num_devices; i++) {
-    // RawAddress* p_remote_addr;
-    tBTA_LE_KEY_VALUE key = {};
-    if (btif_storage_get_ble_bonding_key(
-            bonded_devices.devices[i], BTM_LE_KEY_PID, (uint8_t*)&key,
-            sizeof(tBTM_LE_PID_KEYS)) == BT_STATUS_SUCCESS) {
+    tBTA_LE_KEY_VALUE key;
+    if (get_record_le_key(*records[bonded_devices.devices[i]], BTM_LE_KEY_PID,
+                          sizeof(tBTM_LE_PID_KEYS), &key)) {
       if (bonded_devices.devices[i] != key.pid_key.identity_addr) {
         LOG_INFO("found device with a known identity address %s %s",
                  ADDRESS_TO_LOGGABLE_CSTR(bonded_devices.devices[i]),
@@ -1016,18 +1340,21 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   uint32_t i = 0;
   bt_property_t adapter_props[6];
   uint32_t num_props = 0;
-  bt_property_t remote_properties[10];
   RawAddress addr;
-  bt_bdname_t name, alias, model_name;
+  bt_bdname_t name;
   bt_scan_mode_t mode;
   uint32_t disc_timeout;
   Uuid local_uuids[BT_MAX_NUM_UUIDS];
-  Uuid remote_uuids[BT_MAX_NUM_UUIDS];
   bt_status_t status;
 
-  remove_devices_with_sample_ltk();
+  std::vector<BondedDeviceRecord> records =
+      bonded_device_records ? std::move(*bonded_device_records)
+                            : btif_read_bonded_device_records();
+  bonded_device_records.reset();
+
+  remove_devices_with_sample_ltk(&records);
 
-  btif_in_fetch_bonded_devices(&bonded_devices, 1);
+  btif_in_add_bonded_devices(records, true, &bonded_devices);
 
   /* Now send the adapter_properties_cb with all adapter_properties */
   {
@@ -1090,71 +1417,13 @@ bt_status_t btif_storage_load_bonded_devices(void) {
   BTIF_TRACE_EVENT("%s: %d bonded devices found", __func__,
                    bonded_devices.num_devices);
 
-  {
-    for (i = 0; i < bonded_devices.num_devices; i++) {
-      RawAddress* p_remote_addr;
-
-      /*
-       * TODO: improve handling of missing fields in NVRAM.
-       */
-      uint32_t cod = 0;
-      uint32_t devtype = 0;
-
-      num_props = 0;
-      p_remote_addr = &bonded_devices.devices[i];
-      memset(remote_properties, 0, sizeof(remote_properties));
-      btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_BDNAME, &name,
-                                   sizeof(name), &remote_properties[num_props]);
-      num_props++;
-
-      btif_storage_get_remote_prop(
-          p_remote_addr, BT_PROPERTY_REMOTE_FRIENDLY_NAME, &alias,
-          sizeof(alias), &remote_properties[num_props]);
-      num_props++;
-
-      btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_CLASS_OF_DEVICE,
-                                   &cod, sizeof(cod),
-                                   &remote_properties[num_props]);
-      num_props++;
-
-      btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_TYPE_OF_DEVICE,
-                                   &devtype, sizeof(devtype),
-                                   &remote_properties[num_props]);
-      num_props++;
-
-      btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_UUIDS,
-                                   remote_uuids, sizeof(remote_uuids),
-                                   &remote_properties[num_props]);
-      num_props++;
-
-      // Floss needs appearance for metrics purposes
-      uint16_t appearance = 0;
-      if (btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_APPEARANCE,
-                                       &appearance, sizeof(appearance),
-                                       &remote_properties[num_props]) ==
-          BT_STATUS_SUCCESS) {
-        num_props++;
-      }
-
-#if TARGET_FLOSS
-      // Floss needs VID:PID for metrics purposes
-      bt_vendor_product_info_t vp_info;
-      if (btif_storage_get_remote_prop(
-              p_remote_addr, BT_PROPERTY_VENDOR_PRODUCT_INFO, &vp_info,
-              sizeof(vp_info),
-              &remote_properties[num_props]) == BT_STATUS_SUCCESS) {
-        num_props++;
-      }
-#endif
-
-      btif_storage_get_remote_prop(p_remote_addr, BT_PROPERTY_REMOTE_MODEL_NUM,
-                                   &model_name, sizeof(model_name),
-                                   &remote_properties[num_props]);
-      num_props++;
-
-      btif_remote_properties_evt(BT_STATUS_SUCCESS, p_remote_addr, num_props,
-                                 remote_properties);
-    }
+  std::unordered_map<RawAddress, const BondedDeviceRecord*> records_by_addr;
+  for (const auto& record : records) {
+    records_by_addr.emplace(record.bd_addr, &record);
+  }
+  for (i = 0; i < bonded_devices.num_devices; i++) {
+    btif_remote_properties_from_record(
+        *records_by_addr[bonded_devices.devices[i]]);
   }
   return BT_STATUS_SUCCESS;
 }
@@ -1359,65 +1628,6 @@ bt_status_t btif_storage_remove_ble_local_keys(void) {
   return ret ? BT_STATUS_SUCCESS : BT_STATUS_FAIL;
 }
 
-bt_status_t btif_in_fetch_bonded_ble_device(
-    const std::string& remote_bd_addr, int add,
-    btif_bonded_devices_t* p_bonded_devices) {
-  int device_type;
-  tBLE_ADDR_TYPE addr_type;
-  bool device_added = false;
-  bool key_found = false;
-
-  if (!btif_config_get_int(remote_bd_addr, "DevType", &device_type))
-    return BT_STATUS_FAIL;
-
-  if ((device_type & BT_DEVICE_TYPE_BLE) == BT_DEVICE_TYPE_BLE ||
-      btif_has_ble_keys(remote_bd_addr)) {
-    BTIF_TRACE_DEBUG("%s Found a LE device: %s", __func__,
-                     remote_bd_addr.c_str());
-
-    RawAddress bd_addr;
-    RawAddress::FromString(remote_bd_addr, bd_addr);
-
-    if (btif_storage_get_remote_addr_type(&bd_addr, &addr_type) !=
-        BT_STATUS_SUCCESS) {
-      addr_type = BLE_ADDR_PUBLIC;
-      btif_storage_set_remote_addr_type(&bd_addr, BLE_ADDR_PUBLIC);
-    }
-
-    btif_read_le_key(BTM_LE_KEY_PENC, sizeof(tBTM_LE_PENC_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_PID, sizeof(tBTM_LE_PID_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LID, sizeof(tBTM_LE_PID_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_PCSRK, sizeof(tBTM_LE_PCSRK_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LENC, sizeof(tBTM_LE_LENC_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    btif_read_le_key(BTM_LE_KEY_LCSRK, sizeof(tBTM_LE_LCSRK_KEYS), bd_addr,
-                     addr_type, add, &device_added, &key_found);
-
-    // Fill in the bonded devices
-    if (device_added) {
-      if (p_bonded_devices->num_devices < BTM_SEC_MAX_DEVICE_RECORDS) {
-        p_bonded_devices->devices[p_bonded_devices->num_devices++] = bd_addr;
-      } else {
-        BTIF_TRACE_WARNING("%s: exceed the max number of bonded devices",
-                           __func__);
-      }
-      btif_gatts_add_bonded_dev_from_nv(bd_addr);
-    }
-
-    if (key_found) return BT_STATUS_SUCCESS;
-  }
-  return BT_STATUS_FAIL;
-}
-
 bt_status_t btif_storage_set_remote_addr_type(const RawAddress* remote_bd_addr,
                                               tBLE_ADDR_TYPE addr_type) {
   int ret = btif_config_set_int(remote_bd_addr->ToString(), "AddrType",
@@ -1439,10 +1649,6 @@ void btif_storage_set_remote_device_type(const RawAddress& remote_bd_addr,
     LOG_ERROR("Unable to set storage property");
 }
 
-bool btif_has_ble_keys(const std::string& bdstr) {
-  return btif_config_exist(bdstr, "LE_KEY_PENC");
-}
-
 /*******************************************************************************
  *
  * Function         btif_storage_get_remote_addr_type
@@ -0,0 +1,315 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/* Binary snapshot of the bonded devices decoded from the config.
+ *
+ * All integers are little endian. The snapshot is
+ *
+ *   magic (4) | version (2) | config checksum (8) | record count (4)
+ *   records...
+ *   checksum of everything above (8)
+ *
+ * and every record is the 6 octets of the address followed by the fields
+ * present in the config as tag (1) | length (2) | value, ended by kTagEnd.
+ */
+
+#include "btif/include/btif_storage_snapshot.h"
+
+#include <cstring>
+
+using bluetooth::Uuid;
+
+namespace {
+
+constexpr uint32_t kMagic = 0x534e4442;  // "BDNS"
+constexpr uint16_t kVersion = 1;
+constexpr size_t kHeaderSize = 4 + 2 + 8 + 4;
+constexpr size_t kTrailerSize = 8;
+
+enum : uint8_t {
+  kTagEnd = 0,
+  kTagLinkKey,
+  kTagLinkKeyType,
+  kTagPinLength,
+  kTagDevClass,
+  kTagDevType,
+  kTagAddrType,
+  kTagLeKey,
+  kTagName,
+  kTagAlias,
+  kTagModelNum,
+  kTagUuids,
+  kTagAppearance,
+  kTagVendorProductInfo,
+};
+
+class Writer {
+ public:
+  explicit Writer(std::string* out) : out_(out) {}
+
+  void Put(uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) out_->push_back((char)(value >> (8 * i)));
+  }
+
+  void PutBytes(const void* data, size_t size) {
+    out_->append((const char*)data, size);
+  }
+
+  void PutField(uint8_t tag, const void* data, size_t size) {
+    Put(tag, 1);
+    Put(size, 2);
+    PutBytes(data, size);
+  }
+
+  void PutInt(uint8_t tag, const std::optional<int>& value) {
+    if (!value) return;
+    Put(tag, 1);
+    Put(4, 2);
+    Put((uint32_t)*value, 4);
+  }
+
+  void PutString(uint8_t tag, const std::optional<std::string>& value) {
+    if (value) PutField(tag, value->data(), value->size());
+  }
+
+ private:
+  std::string* out_;
+};
+
+class Reader {
+ public:
+  Reader(const uint8_t* data, size_t size) : data_(data), end_(data + size) {}
+
+  bool Get(uint64_t* value, size_t size) {
+    if ((size_t)(end_ - data_) < size) return false;
+    *value = 0;
+    for (size_t i = 0; i < size; i++) *value |= (uint64_t)data_[i] << (8 * i);
+    data_ += size;
+    return true;
+  }
+
+  const uint8_t* GetBytes(size_t size) {
+    if ((size_t)(end_ - data_) < size) return nullptr;
+    const uint8_t* bytes = data_;
+    data_ += size;
+    return bytes;
+  }
+
+  bool Done() const { return data_ == end_; }
+
+ private:
+  const uint8_t* data_;
+  const uint8_t* end_;
+};
+
+uint64_t Fnv1a(const uint8_t* data, size_t size) {
+  uint64_t hash = 0xcbf29ce484222325;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+int ToInt(const uint8_t* p) {
+  return (int)((uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 |
+               (uint32_t)p[3] << 24);
+}
+
+void SerializeRecord(const BondedDeviceRecord& record, Writer* writer) {
+  writer->PutBytes(record.bd_addr.address, RawAddress::kLength);
+  if (record.link_key) {
+    writer->PutField(kTagLinkKey, record.link_key->data(),
+                     record.link_key->size());
+  }
+  writer->PutInt(kTagLinkKeyType, record.link_key_type);
+  writer->PutInt(kTagPinLength, record.pin_length);
+  writer->PutInt(kTagDevClass, record.dev_class);
+  writer->PutInt(kTagDevType, record.dev_type);
+  writer->PutInt(kTagAddrType, record.addr_type);
+  for (const auto& [key_type, key] : record.le_keys) {
+    writer->Put(kTagLeKey, 1);
+    writer->Put(1 + key.size(), 2);
+    writer->Put(key_type, 1);
+    writer->PutBytes(key.data(), key.size());
+  }
+  writer->PutString(kTagName, record.name);
+  writer->PutString(kTagAlias, record.alias);
+  writer->PutString(kTagModelNum, record.model_num);
+  if (record.uuids) {
+    writer->Put(kTagUuids, 1);
+    writer->Put(record.uuids->size() * Uuid::kNumBytes128, 2);
+    for (const Uuid& uuid : *record.uuids) {
+      writer->PutBytes(uuid.To128BitBE().data(), Uuid::kNumBytes128);
+    }
+  }
+  writer->PutInt(kTagAppearance, record.appearance);
+  if (record.vendor_product_info) {
+    const auto& info = *record.vendor_product_info;
+    writer->Put(kTagVendorProductInfo, 1);
+    writer->Put(16, 2);
+    writer->Put((uint32_t)info.vendor_id_src, 4);
+    writer->Put((uint32_t)info.vendor_id, 4);
+    writer->Put((uint32_t)info.product_id, 4);
+    writer->Put((uint32_t)info.version, 4);
+  }
+  writer->Put(kTagEnd, 1);
+}
+
+bool ParseRecord(Reader* reader, BondedDeviceRecord* record) {
+  const uint8_t* address = reader->GetBytes(RawAddress::kLength);
+  if (address == nullptr) return false;
+  record->bd_addr.FromOctets(address);
+
+  for (;;) {
+    uint64_t tag, size;
+    if (!reader->Get(&tag, 1)) return false;
+    if (tag == kTagEnd) return true;
+    if (!reader->Get(&size, 2)) return false;
+    const uint8_t* value = reader->GetBytes(size);
+    if (value == nullptr) return false;
+
+    switch (tag) {
+      case kTagLinkKey:
+        if (size != LINK_KEY_LEN) return false;
+        record->link_key.emplace();
+        memcpy(record->link_key->data(), value, LINK_KEY_LEN);
+        break;
+      case kTagLinkKeyType:
+      case kTagPinLength:
+      case kTagDevClass:
+      case kTagDevType:
+      case kTagAddrType:
+      case kTagAppearance: {
+        if (size != 4) return false;
+        std::optional<int>* field =
+            tag == kTagLinkKeyType  ? &record->link_key_type
+            : tag == kTagPinLength  ? &record->pin_length
+            : tag == kTagDevClass   ? &record->dev_class
+            : tag == kTagDevType    ? &record->dev_type
+            : tag == kTagAddrType   ? &record->addr_type
+                                    : &record->appearance;
+        *field = ToInt(value);
+        break;
+      }
+      case kTagLeKey:
+        if (size < 1) return false;
+        record->le_keys[value[0]].assign(value + 1, value + size);
+        break;
+      case kTagName:
+        record->name.emplace((const char*)value, size);
+        break;
+      case kTagAlias:
+        record->alias.emplace((const char*)value, size);
+        break;
+      case kTagModelNum:
+        record->model_num.emplace((const char*)value, size);
+        break;
+      case kTagUuids:
+        if (size % Uuid::kNumBytes128 != 0) return false;
+        record->uuids.emplace();
+        for (size_t i = 0; i < size; i += Uuid::kNumBytes128) {
+          record->uuids->push_back(Uuid::From128BitBE(value + i));
+        }
+        break;
+      case kTagVendorProductInfo:
+        if (size != 16) return false;
+        record->vendor_product_info = BondedDeviceRecord::VendorProductInfo{
+            ToInt(value), ToInt(value + 4), ToInt(value + 8),
+            ToInt(value + 12)};
+        break;
+      default:
+        // The tags only change together with the version
+        return false;
+    }
+  }
+}
+
+}  // namespace
+
+bool BondedDeviceRecord::operator==(const BondedDeviceRecord& other) const {
+  auto same_info = [](const std::optional<VendorProductInfo>& a,
+                      const std::optional<VendorProductInfo>& b) {
+    if (!a || !b) return !a && !b;
+    return a->vendor_id_src == b->vendor_id_src &&
+           a->vendor_id == b->vendor_id && a->product_id == b->product_id &&
+           a->version == b->version;
+  };
+  return bd_addr == other.bd_addr && link_key == other.link_key &&
+         link_key_type == other.link_key_type &&
+         pin_length == other.pin_length && dev_class == other.dev_class &&
+         dev_type == other.dev_type && addr_type == other.addr_type &&
+         le_keys == other.le_keys && name == other.name &&
+         alias == other.alias && model_num == other.model_num &&
+         uuids == other.uuids && appearance == other.appearance &&
+         same_info(vendor_product_info, other.vendor_product_info);
+}
+
+uint64_t btif_storage_snapshot_checksum(const std::string& data) {
+  return Fnv1a((const uint8_t*)data.data(), data.size());
+}
+
+std::string btif_storage_snapshot_path(const std::string& config_path) {
+  return config_path.substr(0, config_path.find_last_of('.')) + ".snapshot";
+}
+
+std::string btif_storage_snapshot_serialize(
+    uint64_t config_checksum, const std::vector<BondedDeviceRecord>& records) {
+  std::string out;
+  Writer writer(&out);
+  writer.Put(kMagic, 4);
+  writer.Put(kVersion, 2);
+  writer.Put(config_checksum, 8);
+  writer.Put(records.size(), 4);
+  for (const auto& record : records) SerializeRecord(record, &writer);
+  writer.Put(btif_storage_snapshot_checksum(out), 8);
+  return out;
+}
+
+bool btif_storage_snapshot_parse(const std::string& data,
+                                 uint64_t config_checksum,
+                                 std::vector<BondedDeviceRecord>* records) {
+  if (data.size() < kHeaderSize + kTrailerSize) return false;
+  const uint8_t* bytes = (const uint8_t*)data.data();
+  size_t body_size = data.size() - kTrailerSize;
+
+  uint64_t magic, version, checksum, count, trailer;
+  Reader header(bytes, kHeaderSize);
+  header.Get(&magic, 4);
+  header.Get(&version, 2);
+  header.Get(&checksum, 8);
+  header.Get(&count, 4);
+  if (magic != kMagic || version != kVersion || checksum != config_checksum) {
+    return false;
+  }
+  Reader(bytes + body_size, kTrailerSize).Get(&trailer, kTrailerSize);
+  if (trailer != Fnv1a(bytes, body_size)) {
+    return false;
+  }
+
+  Reader reader(bytes + kHeaderSize, body_size - kHeaderSize);
+  std::vector<BondedDeviceRecord> parsed;
+  // Every record takes at least 7 octets
+  if (count > body_size / (RawAddress::kLength + 1)) return false;
+  parsed.resize(count);
+  for (auto& record : parsed) {
+    if (!ParseRecord(&reader, &record)) return false;
+  }
+  if (!reader.Done()) return false;
+
+  *records = std::move(parsed);
+  return true;
+}
@@ -0,0 +1,129 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "btif/include/btif_sock_util.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <vector>
+
+#include "osi/include/allocator.h"
+#include "osi/include/list.h"
+#include "stack/include/bt_hdr.h"
+
+namespace {
+
+constexpr uint16_t kHeadroom = 13;
+
+BT_HDR* AllocateFrame(uint16_t len, uint8_t fill) {
+  BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + kHeadroom + len);
+  p_buf->offset = kHeadroom;
+  p_buf->len = len;
+  memset(p_buf->data + p_buf->offset, fill, len);
+  return p_buf;
+}
+
+std::vector<uint8_t> DrainSocket(int fd) {
+  std::vector<uint8_t> data;
+  uint8_t chunk[4096];
+  ssize_t ret;
+  while ((ret = recv(fd, chunk, sizeof(chunk), MSG_DONTWAIT)) > 0) {
+    data.insert(data.end(), chunk, chunk + ret);
+  }
+  return data;
+}
+
+}  // namespace
+
+class BtifSockUtilTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(socketpair(AF_LOCAL, SOCK_STREAM, 0, fds_), 0);
+    queue_ = list_new(osi_free);
+  }
+
+  void TearDown() override {
+    list_free(queue_);
+    close(fds_[0]);
+    if (fds_[1] != -1) close(fds_[1]);
+  }
+
+  int fds_[2];
+  list_t* queue_ = nullptr;
+};
+
+TEST_F(BtifSockUtilTest, send_empty_queue) {
+  ASSERT_EQ(sock_send_bt_hdr_queue(fds_[0], queue_), SOCK_SEND_ALL);
+  ASSERT_TRUE(DrainSocket(fds_[1]).empty());
+}
+
+TEST_F(BtifSockUtilTest, send_gathers_all_frames_in_order) {
+  // More frames than fit in one gathered write, with empty frames mixed in.
+  const int kFrames = 100;
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < kFrames; i++) {
+    uint16_t len = (i % 10 == 0) ? 0 : 17 + i;
+    list_append(queue_, AllocateFrame(len, (uint8_t)i));
+    expected.insert(expected.end(), len, (uint8_t)i);
+  }
+
+  ASSERT_EQ(sock_send_bt_hdr_queue(fds_[0], queue_), SOCK_SEND_ALL);
+  ASSERT_TRUE(list_is_empty(queue_));
+  ASSERT_EQ(DrainSocket(fds_[1]), expected);
+}
+
+TEST_F(BtifSockUtilTest, send_resumes_after_partial_write) {
+  int sndbuf = 4096;
+  ASSERT_EQ(setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)),
+            0);
+
+  const int kFrames = 64;
+  const uint16_t kFrameLen = 990;
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < kFrames; i++) {
+    list_append(queue_, AllocateFrame(kFrameLen, (uint8_t)i));
+    expected.insert(expected.end(), kFrameLen, (uint8_t)i);
+  }
+
+  std::vector<uint8_t> received;
+  sock_send_status_t status = sock_send_bt_hdr_queue(fds_[0], queue_);
+  ASSERT_EQ(status, SOCK_SEND_PARTIAL);
+  ASSERT_FALSE(list_is_empty(queue_));
+
+  while (status != SOCK_SEND_ALL) {
+    std::vector<uint8_t> chunk = DrainSocket(fds_[1]);
+    received.insert(received.end(), chunk.begin(), chunk.end());
+    status = sock_send_bt_hdr_queue(fds_[0], queue_);
+    ASSERT_NE(status, SOCK_SEND_FAILED);
+  }
+  std::vector<uint8_t> chunk = DrainSocket(fds_[1]);
+  received.insert(received.end(), chunk.begin(), chunk.end());
+
+  ASSERT_TRUE(list_is_empty(queue_));
+  ASSERT_EQ(received, expected);
+}
+
+TEST_F(BtifSockUtilTest, send_to_closed_peer_fails) {
+  close(fds_[1]);
+  fds_[1] = -1;
+
+  list_append(queue_, AllocateFrame(10, 0xaa));
+  ASSERT_EQ(sock_send_bt_hdr_queue(fds_[0], queue_), SOCK_SEND_FAILED);
+}
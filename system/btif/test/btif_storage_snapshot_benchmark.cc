@@ -0,0 +1,263 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "btif/include/btif_common.h"
+#include "btif/include/btif_storage.h"
+#include "btif/include/btif_storage_snapshot.h"
+#include "btif/include/core_callbacks.h"
+#include "gd/common/init_flags.h"
+#include "gd/os/files.h"
+#include "gd/os/parameter_provider.h"
+#include "stack/include/btm_ble_api_types.h"
+#include "test/mock/mock_btif_config.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+
+namespace {
+
+void le_address_associate(RawAddress main_bd_addr,
+                          RawAddress secondary_bd_addr) {}
+
+void address_consolidate(RawAddress main_bd_addr,
+                         RawAddress secondary_bd_addr) {}
+
+bluetooth::core::EventCallbacks event_callbacks = {
+    .invoke_address_consolidate_cb = address_consolidate,
+    .invoke_le_address_associate_cb = le_address_associate,
+};
+
+struct TestCoreInterface : bluetooth::core::CoreInterface {
+  TestCoreInterface()
+      : bluetooth::core::CoreInterface{&event_callbacks, nullptr, nullptr,
+                                       nullptr} {}
+  void onBluetoothEnabled() override {}
+  bt_status_t toggleProfile(tBTA_SERVICE_ID service_id, bool enable) override {
+    return BT_STATUS_SUCCESS;
+  }
+  void removeDeviceFromProfiles(const RawAddress& bd_addr) override {}
+  void onLinkDown(const RawAddress& bd_addr) override {}
+} core_interface;
+
+}  // namespace
+
+bluetooth::core::CoreInterface* GetInterfaceToProfiles() {
+  return &core_interface;
+}
+
+void btif_adapter_properties_evt(bt_status_t status, uint32_t num_props,
+                                 bt_property_t* p_props) {}
+
+void btif_remote_properties_evt(bt_status_t status, RawAddress* remote_addr,
+                                uint32_t num_props, bt_property_t* p_props) {}
+
+void btif_gatts_add_bonded_dev_from_nv(const RawAddress& bda) {}
+
+tBTA_SERVICE_MASK btif_get_enabled_services_mask(void) { return 0; }
+
+bt_status_t btif_dm_get_adapter_property(bt_property_t* prop) {
+  return BT_STATUS_FAIL;
+}
+
+bt_status_t do_in_jni_thread(const base::Location& from_here,
+                             base::OnceClosure task) {
+  return BT_STATUS_FAIL;
+}
+
+namespace {
+
+const char* config_flags[] = {
+    "INIT_bonded_devices_snapshot=false",
+    nullptr,
+};
+
+const char* snapshot_flags[] = {
+    "INIT_bonded_devices_snapshot=true",
+    nullptr,
+};
+
+std::string ToString(const uint8_t* data, size_t size) {
+  return std::string((const char*)data, size);
+}
+
+}  // namespace
+
+/* A config of state.range(0) bonded devices, half of them classic headsets
+ * and half LE devices with a resolvable private address, loaded as the stack
+ * does when it starts */
+class BM_BtifStorageLoad : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    config_path_ = std::filesystem::temp_directory_path() /
+                   "btif_storage_snapshot_benchmark.conf";
+    snapshot_path_ = btif_storage_snapshot_path(config_path_);
+    std::filesystem::remove(snapshot_path_);
+    bluetooth::os::WriteToFile(config_path_, "[Adapter]\n");
+    bluetooth::os::ParameterProvider::OverrideConfigFilePath(config_path_);
+
+    std::vector<RawAddress> paired_devices;
+    for (int i = 0; i < st.range(0); i++) {
+      RawAddress bd_addr({0x5a, 0x11, 0x22, (uint8_t)(i >> 8), (uint8_t)i,
+                          (uint8_t)(i % 2)});
+      paired_devices.push_back(bd_addr);
+      std::string section = bd_addr.ToString();
+      config_[section]["Name"] = "Device " + std::to_string(i);
+      if (i % 2 == 0) {
+        LinkKey link_key;
+        link_key.fill(i);
+        config_[section]["LinkKey"] =
+            ToString(link_key.data(), link_key.size());
+        config_[section]["LinkKeyType"] = "5";
+        config_[section]["PinLength"] = "4";
+        config_[section]["DevClass"] = "2360324";
+        config_[section]["DevType"] = "1";
+        config_[section]["Service"] = Uuid::From16Bit(0x110b).ToString() +
+                                      " " + Uuid::From16Bit(0x110e).ToString() +
+                                      " ";
+      } else {
+        tBTM_LE_PENC_KEYS penc = {};
+        penc.ltk.fill(i);
+        penc.ediv = i;
+        penc.key_size = 16;
+        tBTM_LE_PID_KEYS pid = {};
+        pid.irk.fill(i);
+        pid.identity_addr = RawAddress({0x00, 0x11, 0x22, (uint8_t)(i >> 8),
+                                        (uint8_t)i, 0x00});
+        config_[section]["DevType"] = "2";
+        config_[section]["AddrType"] = "1";
+        config_[section]["LE_KEY_PENC"] = ToString((uint8_t*)&penc,
+                                                   sizeof(penc));
+        config_[section]["LE_KEY_PID"] = ToString((uint8_t*)&pid, sizeof(pid));
+      }
+    }
+
+    test::mock::btif_config::btif_config_get_paired_devices.raw_addresses =
+        paired_devices;
+    test::mock::btif_config::btif_config_get_int.body =
+        [this](const std::string& section, const std::string& key,
+               int* value) {
+          auto property = Get(section, key);
+          if (property) *value = std::stoi(*property);
+          return property.has_value();
+        };
+    test::mock::btif_config::btif_config_get_str.body =
+        [this](const std::string& section, const std::string& key,
+               char* value, int* size_bytes) {
+          auto property = Get(section, key);
+          if (!property) return false;
+          *size_bytes = property->copy(value, *size_bytes - 1);
+          value[(*size_bytes)++] = '\0';
+          return true;
+        };
+    test::mock::btif_config::btif_config_get_bin.body =
+        [this](const std::string& section, const std::string& key,
+               uint8_t* value, size_t* length) {
+          config_reads_++;
+          auto property = Get(section, key);
+          if (!property) return false;
+          *length = property->copy((char*)value, *length);
+          return true;
+        };
+  }
+
+  void TearDown(State& st) override {
+    test::mock::btif_config::btif_config_get_paired_devices.raw_addresses
+        .clear();
+    test::mock::btif_config::btif_config_get_int = {};
+    test::mock::btif_config::btif_config_get_str = {};
+    test::mock::btif_config::btif_config_get_bin = {};
+    config_.clear();
+    std::filesystem::remove(config_path_);
+    std::filesystem::remove(snapshot_path_);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::optional<std::string> Get(const std::string& section,
+                                 const std::string& key) {
+    auto it = config_.find(section);
+    if (it == config_.end()) return std::nullopt;
+    auto property = it->second.find(key);
+    if (property == it->second.end()) return std::nullopt;
+    return property->second;
+  }
+
+  void Load() {
+    btif_storage_load_le_devices();
+    btif_storage_load_bonded_devices();
+  }
+
+  std::string config_path_;
+  std::string snapshot_path_;
+  std::map<std::string, std::map<std::string, std::string>> config_;
+  int config_reads_ = 0;
+};
+
+// Without the snapshot every start decodes all the bonds from the config
+BENCHMARK_DEFINE_F(BM_BtifStorageLoad, from_config)(State& state) {
+  bluetooth::common::InitFlags::Load(config_flags);
+  for (auto _ : state) {
+    Load();
+  }
+  if (config_reads_ == 0) {
+    state.SkipWithError("The config was not read");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The snapshot is written by the first load, every start after it reads the
+// bonds from the snapshot as long as the config file is unchanged
+BENCHMARK_DEFINE_F(BM_BtifStorageLoad, from_snapshot)(State& state) {
+  bluetooth::common::InitFlags::Load(snapshot_flags);
+  Load();
+  if (!bluetooth::os::FileExists(snapshot_path_)) {
+    state.SkipWithError("The snapshot was not written");
+    return;
+  }
+  config_reads_ = 0;
+  for (auto _ : state) {
+    Load();
+  }
+  if (config_reads_ != 0) {
+    state.SkipWithError("The keys were read from the config");
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_REGISTER_F(BM_BtifStorageLoad, from_config)
+    ->Arg(10)
+    ->Arg(40)
+    ->Arg(100);
+BENCHMARK_REGISTER_F(BM_BtifStorageLoad, from_snapshot)
+    ->Arg(10)
+    ->Arg(40)
+    ->Arg(100);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,458 @@
+/*
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "btif/include/btif_storage_snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "btif/include/btif_common.h"
+#include "btif/include/btif_storage.h"
+#include "btif/include/core_callbacks.h"
+#include "gd/common/init_flags.h"
+#include "gd/os/files.h"
+#include "gd/os/parameter_provider.h"
+#include "stack/include/btm_ble_api_types.h"
+#include "test/mock/mock_bta_dm_api.h"
+#include "test/mock/mock_btif_config.h"
+
+using bluetooth::Uuid;
+
+namespace {
+
+constexpr uint64_t kConfigChecksum = 0x0123456789abcdef;
+
+BondedDeviceRecord MakeRecord(uint32_t index) {
+  BondedDeviceRecord record;
+  record.bd_addr = RawAddress({0xA0, 0xA1, (uint8_t)(index >> 16),
+                               (uint8_t)(index >> 8), (uint8_t)index, 0xA5});
+  LinkKey link_key;
+  for (size_t i = 0; i < link_key.size(); i++) link_key[i] = index + i;
+  record.link_key = link_key;
+  record.link_key_type = 5;
+  record.pin_length = 0;
+  record.dev_class = 0x240404;
+  record.dev_type = 3;
+  record.addr_type = 0;
+  record.le_keys[0x01] = std::vector<uint8_t>(28, (uint8_t)index);
+  record.le_keys[0x02] = std::vector<uint8_t>(23, (uint8_t)(index + 1));
+  record.name = "Headset " + std::to_string(index);
+  record.uuids = {Uuid::From16Bit(0x110b), Uuid::From16Bit(0x110e),
+                  Uuid::From16Bit(0x111e), Uuid::From16Bit(0x1800)};
+  record.appearance = 0x0941;
+  record.vendor_product_info =
+      BondedDeviceRecord::VendorProductInfo{1, 0x00e0, 0x1234, 0x0100};
+  return record;
+}
+
+std::vector<BondedDeviceRecord> MakeRecords(size_t count) {
+  std::vector<BondedDeviceRecord> records;
+  for (size_t i = 0; i < count; i++) records.push_back(MakeRecord(i));
+  return records;
+}
+
+}  // namespace
+
+TEST(BtifStorageSnapshotTest, round_trip) {
+  std::vector<BondedDeviceRecord> records = MakeRecords(3);
+  // A device with nothing but its address stored
+  records.emplace_back();
+  records.back().bd_addr = RawAddress({1, 2, 3, 4, 5, 6});
+  records[1].alias = "";
+  records[1].model_num = "Model 1";
+  records[2].uuids.emplace();
+
+  std::string data = btif_storage_snapshot_serialize(kConfigChecksum, records);
+  std::vector<BondedDeviceRecord> parsed;
+  ASSERT_TRUE(btif_storage_snapshot_parse(data, kConfigChecksum, &parsed));
+  ASSERT_EQ(parsed, records);
+}
+
+TEST(BtifStorageSnapshotTest, no_devices) {
+  std::string data = btif_storage_snapshot_serialize(kConfigChecksum, {});
+  std::vector<BondedDeviceRecord> parsed = MakeRecords(1);
+  ASSERT_TRUE(btif_storage_snapshot_parse(data, kConfigChecksum, &parsed));
+  ASSERT_TRUE(parsed.empty());
+}
+
+TEST(BtifStorageSnapshotTest, config_changed) {
+  std::string data =
+      btif_storage_snapshot_serialize(kConfigChecksum, MakeRecords(2));
+  std::vector<BondedDeviceRecord> parsed;
+  ASSERT_FALSE(btif_storage_snapshot_parse(data, kConfigChecksum + 1, &parsed));
+  ASSERT_TRUE(parsed.empty());
+}
+
+TEST(BtifStorageSnapshotTest, corrupted) {
+  std::string data =
+      btif_storage_snapshot_serialize(kConfigChecksum, MakeRecords(2));
+  std::vector<BondedDeviceRecord> parsed;
+
+  for (size_t i = 0; i < data.size(); i++) {
+    std::string corrupted = data;
+    corrupted[i] ^= 0x10;
+    ASSERT_FALSE(
+        btif_storage_snapshot_parse(corrupted, kConfigChecksum, &parsed))
+        << "octet " << i;
+  }
+  for (size_t size = 0; size < data.size(); size++) {
+    ASSERT_FALSE(btif_storage_snapshot_parse(data.substr(0, size),
+                                             kConfigChecksum, &parsed))
+        << "size " << size;
+  }
+  ASSERT_TRUE(parsed.empty());
+}
+
+TEST(BtifStorageSnapshotTest, checksum) {
+  ASSERT_EQ(btif_storage_snapshot_checksum(""), 0xcbf29ce484222325u);
+  ASSERT_EQ(btif_storage_snapshot_checksum("a"), 0xaf63dc4c8601ec8cu);
+  ASSERT_NE(btif_storage_snapshot_checksum("[Adapter]\n"),
+            btif_storage_snapshot_checksum("[Adapter] \n"));
+}
+
+TEST(BtifStorageSnapshotTest, path) {
+  ASSERT_EQ(btif_storage_snapshot_path("/data/misc/bluedroid/bt_config.conf"),
+            "/data/misc/bluedroid/bt_config.snapshot");
+}
+
+namespace {
+
+const RawAddress kClassicAddress({0x00, 0x11, 0x22, 0x33, 0x44, 0x01});
+const RawAddress kLeAddress({0x5a, 0x11, 0x22, 0x33, 0x44, 0x02});
+const RawAddress kIdentityAddress({0x00, 0x11, 0x22, 0x33, 0x44, 0x03});
+
+std::string ToString(const uint8_t* data, size_t size) {
+  return std::string((const char*)data, size);
+}
+
+std::string AddressList(const bt_property_t& prop) {
+  std::string list;
+  for (size_t i = 0; i < prop.len / sizeof(RawAddress); i++) {
+    list += " " + ((RawAddress*)prop.val)[i].ToString();
+  }
+  return list;
+}
+
+/* What loading the bonded devices gave BTA and the upper layers, in order */
+std::vector<std::string> events;
+
+void le_address_associate(RawAddress main_bd_addr,
+                          RawAddress secondary_bd_addr) {
+  events.push_back("associate " + main_bd_addr.ToString() + " " +
+                   secondary_bd_addr.ToString());
+}
+
+void address_consolidate(RawAddress main_bd_addr,
+                         RawAddress secondary_bd_addr) {
+  events.push_back("consolidate " + main_bd_addr.ToString() + " " +
+                   secondary_bd_addr.ToString());
+}
+
+bluetooth::core::EventCallbacks event_callbacks = {
+    .invoke_address_consolidate_cb = address_consolidate,
+    .invoke_le_address_associate_cb = le_address_associate,
+};
+
+struct TestCoreInterface : bluetooth::core::CoreInterface {
+  TestCoreInterface()
+      : bluetooth::core::CoreInterface{&event_callbacks, nullptr, nullptr,
+                                       nullptr} {}
+  void onBluetoothEnabled() override {}
+  bt_status_t toggleProfile(tBTA_SERVICE_ID service_id, bool enable) override {
+    return BT_STATUS_SUCCESS;
+  }
+  void removeDeviceFromProfiles(const RawAddress& bd_addr) override {}
+  void onLinkDown(const RawAddress& bd_addr) override {}
+} core_interface;
+
+}  // namespace
+
+bluetooth::core::CoreInterface* GetInterfaceToProfiles() {
+  return &core_interface;
+}
+
+void btif_adapter_properties_evt(bt_status_t status, uint32_t num_props,
+                                 bt_property_t* p_props) {
+  for (uint32_t i = 0; i < num_props; i++) {
+    if (p_props[i].type == BT_PROPERTY_ADAPTER_BONDED_DEVICES) {
+      events.push_back("bonded devices" + AddressList(p_props[i]));
+    }
+  }
+}
+
+void btif_remote_properties_evt(bt_status_t status, RawAddress* remote_addr,
+                                uint32_t num_props, bt_property_t* p_props) {
+  std::string event = "properties " + remote_addr->ToString();
+  for (uint32_t i = 0; i < num_props; i++) {
+    const bt_property_t& prop = p_props[i];
+    switch (prop.type) {
+      case BT_PROPERTY_BDNAME:
+        event += " name=" + ToString((uint8_t*)prop.val, prop.len);
+        break;
+      case BT_PROPERTY_CLASS_OF_DEVICE:
+        event += " cod=" + std::to_string(*(uint32_t*)prop.val);
+        break;
+      case BT_PROPERTY_TYPE_OF_DEVICE:
+        event += " type=" + std::to_string(*(uint32_t*)prop.val);
+        break;
+      case BT_PROPERTY_UUIDS:
+        for (size_t j = 0; j < prop.len / sizeof(Uuid); j++) {
+          event += " uuid=" + ((Uuid*)prop.val)[j].ToString();
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  events.push_back(event);
+}
+
+void btif_gatts_add_bonded_dev_from_nv(const RawAddress& bda) {
+  events.push_back("gatt bonded " + bda.ToString());
+}
+
+tBTA_SERVICE_MASK btif_get_enabled_services_mask(void) { return 0; }
+
+bt_status_t btif_dm_get_adapter_property(bt_property_t* prop) {
+  return BT_STATUS_FAIL;
+}
+
+bt_status_t do_in_jni_thread(const base::Location& from_here,
+                             base::OnceClosure task) {
+  return BT_STATUS_FAIL;
+}
+
+namespace {
+
+const char* test_flags[] = {
+    "INIT_bonded_devices_snapshot=true",
+    nullptr,
+};
+
+/* Loads the bonded devices of a config holding a classic device and an LE
+ * device with a resolvable private address */
+class BtifStorageLoadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    bluetooth::common::InitFlags::Load(test_flags);
+    config_path_ = std::filesystem::temp_directory_path() /
+                   "btif_storage_load_test.conf";
+    snapshot_path_ = btif_storage_snapshot_path(config_path_);
+    std::filesystem::remove(snapshot_path_);
+    WriteConfigFile("[Adapter]\n");
+    bluetooth::os::ParameterProvider::OverrideConfigFilePath(config_path_);
+
+    LinkKey link_key;
+    for (size_t i = 0; i < link_key.size(); i++) link_key[i] = i;
+    std::string classic = kClassicAddress.ToString();
+    config_[classic]["LinkKey"] = ToString(link_key.data(), link_key.size());
+    config_[classic]["LinkKeyType"] = "5";
+    config_[classic]["PinLength"] = "4";
+    config_[classic]["DevClass"] = "2360324";
+    config_[classic]["DevType"] = "1";
+    config_[classic]["Name"] = "Headset";
+    config_[classic]["Service"] = Uuid::From16Bit(0x110b).ToString() + " ";
+
+    tBTM_LE_PENC_KEYS penc = {};
+    penc.ltk.fill(0x42);
+    penc.ediv = 0x1234;
+    penc.key_size = 16;
+    tBTM_LE_PID_KEYS pid = {};
+    pid.irk.fill(0x24);
+    pid.identity_addr = kIdentityAddress;
+    std::string le = kLeAddress.ToString();
+    config_[le]["DevType"] = "2";
+    config_[le]["AddrType"] = "1";
+    config_[le]["Name"] = "Mouse";
+    config_[le]["LE_KEY_PENC"] = ToString((uint8_t*)&penc, sizeof(penc));
+    config_[le]["LE_KEY_PID"] = ToString((uint8_t*)&pid, sizeof(pid));
+
+    test::mock::btif_config::btif_config_get_paired_devices.raw_addresses = {
+        kClassicAddress, kLeAddress};
+    test::mock::btif_config::btif_config_get_int.body =
+        [this](const std::string& section, const std::string& key,
+               int* value) {
+          auto property = Get(section, key);
+          if (property) *value = std::stoi(*property);
+          return property.has_value();
+        };
+    test::mock::btif_config::btif_config_get_str.body =
+        [this](const std::string& section, const std::string& key,
+               char* value, int* size_bytes) {
+          auto property = Get(section, key);
+          if (!property) return false;
+          *size_bytes = property->copy(value, *size_bytes - 1);
+          value[(*size_bytes)++] = '\0';
+          return true;
+        };
+    test::mock::btif_config::btif_config_get_bin.body =
+        [this](const std::string& section, const std::string& key,
+               uint8_t* value, size_t* length) {
+          config_reads_++;
+          auto property = Get(section, key);
+          if (!property) return false;
+          *length = property->copy((char*)value, *length);
+          return true;
+        };
+    test::mock::bta_dm_api::BTA_DmAddDevice.body =
+        [](const RawAddress& bd_addr, DEV_CLASS dev_class,
+           const LinkKey& link_key, uint8_t key_type, uint8_t pin_length) {
+          events.push_back("add device " + bd_addr.ToString() + " key=" +
+                           std::to_string(link_key[15]) + " type=" +
+                           std::to_string(key_type) +
+                           " pin=" + std::to_string(pin_length));
+        };
+    test::mock::bta_dm_api::BTA_DmAddBleDevice.body =
+        [](const RawAddress& bd_addr, tBLE_ADDR_TYPE addr_type,
+           tBT_DEVICE_TYPE dev_type) {
+          events.push_back("add le device " + bd_addr.ToString() +
+                           " addr_type=" + std::to_string(addr_type));
+        };
+    test::mock::bta_dm_api::BTA_DmAddBleKey.body =
+        [](const RawAddress& bd_addr, tBTA_LE_KEY_VALUE* p_le_key,
+           tBTM_LE_KEY_TYPE key_type) {
+          std::string event = "add le key " + bd_addr.ToString() +
+                              " key_type=" + std::to_string(key_type);
+          if (key_type == BTM_LE_KEY_PENC) {
+            event += " ltk=" + std::to_string(p_le_key->penc_key.ltk[0]) +
+                     " ediv=" + std::to_string(p_le_key->penc_key.ediv);
+          } else if (key_type == BTM_LE_KEY_PID) {
+            event += " identity=" + p_le_key->pid_key.identity_addr.ToString();
+          }
+          events.push_back(event);
+        };
+    events.clear();
+  }
+
+  void TearDown() override {
+    test::mock::btif_config::btif_config_get_paired_devices.raw_addresses
+        .clear();
+    test::mock::btif_config::btif_config_get_int = {};
+    test::mock::btif_config::btif_config_get_str = {};
+    test::mock::btif_config::btif_config_get_bin = {};
+    test::mock::bta_dm_api::BTA_DmAddDevice = {};
+    test::mock::bta_dm_api::BTA_DmAddBleDevice = {};
+    test::mock::bta_dm_api::BTA_DmAddBleKey = {};
+    std::filesystem::remove(config_path_);
+    std::filesystem::remove(snapshot_path_);
+  }
+
+  std::optional<std::string> Get(const std::string& section,
+                                 const std::string& key) {
+    if (config_.count(section) == 0 || config_[section].count(key) == 0) {
+      return std::nullopt;
+    }
+    return config_[section][key];
+  }
+
+  void WriteConfigFile(const std::string& text) {
+    ASSERT_TRUE(bluetooth::os::WriteToFile(config_path_, text));
+  }
+
+  /* Loads the bonded devices as the stack does when it starts */
+  std::vector<std::string> Load() {
+    events.clear();
+    config_reads_ = 0;
+    btif_storage_load_le_devices();
+    btif_storage_load_bonded_devices();
+    return events;
+  }
+
+  std::string config_path_;
+  std::string snapshot_path_;
+  std::map<std::string, std::map<std::string, std::string>> config_;
+  int config_reads_ = 0;
+};
+
+const std::string kClassic = kClassicAddress.ToString();
+const std::string kLe = kLeAddress.ToString();
+const std::string kIdentity = kIdentityAddress.ToString();
+
+const std::vector<std::string> kAddDevices = {
+    "add device " + kClassic + " key=15 type=5 pin=4",
+    "add le device " + kLe + " addr_type=1",
+    "add le key " + kLe + " key_type=1 ltk=66 ediv=4660",
+    "add le key " + kLe + " key_type=2 identity=" + kIdentity,
+    "gatt bonded " + kLe,
+};
+
+std::vector<std::string> ExpectedEvents() {
+  std::vector<std::string> expected = kAddDevices;
+  expected.push_back("bonded devices " + kLe);
+  expected.push_back("associate " + kLe + " " + kIdentity);
+  expected.insert(expected.end(), kAddDevices.begin(), kAddDevices.end());
+  expected.push_back("bonded devices " + kClassic + " " + kLe);
+  expected.push_back("properties " + kClassic +
+                     " name=Headset cod=2360324 type=1 uuid=" +
+                     Uuid::From16Bit(0x110b).ToString());
+  expected.push_back("properties " + kLe + " name=Mouse cod=0 type=2");
+  return expected;
+}
+
+}  // namespace
+
+TEST_F(BtifStorageLoadTest, load_from_config) {
+  ASSERT_EQ(Load(), ExpectedEvents());
+  ASSERT_GT(config_reads_, 0);
+  ASSERT_TRUE(bluetooth::os::FileExists(snapshot_path_));
+}
+
+TEST_F(BtifStorageLoadTest, load_from_snapshot) {
+  Load();
+
+  ASSERT_EQ(Load(), ExpectedEvents());
+  ASSERT_EQ(config_reads_, 0);
+}
+
+TEST_F(BtifStorageLoadTest, config_file_changed) {
+  Load();
+  config_[kClassic]["PinLength"] = "6";
+  WriteConfigFile("[Adapter]\nName = changed\n");
+
+  std::vector<std::string> loaded = Load();
+  ASSERT_GT(config_reads_, 0);
+  ASSERT_EQ(loaded[0], "add device " + kClassic + " key=15 type=5 pin=6");
+}
+
+TEST_F(BtifStorageLoadTest, paired_devices_changed) {
+  Load();
+  test::mock::btif_config::btif_config_get_paired_devices.raw_addresses = {
+      kClassicAddress};
+
+  ASSERT_EQ(Load(),
+            std::vector<std::string>({
+                "add device " + kClassic + " key=15 type=5 pin=4",
+                "bonded devices",
+                "add device " + kClassic + " key=15 type=5 pin=4",
+                "bonded devices " + kClassic,
+                "properties " + kClassic +
+                    " name=Headset cod=2360324 type=1 uuid=" +
+                    Uuid::From16Bit(0x110b).ToString(),
+            }));
+  ASSERT_GT(config_reads_, 0);
+}
+
+TEST_F(BtifStorageLoadTest, fetch_bonded_device) {
+  ASSERT_EQ(btif_in_fetch_bonded_device(kClassic), BT_STATUS_SUCCESS);
+  ASSERT_EQ(btif_in_fetch_bonded_device(kLe), BT_STATUS_SUCCESS);
+  ASSERT_EQ(btif_in_fetch_bonded_device(kIdentity), BT_STATUS_FAIL);
+  ASSERT_TRUE(events.empty());
+}
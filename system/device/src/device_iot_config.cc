@@ -28,6 +28,7 @@
 
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "bt_types.h"
 #include "btcore/include/module.h"
@@ -55,12 +56,130 @@ alarm_t* config_timer;
 
 using bluetooth::common::InitFlags;
 
+/* With the device_iot_config_cache init flag the values set and counted on
+ * connection and profile events are kept typed in memory, and only formatted
+ * into |config| when it is saved or read other than through these values.
+ * The save timer is started by the first change and not pushed back by the
+ * following ones, so that the changes are written once per settle period. */
+typedef enum {
+  IOT_CONFIG_VALUE_INT,
+  IOT_CONFIG_VALUE_HEX,
+  IOT_CONFIG_VALUE_STR,
+} iot_config_value_type_t;
+
+typedef struct {
+  iot_config_value_type_t type;
+  int value;
+  int byte_num;
+  std::string str;
+  bool dirty;
+} iot_config_value_t;
+
+// protected by |config_lock|
+static std::unordered_map<std::string,
+                          std::unordered_map<std::string, iot_config_value_t>>
+    config_cache;
+
+static void format_hex(char* value_str, size_t size, int value, int byte_num) {
+  if (byte_num == 1)
+    snprintf(value_str, size, "%02x", value);
+  else if (byte_num == 2)
+    snprintf(value_str, size, "%04x", value);
+  else if (byte_num == 3)
+    snprintf(value_str, size, "%06x", value);
+  else if (byte_num == 4)
+    snprintf(value_str, size, "%08x", value);
+}
+
+static std::string iot_config_value_to_string(const iot_config_value_t& value) {
+  char value_str[32] = {0};
+  switch (value.type) {
+    case IOT_CONFIG_VALUE_INT:
+      snprintf(value_str, sizeof(value_str), "%d", value.value);
+      break;
+    case IOT_CONFIG_VALUE_HEX:
+      format_hex(value_str, sizeof(value_str), value.value, value.byte_num);
+      break;
+    case IOT_CONFIG_VALUE_STR:
+      return value.str;
+  }
+  return value_str;
+}
+
+static iot_config_value_t* cache_find(const std::string& section,
+                                      const std::string& key) {
+  auto section_it = config_cache.find(section);
+  if (section_it == config_cache.end()) return nullptr;
+  auto it = section_it->second.find(key);
+  return it == section_it->second.end() ? nullptr : &it->second;
+}
+
+static void cache_erase(const std::string& section, const std::string& key) {
+  auto section_it = config_cache.find(section);
+  if (section_it != config_cache.end()) section_it->second.erase(key);
+}
+
+static bool iot_config_value_equal(const iot_config_value_t& a,
+                                   const iot_config_value_t& b) {
+  if (a.type != b.type) {
+    return iot_config_value_to_string(a) == iot_config_value_to_string(b);
+  }
+  switch (a.type) {
+    case IOT_CONFIG_VALUE_INT:
+      return a.value == b.value;
+    case IOT_CONFIG_VALUE_HEX:
+      return a.value == b.value && a.byte_num == b.byte_num;
+    case IOT_CONFIG_VALUE_STR:
+      return a.str == b.str;
+  }
+  return false;
+}
+
+/* Stores |value| unless the same value is stored already, and starts the save
+ * timer if needed */
+static void cache_set(const std::string& section, const std::string& key,
+                      iot_config_value_t value) {
+  iot_config_value_t* cached = cache_find(section, key);
+  if (cached == nullptr) {
+    value.dirty = !device_iot_config_has_key_value(
+        section, key, iot_config_value_to_string(value));
+    cached = &config_cache[section][key];
+    *cached = std::move(value);
+    if (!cached->dirty) return;
+  } else {
+    if (iot_config_value_equal(*cached, value)) return;
+    bool dirty = cached->dirty;
+    *cached = std::move(value);
+    cached->dirty = true;
+    if (dirty) return;
+  }
+
+  if (!alarm_is_scheduled(config_timer)) device_iot_config_save_async();
+}
+
+void device_iot_config_cache_sync(void) {
+  for (auto& [section, values] : config_cache) {
+    for (auto& [key, value] : values) {
+      if (!value.dirty) continue;
+      config_set_string(config.get(), section, key,
+                        iot_config_value_to_string(value));
+      value.dirty = false;
+    }
+  }
+}
+
+void device_iot_config_cache_clear(void) { config_cache.clear(); }
+
 bool device_iot_config_has_section(const std::string& section) {
   if (!InitFlags::IsDeviceIotConfigLoggingEnabled()) return false;
 
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  auto section_it = config_cache.find(section);
+  if (section_it != config_cache.end() && !section_it->second.empty()) {
+    return true;
+  }
   return config_has_section(*config, section);
 }
 
@@ -71,6 +190,7 @@ bool device_iot_config_exist(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  if (cache_find(section, key) != nullptr) return true;
   return config_has_key(*config, section, key);
 }
 
@@ -81,6 +201,12 @@ bool device_iot_config_get_int(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  iot_config_value_t* cached = cache_find(section, key);
+  if (cached != nullptr && cached->type == IOT_CONFIG_VALUE_INT) {
+    value = cached->value;
+    return true;
+  }
+  device_iot_config_cache_sync();
   bool ret = config_has_key(*config, section, key);
   if (ret) value = config_get_int(*config, section, key, value);
 
@@ -94,6 +220,11 @@ bool device_iot_config_set_int(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  if (InitFlags::IsDeviceIotConfigCacheEnabled()) {
+    cache_set(section, key, {IOT_CONFIG_VALUE_INT, value, 0, {}, true});
+    return true;
+  }
+
   char value_str[32] = {0};
   snprintf(value_str, sizeof(value_str), "%d", value);
   if (device_iot_config_has_key_value(section, key, value_str)) return true;
@@ -112,12 +243,32 @@ bool device_iot_config_int_add_one(const std::string& section,
 
   int result = 0;
   std::unique_lock<std::mutex> lock(config_lock);
-  result = config_get_int(*config, section, key, result);
+  iot_config_value_t* cached = nullptr;
+  if (InitFlags::IsDeviceIotConfigCacheEnabled()) {
+    cached = cache_find(section, key);
+    if (cached != nullptr && cached->type != IOT_CONFIG_VALUE_INT) {
+      device_iot_config_cache_sync();
+      cache_erase(section, key);
+      cached = nullptr;
+    }
+  }
+
+  if (cached != nullptr) {
+    result = cached->value;
+  } else {
+    result = config_get_int(*config, section, key, result);
+  }
   if (result >= 0) {
     result += 1;
   } else {
     result = 0;
   }
+
+  if (InitFlags::IsDeviceIotConfigCacheEnabled()) {
+    cache_set(section, key, {IOT_CONFIG_VALUE_INT, result, 0, {}, true});
+    return true;
+  }
+
   config_set_int(config.get(), section, key, result);
   device_iot_config_save_async();
 
@@ -131,6 +282,13 @@ bool device_iot_config_get_hex(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  iot_config_value_t* cached = cache_find(section, key);
+  if (cached != nullptr && cached->type == IOT_CONFIG_VALUE_HEX &&
+      cached->byte_num >= 1 && cached->byte_num <= 4) {
+    value = cached->value;
+    return true;
+  }
+  device_iot_config_cache_sync();
   const std::string* stored_value =
       config_get_string(*config, section, key, NULL);
   if (!stored_value) return false;
@@ -153,17 +311,14 @@ bool device_iot_config_set_hex(const std::string& section,
 
   CHECK(config != NULL);
 
-  char value_str[32] = {0};
-  if (byte_num == 1)
-    snprintf(value_str, sizeof(value_str), "%02x", value);
-  else if (byte_num == 2)
-    snprintf(value_str, sizeof(value_str), "%04x", value);
-  else if (byte_num == 3)
-    snprintf(value_str, sizeof(value_str), "%06x", value);
-  else if (byte_num == 4)
-    snprintf(value_str, sizeof(value_str), "%08x", value);
-
   std::unique_lock<std::mutex> lock(config_lock);
+  if (InitFlags::IsDeviceIotConfigCacheEnabled()) {
+    cache_set(section, key, {IOT_CONFIG_VALUE_HEX, value, byte_num, {}, true});
+    return true;
+  }
+
+  char value_str[32] = {0};
+  format_hex(value_str, sizeof(value_str), value, byte_num);
   if (device_iot_config_has_key_value(section, key, value_str)) return true;
 
   config_set_string(config.get(), section, key, value_str);
@@ -194,6 +349,13 @@ bool device_iot_config_get_str(const std::string& section,
   CHECK(size_bytes != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  iot_config_value_t* cached = cache_find(section, key);
+  if (cached != nullptr) {
+    strlcpy(value, iot_config_value_to_string(*cached).c_str(), *size_bytes);
+    *size_bytes = strlen(value) + 1;
+    return true;
+  }
+
   const std::string* stored_value =
       config_get_string(*config, section, key, NULL);
 
@@ -213,6 +375,11 @@ bool device_iot_config_set_str(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  if (InitFlags::IsDeviceIotConfigCacheEnabled()) {
+    cache_set(section, key, {IOT_CONFIG_VALUE_STR, 0, 0, value, true});
+    return true;
+  }
+
   if (device_iot_config_has_key_value(section, key, value)) return true;
 
   config_set_string(config.get(), section, key, value);
@@ -231,6 +398,7 @@ bool device_iot_config_get_bin(const std::string& section,
   CHECK(length != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_sync();
   const std::string* value_string =
       config_get_string(*config, section, key, NULL);
 
@@ -263,6 +431,7 @@ size_t device_iot_config_get_bin_length(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_sync();
   const std::string* value_str = config_get_string(*config, section, key, NULL);
 
   if (!value_str) return 0;
@@ -295,6 +464,8 @@ bool device_iot_config_set_bin(const std::string& section,
   }
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_sync();
+  cache_erase(section, key);
   if (device_iot_config_has_key_value(section, key, str)) {
     osi_free(str);
     return true;
@@ -314,6 +485,8 @@ bool device_iot_config_remove(const std::string& section,
   CHECK(config != NULL);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_sync();
+  cache_erase(section, key);
   return config_remove_key(config.get(), section, key);
 }
 
@@ -340,6 +513,7 @@ bool device_iot_config_clear(void) {
   alarm_cancel(config_timer);
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_clear();
   config.reset();
 
   config = config_new_empty();
@@ -58,6 +58,7 @@ using bluetooth::common::InitFlags;
 static void cleanup() {
   alarm_free(config_timer);
   config_timer = NULL;
+  device_iot_config_cache_clear();
   config.reset();
   config = NULL;
   device_iot_config_source = NOT_LOADED;
@@ -71,6 +72,7 @@ future_t* device_iot_config_module_init(void) {
 
   config_timer = NULL;
   config = NULL;
+  device_iot_config_cache_clear();
 
   if (device_iot_config_is_factory_reset()) {
     device_iot_config_delete_files();
@@ -180,6 +182,7 @@ future_t* device_iot_config_module_clean_up(void) {
   config_timer = NULL;
 
   std::unique_lock<std::mutex> lock(config_lock);
+  device_iot_config_cache_clear();
   config.reset();
   config = NULL;
   return future_new_immediate(FUTURE_SUCCESS);
@@ -204,6 +207,10 @@ void device_iot_config_write(uint16_t event, UNUSED_ATTR char* p_param) {
     device_iot_config_set_modified_time();
   }
 
+  // Devices may be dropped below, so the cached values are not kept
+  device_iot_config_cache_sync();
+  device_iot_config_cache_clear();
+
   rename(IOT_CONFIG_FILE_PATH, IOT_CONFIG_BACKUP_PATH);
   device_iot_config_restrict_device_num(*config);
   device_iot_config_sections_sort_by_entry_key(*config,
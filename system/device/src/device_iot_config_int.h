@@ -94,3 +94,5 @@ void device_iot_config_timer_save_cb(UNUSED_ATTR void* data);
 void device_iot_config_set_modified_time();
 bool device_iot_config_is_factory_reset(void);
 void device_iot_config_delete_files(void);
+void device_iot_config_cache_sync(void);
+void device_iot_config_cache_clear(void);
@@ -0,0 +1,119 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2022 Google, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include "btif/include/btif_common.h"
+#include "common/init_flags.h"
+#include "device/include/device_iot_config.h"
+#include "device/src/device_iot_config_int.h"
+#include "osi/include/alarm.h"
+
+using ::benchmark::State;
+
+extern alarm_t* config_timer;
+
+bt_status_t btif_transfer_context(tBTIF_CBACK* p_cback, uint16_t event,
+                                  char* p_params, int param_len,
+                                  tBTIF_COPY_CBACK* p_copy_cback) {
+  return BT_STATUS_SUCCESS;
+}
+
+namespace {
+
+const char* config_flags[] = {
+    "INIT_device_iot_config_logging=true",
+    nullptr,
+};
+
+const char* cache_flags[] = {
+    "INIT_device_iot_config_logging=true",
+    "INIT_device_iot_config_cache=true",
+    nullptr,
+};
+
+const char* kCounters[] = {"Profile/A2dp/ConnCount", "Profile/Hfp/ConnCount",
+                           "Gatt/ConnCount",         "Acl/ConnCount",
+                           "Acl/DisconnCount",       "Smp/PairingCount"};
+
+}  // namespace
+
+/* The counter and role updates made on the connection events of
+ * state.range(0) devices, with the values kept in the config as strings and
+ * in the cache. The config is not saved. */
+class BM_DeviceIotConfig : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    for (int i = 0; i < st.range(0); i++) {
+      sections_.push_back("00:11:22:33:" + std::to_string(10 + i / 90) + ":" +
+                          std::to_string(10 + i % 90));
+    }
+  }
+
+  void TearDown(State& st) override {
+    alarm_cancel(config_timer);
+    device_iot_config_module_clean_up();
+    sections_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void Start(const char** flags) {
+    bluetooth::common::InitFlags::Load(flags);
+    device_iot_config_module_init();
+    device_iot_config_module_start_up();
+  }
+
+  void Update(State& state) {
+    size_t i = 0;
+    for (auto _ : state) {
+      const std::string& section = sections_[i % sections_.size()];
+      device_iot_config_int_add_one(section, kCounters[i % 6]);
+      device_iot_config_set_hex(section, "Acl/Role",
+                                i / sections_.size() % 2, 1);
+      i++;
+    }
+    state.SetItemsProcessed(2 * state.iterations());
+  }
+
+  std::vector<std::string> sections_;
+};
+
+BENCHMARK_DEFINE_F(BM_DeviceIotConfig, config)(State& state) {
+  Start(config_flags);
+  Update(state);
+}
+
+BENCHMARK_DEFINE_F(BM_DeviceIotConfig, cache)(State& state) {
+  Start(cache_flags);
+  Update(state);
+}
+
+BENCHMARK_REGISTER_F(BM_DeviceIotConfig, config)->Arg(4)->Arg(40)->Arg(200);
+BENCHMARK_REGISTER_F(BM_DeviceIotConfig, cache)->Arg(4)->Arg(40)->Arg(200);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
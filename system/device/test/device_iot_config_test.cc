@@ -22,6 +22,10 @@
 #include <gtest/gtest.h>
 #include <sys/mman.h>
 
+#include <map>
+#include <string>
+#include <vector>
+
 #include "btcore/include/module.h"
 #include "btif/include/btif_common.h"
 #include "common/init_flags.h"
@@ -3290,6 +3294,301 @@ TEST_F(DeviceIotConfigTest, test_device_debug_iot_config_delete_files) {
     EXPECT_EQ(errno, ENOENT);
   }
 }
+const char* test_flags_cache_enabled[] = {
+    "INIT_logging_debug_enabled_for_all=true",
+    "INIT_device_iot_config_logging=true",
+    "INIT_device_iot_config_cache=true",
+    nullptr,
+};
+
+class DeviceIotConfigCacheTest : public DeviceIotConfigTest {
+ protected:
+  void SetUp() override {
+    DeviceIotConfigTest::SetUp();
+    bluetooth::common::InitFlags::Load(test_flags_cache_enabled);
+
+    test::mock::osi_alarm::alarm_set.body =
+        [&](alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
+            void* data) { alarm_scheduled = true; };
+    test::mock::osi_alarm::alarm_is_scheduled.body =
+        [&](const alarm_t* alarm) -> bool { return alarm_scheduled; };
+    test::mock::osi_config::config_save.body =
+        [&](const config_t& config, const std::string& filename) -> bool {
+      return true;
+    };
+    test::mock::osi_config::config_has_section.body =
+        [&](const config_t& config, const std::string& section) {
+          return false;
+        };
+    test::mock::osi_config::config_has_key.body =
+        [&](const config_t& config, const std::string& section,
+            const std::string& key) { return false; };
+    test::mock::osi_config::config_remove_key.body =
+        [&](config_t* config, const std::string& section,
+            const std::string& key) { return true; };
+  }
+
+  void TearDown() override {
+    device_iot_config_cache_clear();
+    test::mock::osi_config::config_save = {};
+    test::mock::osi_config::config_has_section = {};
+    test::mock::osi_config::config_has_key = {};
+    test::mock::osi_config::config_remove_key = {};
+    DeviceIotConfigTest::TearDown();
+  }
+
+  bool alarm_scheduled = false;
+};
+
+TEST_F(DeviceIotConfigCacheTest, test_device_iot_config_int_add_one) {
+  std::string set_section, set_key, set_value;
+  int int_value = 5;
+
+  test::mock::osi_config::config_get_int.body =
+      [&](const config_t& config, const std::string& section,
+          const std::string& key, int def_value) { return int_value; };
+  test::mock::osi_config::config_set_string.body =
+      [&](config_t* config, const std::string& section, const std::string& key,
+          const std::string& value) {
+        set_section = section;
+        set_key = key;
+        set_value = value;
+      };
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(device_iot_config_int_add_one("abc", "def"));
+  }
+  // The stored value is read once and the updates are not written back yet
+  EXPECT_EQ(get_func_call_count("config_get_int"), 1);
+  EXPECT_EQ(get_func_call_count("config_set_int"), 0);
+  EXPECT_EQ(get_func_call_count("config_set_string"), 0);
+  EXPECT_EQ(get_func_call_count("alarm_set"), 1);
+
+  int value = 0;
+  EXPECT_TRUE(device_iot_config_get_int("abc", "def", value));
+  EXPECT_EQ(value, int_value + 3);
+  EXPECT_EQ(get_func_call_count("config_get_int"), 1);
+
+  device_iot_config_write(IOT_CONFIG_FLUSH_EVT, NULL);
+  EXPECT_EQ(get_func_call_count("config_set_string"), 1);
+  EXPECT_EQ(get_func_call_count("config_save"), 1);
+  EXPECT_EQ(set_section, "abc");
+  EXPECT_EQ(set_key, "def");
+  EXPECT_EQ(set_value, "8");
+
+  // The written value is read back from the config after the save
+  EXPECT_TRUE(device_iot_config_int_add_one("abc", "def"));
+  EXPECT_EQ(get_func_call_count("config_get_int"), 2);
+}
+
+TEST_F(DeviceIotConfigCacheTest, test_device_iot_config_int_add_one_negative) {
+  test::mock::osi_config::config_get_int.body =
+      [&](const config_t& config, const std::string& section,
+          const std::string& key, int def_value) { return -1; };
+
+  EXPECT_TRUE(device_iot_config_int_add_one("abc", "def"));
+  int value = -1;
+  EXPECT_TRUE(device_iot_config_get_int("abc", "def", value));
+  EXPECT_EQ(value, 0);
+
+  EXPECT_TRUE(device_iot_config_set_int("abc", "def", INT_MAX));
+  EXPECT_TRUE(device_iot_config_int_add_one("abc", "def"));
+  EXPECT_TRUE(device_iot_config_get_int("abc", "def", value));
+  EXPECT_EQ(value, INT_MIN);
+
+  EXPECT_TRUE(device_iot_config_int_add_one("abc", "def"));
+  EXPECT_TRUE(device_iot_config_get_int("abc", "def", value));
+  EXPECT_EQ(value, 0);
+  EXPECT_EQ(get_func_call_count("config_get_int"), 1);
+}
+
+TEST_F(DeviceIotConfigCacheTest, test_device_iot_config_set_unchanged) {
+  std::string stored_value = "0a";
+
+  test::mock::osi_config::config_get_string.body =
+      [&](const config_t& config, const std::string& section,
+          const std::string& key, const std::string* def_value) {
+        return &stored_value;
+      };
+
+  EXPECT_TRUE(device_iot_config_set_hex("abc", "def", 10, 1));
+  EXPECT_TRUE(device_iot_config_set_hex("abc", "def", 10, 1));
+  EXPECT_EQ(get_func_call_count("config_get_string"), 1);
+  EXPECT_EQ(get_func_call_count("alarm_set"), 0);
+
+  device_iot_config_write(IOT_CONFIG_FLUSH_EVT, NULL);
+  EXPECT_EQ(get_func_call_count("config_set_string"), 0);
+}
+
+TEST_F(DeviceIotConfigCacheTest, test_device_iot_config_get_cached) {
+  EXPECT_TRUE(device_iot_config_set_hex("abc", "hex", 0x1234, 2));
+  EXPECT_TRUE(device_iot_config_set_str("abc", "str", "value"));
+  EXPECT_TRUE(device_iot_config_set_int("abc", "int", 7));
+  reset_mock_function_count_map();
+
+  EXPECT_TRUE(device_iot_config_has_section("abc"));
+  EXPECT_TRUE(device_iot_config_exist("abc", "str"));
+
+  int value = 0;
+  EXPECT_TRUE(device_iot_config_get_hex("abc", "hex", value));
+  EXPECT_EQ(value, 0x1234);
+
+  char str[32];
+  int size = sizeof(str);
+  EXPECT_TRUE(device_iot_config_get_str("abc", "hex", str, &size));
+  EXPECT_STREQ(str, "1234");
+  EXPECT_EQ(size, 5);
+  size = sizeof(str);
+  EXPECT_TRUE(device_iot_config_get_str("abc", "str", str, &size));
+  EXPECT_STREQ(str, "value");
+  size = sizeof(str);
+  EXPECT_TRUE(device_iot_config_get_str("abc", "int", str, &size));
+  EXPECT_STREQ(str, "7");
+
+  EXPECT_EQ(get_func_call_size(), 0);
+
+  // Reading a value any other way writes the cached values to the config
+  device_iot_config_get_int("abc", "str", value);
+  EXPECT_EQ(get_func_call_count("config_set_string"), 3);
+  EXPECT_EQ(get_func_call_count("config_has_key"), 1);
+}
+
+TEST_F(DeviceIotConfigCacheTest, test_device_iot_config_remove) {
+  EXPECT_TRUE(device_iot_config_set_int("abc", "def", 7));
+  EXPECT_TRUE(device_iot_config_remove("abc", "def"));
+  EXPECT_EQ(get_func_call_count("config_set_string"), 1);
+  EXPECT_EQ(get_func_call_count("config_remove_key"), 1);
+  EXPECT_FALSE(device_iot_config_exist("abc", "def"));
+}
+
+namespace {
+
+/* The accessors the IoT config uses, working on the config like osi config */
+void UseConfigValues() {
+  test::mock::osi_config::config_get_int.body =
+      [](const config_t& config, const std::string& section,
+         const std::string& key, int def_value) {
+        const std::string* value = test::mock::osi_config::config_get_string(
+            config, section, key, nullptr);
+        if (!value) return def_value;
+        char* endptr;
+        int ret = strtol(value->c_str(), &endptr, 0);
+        return (*endptr == '\0') ? ret : def_value;
+      };
+  test::mock::osi_config::config_set_int.body =
+      [](config_t* config, const std::string& section, const std::string& key,
+         int value) {
+        test::mock::osi_config::config_set_string(config, section, key,
+                                                  std::to_string(value));
+      };
+  test::mock::osi_config::config_get_string.body =
+      [](const config_t& config, const std::string& section,
+         const std::string& key,
+         const std::string* def_value) -> const std::string* {
+    for (const auto& sec : config.sections) {
+      if (sec.name != section) continue;
+      for (const auto& entry : sec.entries) {
+        if (entry.key == key) return &entry.value;
+      }
+    }
+    return def_value;
+  };
+  test::mock::osi_config::config_set_string.body =
+      [](config_t* config, const std::string& section, const std::string& key,
+         const std::string& value) {
+        auto sec = config->sections.begin();
+        while (sec != config->sections.end() && sec->name != section) sec++;
+        if (sec == config->sections.end()) {
+          sec = config->sections.insert(sec, section_t{.name = section});
+        }
+        for (auto& entry : sec->entries) {
+          if (entry.key == key) {
+            entry.value = value;
+            return;
+          }
+        }
+        sec->entries.push_back(entry_t{.key = key, .value = value});
+      };
+}
+
+}  // namespace
+
+/* The counter and value updates made on connection events leave the same
+ * config with the cache, which writes each value once when the config is
+ * saved instead of on every update */
+TEST_F(DeviceIotConfigCacheTest, connection_updates_match_config) {
+  const int kDevices = 4;
+  const int kUpdates = 1000;
+  const char* keys[] = {"Profile/A2dp/ConnCount", "Profile/Hfp/ConnCount",
+                        "Gatt/ConnCount",        "Acl/ConnCount",
+                        "Acl/DisconnCount",      "Smp/PairingCount"};
+  UseConfigValues();
+  test::mock::osi_config::config_new_empty.body = [](void) {
+    return std::make_unique<config_t>();
+  };
+  test::mock::osi_allocator::osi_calloc.body = [](size_t size) {
+    return calloc(1, size);
+  };
+  test::mock::osi_allocator::osi_free.body = [](void* ptr) { free(ptr); };
+  test::mock::osi_alarm::alarm_cancel.body = [](alarm_t* alarm) {};
+  std::map<std::string, std::map<std::string, std::string>> saved;
+  test::mock::osi_config::config_save.body =
+      [&](const config_t& config, const std::string& filename) -> bool {
+    saved.clear();
+    for (const auto& section : config.sections) {
+      for (const auto& entry : section.entries) {
+        saved[section.name][entry.key] = entry.value;
+      }
+    }
+    return true;
+  };
+
+  std::vector<std::map<std::string, std::map<std::string, std::string>>>
+      saved_configs;
+  std::vector<int> config_writes;
+  for (const char** flags :
+       {test_flags_feature_enabled, test_flags_cache_enabled}) {
+    bluetooth::common::InitFlags::Load(flags);
+    device_iot_config_clear();
+    reset_mock_function_count_map();
+
+    for (int i = 0; i < kUpdates; i++) {
+      std::string section =
+          "00:11:22:33:44:" + std::to_string(10 + i % kDevices);
+      device_iot_config_int_add_one(section, keys[i % 6]);
+      device_iot_config_set_hex(section, "Acl/Role", i / kDevices % 2, 1);
+    }
+    device_iot_config_write(IOT_CONFIG_FLUSH_EVT, NULL);
+
+    saved_configs.push_back(saved);
+    config_writes.push_back(get_func_call_count("config_set_int") +
+                            get_func_call_count("config_set_string"));
+  }
+
+  int values = 0;
+  int count = 0;
+  for (const auto& [section, entries] : saved_configs[0]) {
+    for (const auto& [key, value] : entries) {
+      values++;
+      if (key == "Acl/Role") {
+        EXPECT_EQ(value, "01") << section;
+      } else {
+        count += std::stoi(value);
+      }
+    }
+  }
+  EXPECT_EQ(saved_configs[0].size(), (size_t)kDevices);
+  EXPECT_EQ(count, kUpdates);
+  EXPECT_EQ(saved_configs[1], saved_configs[0]);
+  EXPECT_EQ(config_writes[0], 2 * kUpdates);
+  EXPECT_EQ(config_writes[1], values);
+
+  test::mock::osi_config::config_new_empty.body = {};
+  test::mock::osi_allocator::osi_calloc.body = {};
+  test::mock::osi_allocator::osi_free.body = {};
+  test::mock::osi_alarm::alarm_cancel.body = {};
+}
+
 class DeviceIotConfigDisabledTest : public testing::Test {
  protected:
   void SetUp() override {
@@ -136,6 +136,13 @@ extern "C" {
 g722_encode_state_t *g722_encode_init(g722_encode_state_t *s, unsigned int rate, int options);
 int g722_encode_release(g722_encode_state_t *s);
 int g722_encode(g722_encode_state_t *s, uint8_t g722_data[], const int16_t amp[], int len);
+/*! Encode |len| samples of each of the two channels interleaved in |amp|, left first,
+    into |left_data| and |right_data|. The result is the same as encoding the channels
+    separately with g722_encode(). Returns the total number of bytes written to both
+    buffers, which is one byte for each pair of samples of each channel. */
+int g722_encode_stereo(g722_encode_state_t *left, g722_encode_state_t *right,
+                       uint8_t left_data[], uint8_t right_data[],
+                       const int16_t amp[], int len);
 
 g722_decode_state_t *g722_decode_init(g722_decode_state_t *s, unsigned int rate, int options);
 int g722_decode_release(g722_decode_state_t *s);
@@ -32,6 +32,14 @@
 #include "g722_typedefs.h"
 #include "g722_enc_dec.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define G722_QMF_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define G722_QMF_NEON
+#endif
+
 #if !defined(FALSE)
 #define FALSE 0
 #endif
@@ -259,17 +267,162 @@ static int16_t qm2[4] =
 {
     -7408,  -1616,   7408,   1616
 };
-static int16_t qmf_coeffs[12] =
-{
-       3,  -11,   12,   32, -210,  951, 3876, -805,  362, -156,   53,  -11,
-};
 static int16_t ihn[3] = {0, 1, 0};
 static int16_t ihp[3] = {0, 3, 2};
 static int16_t wh[3] = {0, -214, 798};
 static int16_t rh2[4] = {2, 1, 2, 1};
 
-int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
-                       const int16_t amp[], int len)
+/* The transmit QMF taps in the order of the signal history they multiply,
+   combined so that one dot product gives the sum of the even and odd filter
+   outputs and another one their difference. All sums fit 32 bits, so they
+   are bit exact in any order. */
+static const int16_t qmf_sum[24] =
+{
+       3,  -11,  -11,   53,   12, -156,   32,  362, -210, -805,  951, 3876,
+    3876,  951, -805, -210,  362,   32, -156,   12,   53,  -11,  -11,    3,
+};
+static const int16_t qmf_diff[24] =
+{
+      -3,  -11,   11,   53,  -12, -156,  -32,  362,  210, -805, -951, 3876,
+   -3876,  951,  805, -210, -362,   32,  156,   12,  -53,  -11,   11,    3,
+};
+
+/* Number of sample pairs run through the QMF at a time */
+#define QMF_BLOCK_PAIRS 80
+
+/* Apply the transmit QMF to |pairs| sample pairs. The history for the n'th
+   pair is x[2*n] to x[2*n + 23], with the new samples last. */
+#if defined(G722_QMF_SSE2)
+static void qmf_analysis(const int16_t x[], int pairs, int xlow[], int xhigh[])
+{
+    const __m128i sum0 = _mm_loadu_si128((const __m128i *) &qmf_sum[0]);
+    const __m128i sum1 = _mm_loadu_si128((const __m128i *) &qmf_sum[8]);
+    const __m128i sum2 = _mm_loadu_si128((const __m128i *) &qmf_sum[16]);
+    const __m128i diff0 = _mm_loadu_si128((const __m128i *) &qmf_diff[0]);
+    const __m128i diff1 = _mm_loadu_si128((const __m128i *) &qmf_diff[8]);
+    const __m128i diff2 = _mm_loadu_si128((const __m128i *) &qmf_diff[16]);
+    int n;
+
+    for (n = 0;  n < pairs;  n++)
+    {
+        const int16_t *w = &x[2*n];
+        __m128i x0 = _mm_loadu_si128((const __m128i *) &w[0]);
+        __m128i x1 = _mm_loadu_si128((const __m128i *) &w[8]);
+        __m128i x2 = _mm_loadu_si128((const __m128i *) &w[16]);
+        __m128i sum;
+        __m128i diff;
+        __m128i t;
+
+        sum = _mm_add_epi32(_mm_madd_epi16(x0, sum0), _mm_madd_epi16(x1, sum1));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x2, sum2));
+        diff = _mm_add_epi32(_mm_madd_epi16(x0, diff0), _mm_madd_epi16(x1, diff1));
+        diff = _mm_add_epi32(diff, _mm_madd_epi16(x2, diff2));
+
+        /* Reduce both at once, to { sum, diff, sum, diff } */
+        t = _mm_add_epi32(_mm_unpacklo_epi32(sum, diff), _mm_unpackhi_epi32(sum, diff));
+        t = _mm_add_epi32(t, _mm_shuffle_epi32(t, _MM_SHUFFLE(1, 0, 3, 2)));
+        xlow[n] = _mm_cvtsi128_si32(t) >> 14;
+        xhigh[n] = _mm_cvtsi128_si32(_mm_srli_si128(t, 4)) >> 14;
+    }
+}
+#elif defined(G722_QMF_NEON)
+static __inline int32_t qmf_dot(const int16_t *w, const int16_t h[])
+{
+    int16x8_t x0 = vld1q_s16(&w[0]);
+    int16x8_t x1 = vld1q_s16(&w[8]);
+    int16x8_t x2 = vld1q_s16(&w[16]);
+    int16x8_t h0 = vld1q_s16(&h[0]);
+    int16x8_t h1 = vld1q_s16(&h[8]);
+    int16x8_t h2 = vld1q_s16(&h[16]);
+    int32x4_t acc;
+
+    acc = vmull_s16(vget_low_s16(x0), vget_low_s16(h0));
+    acc = vmlal_s16(acc, vget_high_s16(x0), vget_high_s16(h0));
+    acc = vmlal_s16(acc, vget_low_s16(x1), vget_low_s16(h1));
+    acc = vmlal_s16(acc, vget_high_s16(x1), vget_high_s16(h1));
+    acc = vmlal_s16(acc, vget_low_s16(x2), vget_low_s16(h2));
+    acc = vmlal_s16(acc, vget_high_s16(x2), vget_high_s16(h2));
+#if defined(__aarch64__)
+    return vaddvq_s32(acc);
+#else
+    {
+        int32x2_t t = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+        return vget_lane_s32(vpadd_s32(t, t), 0);
+    }
+#endif
+}
+
+static void qmf_analysis(const int16_t x[], int pairs, int xlow[], int xhigh[])
+{
+    int n;
+
+    for (n = 0;  n < pairs;  n++)
+    {
+        xlow[n] = qmf_dot(&x[2*n], qmf_sum) >> 14;
+        xhigh[n] = qmf_dot(&x[2*n], qmf_diff) >> 14;
+    }
+}
+#else
+static void qmf_analysis(const int16_t x[], int pairs, int xlow[], int xhigh[])
+{
+    int n;
+    int i;
+    int sum;
+    int diff;
+
+    for (n = 0;  n < pairs;  n++)
+    {
+        sum = 0;
+        diff = 0;
+        for (i = 0;  i < 24;  i++)
+        {
+            sum += x[2*n + i]*qmf_sum[i];
+            diff += x[2*n + i]*qmf_diff[i];
+        }
+        xlow[n] = sum >> 14;
+        xhigh[n] = diff >> 14;
+    }
+}
+#endif
+/*- End of function --------------------------------------------------------*/
+
+/* Run the QMF over the next |pairs| sample pairs of one channel of |amp|,
+   whose samples are |channels| apart, and keep the signal history in |s|.
+   We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
+   to allow for us summing two filters, plus 1 to allow for the 15 bit
+   input to the G.722 algorithm. */
+static void transmit_qmf(g722_encode_state_t *s, const int16_t amp[], int channels,
+                         int pairs, int xlow[], int xhigh[])
+{
+    int16_t x[22 + 2*QMF_BLOCK_PAIRS];
+    int i;
+
+    for (i = 0;  i < 22;  i++)
+        x[i] = (int16_t) s->x[i + 2];
+    for (i = 0;  i < 2*pairs;  i++)
+        x[22 + i] = amp[i*channels];
+
+    qmf_analysis(x, pairs, xlow, xhigh);
+
+    for (i = 0;  i < 24;  i++)
+        s->x[i] = x[2*pairs - 2 + i];
+
+#ifdef RUN_LIKE_REFERENCE_G722
+    /* The following lines are only used to verify bit-exactness
+     * with reference implementation of G.722. Higher precision
+     * is achieved without limiting the values.
+     */
+    for (i = 0;  i < pairs;  i++)
+    {
+        xlow[i] = limitValues(xlow[i]);
+        xhigh[i] = limitValues(xhigh[i]);
+    }
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Encode one low and high band sample pair into a code */
+static __inline int encode_bands(g722_encode_state_t *s, int xlow, int xhigh)
 {
     int dlow;
     int dhigh;
@@ -284,155 +437,179 @@ int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
     int eh;
     int mih;
     int i;
-    int j;
-    /* Low and high band PCM from the QMF */
-    int xlow;
-    int xhigh;
-    int g722_bytes;
-    /* Even and odd tap accumulators */
-    int sumeven;
-    int sumodd;
     int ihigh;
     int ilow;
     int code;
 
-    g722_bytes = 0;
-    xhigh = 0;
-    for (j = 0;  j < len;  )
-    {
-        if (s->itu_test_mode)
-        {
-            xlow =
-            xhigh = amp[j++] >> 1;
-        }
-        else
-        {
-            {
-                /* Apply the transmit QMF */
-                /* Shuffle the buffer down */
-                for (i = 0;  i < 22;  i++)
-                    s->x[i] = s->x[i + 2];
-                //TODO: if len is odd, then this can be a buffer overrun
-                s->x[22] = amp[j++];
-                s->x[23] = amp[j++];
-    
-                /* Discard every other QMF output */
-                sumeven = 0;
-                sumodd = 0;
-                for (i = 0;  i < 12;  i++)
-                {
-                    sumodd += s->x[2*i]*qmf_coeffs[i];
-                    sumeven += s->x[2*i + 1]*qmf_coeffs[11 - i];
-                }
-                /* We shift by 12 to allow for the QMF filters (DC gain = 4096), plus 1
-                   to allow for us summing two filters, plus 1 to allow for the 15 bit
-                   input to the G.722 algorithm. */
-                xlow = (sumeven + sumodd) >> 14;
-                xhigh = (sumeven - sumodd) >> 14;
-
-#ifdef RUN_LIKE_REFERENCE_G722
-                /* The following lines are only used to verify bit-exactness
-                 * with reference implementation of G.722. Higher precision
-                 * is achieved without limiting the values.
-                 */
-                xlow = limitValues(xlow);
-                xhigh = limitValues(xhigh);
-#endif
-            }
-        }
-        /* Block 1L, SUBTRA */
-        el = saturate(xlow - s->band[0].s);
+    /* Block 1L, SUBTRA */
+    el = saturate(xlow - s->band[0].s);
 
-        /* Block 1L, QUANTL */
-        wd = (el >= 0)  ?  el  :  -(el + 1);
+    /* Block 1L, QUANTL */
+    wd = (el >= 0)  ?  el  :  -(el + 1);
 
-        for (i = 1;  i < 30;  i++)
-        {
-            wd1 = (q6[i]*s->band[0].det) >> 12;
-            if (wd < wd1)
-                break;
-        }
-        ilow = (el < 0)  ?  iln[i]  :  ilp[i];
-
-        /* Block 2L, INVQAL */
-        ril = ilow >> 2;
-        wd2 = qm4[ril];
-        dlow = (s->band[0].det*wd2) >> 15;
-
-        /* Block 3L, LOGSCL */
-        il4 = rl42[ril];
-        wd = (s->band[0].nb*127) >> 7;
-        s->band[0].nb = wd + wl[il4];
-        if (s->band[0].nb < 0)
-            s->band[0].nb = 0;
-        else if (s->band[0].nb > 18432)
-            s->band[0].nb = 18432;
-
-        /* Block 3L, SCALEL */
-        wd1 = (s->band[0].nb >> 6) & 31;
-        wd2 = 8 - (s->band[0].nb >> 11);
+    for (i = 1;  i < 30;  i++)
+    {
+        wd1 = (q6[i]*s->band[0].det) >> 12;
+        if (wd < wd1)
+            break;
+    }
+    ilow = (el < 0)  ?  iln[i]  :  ilp[i];
+
+    /* Block 2L, INVQAL */
+    ril = ilow >> 2;
+    wd2 = qm4[ril];
+    dlow = (s->band[0].det*wd2) >> 15;
+
+    /* Block 3L, LOGSCL */
+    il4 = rl42[ril];
+    wd = (s->band[0].nb*127) >> 7;
+    s->band[0].nb = wd + wl[il4];
+    if (s->band[0].nb < 0)
+        s->band[0].nb = 0;
+    else if (s->band[0].nb > 18432)
+        s->band[0].nb = 18432;
+
+    /* Block 3L, SCALEL */
+    wd1 = (s->band[0].nb >> 6) & 31;
+    wd2 = 8 - (s->band[0].nb >> 11);
+    wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
+    s->band[0].det = wd3 << 2;
+
+    block4(&s->band[0], dlow);
+    {
+	int nb;
+
+        /* Block 1H, SUBTRA */
+        eh = saturate(xhigh - s->band[1].s);
+
+        /* Block 1H, QUANTH */
+        wd = (eh >= 0)  ?  eh  :  -(eh + 1);
+        wd1 = (564*s->band[1].det) >> 12;
+        mih = (wd >= wd1)  ?  2  :  1;
+        ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
+
+        /* Block 2H, INVQAH */
+        wd2 = qm2[ihigh];
+        dhigh = (s->band[1].det*wd2) >> 15;
+
+        /* Block 3H, LOGSCH */
+        ih2 = rh2[ihigh];
+        wd = (s->band[1].nb*127) >> 7;
+
+        nb = wd + wh[ih2];
+        if (nb < 0)
+            nb = 0;
+        else if (nb > 22528)
+            nb = 22528;
+	s->band[1].nb = nb;
+
+        /* Block 3H, SCALEH */
+        wd1 = (s->band[1].nb >> 6) & 31;
+        wd2 = 10 - (s->band[1].nb >> 11);
         wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-        s->band[0].det = wd3 << 2;
+        s->band[1].det = wd3 << 2;
 
-        block4(&s->band[0], dlow);
-        {
-	    int nb;
-
-            /* Block 1H, SUBTRA */
-            eh = saturate(xhigh - s->band[1].s);
-
-            /* Block 1H, QUANTH */
-            wd = (eh >= 0)  ?  eh  :  -(eh + 1);
-            wd1 = (564*s->band[1].det) >> 12;
-            mih = (wd >= wd1)  ?  2  :  1;
-            ihigh = (eh < 0)  ?  ihn[mih]  :  ihp[mih];
-
-            /* Block 2H, INVQAH */
-            wd2 = qm2[ihigh];
-            dhigh = (s->band[1].det*wd2) >> 15;
-
-            /* Block 3H, LOGSCH */
-            ih2 = rh2[ihigh];
-            wd = (s->band[1].nb*127) >> 7;
-
-            nb = wd + wh[ih2];
-            if (nb < 0)
-                nb = 0;
-            else if (nb > 22528)
-                nb = 22528;
-	    s->band[1].nb = nb;
-
-            /* Block 3H, SCALEH */
-            wd1 = (s->band[1].nb >> 6) & 31;
-            wd2 = 10 - (s->band[1].nb >> 11);
-            wd3 = (wd2 < 0)  ?  (ilb[wd1] << -wd2)  :  (ilb[wd1] >> wd2);
-            s->band[1].det = wd3 << 2;
-
-            block4(&s->band[1], dhigh);
+        block4(&s->band[1], dhigh);
 #if   BITS_PER_SAMPLE == 8
-            code = ((ihigh << 6) | ilow);
+        code = ((ihigh << 6) | ilow);
 #elif BITS_PER_SAMPLE == 7
-            code = ((ihigh << 6) | ilow) >> 1;
+        code = ((ihigh << 6) | ilow) >> 1;
 #elif BITS_PER_SAMPLE == 6
-            code = ((ihigh << 6) | ilow) >> 2;
+        code = ((ihigh << 6) | ilow) >> 2;
 #endif
-        }
+    }
+    return code;
+}
+/*- End of function --------------------------------------------------------*/
 
+/* |s| only holds the bits left over between calls with PACKED_OUTPUT */
+static __inline int put_code([[maybe_unused]] g722_encode_state_t *s,
+                             uint8_t g722_data[], int g722_bytes, int code)
+{
 #if PACKED_OUTPUT == 1
-            /* Pack the code bits */
-            s->out_buffer |= (code << s->out_bits);
-            s->out_bits += s->bits_per_sample;
-            if (s->out_bits >= 8)
-            {
-                g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
-                s->out_bits -= 8;
-                s->out_buffer >>= 8;
-            }
+    /* Pack the code bits */
+    s->out_buffer |= (code << s->out_bits);
+    s->out_bits += s->bits_per_sample;
+    if (s->out_bits >= 8)
+    {
+        g722_data[g722_bytes++] = (uint8_t) (s->out_buffer & 0xFF);
+        s->out_bits -= 8;
+        s->out_buffer >>= 8;
+    }
 #else
-            g722_data[g722_bytes++] = (uint8_t) code;
+    g722_data[g722_bytes++] = (uint8_t) code;
 #endif
-    }
     return g722_bytes;
 }
 /*- End of function --------------------------------------------------------*/
+
+/* Encode |channels| channels of |len| samples each, interleaved in |amp|.
+   The channels go through the QMF a block at a time, and their ADPCM
+   encoders run side by side, as they do not depend on each other.
+   Returns the number of bytes written for all the channels. */
+static int encode_channels(g722_encode_state_t *s[], uint8_t *g722_data[],
+                           int channels, const int16_t amp[], int len)
+{
+    int xlow[2][QMF_BLOCK_PAIRS];
+    int xhigh[2][QMF_BLOCK_PAIRS];
+    int g722_bytes[2] = {0, 0};
+    int pairs;
+    int ch;
+    int i;
+    int j;
+
+    if (s[0]->itu_test_mode)
+    {
+        for (j = 0;  j < len;  j++)
+        {
+            for (ch = 0;  ch < channels;  ch++)
+            {
+                int x = amp[j*channels + ch] >> 1;
+                g722_bytes[ch] = put_code(s[ch], g722_data[ch], g722_bytes[ch],
+                                          encode_bands(s[ch], x, x));
+            }
+        }
+        return g722_bytes[0] + g722_bytes[1];
+    }
+
+    /* A trailing odd sample has no pair to go through the QMF with */
+    for (j = 0;  j + 1 < len;  j += 2*pairs)
+    {
+        pairs = (len - j)/2;
+        if (pairs > QMF_BLOCK_PAIRS)
+            pairs = QMF_BLOCK_PAIRS;
+
+        for (ch = 0;  ch < channels;  ch++)
+            transmit_qmf(s[ch], &amp[j*channels + ch], channels, pairs, xlow[ch], xhigh[ch]);
+
+        for (i = 0;  i < pairs;  i++)
+        {
+            for (ch = 0;  ch < channels;  ch++)
+            {
+                g722_bytes[ch] = put_code(s[ch], g722_data[ch], g722_bytes[ch],
+                                          encode_bands(s[ch], xlow[ch][i], xhigh[ch][i]));
+            }
+        }
+    }
+    return g722_bytes[0] + g722_bytes[1];
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_encode(g722_encode_state_t *s, uint8_t g722_data[],
+                       const int16_t amp[], int len)
+{
+    return encode_channels(&s, &g722_data, 1, amp, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+int g722_encode_stereo(g722_encode_state_t *left, g722_encode_state_t *right,
+                       uint8_t left_data[], uint8_t right_data[],
+                       const int16_t amp[], int len)
+{
+    g722_encode_state_t *s[2] = {left, right};
+    uint8_t *g722_data[2] = {left_data, right_data};
+
+    return encode_channels(s, g722_data, 2, amp, len);
+}
+/*- End of function --------------------------------------------------------*/
 /*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "embdrv/g722/g722_enc_dec.h"
+
+namespace {
+
+constexpr size_t kSamples = 16000;  // 1s at 16kHz
+
+enum Signal {
+  kSilence,
+  kNoise,
+  kSquare,
+  kSawtooth,
+  kFullScale,
+  kQuietNoise,
+  kMixed,
+  kNumSignals,
+};
+
+std::vector<int16_t> MakeSignal(int signal, size_t len) {
+  std::vector<int16_t> pcm(len);
+  uint32_t seed = 0x12345678u + signal;
+  for (size_t i = 0; i < len; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    int16_t noise = (int16_t)(seed >> 16);
+    switch (signal) {
+      case kSilence:
+        pcm[i] = 0;
+        break;
+      case kNoise:
+        pcm[i] = noise;
+        break;
+      case kSquare:
+        pcm[i] = (i / 16) % 2 ? 20000 : -20000;
+        break;
+      case kSawtooth:
+        pcm[i] = (int16_t)((i * 655) % 65536 - 32768);
+        break;
+      case kFullScale:
+        pcm[i] = i % 2 ? 32767 : -32768;
+        break;
+      case kQuietNoise:
+        pcm[i] = noise >> 9;
+        break;
+      case kMixed:
+        pcm[i] = (int16_t)(((i * 97) % 400 < 200 ? 1 : -1) * (int)(i % 8000)) +
+                 (noise >> 6);
+        break;
+    }
+  }
+  return pcm;
+}
+
+uint32_t Fnv1a(const uint8_t* data, size_t size) {
+  uint32_t hash = 0x811c9dc5;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= 0x01000193;
+  }
+  return hash;
+}
+
+/* Output of the scalar encoder for one second of each signal */
+struct ReferenceOutput {
+  uint32_t hash;
+  uint8_t first[16];
+};
+
+const ReferenceOutput kReference[kNumSignals] = {
+    {0x0fbe9c9b,
+     {0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa, 0xfa,
+      0xfa, 0xfa, 0xfa, 0xfa}},
+    {0xffe9177e,
+     {0x85, 0x20, 0x84, 0x20, 0x84, 0x20, 0x9b, 0xa6, 0x1b, 0x30, 0x84, 0xac,
+      0xaf, 0x2d, 0x36, 0xad}},
+    {0xd51896f7,
+     {0x28, 0x84, 0x20, 0x84, 0x20, 0x84, 0x04, 0x86, 0x05, 0x06, 0x86, 0x08,
+      0x86, 0x2f, 0xa0, 0x22}},
+    {0xd0c52562,
+     {0x23, 0x84, 0x20, 0x84, 0x20, 0x84, 0x04, 0x84, 0x04, 0x84, 0x04, 0x45,
+      0xc6, 0xc7, 0xc9, 0xcb}},
+    {0x2f5e607d,
+     {0x20, 0x84, 0x20, 0x86, 0x25, 0x84, 0xb5, 0x9e, 0xbd, 0xbd, 0xbe, 0xbc,
+      0xbf, 0xbd, 0xbf, 0xbd}},
+    {0xeb1931c2,
+     {0xde, 0x7a, 0xf7, 0x6e, 0x99, 0x22, 0xb4, 0xb6, 0x15, 0x1d, 0x37, 0x37,
+      0xde, 0x5f, 0x7a, 0x5c}},
+    {0xaf265c72,
+     {0xde, 0x37, 0x9e, 0x2c, 0x88, 0x20, 0x20, 0x08, 0xbe, 0xbe, 0x10, 0x12,
+      0x78, 0xb2, 0x2f, 0x50}},
+};
+
+std::vector<uint8_t> Encode(const std::vector<int16_t>& pcm, size_t chunk) {
+  g722_encode_state_t state;
+  g722_encode_init(&state, 64000, G722_PACKED);
+  std::vector<uint8_t> out(pcm.size() / 2);
+  size_t encoded = 0;
+  for (size_t i = 0; i < pcm.size(); i += chunk) {
+    size_t len = std::min(chunk, pcm.size() - i);
+    encoded += g722_encode(&state, out.data() + encoded, pcm.data() + i, len);
+  }
+  out.resize(encoded);
+  return out;
+}
+
+void ExpectReference(int signal, const std::vector<uint8_t>& out) {
+  ASSERT_EQ(out.size(), kSamples / 2) << "signal " << signal;
+  EXPECT_EQ(Fnv1a(out.data(), out.size()), kReference[signal].hash)
+      << "signal " << signal;
+  EXPECT_EQ(0, memcmp(out.data(), kReference[signal].first,
+                      sizeof(kReference[signal].first)))
+      << "signal " << signal;
+}
+
+}  // namespace
+
+TEST(G722EncodeTest, reference_output) {
+  for (int signal = 0; signal < kNumSignals; signal++) {
+    ExpectReference(signal, Encode(MakeSignal(signal, kSamples), kSamples));
+  }
+}
+
+TEST(G722EncodeTest, reference_output_in_chunks) {
+  // The history kept between calls must not depend on the call sizes
+  for (size_t chunk : {2, 32, 158, 160, 162, 320, 1000}) {
+    for (int signal = 0; signal < kNumSignals; signal++) {
+      ExpectReference(signal, Encode(MakeSignal(signal, kSamples), chunk));
+    }
+  }
+}
+
+TEST(G722EncodeTest, odd_length) {
+  std::vector<int16_t> pcm = MakeSignal(kNoise, 7);
+  g722_encode_state_t state;
+  g722_encode_init(&state, 64000, G722_PACKED);
+  uint8_t out[4];
+  ASSERT_EQ(g722_encode(&state, out, pcm.data(), pcm.size()), 3);
+}
+
+TEST(G722EncodeTest, stereo_matches_mono) {
+  for (int signal = 0; signal < kNumSignals; signal++) {
+    std::vector<int16_t> left = MakeSignal(signal, kSamples);
+    std::vector<int16_t> right = MakeSignal((signal + 1) % kNumSignals, kSamples);
+    std::vector<int16_t> interleaved;
+    for (size_t i = 0; i < kSamples; i++) {
+      interleaved.push_back(left[i]);
+      interleaved.push_back(right[i]);
+    }
+
+    g722_encode_state_t left_state;
+    g722_encode_state_t right_state;
+    g722_encode_init(&left_state, 64000, G722_PACKED);
+    g722_encode_init(&right_state, 64000, G722_PACKED);
+    std::vector<uint8_t> left_out(kSamples / 2);
+    std::vector<uint8_t> right_out(kSamples / 2);
+    // 10ms frames, as the hearing aid profile sends them
+    const size_t frame = 160;
+    for (size_t i = 0; i < kSamples; i += frame) {
+      ASSERT_EQ(g722_encode_stereo(&left_state, &right_state,
+                                   left_out.data() + i / 2,
+                                   right_out.data() + i / 2,
+                                   interleaved.data() + 2 * i, frame),
+                (int)frame);
+    }
+
+    EXPECT_EQ(left_out, Encode(left, kSamples)) << "signal " << signal;
+    EXPECT_EQ(right_out, Encode(right, kSamples)) << "signal " << signal;
+  }
+}
+
+TEST(G722EncodeTest, stereo_odd_length) {
+  std::vector<int16_t> pcm = MakeSignal(kNoise, 14);
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+  uint8_t left_out[4];
+  uint8_t right_out[4];
+  // The total for both channels, of 3 bytes each
+  ASSERT_EQ(g722_encode_stereo(&left_state, &right_state, left_out, right_out,
+                               pcm.data(), pcm.size() / 2),
+            6);
+}
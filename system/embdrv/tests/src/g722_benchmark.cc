@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "embdrv/g722/g722_enc_dec.h"
+
+using ::benchmark::State;
+
+namespace {
+
+constexpr size_t kSamples = 16000;  // 1s at 16kHz
+// 10ms frames, as the hearing aid profile sends them
+constexpr size_t kFrame = 160;
+
+// Noise on the left, a square wave on the right
+std::vector<int16_t> MakeInterleaved() {
+  std::vector<int16_t> pcm(2 * kSamples);
+  uint32_t seed = 0x12345678u;
+  for (size_t i = 0; i < kSamples; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    pcm[2 * i] = (int16_t)(seed >> 16);
+    pcm[2 * i + 1] = (i / 16) % 2 ? 20000 : -20000;
+  }
+  return pcm;
+}
+
+}  // namespace
+
+// Both channels encoded by one call per frame
+static void BM_G722EncodeStereo(State& state) {
+  std::vector<int16_t> pcm = MakeInterleaved();
+  std::vector<uint8_t> left_out(kFrame / 2);
+  std::vector<uint8_t> right_out(kFrame / 2);
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kSamples; i += kFrame) {
+      g722_encode_stereo(&left_state, &right_state, left_out.data(),
+                         right_out.data(), &pcm[2 * i], kFrame);
+    }
+    ::benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kSamples);
+}
+BENCHMARK(BM_G722EncodeStereo);
+
+// Each frame split into two mono buffers and encoded by one call per channel
+static void BM_G722EncodeTwoMono(State& state) {
+  std::vector<int16_t> pcm = MakeInterleaved();
+  std::vector<int16_t> left(kFrame);
+  std::vector<int16_t> right(kFrame);
+  std::vector<uint8_t> left_out(kFrame / 2);
+  std::vector<uint8_t> right_out(kFrame / 2);
+  g722_encode_state_t left_state;
+  g722_encode_state_t right_state;
+  g722_encode_init(&left_state, 64000, G722_PACKED);
+  g722_encode_init(&right_state, 64000, G722_PACKED);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kSamples; i += kFrame) {
+      for (size_t j = 0; j < kFrame; j++) {
+        left[j] = pcm[2 * (i + j)];
+        right[j] = pcm[2 * (i + j) + 1];
+      }
+      g722_encode(&left_state, left_out.data(), left.data(), kFrame);
+      g722_encode(&right_state, right_out.data(), right.data(), kFrame);
+    }
+    ::benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kSamples);
+}
+BENCHMARK(BM_G722EncodeTwoMono);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -141,6 +141,10 @@ struct ActivityAttribution::impl {
     attribution_processor_.OnBtaaPackets(std::move(hci_processor_.OnHciPacket(std::move(packet), type, length)));
   }
 
+  void on_hci_data_packet(hal::SnoopLogger::PacketType type, uint16_t connection_handle, uint16_t length) {
+    attribution_processor_.OnBtaaPacket(hci_processor_.OnHciDataPacket(type, connection_handle, length));
+  }
+
   void on_wakelock_acquired() {
     wakelock_processor_.OnWakelockAcquired();
   }
@@ -179,26 +183,26 @@ struct ActivityAttribution::impl {
 
 void ActivityAttribution::Capture(const hal::HciPacket& packet, hal::SnoopLogger::PacketType type) {
   uint16_t original_length = packet.size();
-  uint16_t truncate_length;
 
   switch (type) {
     case hal::SnoopLogger::PacketType::CMD:
     case hal::SnoopLogger::PacketType::EVT:
-      truncate_length = packet.size();
+      if (!original_length) {
+        return;
+      }
+      CallOn(pimpl_.get(), &impl::on_hci_packet, packet, type, original_length);
       break;
     case hal::SnoopLogger::PacketType::ACL:
     case hal::SnoopLogger::PacketType::SCO:
-    case hal::SnoopLogger::PacketType::ISO:
-      truncate_length = kHciAclHeaderSize;
-      break;
-  }
-
-  if (!truncate_length) {
-    return;
+    case hal::SnoopLogger::PacketType::ISO: {
+      // Data packets are attributed by connection handle only, pass it on without copying the packet.
+      if (original_length < kHciAclHeaderSize) {
+        return;
+      }
+      uint16_t connection_handle = packet[0] | (packet[1] << 8);
+      CallOn(pimpl_.get(), &impl::on_hci_data_packet, type, connection_handle, original_length);
+    } break;
   }
-
-  hal::HciPacket truncate_packet(packet.begin(), packet.begin() + truncate_length);
-  CallOn(pimpl_.get(), &impl::on_hci_packet, truncate_packet, type, original_length);
 }
 
 void ActivityAttribution::OnWakelockAcquired() {
@@ -38,7 +38,7 @@ struct AddressActivityKey {
 struct AddressActivityKeyHasher {
   std::size_t operator()(const AddressActivityKey& key) const {
     return (
-        (std::hash<std::string>()(key.address.ToString()) ^
+        (std::hash<hci::Address>()(key.address) ^
          (std::hash<unsigned char>()(static_cast<unsigned char>(key.activity)))));
   }
 };
@@ -76,6 +76,7 @@ struct AppWakeupDescriptor {
 class AttributionProcessor {
  public:
   void OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets);
+  void OnBtaaPacket(const BtaaHciPacket& btaa_packet);
   void OnWakelockReleased(uint32_t duration_ms);
   void OnWakeup();
   void NotifyActivityAttributionInfo(int uid, const std::string& package_name, const std::string& device_address);
@@ -106,6 +107,7 @@ class AttributionProcessor {
   common::TimestampedCircularBuffer<AppWakeupDescriptor> app_wakeup_aggregator_ =
       common::TimestampedCircularBuffer<AppWakeupDescriptor>(kWakeupAggregatorSize);
   const char* ActivityToString(Activity activity);
+  void aggregate_packet(const BtaaHciPacket& btaa_packet);
 };
 
 }  // namespace activity_attribution
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <array>
+
 #include "btaa/activity_attribution.h"
 #include "btaa/cmd_evt_classification.h"
 #include "hal/snoop_logger.h"
@@ -39,7 +41,9 @@ class DeviceParser {
   void match_handle_with_address(uint16_t connection_handle, hci::Address& address);
 
  private:
-  std::map<uint16_t, hci::Address> connection_lookup_table_;
+  // Indexed by the 12-bit connection handle; an all-zero address means the handle is unknown.
+  static constexpr size_t kMaxConnectionHandles = 0x1000;
+  std::array<std::array<uint8_t, hci::Address::kLength>, kMaxConnectionHandles> connection_lookup_table_ = {};
 };
 
 struct PendingCommand {
@@ -50,6 +54,9 @@ struct PendingCommand {
 class HciProcessor {
  public:
   std::vector<BtaaHciPacket> OnHciPacket(hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length);
+  // ACL, SCO and ISO packets are attributed from their connection handle alone, so callers can pass the
+  // pre-extracted handle instead of a copy of the packet.
+  BtaaHciPacket OnHciDataPacket(hal::SnoopLogger::PacketType type, uint16_t connection_handle, uint16_t length);
 
  private:
   void process_le_event(std::vector<BtaaHciPacket>& btaa_hci_packets, int16_t byte_count, hci::EventView& event);
@@ -66,18 +73,6 @@ class HciProcessor {
       std::vector<BtaaHciPacket>& btaa_hci_packets,
       packet::PacketView<packet::kLittleEndian>& packet_view,
       uint16_t byte_count);
-  void process_acl(
-      std::vector<BtaaHciPacket>& btaa_hci_packets,
-      packet::PacketView<packet::kLittleEndian>& packet_view,
-      uint16_t byte_count);
-  void process_sco(
-      std::vector<BtaaHciPacket>& btaa_hci_packets,
-      packet::PacketView<packet::kLittleEndian>& packet_view,
-      uint16_t byte_count);
-  void process_iso(
-      std::vector<BtaaHciPacket>& btaa_hci_packets,
-      packet::PacketView<packet::kLittleEndian>& packet_view,
-      uint16_t byte_count);
 
   DeviceParser device_parser_;
   PendingCommand pending_command_;
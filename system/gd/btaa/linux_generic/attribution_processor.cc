@@ -33,29 +33,36 @@ static const int kDurationTransientDeviceActivityEntrySecs = 900;
 static const int kMapSizeTrimDownAggregationEntry = 200;
 
 void AttributionProcessor::OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets) {
+  for (auto& btaa_packet : btaa_packets) {
+    aggregate_packet(btaa_packet);
+  }
+  wakeup_ = false;
+}
+
+void AttributionProcessor::OnBtaaPacket(const BtaaHciPacket& btaa_packet) {
+  aggregate_packet(btaa_packet);
+  wakeup_ = false;
+}
+
+void AttributionProcessor::aggregate_packet(const BtaaHciPacket& btaa_packet) {
   AddressActivityKey key;
+  key.address = btaa_packet.address;
+  key.activity = btaa_packet.activity;
 
-  for (auto& btaa_packet : btaa_packets) {
-    key.address = btaa_packet.address;
-    key.activity = btaa_packet.activity;
+  // operator[] value-initializes a new entry, so a single lookup covers both insert and update.
+  auto& entry = wakelock_duration_aggregator_[key];
+  entry.byte_count += btaa_packet.byte_count;
 
-    if (wakelock_duration_aggregator_.find(key) == wakelock_duration_aggregator_.end()) {
-      wakelock_duration_aggregator_[key] = {};
-    }
-    wakelock_duration_aggregator_[key].byte_count += btaa_packet.byte_count;
-
-    if (wakeup_) {
-      wakelock_duration_aggregator_[key].wakeup_count += 1;
-      device_wakeup_aggregator_.Push(std::move(DeviceWakeupDescriptor(btaa_packet.activity, btaa_packet.address)));
-      std::string package_info = kUnknownPackageInfo;
-      std::string address = btaa_packet.address.ToString();
-      if (address_app_map_.find(address) != address_app_map_.end()) {
-        package_info = address_app_map_[address];
-      }
-      app_wakeup_aggregator_.Push(std::move(AppWakeupDescriptor(btaa_packet.activity, package_info)));
+  if (wakeup_) {
+    entry.wakeup_count += 1;
+    device_wakeup_aggregator_.Push(std::move(DeviceWakeupDescriptor(btaa_packet.activity, btaa_packet.address)));
+    std::string package_info = kUnknownPackageInfo;
+    std::string address = btaa_packet.address.ToString();
+    if (address_app_map_.find(address) != address_app_map_.end()) {
+      package_info = address_app_map_[address];
     }
+    app_wakeup_aggregator_.Push(std::move(AppWakeupDescriptor(btaa_packet.activity, package_info)));
   }
-  wakeup_ = false;
 }
 
 void AttributionProcessor::OnWakelockReleased(uint32_t duration_ms) {
@@ -22,12 +22,13 @@ namespace bluetooth {
 namespace activity_attribution {
 
 void DeviceParser::match_handle_with_address(uint16_t connection_handle, hci::Address& address) {
-  if (connection_handle && !address.IsEmpty()) {
-    connection_lookup_table_[connection_handle] = address;
-  } else if (connection_handle) {
-    if (connection_lookup_table_.find(connection_handle) != connection_lookup_table_.end()) {
-      address = connection_lookup_table_[connection_handle];
-    }
+  if (!connection_handle || connection_handle >= kMaxConnectionHandles) {
+    return;
+  }
+  if (!address.IsEmpty()) {
+    connection_lookup_table_[connection_handle] = address.address;
+  } else {
+    address.address = connection_lookup_table_[connection_handle];
   }
 }
 
@@ -201,64 +202,51 @@ void HciProcessor::process_event(
   }
 }
 
-void HciProcessor::process_acl(
-    std::vector<BtaaHciPacket>& btaa_hci_packets,
-    packet::PacketView<packet::kLittleEndian>& packet_view,
-    uint16_t byte_count) {
-  hci::AclView acl = hci::AclView::Create(packet_view);
-  auto connection_handle = acl.begin();
-  // Connection handle is extracted from the 12 least significant bit.
-  uint16_t connection_handle_value = connection_handle.extract<uint16_t>() & 0xfff;
-  hci::Address address_value;
-  device_parser_.match_handle_with_address(connection_handle_value, address_value);
-  btaa_hci_packets.push_back(BtaaHciPacket(Activity::ACL, address_value, byte_count));
-}
-
-void HciProcessor::process_sco(
-    std::vector<BtaaHciPacket>& btaa_hci_packets,
-    packet::PacketView<packet::kLittleEndian>& packet_view,
-    uint16_t byte_count) {
-  hci::ScoView sco = hci::ScoView::Create(packet_view);
-  auto connection_handle = sco.begin();
-  // Connection handle is extracted from the 12 least significant bit.
-  uint16_t connection_handle_value = connection_handle.extract<uint16_t>() & 0xfff;
+BtaaHciPacket HciProcessor::OnHciDataPacket(
+    hal::SnoopLogger::PacketType type, uint16_t connection_handle, uint16_t length) {
+  Activity activity = Activity::UNKNOWN;
+  switch (type) {
+    case hal::SnoopLogger::PacketType::ACL:
+      activity = Activity::ACL;
+      break;
+    case hal::SnoopLogger::PacketType::SCO:
+      activity = Activity::HFP;
+      break;
+    case hal::SnoopLogger::PacketType::ISO:
+      activity = Activity::ISO;
+      break;
+    case hal::SnoopLogger::PacketType::CMD:
+    case hal::SnoopLogger::PacketType::EVT:
+      LOG_ERROR("Command and event packets need to be parsed");
+      break;
+  }
   hci::Address address_value;
-  device_parser_.match_handle_with_address(connection_handle_value, address_value);
-  btaa_hci_packets.push_back(BtaaHciPacket(Activity::HFP, address_value, byte_count));
-}
-
-void HciProcessor::process_iso(
-    std::vector<BtaaHciPacket>& btaa_hci_packets,
-    packet::PacketView<packet::kLittleEndian>& packet_view,
-    uint16_t byte_count) {
-  hci::IsoView iso = hci::IsoView::Create(packet_view);
-  auto connection_handle = iso.begin();
   // Connection handle is extracted from the 12 least significant bit.
-  uint16_t connection_handle_value = connection_handle.extract<uint16_t>() & 0xfff;
-  hci::Address address_value;
-  device_parser_.match_handle_with_address(connection_handle_value, address_value);
-  btaa_hci_packets.push_back(BtaaHciPacket(Activity::ISO, address_value, byte_count));
+  device_parser_.match_handle_with_address(connection_handle & 0xfff, address_value);
+  return BtaaHciPacket(activity, address_value, length);
 }
 
 std::vector<BtaaHciPacket> HciProcessor::OnHciPacket(
     hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length) {
   std::vector<BtaaHciPacket> btaa_hci_packets;
-  auto packet_view = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(packet));
   switch (type) {
-    case hal::SnoopLogger::PacketType::CMD:
+    case hal::SnoopLogger::PacketType::CMD: {
+      auto packet_view =
+          packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::move(packet)));
       process_command(btaa_hci_packets, packet_view, length);
-      break;
-    case hal::SnoopLogger::PacketType::EVT:
+    } break;
+    case hal::SnoopLogger::PacketType::EVT: {
+      auto packet_view =
+          packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::move(packet)));
       process_event(btaa_hci_packets, packet_view, length);
-      break;
+    } break;
     case hal::SnoopLogger::PacketType::ACL:
-      process_acl(btaa_hci_packets, packet_view, length);
-      break;
     case hal::SnoopLogger::PacketType::SCO:
-      process_sco(btaa_hci_packets, packet_view, length);
-      break;
     case hal::SnoopLogger::PacketType::ISO:
-      process_iso(btaa_hci_packets, packet_view, length);
+      if (packet.size() >= sizeof(uint16_t)) {
+        uint16_t connection_handle = packet[0] | (packet[1] << 8);
+        btaa_hci_packets.push_back(OnHciDataPacket(type, connection_handle, length));
+      }
       break;
   }
   return btaa_hci_packets;
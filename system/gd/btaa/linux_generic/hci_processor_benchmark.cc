@@ -0,0 +1,107 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "btaa/attribution_processor.h"
+#include "btaa/hci_processor.h"
+
+using ::benchmark::State;
+using bluetooth::hal::HciPacket;
+using bluetooth::hal::SnoopLogger;
+
+namespace bluetooth {
+namespace activity_attribution {
+
+// Replays a stream of ACL packets spread over a number of connections, as seen by
+// ActivityAttribution::Capture on the HCI path.
+class BM_HciAttribution : public ::benchmark::Fixture {
+ protected:
+  static constexpr size_t kNumPackets = 1000;
+  static constexpr size_t kAclPacketSize = 1021;
+
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    size_t num_connections = st.range(0);
+    for (size_t i = 0; i < num_connections; i++) {
+      uint16_t handle = 0x40 + i;
+      HciPacket event = {
+          0x03, 0x0b, 0x00, static_cast<uint8_t>(handle & 0xff), static_cast<uint8_t>(handle >> 8)};
+      for (size_t j = 0; j < hci::Address::kLength; j++) {
+        event.push_back(static_cast<uint8_t>(i + j));
+      }
+      event.push_back(0x01);
+      event.push_back(0x00);
+      hci_processor_.OnHciPacket(event, SnoopLogger::PacketType::EVT, event.size());
+    }
+    for (size_t i = 0; i < kNumPackets; i++) {
+      uint16_t handle = 0x40 + (i % num_connections);
+      HciPacket packet(kAclPacketSize, 0);
+      packet[0] = handle & 0xff;
+      packet[1] = handle >> 8;
+      packets_.push_back(std::move(packet));
+    }
+  }
+
+  void TearDown(State& st) override {
+    packets_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  HciProcessor hci_processor_;
+  AttributionProcessor attribution_processor_;
+  std::vector<HciPacket> packets_;
+};
+
+BENCHMARK_DEFINE_F(BM_HciAttribution, attribution_off)(State& state) {
+  for (auto _ : state) {
+    for (auto& packet : packets_) {
+      uint16_t length = packet.size();
+      ::benchmark::DoNotOptimize(length);
+    }
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * kNumPackets);
+}
+
+BENCHMARK_DEFINE_F(BM_HciAttribution, attribution_on_packet_copy)(State& state) {
+  for (auto _ : state) {
+    for (auto& packet : packets_) {
+      HciPacket header(packet.begin(), packet.begin() + 4);
+      attribution_processor_.OnBtaaPackets(
+          hci_processor_.OnHciPacket(std::move(header), SnoopLogger::PacketType::ACL, packet.size()));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * kNumPackets);
+}
+
+BENCHMARK_DEFINE_F(BM_HciAttribution, attribution_on_header)(State& state) {
+  for (auto _ : state) {
+    for (auto& packet : packets_) {
+      uint16_t connection_handle = packet[0] | (packet[1] << 8);
+      attribution_processor_.OnBtaaPacket(
+          hci_processor_.OnHciDataPacket(SnoopLogger::PacketType::ACL, connection_handle, packet.size()));
+    }
+  }
+  state.SetItemsProcessed(static_cast<int_fast64_t>(state.iterations()) * kNumPackets);
+}
+
+BENCHMARK_REGISTER_F(BM_HciAttribution, attribution_off)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_REGISTER_F(BM_HciAttribution, attribution_on_packet_copy)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK_REGISTER_F(BM_HciAttribution, attribution_on_header)->Arg(1)->Arg(8)->Arg(64);
+
+}  // namespace activity_attribution
+}  // namespace bluetooth
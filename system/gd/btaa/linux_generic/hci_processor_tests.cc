@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btaa/hci_processor.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using bluetooth::hci::Address;
+using bluetooth::hal::HciPacket;
+using bluetooth::hal::SnoopLogger;
+using namespace bluetooth::activity_attribution;
+
+namespace {
+
+const Address kAddress{0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+constexpr uint16_t kConnectionHandle = 0x0123;
+
+HciPacket ConnectionCompleteEvent(uint16_t handle, const Address& address) {
+  HciPacket packet = {
+      0x03,  // Connection Complete
+      0x0b,  // Parameter length
+      0x00,  // Status
+      static_cast<uint8_t>(handle & 0xff),
+      static_cast<uint8_t>(handle >> 8)};
+  packet.insert(packet.end(), address.data(), address.data() + Address::kLength);
+  packet.push_back(0x01);  // ACL link
+  packet.push_back(0x00);  // Encryption disabled
+  return packet;
+}
+
+HciPacket AclHeader(uint16_t handle, uint16_t length) {
+  // Packet boundary flags in the upper bits of the handle field must be ignored.
+  uint16_t handle_and_flags = handle | 0x2000;
+  return {
+      static_cast<uint8_t>(handle_and_flags & 0xff),
+      static_cast<uint8_t>(handle_and_flags >> 8),
+      static_cast<uint8_t>(length & 0xff),
+      static_cast<uint8_t>(length >> 8)};
+}
+
+}  // namespace
+
+class HciProcessorTest : public ::testing::Test {
+ protected:
+  HciProcessor hci_processor_;
+};
+
+TEST_F(HciProcessorTest, connection_complete_is_attributed_to_peer) {
+  HciPacket event = ConnectionCompleteEvent(kConnectionHandle, kAddress);
+  auto packets = hci_processor_.OnHciPacket(event, SnoopLogger::PacketType::EVT, event.size());
+  ASSERT_EQ(packets.size(), 1u);
+  ASSERT_EQ(packets[0].activity, Activity::CONNECT);
+  ASSERT_EQ(packets[0].address, kAddress);
+  ASSERT_EQ(packets[0].byte_count, event.size());
+}
+
+TEST_F(HciProcessorTest, acl_packet_uses_learned_handle) {
+  HciPacket event = ConnectionCompleteEvent(kConnectionHandle, kAddress);
+  hci_processor_.OnHciPacket(event, SnoopLogger::PacketType::EVT, event.size());
+
+  auto packets = hci_processor_.OnHciPacket(AclHeader(kConnectionHandle, 100), SnoopLogger::PacketType::ACL, 104);
+  ASSERT_EQ(packets.size(), 1u);
+  ASSERT_EQ(packets[0].activity, Activity::ACL);
+  ASSERT_EQ(packets[0].address, kAddress);
+  ASSERT_EQ(packets[0].byte_count, 104);
+}
+
+TEST_F(HciProcessorTest, data_packet_header_matches_full_packet) {
+  HciPacket event = ConnectionCompleteEvent(kConnectionHandle, kAddress);
+  hci_processor_.OnHciPacket(event, SnoopLogger::PacketType::EVT, event.size());
+
+  std::vector<SnoopLogger::PacketType> types = {
+      SnoopLogger::PacketType::ACL, SnoopLogger::PacketType::SCO, SnoopLogger::PacketType::ISO};
+  for (auto type : types) {
+    HciPacket header = AclHeader(kConnectionHandle, 60);
+    auto full = hci_processor_.OnHciPacket(header, type, 64);
+    auto compact = hci_processor_.OnHciDataPacket(type, header[0] | (header[1] << 8), 64);
+    ASSERT_EQ(full.size(), 1u);
+    ASSERT_EQ(full[0].activity, compact.activity);
+    ASSERT_EQ(full[0].address, compact.address);
+    ASSERT_EQ(full[0].byte_count, compact.byte_count);
+  }
+}
+
+TEST_F(HciProcessorTest, unknown_handle_has_empty_address) {
+  auto packet = hci_processor_.OnHciDataPacket(SnoopLogger::PacketType::ACL, 0x0042, 27);
+  ASSERT_EQ(packet.activity, Activity::ACL);
+  ASSERT_TRUE(packet.address.IsEmpty());
+}
+
+TEST_F(HciProcessorTest, truncated_data_packet_is_ignored) {
+  auto packets = hci_processor_.OnHciPacket({0x01}, SnoopLogger::PacketType::ACL, 1);
+  ASSERT_TRUE(packets.empty());
+}
@@ -48,6 +48,10 @@ class InitFlags final {
     return init_flags::device_iot_config_logging_is_enabled();
   }
 
+  inline static bool IsDeviceIotConfigCacheEnabled() {
+    return init_flags::device_iot_config_cache_is_enabled();
+  }
+
   inline static bool IsBtmDmFlushDiscoveryQueueOnSearchCancel() {
     return init_flags::btm_dm_flush_discovery_queue_on_search_cancel_is_enabled();
   }
@@ -17,191 +17,218 @@
 #include "dumpsys/filter.h"
 
 #include <memory>
+#include <vector>
 
-#include "common/init_flags.h"
 #include "dumpsys/internal/filter_internal.h"
 #include "os/log.h"
 
-using namespace bluetooth;
-using namespace dumpsys;
-
-class Filter {
- public:
-  Filter(const dumpsys::ReflectionSchema& reflection_schema) : reflection_schema_(reflection_schema) {}
-
-  virtual ~Filter() = default;
-
-  virtual void FilterInPlace(char* dumpsys_data) = 0;
-
-  static std::unique_ptr<Filter> Factory(
-      dumpsys::FilterType filter_type, const dumpsys::ReflectionSchema& reflection_schema);
-
- protected:
-  /**
-   * Given both reflection field data and the populated flatbuffer table data, if any,
-   * filter the contents of the field based upon the filtering privacy level.
-   *
-   * Primitives and composite strings may be successfully processed at this point.
-   * Other composite types (e.g. structs or tables) must be expanded into the
-   * respective grouping of subfields.
-   *
-   * @param field The reflection field information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   * @return true if field was filtered successfully, false otherwise.
-   */
-  virtual bool FilterField(const reflection::Field* field, flatbuffers::Table* table) {
-    return false;
-  }
+namespace bluetooth {
+namespace dumpsys {
 
-  /**
-   * Given both reflection object data and the populated flatbuffer table data, if any,
-   * filter the object fields based upon the filtering privacy level.
-   *
-   * @param object The reflection object information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   */
-  virtual void FilterObject(const reflection::Object* object, flatbuffers::Table* table){};
-
-  /**
-   * Given both reflection field data and the populated table data, if any,
-   * filter the contents of the table based upon the filtering privacy level.
-   *
-   * @param schema The reflection schema information from the bundled schema
-   * @param table The populated field data, if any
-   *
-   */
-  virtual void FilterTable(const reflection::Schema* schema, flatbuffers::Table* table){};
-
-  const dumpsys::ReflectionSchema& reflection_schema_;
-};
+namespace {
 
-class DeveloperPrivacyFilter : public Filter {
- public:
-  DeveloperPrivacyFilter(const dumpsys::ReflectionSchema& reflection_schema) : Filter(reflection_schema) {}
-  void FilterInPlace(char* dumpsys_data) override { /* Nothing to do in this mode */
-  }
-};
-
-class UserPrivacyFilter : public Filter {
- public:
-  UserPrivacyFilter(const dumpsys::ReflectionSchema& reflection_schema) : Filter(reflection_schema) {}
-  void FilterInPlace(char* dumpsys_data) override;
-
- protected:
-  bool FilterField(const reflection::Field* field, flatbuffers::Table* table) override;
-  void FilterObject(const reflection::Object* object, flatbuffers::Table* table) override;
-  void FilterTable(const reflection::Schema* schema, flatbuffers::Table* table) override;
-};
+using FieldFilter =
+    bool (*)(const reflection::Field& field, flatbuffers::Table* table, internal::PrivacyLevel privacy_level);
 
-bool UserPrivacyFilter::FilterField(const reflection::Field* field, flatbuffers::Table* table) {
-  ASSERT(field != nullptr);
-  ASSERT(table != nullptr);
-  internal::PrivacyLevel privacy_level = internal::FindFieldPrivacyLevel(*field);
-
-  const auto type = static_cast<flatbuffers::BaseType>(field->type()->base_type());
+/**
+ * Returns the filter of the primitives, strings and structs of the given type,
+ * nullptr for the other types.
+ */
+FieldFilter FindFieldFilter(flatbuffers::BaseType type) {
   switch (type) {
     case flatbuffers::BASE_TYPE_INT:
-      return internal::FilterTypeInteger(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeInteger;
     case flatbuffers::BASE_TYPE_FLOAT:
-      return internal::FilterTypeFloat(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeFloat;
     case flatbuffers::BASE_TYPE_STRING:
-      return internal::FilterTypeString(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeString;
     case flatbuffers::BASE_TYPE_STRUCT:
-      return internal::FilterTypeStruct(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeStruct;
     case flatbuffers::BASE_TYPE_BOOL:
-      return internal::FilterTypeBool(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeBool;
     case flatbuffers::BASE_TYPE_LONG:
-      return internal::FilterTypeLong(*field, table, privacy_level);
-      break;
+      return internal::FilterTypeLong;
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * Removes a field that cannot be filtered and is not public, as if it were
+ * private.
+ */
+bool RemoveField(const reflection::Field& field, flatbuffers::Table* table, internal::PrivacyLevel privacy_level) {
+  if (table->CheckField(field.offset())) {
+    internal::ScrubFromTable(table, field.offset());
+  }
+  return true;
+}
+
+}  // namespace
+
+struct PrivacyFilter::Table {
+  struct Field {
+    const reflection::Field* field;
+    internal::PrivacyLevel privacy_level;
+    // Filters the field itself, if set.
+    FieldFilter filter;
+    // Filters the table the field points to, or each table of the vector
+    // the field points to, if set.
+    const Table* sub_table;
+    bool is_vector;
+  };
+  std::vector<Field> fields;
+
+  void FilterInPlace(flatbuffers::Table* table) const {
+    if (table == nullptr) {
+      return;  // table not populated
+    }
+    for (const Field& field : fields) {
+      if (field.filter != nullptr) {
+        field.filter(*field.field, table, field.privacy_level);
+      }
+      if (field.sub_table == nullptr) {
+        continue;
+      }
+      if (!field.is_vector) {
+        field.sub_table->FilterInPlace(table->GetPointer<flatbuffers::Table*>(field.field->offset()));
+        continue;
+      }
+      auto* vector = table->GetPointer<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::Table>>*>(
+          field.field->offset());
+      if (vector == nullptr) {
+        continue;  // vector not populated
+      }
+      for (flatbuffers::uoffset_t i = 0; i < vector->size(); i++) {
+        field.sub_table->FilterInPlace(const_cast<flatbuffers::Table*>(vector->Get(i)));
+      }
+    }
+  }
+};
+
+PrivacyFilter::PrivacyFilter(FilterType filter_type, const ReflectionSchema& reflection_schema)
+    : reflection_schema_(reflection_schema) {
+  switch (filter_type) {
+    case FilterType::AS_DEVELOPER:
+      break;  // Nothing to do in this mode
     default:
-      LOG_WARN("Unsupported base type:%s", internal::FlatbufferTypeText(type).c_str());
+      root_table_ = CompileTable(reflection_schema_.FindInReflectionSchema(reflection_schema_.GetRootName()));
       break;
   }
-  return false;
 }
 
-void UserPrivacyFilter::FilterObject(const reflection::Object* object, flatbuffers::Table* table) {
-  ASSERT(object != nullptr);
-  if (table == nullptr) {
-    return;  // table data is not populated
+PrivacyFilter::~PrivacyFilter() = default;
+
+const PrivacyFilter::Table* PrivacyFilter::CompileSubTable(const reflection::Schema* schema, int32_t index) {
+  const flatbuffers::String* name = schema->objects()->Get(index)->name();
+  const reflection::Schema* sub_schema = reflection_schema_.FindInReflectionSchema(name->str());
+  if (sub_schema != nullptr) {
+    return CompileTable(sub_schema);  // Top level schema
   }
-  for (auto it = object->fields()->cbegin(); it != object->fields()->cend(); ++it) {
-    if (!FilterField(*it, table)) {
-      LOG_ERROR("%s Unable to filter field from an object when it's expected it will work", __func__);
-    };
+  // Leaf node schema
+  const reflection::Object* sub_object = internal::FindReflectionObject(schema->objects(), name);
+  if (sub_object == nullptr) {
+    LOG_ERROR("Unable to find reflection sub object:%s\n", name->c_str());
+    return nullptr;
   }
+  return CompileObject(sub_object);
 }
 
-void UserPrivacyFilter::FilterTable(const reflection::Schema* schema, flatbuffers::Table* table) {
+const PrivacyFilter::Table* PrivacyFilter::CompileTable(const reflection::Schema* schema) {
+  auto [entry, inserted] = tables_.try_emplace(schema);
+  if (!inserted) {
+    return entry->second.get();
+  }
+  entry->second = std::make_unique<Table>();
+  Table* table = entry->second.get();
+
   if (schema == nullptr) {
     LOG_WARN("%s schema is nullptr...probably ok", __func__);
-    return;
+    return table;
   }
 
   const reflection::Object* object = schema->root_table();
   if (object == nullptr) {
     LOG_WARN("%s reflection object is nullptr...is ok ?", __func__);
-    return;
+    return table;
   }
 
-  if (table == nullptr) {
-    return;  // table not populated
+  for (auto it = object->fields()->cbegin(); it != object->fields()->cend(); ++it) {
+    const reflection::Type* type = it->type();
+    const auto base_type = static_cast<flatbuffers::BaseType>(type->base_type());
+    Table::Field field{*it, internal::FindFieldPrivacyLevel(**it), FindFieldFilter(base_type), nullptr, false};
+
+    switch (base_type) {
+      case flatbuffers::BASE_TYPE_STRUCT:
+        // Removed unless public, then filtered field by field.
+        field.sub_table = CompileSubTable(schema, type->index());
+        break;
+      case flatbuffers::BASE_TYPE_VECTOR:
+        // Removed unless public, then each table is filtered field by field.
+        if (field.privacy_level != internal::kAny) {
+          field.filter = RemoveField;
+        } else if (
+            type->element() == reflection::BaseType::Obj &&
+            !schema->objects()->Get(type->index())->is_struct()) {
+          field.sub_table = CompileSubTable(schema, type->index());
+          field.is_vector = true;
+        }
+        break;
+      default:
+        if (field.filter == nullptr && field.privacy_level != internal::kAny) {
+          LOG_WARN(
+              "Removing field:%s of unsupported type:%s",
+              it->name()->c_str(),
+              internal::FlatbufferTypeText(base_type).c_str());
+          field.filter = RemoveField;
+        }
+        break;
+    }
+    table->fields.push_back(field);
   }
+  return table;
+}
+
+const PrivacyFilter::Table* PrivacyFilter::CompileObject(const reflection::Object* object) {
+  auto [entry, inserted] = tables_.try_emplace(object);
+  if (!inserted) {
+    return entry->second.get();
+  }
+  entry->second = std::make_unique<Table>();
+  Table* table = entry->second.get();
 
   for (auto it = object->fields()->cbegin(); it != object->fields()->cend(); ++it) {
-    if (FilterField(*it, table)) {
-      continue;  // Field successfully filtered
-    }
-    // Get the index of this complex non-string object from the schema which is
-    // also the same index into the data table.
-    int32_t index = it->type()->index();
-    ASSERT(index != -1);
-
-    flatbuffers::Table* sub_table = table->GetPointer<flatbuffers::Table*>(it->offset());
-    const reflection::Schema* sub_schema =
-        reflection_schema_.FindInReflectionSchema(schema->objects()->Get(index)->name()->str());
-
-    if (sub_schema != nullptr) {
-      FilterTable(sub_schema, sub_table);  // Top level schema
-    } else {
-      // Leaf node schema
-      const flatbuffers::String* name = schema->objects()->Get(index)->name();
-      const reflection::Object* sub_object = internal::FindReflectionObject(schema->objects(), name);
-      if (sub_object != nullptr) {
-        FilterObject(sub_object, sub_table);
-      } else {
-        LOG_ERROR("Unable to find reflection sub object:%s\n", name->c_str());
+    const auto type = static_cast<flatbuffers::BaseType>(it->type()->base_type());
+    internal::PrivacyLevel privacy_level = internal::FindFieldPrivacyLevel(**it);
+    FieldFilter filter = FindFieldFilter(type);
+    if (filter == nullptr) {
+      if (privacy_level == internal::kAny) {
+        continue;  // Public, nothing to filter
       }
+      LOG_WARN(
+          "Removing field:%s of unsupported type:%s",
+          it->name()->c_str(),
+          internal::FlatbufferTypeText(type).c_str());
+      filter = RemoveField;
     }
+    table->fields.push_back(Table::Field{*it, privacy_level, filter, nullptr, false});
   }
+  return table;
 }
 
-void UserPrivacyFilter::FilterInPlace(char* dumpsys_data) {
+void PrivacyFilter::FilterInPlace(std::string* dumpsys_data) const {
   ASSERT(dumpsys_data != nullptr);
-  const reflection::Schema* root_schema = reflection_schema_.FindInReflectionSchema(reflection_schema_.GetRootName());
-  flatbuffers::Table* table = const_cast<flatbuffers::Table*>(flatbuffers::GetRoot<flatbuffers::Table>(dumpsys_data));
-  FilterTable(root_schema, table);
-}
-
-std::unique_ptr<Filter> Filter::Factory(
-    dumpsys::FilterType filter_type, const dumpsys::ReflectionSchema& reflection_schema) {
-  switch (filter_type) {
-    case dumpsys::FilterType::AS_DEVELOPER:
-      return std::make_unique<DeveloperPrivacyFilter>(reflection_schema);
-    default:
-      return std::make_unique<UserPrivacyFilter>(reflection_schema);
+  if (root_table_ == nullptr) {
+    return;
   }
+  flatbuffers::Table* table =
+      const_cast<flatbuffers::Table*>(flatbuffers::GetRoot<flatbuffers::Table>(dumpsys_data->data()));
+  root_table_->FilterInPlace(table);
 }
 
-void bluetooth::dumpsys::FilterInPlace(
-    FilterType filter_type, const ReflectionSchema& reflection_schema, std::string* dumpsys_data) {
-  auto filter = Filter::Factory(filter_type, reflection_schema);
-  filter->FilterInPlace(dumpsys_data->data());
+void FilterInPlace(FilterType filter_type, const ReflectionSchema& reflection_schema, std::string* dumpsys_data) {
+  PrivacyFilter(filter_type, reflection_schema).FilterInPlace(dumpsys_data);
 }
+
+}  // namespace dumpsys
+}  // namespace bluetooth
@@ -14,7 +14,12 @@
  * limitations under the License.
  */
 
+#pragma once
+
+#include <memory>
 #include <string>
+#include <unordered_map>
+
 #include "dumpsys/reflection_schema.h"
 
 namespace bluetooth {
@@ -22,6 +27,36 @@ namespace dumpsys {
 
 enum FilterType { AS_USER = 0, AS_DEVELOPER };
 
+/**
+ * Privacy filter for the dumpsys data of one reflection schema.
+ *
+ * The schema lookups (sub-schemas by name, field types and privacy levels)
+ * are all done when the filter is built, so that filtering a dump only walks
+ * the populated tables.
+ */
+class PrivacyFilter {
+ public:
+  PrivacyFilter(FilterType filter_type, const ReflectionSchema& reflection_schema);
+  ~PrivacyFilter();
+
+  PrivacyFilter(const PrivacyFilter&) = delete;
+  PrivacyFilter& operator=(const PrivacyFilter&) = delete;
+
+  void FilterInPlace(std::string* dumpsys_data) const;
+
+ private:
+  struct Table;
+
+  const Table* CompileTable(const reflection::Schema* schema);
+  const Table* CompileSubTable(const reflection::Schema* schema, int32_t index);
+  const Table* CompileObject(const reflection::Object* object);
+
+  const ReflectionSchema& reflection_schema_;
+  // Compiled tables by schema or object, nullptr to filter nothing.
+  std::unordered_map<const void*, std::unique_ptr<Table>> tables_;
+  const Table* root_table_{nullptr};
+};
+
 void FilterInPlace(FilterType filter_type, const ReflectionSchema& reflection_schema, std::string* dumpsys_data);
 
 }  // namespace dumpsys
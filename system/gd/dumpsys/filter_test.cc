@@ -26,6 +26,7 @@
 #include "test_data/bar.h"
 #include "test_data/baz.h"
 #include "test_data/foo.h"
+#include "test_data/quux.h"
 #include "test_data/qux.h"
 #include "test_data/root.h"
 
@@ -40,6 +41,7 @@ class DumpsysFilterTest : public Test {
     test_data_classes_.push_back(std::make_unique<BazTestDataClass>());
     test_data_classes_.push_back(std::make_unique<FooTestDataClass>());
     test_data_classes_.push_back(std::make_unique<QuxTestDataClass>());
+    test_data_classes_.push_back(std::make_unique<QuuxTestDataClass>());
   }
 
   void TearDown() override {}
@@ -47,6 +49,7 @@ class DumpsysFilterTest : public Test {
   std::list<std::unique_ptr<DumpsysTestDataClass>> test_data_classes_;
 
   std::string PopulateTestSchema();
+  void CheckFilteredAsUser(const std::string& dumpsys_data);
 };
 
 std::string DumpsysFilterTest::PopulateTestSchema() {
@@ -116,15 +119,19 @@ TEST_F(DumpsysFilterTest, filter_as_developer) {
   ASSERT_FLOAT_EQ(123.456, foo->foo_float_anonymized());
   ASSERT_FLOAT_EQ(123.456, foo->foo_float_any());
   ASSERT_STREQ("123.456", foo->foo_float_string()->c_str());
-}
-
-TEST_F(DumpsysFilterTest, filter_as_user) {
-  std::string dumpsys_data = PopulateTestSchema();
-  dumpsys::ReflectionSchema reflection_schema(testing::GetBundledSchemaData());
 
-  dumpsys::FilterInPlace(dumpsys::FilterType::AS_USER, reflection_schema, &dumpsys_data);
+  const testing::QuuxTestSchema* quux = data_root->quux_module_data();
+  ASSERT_EQ(2U, quux->quux_entries_any()->size());
+  ASSERT_EQ(1, quux->quux_entries_any()->Get(0)->quux_entry_int_private());
+  ASSERT_EQ(1U, quux->quux_entries_private()->size());
+  ASSERT_EQ(3U, quux->quux_ints_opaque()->size());
+  ASSERT_EQ(9, quux->quux_short_private());
+  ASSERT_EQ(11, quux->quux_nested_any()->quux_short_private());
+  ASSERT_NE(nullptr, quux->quux_nested_private());
+}
 
-  [[maybe_unused]] const testing::DumpsysTestDataRoot* data_root = GetDumpsysTestDataRoot(dumpsys_data.data());
+void DumpsysFilterTest::CheckFilteredAsUser(const std::string& dumpsys_data) {
+  const testing::DumpsysTestDataRoot* data_root = GetDumpsysTestDataRoot(dumpsys_data.data());
 
   ASSERT_TRUE(data_root->string_private() == nullptr);
   ASSERT_TRUE(data_root->string_opaque()->str() == "*************");
@@ -175,6 +182,59 @@ TEST_F(DumpsysFilterTest, filter_as_user) {
   ASSERT_NE(789, qux->qux_int_anonymized());
   ASSERT_EQ(0xabc, qux->qux_int_any());
   ASSERT_STREQ("Qux Module String", qux->qux_string_name()->c_str());
+
+  // quux
+  const testing::QuuxTestSchema* quux = data_root->quux_module_data();
+  ASSERT_NE(nullptr, quux);
+
+  // Public vectors of tables are filtered table by table
+  const auto* entries = quux->quux_entries_any();
+  ASSERT_NE(nullptr, entries);
+  ASSERT_EQ(2U, entries->size());
+  ASSERT_EQ(0, entries->Get(0)->quux_entry_int_private());  // 1
+  ASSERT_EQ(2, entries->Get(0)->quux_entry_int_any());
+  ASSERT_STREQ("Quux Entry Any", entries->Get(0)->quux_entry_string_any()->c_str());
+  ASSERT_EQ(0, entries->Get(1)->quux_entry_int_private());  // 3
+  ASSERT_EQ(4, entries->Get(1)->quux_entry_int_any());
+
+  // Public vectors of scalars are kept, other vectors are removed
+  ASSERT_EQ(nullptr, quux->quux_entries_private());
+  ASSERT_EQ(nullptr, quux->quux_ints_opaque());
+  ASSERT_NE(nullptr, quux->quux_ints_any());
+  ASSERT_EQ(3U, quux->quux_ints_any()->size());
+  ASSERT_EQ(3, quux->quux_ints_any()->Get(2));
+
+  // Fields without a filter are removed unless public
+  ASSERT_EQ(0, quux->quux_short_private());  // 9
+  ASSERT_EQ(10, quux->quux_short_any());
+
+  // Nested tables of the same schema are filtered with the same compiled table
+  ASSERT_EQ(nullptr, quux->quux_nested_private());
+  const testing::QuuxTestSchema* nested = quux->quux_nested_any();
+  ASSERT_NE(nullptr, nested);
+  ASSERT_EQ(nullptr, nested->quux_ints_opaque());
+  ASSERT_EQ(0, nested->quux_short_private());  // 11
+  ASSERT_EQ(12, nested->quux_short_any());
+}
+
+TEST_F(DumpsysFilterTest, filter_as_user) {
+  std::string dumpsys_data = PopulateTestSchema();
+  dumpsys::ReflectionSchema reflection_schema(testing::GetBundledSchemaData());
+
+  dumpsys::FilterInPlace(dumpsys::FilterType::AS_USER, reflection_schema, &dumpsys_data);
+
+  CheckFilteredAsUser(dumpsys_data);
+}
+
+TEST_F(DumpsysFilterTest, filter_as_user_many_times) {
+  dumpsys::ReflectionSchema reflection_schema(testing::GetBundledSchemaData());
+  dumpsys::PrivacyFilter filter(dumpsys::FilterType::AS_USER, reflection_schema);
+
+  for (int i = 0; i < 3; i++) {
+    std::string dumpsys_data = PopulateTestSchema();
+    filter.FilterInPlace(&dumpsys_data);
+    CheckFilteredAsUser(dumpsys_data);
+  }
 }
 
 }  // namespace testing
@@ -0,0 +1,51 @@
+#include "quux_generated.h"
+#include "root.h"
+#include "root_generated.h"
+
+namespace testing {
+
+class QuuxTestDataClass : public DumpsysTestDataClass {
+ public:
+  TableAddFunction GetTable(flatbuffers::FlatBufferBuilder& fb_builder) override {
+    // The entries have different fields populated so that they do not share a vtable, and each has to be filtered.
+    auto entry_name = fb_builder.CreateString("Quux Entry Any");
+    std::vector<flatbuffers::Offset<QuuxEntry>> entries_any{
+        CreateQuuxEntry(fb_builder, 1, 2, entry_name),
+        CreateQuuxEntry(fb_builder, 3, 4),
+    };
+    std::vector<flatbuffers::Offset<QuuxEntry>> entries_private{
+        CreateQuuxEntry(fb_builder, 5, 6),
+    };
+    auto entries_any_vector = fb_builder.CreateVector(entries_any);
+    auto entries_private_vector = fb_builder.CreateVector(entries_private);
+    auto ints_any_vector = fb_builder.CreateVector(std::vector<int32_t>{1, 2, 3});
+    auto ints_opaque_vector = fb_builder.CreateVector(std::vector<int32_t>{4, 5, 6});
+
+    // The nested tables have other fields populated than their parent, for the same reason.
+    auto nested_ints_opaque_vector = fb_builder.CreateVector(std::vector<int32_t>{7, 8});
+    QuuxTestSchemaBuilder nested_any_builder(fb_builder);
+    nested_any_builder.add_quux_ints_opaque(nested_ints_opaque_vector);
+    nested_any_builder.add_quux_short_private(11);
+    nested_any_builder.add_quux_short_any(12);
+    auto nested_any = nested_any_builder.Finish();
+
+    QuuxTestSchemaBuilder nested_private_builder(fb_builder);
+    nested_private_builder.add_quux_short_any(13);
+    auto nested_private = nested_private_builder.Finish();
+
+    QuuxTestSchemaBuilder builder(fb_builder);
+    builder.add_quux_entries_any(entries_any_vector);
+    builder.add_quux_entries_private(entries_private_vector);
+    builder.add_quux_ints_any(ints_any_vector);
+    builder.add_quux_ints_opaque(ints_opaque_vector);
+    builder.add_quux_short_private(9);
+    builder.add_quux_short_any(10);
+    builder.add_quux_nested_any(nested_any);
+    builder.add_quux_nested_private(nested_private);
+    auto quux_table = builder.Finish();
+
+    return [quux_table](DumpsysTestDataRootBuilder* builder) { builder->add_quux_module_data(quux_table); };
+  }
+};
+
+}  // namespace testing
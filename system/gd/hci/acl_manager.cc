@@ -65,7 +65,8 @@ struct AclManager::impl {
     hci_layer_ = acl_manager_.GetDependency<HciLayer>();
     handler_ = acl_manager_.GetHandler();
     controller_ = acl_manager_.GetDependency<Controller>();
-    round_robin_scheduler_ = new RoundRobinScheduler(handler_, controller_, hci_layer_->GetAclQueueEnd());
+    round_robin_scheduler_ =
+        new RoundRobinScheduler(handler_, controller_, hci_layer_->GetAclQueueEnd(), &latency_tracker_);
     acl_scheduler_ = acl_manager_.GetDependency<AclScheduler>();
 
     if (bluetooth::common::init_flags::gd_remote_name_request_is_enabled()) {
@@ -161,6 +162,7 @@ struct AclManager::impl {
     }
     uint16_t handle = packet->GetHandle();
     if (handle == kQualcommDebugHandle) return;
+    latency_tracker_.OnPacketReceived(handle, packet->size());
     if (classic_impl_->send_packet_upward(
             handle, [&packet](struct acl_manager::assembler* assembler) { assembler->on_incoming_packet(*packet); }))
       return;
@@ -179,6 +181,11 @@ struct AclManager::impl {
         BindOnce(&on_unknown_acl_timer, common::Unretained(this)), kWaitBeforeDroppingUnknownAcl);
   }
 
+  void get_acl_latency_stats(
+      uint16_t handle, std::promise<std::optional<acl_manager::AclLatencyTracker::Stats>> promise) const {
+    promise.set_value(latency_tracker_.GetStats(handle));
+  }
+
   void Dump(
       std::promise<flatbuffers::Offset<AclManagerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const;
 
@@ -192,6 +199,7 @@ struct AclManager::impl {
   Controller* controller_ = nullptr;
   HciLayer* hci_layer_ = nullptr;
   RoundRobinScheduler* round_robin_scheduler_ = nullptr;
+  acl_manager::AclLatencyTracker latency_tracker_;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
   std::atomic_bool enqueue_registered_ = false;
   uint16_t default_link_policy_settings_ = 0xffff;
@@ -268,6 +276,11 @@ void AclManager::IsOnBackgroundList(AddressWithType address_with_type, std::prom
   CallOn(pimpl_->le_impl_, &le_impl::is_on_background_connection_list, address_with_type, std::move(promise));
 }
 
+void AclManager::GetAclLatencyStats(
+    uint16_t handle, std::promise<std::optional<acl_manager::AclLatencyTracker::Stats>> promise) {
+  CallOn(pimpl_.get(), &impl::get_acl_latency_stats, handle, std::move(promise));
+}
+
 void AclManager::SetLeSuggestedDefaultDataParameters(uint16_t octets, uint16_t time) {
   CallOn(pimpl_->le_impl_, &le_impl::set_le_suggested_default_data_parameters, octets, time);
 }
@@ -447,6 +460,19 @@ const ModuleFactory AclManager::Factory = ModuleFactory([]() { return new AclMan
 
 AclManager::~AclManager() = default;
 
+static flatbuffers::Offset<AclLatencyHistogramData> CreateAclLatencyHistogram(
+    flatbuffers::FlatBufferBuilder* fb_builder, const acl_manager::AclLatencyTracker::Histogram& histogram) {
+  auto buckets = fb_builder->CreateVector(histogram.buckets.data(), histogram.buckets.size());
+  AclLatencyHistogramDataBuilder builder(*fb_builder);
+  builder.add_count(histogram.count);
+  builder.add_mean_us(histogram.MeanUs());
+  builder.add_p50_us(histogram.PercentileUs(50));
+  builder.add_p99_us(histogram.PercentileUs(99));
+  builder.add_max_us(histogram.max_us);
+  builder.add_buckets(buckets);
+  return builder.Finish();
+}
+
 void AclManager::impl::Dump(
     std::promise<flatbuffers::Offset<AclManagerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const {
   const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
@@ -467,12 +493,34 @@ void AclManager::impl::Dump(
   }
   auto vecofstrings = fb_builder->CreateVector(strings, connect_list.size());
 
+  const auto now = latency_tracker_.Now();
+  std::vector<flatbuffers::Offset<AclConnectionLatencyData>> connection_latencies;
+  latency_tracker_.ForEachConnection([&](uint16_t handle, const acl_manager::AclLatencyTracker::Stats& stats) {
+    auto queue_latency = CreateAclLatencyHistogram(fb_builder, stats.queue_latency);
+    auto scheduler_latency = CreateAclLatencyHistogram(fb_builder, stats.scheduler_latency);
+    auto controller_latency = CreateAclLatencyHistogram(fb_builder, stats.controller_latency);
+    AclConnectionLatencyDataBuilder latency_builder(*fb_builder);
+    latency_builder.add_handle(handle);
+    latency_builder.add_tx_packets(stats.tx_packets);
+    latency_builder.add_tx_bytes(stats.tx_bytes);
+    latency_builder.add_tx_bytes_per_second(stats.TxBytesPerSecond(now));
+    latency_builder.add_rx_packets(stats.rx_packets);
+    latency_builder.add_rx_bytes(stats.rx_bytes);
+    latency_builder.add_rx_bytes_per_second(stats.RxBytesPerSecond(now));
+    latency_builder.add_scheduler_latency(scheduler_latency);
+    latency_builder.add_controller_latency(controller_latency);
+    latency_builder.add_queue_latency(queue_latency);
+    connection_latencies.push_back(latency_builder.Finish());
+  });
+  auto connection_latency = fb_builder->CreateVector(connection_latencies);
+
   AclManagerDataBuilder builder(*fb_builder);
   builder.add_title(title);
   builder.add_le_filter_accept_list_count(connect_list.size());
   builder.add_le_filter_accept_list(vecofstrings);
   builder.add_le_connectability_state(le_connectability_state);
   builder.add_le_create_connection_timeout_alarms_count(le_create_connection_timeout_alarms_count);
+  builder.add_connection_latency(connection_latency);
 
   flatbuffers::Offset<AclManagerData> dumpsys_data = builder.Finish();
   promise.set_value(dumpsys_data);
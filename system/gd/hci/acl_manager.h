@@ -19,9 +19,11 @@
 #include <functional>
 #include <future>
 #include <memory>
+#include <optional>
 
 #include "common/bidi_queue.h"
 #include "common/callback.h"
+#include "hci/acl_manager/acl_latency_tracker.h"
 #include "hci/acl_manager/connection_callbacks.h"
 #include "hci/acl_manager/le_acceptlist_callbacks.h"
 #include "hci/acl_manager/le_connection_callbacks.h"
@@ -115,6 +117,10 @@ public:
  virtual void RemoveFromBackgroundList(AddressWithType address_with_type);
  virtual void IsOnBackgroundList(AddressWithType address_with_type, std::promise<bool> promise);
 
+ // Latency and throughput of the ACL data of a connection, empty if the handle is not connected
+ virtual void GetAclLatencyStats(
+     uint16_t handle, std::promise<std::optional<acl_manager::AclLatencyTracker::Stats>> promise);
+
  virtual void CancelLeConnect(AddressWithType address_with_type);
 
  virtual void ClearFilterAcceptList();
@@ -24,6 +24,48 @@ AclConnection::QueueUpEnd* AclConnection::GetAclQueueEnd() const {
   return queue_up_end_;
 }
 
+AclConnection::Queue::Queue(size_t capacity) : up_queue_(capacity), down_queue_(capacity) {}
+
+void AclConnection::Queue::TimedEnqueue::RegisterEnqueue(os::Handler* handler, EnqueueCallback callback) {
+  queue_->down_queue_.RegisterEnqueue(
+      handler, common::Bind(&Queue::enqueue_timed, common::Unretained(queue_), std::move(callback)));
+}
+
+void AclConnection::Queue::TimedEnqueue::UnregisterEnqueue() {
+  queue_->down_queue_.UnregisterEnqueue();
+}
+
+void AclConnection::Queue::TimedDequeue::RegisterDequeue(os::Handler* handler, DequeueCallback callback) {
+  queue_->down_queue_.RegisterDequeue(handler, std::move(callback));
+}
+
+void AclConnection::Queue::TimedDequeue::UnregisterDequeue() {
+  queue_->down_queue_.UnregisterDequeue();
+}
+
+std::unique_ptr<BasePacketBuilder> AclConnection::Queue::TimedDequeue::TryDequeue() {
+  auto packet = queue_->down_queue_.TryDequeue();
+  if (packet != nullptr) {
+    std::lock_guard<std::mutex> lock(queue_->enqueue_times_mutex_);
+    if (!queue_->enqueue_times_.empty()) {
+      queue_->last_dequeued_enqueue_time_ = queue_->enqueue_times_.front();
+      queue_->enqueue_times_.pop_front();
+    }
+  }
+  return packet;
+}
+
+// The time is recorded before os::Queue pushes the packet, so a packet is never dequeued before its time
+std::unique_ptr<BasePacketBuilder> AclConnection::Queue::enqueue_timed(
+    os::IQueueEnqueue<BasePacketBuilder>::EnqueueCallback callback) {
+  auto packet = callback.Run();
+  if (packet != nullptr) {
+    std::lock_guard<std::mutex> lock(enqueue_times_mutex_);
+    enqueue_times_.push_back(Clock::now());
+  }
+  return packet;
+}
+
 }  // namespace acl_manager
 }  // namespace hci
 }  // namespace bluetooth
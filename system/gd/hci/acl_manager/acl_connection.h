@@ -16,10 +16,14 @@
 
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
 
 #include "common/bidi_queue.h"
 #include "hci/hci_packets.h"
+#include "os/queue.h"
 
 namespace bluetooth {
 namespace hci {
@@ -39,7 +43,7 @@ class AclConnection {
 
   virtual bool ReadRemoteVersionInformation() = 0;
 
-  using Queue = common::BidiQueue<PacketView<kLittleEndian>, BasePacketBuilder>;
+  class Queue;
   using QueueUpEnd = common::BidiQueueEnd<BasePacketBuilder, PacketView<kLittleEndian>>;
   using QueueDownEnd = common::BidiQueueEnd<PacketView<kLittleEndian>, BasePacketBuilder>;
   virtual QueueUpEnd* GetAclQueueEnd() const;
@@ -52,6 +56,65 @@ class AclConnection {
   uint16_t handle_;
 };
 
+// The queues between a connection and the round robin scheduler. Besides passing the packets, it records when the
+// connection enqueued each outgoing packet, so that the scheduler can tell how long the packet waited for it.
+class AclConnection::Queue {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Queue(size_t capacity);
+  Queue(const Queue&) = delete;
+  Queue& operator=(const Queue&) = delete;
+
+  QueueUpEnd* GetUpEnd() {
+    return &up_end_;
+  }
+
+  QueueDownEnd* GetDownEnd() {
+    return &down_end_;
+  }
+
+  // When the packet last taken off the down end was enqueued. Only meaningful on the handler dequeuing.
+  Clock::time_point GetLastDequeuedEnqueueTime() const {
+    return last_dequeued_enqueue_time_;
+  }
+
+ private:
+  class TimedEnqueue : public os::IQueueEnqueue<BasePacketBuilder> {
+   public:
+    explicit TimedEnqueue(Queue* queue) : queue_(queue) {}
+    void RegisterEnqueue(os::Handler* handler, EnqueueCallback callback) override;
+    void UnregisterEnqueue() override;
+
+   private:
+    Queue* queue_;
+  };
+
+  class TimedDequeue : public os::IQueueDequeue<BasePacketBuilder> {
+   public:
+    explicit TimedDequeue(Queue* queue) : queue_(queue) {}
+    void RegisterDequeue(os::Handler* handler, DequeueCallback callback) override;
+    void UnregisterDequeue() override;
+    std::unique_ptr<BasePacketBuilder> TryDequeue() override;
+
+   private:
+    Queue* queue_;
+  };
+
+  std::unique_ptr<BasePacketBuilder> enqueue_timed(os::IQueueEnqueue<BasePacketBuilder>::EnqueueCallback callback);
+
+  os::Queue<PacketView<kLittleEndian>> up_queue_;
+  os::Queue<BasePacketBuilder> down_queue_;
+  // The packets are enqueued on the connection handler and dequeued on the scheduler handler
+  std::mutex enqueue_times_mutex_;
+  std::deque<Clock::time_point> enqueue_times_;
+  Clock::time_point last_dequeued_enqueue_time_;
+  TimedEnqueue timed_enqueue_{this};
+  TimedDequeue timed_dequeue_{this};
+  QueueUpEnd up_end_{&timed_enqueue_, &up_queue_};
+  QueueDownEnd down_end_{&up_queue_, &timed_dequeue_};
+};
+
 }  // namespace acl_manager
 }  // namespace hci
 }  // namespace bluetooth
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/acl_manager/acl_latency_tracker.h"
+
+#include <algorithm>
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+namespace {
+
+uint64_t ElapsedUs(AclLatencyTracker::Clock::time_point from, AclLatencyTracker::Clock::time_point to) {
+  if (to <= from) {
+    return 0;
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+uint64_t BytesPerSecond(
+    uint64_t bytes, AclLatencyTracker::Clock::time_point from, AclLatencyTracker::Clock::time_point to) {
+  uint64_t elapsed_us = ElapsedUs(from, to);
+  if (elapsed_us == 0) {
+    return 0;
+  }
+  return bytes * 1000000 / elapsed_us;
+}
+
+}  // namespace
+
+void AclLatencyTracker::Histogram::Add(uint64_t latency_us) {
+  size_t bucket = 0;
+  while (bucket + 1 < kNumBuckets && latency_us >= (uint64_t{2} << bucket)) {
+    bucket++;
+  }
+  buckets[bucket]++;
+  count++;
+  total_us += latency_us;
+  max_us = std::max(max_us, latency_us);
+}
+
+uint64_t AclLatencyTracker::Histogram::MeanUs() const {
+  return count == 0 ? 0 : total_us / count;
+}
+
+uint64_t AclLatencyTracker::Histogram::PercentileUs(unsigned percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t rank = std::max<uint64_t>((uint64_t{count} * std::min(percentile, 100u) + 99) / 100, 1);
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket + 1 < kNumBuckets; bucket++) {
+    seen += buckets[bucket];
+    if (seen >= rank) {
+      return std::min(max_us, (uint64_t{2} << bucket) - 1);
+    }
+  }
+  return max_us;
+}
+
+uint64_t AclLatencyTracker::Stats::TxBytesPerSecond(Clock::time_point now) const {
+  return BytesPerSecond(tx_bytes, registered_at, now);
+}
+
+uint64_t AclLatencyTracker::Stats::RxBytesPerSecond(Clock::time_point now) const {
+  return BytesPerSecond(rx_bytes, registered_at, now);
+}
+
+AclLatencyTracker::AclLatencyTracker(std::function<Clock::time_point()> now) : now_(std::move(now)) {}
+
+void AclLatencyTracker::Register(uint16_t handle) {
+  Connection& connection = connections_[handle];
+  connection = Connection{};
+  connection.stats.registered_at = now_();
+}
+
+void AclLatencyTracker::Unregister(uint16_t handle) {
+  connections_.erase(handle);
+}
+
+void AclLatencyTracker::OnPacketQueued(
+    uint16_t handle, size_t size, size_t num_fragments, Clock::time_point enqueued_at) {
+  auto connection = connections_.find(handle);
+  if (connection == connections_.end() || num_fragments == 0) {
+    return;
+  }
+  Clock::time_point now = now_();
+  connection->second.stats.queue_latency.Add(ElapsedUs(enqueued_at, now));
+  for (size_t i = 0; i < num_fragments; i++) {
+    connection->second.queued_fragments.emplace_back(now, i + 1 == num_fragments);
+  }
+  connection->second.stats.tx_packets++;
+  connection->second.stats.tx_bytes += size;
+}
+
+void AclLatencyTracker::OnFragmentSent(uint16_t handle) {
+  auto connection = connections_.find(handle);
+  if (connection == connections_.end() || connection->second.queued_fragments.empty()) {
+    return;
+  }
+  Clock::time_point now = now_();
+  auto [queued_at, last_fragment] = connection->second.queued_fragments.front();
+  connection->second.queued_fragments.pop_front();
+  if (last_fragment) {
+    connection->second.stats.scheduler_latency.Add(ElapsedUs(queued_at, now));
+  }
+  connection->second.sent_fragments.push_back(now);
+}
+
+void AclLatencyTracker::OnFragmentsCompleted(uint16_t handle, uint16_t num_fragments) {
+  auto connection = connections_.find(handle);
+  if (connection == connections_.end()) {
+    return;
+  }
+  Clock::time_point now = now_();
+  auto& sent_fragments = connection->second.sent_fragments;
+  for (uint16_t i = 0; i < num_fragments && !sent_fragments.empty(); i++) {
+    connection->second.stats.controller_latency.Add(ElapsedUs(sent_fragments.front(), now));
+    sent_fragments.pop_front();
+  }
+}
+
+void AclLatencyTracker::OnPacketReceived(uint16_t handle, size_t size) {
+  auto connection = connections_.find(handle);
+  if (connection == connections_.end()) {
+    return;
+  }
+  connection->second.stats.rx_packets++;
+  connection->second.stats.rx_bytes += size;
+}
+
+std::optional<AclLatencyTracker::Stats> AclLatencyTracker::GetStats(uint16_t handle) const {
+  auto connection = connections_.find(handle);
+  if (connection == connections_.end()) {
+    return std::nullopt;
+  }
+  return connection->second.stats;
+}
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+// Latency and throughput of the ACL data of each connection handle.
+//
+// Outgoing packets are followed from the connection enqueuing them, through the
+// round robin scheduler taking them off the connection queue, to the controller
+// completing their fragments. This tells apart the time spent waiting for the
+// scheduler to pick the connection, the time spent waiting for controller
+// credits and other connections, and the time spent in the controller. Like the
+// scheduler, it runs on the ACL manager handler, so it needs no locking.
+//
+// ISO data is not tracked yet. It bypasses the round robin scheduler: the ISO
+// manager and the legacy stack shim send it through HciLayer::GetIsoQueueEnd()
+// and count its completed packets themselves, so it needs hooks of its own
+// there.
+class AclLatencyTracker {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Latencies in logarithmic buckets: bucket 0 counts the latencies below
+  // 2us, bucket i those in [2^i, 2^(i+1)) us and the last bucket all those
+  // above.
+  struct Histogram {
+    static constexpr size_t kNumBuckets = 22;  // Up to about 2s
+
+    std::array<uint32_t, kNumBuckets> buckets{};
+    uint32_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+
+    void Add(uint64_t latency_us);
+    uint64_t MeanUs() const;
+    // Upper bound of the bucket holding the given percentile, max_us for
+    // the last bucket.
+    uint64_t PercentileUs(unsigned percentile) const;
+  };
+
+  struct Stats {
+    // From the packet enqueued by the connection to the scheduler taking it off
+    // the connection queue.
+    Histogram queue_latency;
+    // From the packet taken off the connection queue to its last fragment
+    // sent to the HCI layer: waiting for credits and for other connections.
+    Histogram scheduler_latency;
+    // From a fragment sent to the HCI layer to the controller completing it.
+    Histogram controller_latency;
+    uint32_t tx_packets = 0;
+    uint64_t tx_bytes = 0;
+    uint32_t rx_packets = 0;
+    uint64_t rx_bytes = 0;
+    Clock::time_point registered_at;
+
+    // Average throughput since the connection was registered.
+    uint64_t TxBytesPerSecond(Clock::time_point now) const;
+    uint64_t RxBytesPerSecond(Clock::time_point now) const;
+  };
+
+  explicit AclLatencyTracker(std::function<Clock::time_point()> now = Clock::now);
+
+  void Register(uint16_t handle);
+  void Unregister(uint16_t handle);
+
+  // A packet of |size| bytes, enqueued by the connection at |enqueued_at|, was
+  // taken off the connection queue and split in |num_fragments| fragments.
+  void OnPacketQueued(uint16_t handle, size_t size, size_t num_fragments, Clock::time_point enqueued_at);
+  // The oldest queued fragment of the connection was sent to the HCI layer.
+  void OnFragmentSent(uint16_t handle);
+  // The controller completed the |num_fragments| oldest sent fragments.
+  void OnFragmentsCompleted(uint16_t handle, uint16_t num_fragments);
+  // A packet of |size| bytes was received on the connection.
+  void OnPacketReceived(uint16_t handle, size_t size);
+
+  std::optional<Stats> GetStats(uint16_t handle) const;
+
+  Clock::time_point Now() const {
+    return now_();
+  }
+
+  template <typename Function>
+  void ForEachConnection(Function function) const {
+    for (const auto& [handle, connection] : connections_) {
+      function(handle, connection.stats);
+    }
+  }
+
+ private:
+  struct Connection {
+    Stats stats;
+    // Time each fragment waiting to be sent was queued, and whether it is the
+    // last fragment of its packet.
+    std::deque<std::pair<Clock::time_point, bool>> queued_fragments;
+    // Time each fragment waiting to be completed was sent.
+    std::deque<Clock::time_point> sent_fragments;
+  };
+
+  std::function<Clock::time_point()> now_;
+  std::unordered_map<uint16_t, Connection> connections_;
+};
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
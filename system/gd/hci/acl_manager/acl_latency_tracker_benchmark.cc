@@ -0,0 +1,54 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+
+#include "benchmark/benchmark.h"
+#include "hci/acl_manager/acl_latency_tracker.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+
+// Cost of following one packet of |fragments| fragments through the tracker,
+// from the connection enqueuing it to the controller completing it, spread
+// over a few connections like a busy link.
+static void BM_AclLatencyTrackerPacket(State& state) {
+  constexpr uint16_t kNumConnections = 4;
+  const size_t fragments = state.range(0);
+  AclLatencyTracker tracker;
+  for (uint16_t handle = 0; handle < kNumConnections; handle++) {
+    tracker.Register(handle);
+  }
+
+  uint16_t handle = 0;
+  for (auto _ : state) {
+    tracker.OnPacketQueued(handle, 1021 * fragments, fragments, tracker.Now());
+    for (size_t i = 0; i < fragments; i++) {
+      tracker.OnFragmentSent(handle);
+    }
+    tracker.OnFragmentsCompleted(handle, fragments);
+    tracker.OnPacketReceived(handle, 27);
+    handle = (handle + 1) % kNumConnections;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AclLatencyTrackerPacket)->Arg(1)->Arg(3);
+
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "hci/acl_manager/acl_latency_tracker.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace bluetooth {
+namespace hci {
+namespace acl_manager {
+namespace {
+
+using namespace std::chrono_literals;
+
+constexpr uint16_t kHandle = 0x123;
+
+class AclLatencyTrackerTest : public ::testing::Test {
+ protected:
+  AclLatencyTracker::Clock::time_point now_{};
+  AclLatencyTracker tracker_{[this] { return now_; }};
+};
+
+TEST_F(AclLatencyTrackerTest, ignores_unknown_handles) {
+  tracker_.OnPacketQueued(kHandle, 100, 1, now_);
+  tracker_.OnFragmentSent(kHandle);
+  tracker_.OnFragmentsCompleted(kHandle, 1);
+  tracker_.OnPacketReceived(kHandle, 100);
+  ASSERT_FALSE(tracker_.GetStats(kHandle).has_value());
+
+  tracker_.Register(kHandle);
+  tracker_.Unregister(kHandle);
+  ASSERT_FALSE(tracker_.GetStats(kHandle).has_value());
+}
+
+TEST_F(AclLatencyTrackerTest, scheduler_and_controller_latency) {
+  tracker_.Register(kHandle);
+
+  // One packet in three fragments, enqueued by the connection 3ms before the
+  // scheduler takes it, then sent 1, 2 and 4ms after that
+  now_ += 3ms;
+  tracker_.OnPacketQueued(kHandle, 2000, 3, now_ - 3ms);
+  now_ += 1ms;
+  tracker_.OnFragmentSent(kHandle);
+  now_ += 1ms;
+  tracker_.OnFragmentSent(kHandle);
+  now_ += 2ms;
+  tracker_.OnFragmentSent(kHandle);
+
+  // The controller completes the first two after 10ms
+  now_ += 8ms;
+  tracker_.OnFragmentsCompleted(kHandle, 2);
+
+  auto stats = tracker_.GetStats(kHandle);
+  ASSERT_TRUE(stats.has_value());
+  ASSERT_EQ(stats->tx_packets, 1u);
+  ASSERT_EQ(stats->tx_bytes, 2000u);
+
+  ASSERT_EQ(stats->queue_latency.count, 1u);
+  ASSERT_EQ(stats->queue_latency.max_us, 3000u);
+
+  // Only the last fragment of a packet counts for the scheduler
+  ASSERT_EQ(stats->scheduler_latency.count, 1u);
+  ASSERT_EQ(stats->scheduler_latency.max_us, 4000u);
+
+  ASSERT_EQ(stats->controller_latency.count, 2u);
+  ASSERT_EQ(stats->controller_latency.MeanUs(), 10500u);
+  ASSERT_EQ(stats->controller_latency.max_us, 11000u);
+
+  // Completions beyond the sent fragments are ignored
+  tracker_.OnFragmentsCompleted(kHandle, 5);
+  ASSERT_EQ(tracker_.GetStats(kHandle)->controller_latency.count, 3u);
+}
+
+TEST_F(AclLatencyTrackerTest, histogram_buckets) {
+  AclLatencyTracker::Histogram histogram;
+  histogram.Add(0);
+  histogram.Add(1);
+  histogram.Add(2);
+  histogram.Add(1000);
+  histogram.Add(10000000);
+
+  ASSERT_EQ(histogram.buckets[0], 2u);
+  ASSERT_EQ(histogram.buckets[1], 1u);
+  ASSERT_EQ(histogram.buckets[9], 1u);  // [512, 1024)
+  ASSERT_EQ(histogram.buckets[AclLatencyTracker::Histogram::kNumBuckets - 1], 1u);
+  ASSERT_EQ(histogram.count, 5u);
+
+  ASSERT_EQ(histogram.PercentileUs(40), 1u);
+  ASSERT_EQ(histogram.PercentileUs(60), 3u);
+  ASSERT_EQ(histogram.PercentileUs(80), 1023u);
+  ASSERT_EQ(histogram.PercentileUs(100), 10000000u);
+  ASSERT_EQ(AclLatencyTracker::Histogram().PercentileUs(50), 0u);
+}
+
+TEST_F(AclLatencyTrackerTest, throughput) {
+  tracker_.Register(kHandle);
+  now_ += 2s;
+  tracker_.OnPacketQueued(kHandle, 3000, 3, now_);
+  tracker_.OnPacketReceived(kHandle, 500);
+  tracker_.OnPacketReceived(kHandle, 500);
+
+  auto stats = tracker_.GetStats(kHandle);
+  ASSERT_EQ(stats->rx_packets, 2u);
+  ASSERT_EQ(stats->TxBytesPerSecond(now_), 1500u);
+  ASSERT_EQ(stats->RxBytesPerSecond(now_), 500u);
+}
+
+}  // namespace
+}  // namespace acl_manager
+}  // namespace hci
+}  // namespace bluetooth
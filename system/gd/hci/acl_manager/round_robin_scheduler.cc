@@ -22,8 +22,11 @@ namespace hci {
 namespace acl_manager {
 
 RoundRobinScheduler::RoundRobinScheduler(
-    os::Handler* handler, Controller* controller, common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end)
-    : handler_(handler), controller_(controller), hci_queue_end_(hci_queue_end) {
+    os::Handler* handler,
+    Controller* controller,
+    common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end,
+    AclLatencyTracker* latency_tracker)
+    : handler_(handler), controller_(controller), hci_queue_end_(hci_queue_end), latency_tracker_(latency_tracker) {
   max_acl_packet_credits_ = controller_->GetNumAclPacketBuffers();
   acl_packet_credits_ = max_acl_packet_credits_;
   hci_mtu_ = controller_->GetAclPacketLength();
@@ -44,6 +47,9 @@ void RoundRobinScheduler::Register(ConnectionType connection_type, uint16_t hand
   ASSERT(acl_queue_handlers_.count(handle) == 0);
   acl_queue_handler acl_queue_handler = {connection_type, std::move(queue), false, 0};
   acl_queue_handlers_.insert(std::pair<uint16_t, RoundRobinScheduler::acl_queue_handler>(handle, acl_queue_handler));
+  if (latency_tracker_ != nullptr) {
+    latency_tracker_->Register(handle);
+  }
   if (fragments_to_send_.size() == 0) {
     start_round_robin();
   }
@@ -65,6 +71,9 @@ void RoundRobinScheduler::Unregister(uint16_t handle) {
     acl_queue_handler.queue_->GetDownEnd()->UnregisterDequeue();
   }
   acl_queue_handlers_.erase(handle);
+  if (latency_tracker_ != nullptr) {
+    latency_tracker_->Unregister(handle);
+  }
   starting_point_ = acl_queue_handlers_.begin();
 }
 
@@ -90,7 +99,7 @@ void RoundRobinScheduler::start_round_robin() {
     return;
   }
   if (!fragments_to_send_.empty()) {
-    auto connection_type = fragments_to_send_.front().first;
+    auto connection_type = fragments_to_send_.front().connection_type_;
     bool classic_buffer_full = acl_packet_credits_ == 0 && connection_type == ConnectionType::CLASSIC;
     bool le_buffer_full = le_acl_packet_credits_ == 0 && connection_type == ConnectionType::LE;
     if (classic_buffer_full || le_buffer_full) {
@@ -151,22 +160,32 @@ void RoundRobinScheduler::buffer_packet(uint16_t acl_handle) {
                                                 : PacketBoundaryFlag::FIRST_NON_AUTOMATICALLY_FLUSHABLE;
 
   int acl_priority = acl_queue_handler->second.high_priority_ ? 1 : 0;
-  if (packet->size() <= mtu) {
+  size_t packet_size = packet->size();
+  size_t num_fragments = 1;
+  if (packet_size <= mtu) {
     fragments_to_send_.push(
-        std::make_pair(
-            connection_type, AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))),
+        acl_fragment{
+            connection_type,
+            handle,
+            AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(packet))},
         acl_priority);
   } else {
     auto fragments = AclFragmenter(mtu, std::move(packet)).GetFragments();
+    num_fragments = fragments.size();
     for (size_t i = 0; i < fragments.size(); i++) {
       fragments_to_send_.push(
-          std::make_pair(
+          acl_fragment{
               connection_type,
-              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))),
+              handle,
+              AclBuilder::Create(handle, packet_boundary_flag, broadcast_flag, std::move(fragments[i]))},
           acl_priority);
       packet_boundary_flag = PacketBoundaryFlag::CONTINUING_FRAGMENT;
     }
   }
+  if (latency_tracker_ != nullptr) {
+    latency_tracker_->OnPacketQueued(
+        handle, packet_size, num_fragments, acl_queue_handler->second.queue_->GetLastDequeuedEnqueueTime());
+  }
   ASSERT(fragments_to_send_.size() > 0);
   unregister_all_connections();
 
@@ -193,7 +212,7 @@ void RoundRobinScheduler::send_next_fragment() {
 
 // Invoked from some external Queue Reactable context 1
 std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment() {
-  ConnectionType connection_type = fragments_to_send_.front().first;
+  ConnectionType connection_type = fragments_to_send_.front().connection_type_;
   if (connection_type == ConnectionType::CLASSIC) {
     ASSERT(acl_packet_credits_ > 0);
     acl_packet_credits_ -= 1;
@@ -202,7 +221,10 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     le_acl_packet_credits_ -= 1;
   }
 
-  auto raw_pointer = fragments_to_send_.front().second.release();
+  if (latency_tracker_ != nullptr) {
+    latency_tracker_->OnFragmentSent(fragments_to_send_.front().handle_);
+  }
+  auto raw_pointer = fragments_to_send_.front().packet_.release();
   fragments_to_send_.pop();
   if (fragments_to_send_.empty()) {
     if (enqueue_registered_.exchange(false)) {
@@ -210,7 +232,7 @@ std::unique_ptr<AclBuilder> RoundRobinScheduler::handle_enqueue_next_fragment()
     }
     handler_->Post(common::BindOnce(&RoundRobinScheduler::start_round_robin, common::Unretained(this)));
   } else {
-    ConnectionType next_connection_type = fragments_to_send_.front().first;
+    ConnectionType next_connection_type = fragments_to_send_.front().connection_type_;
     bool classic_buffer_full = next_connection_type == ConnectionType::CLASSIC && acl_packet_credits_ == 0;
     bool le_buffer_full = next_connection_type == ConnectionType::LE && le_acl_packet_credits_ == 0;
     if ((classic_buffer_full || le_buffer_full) && enqueue_registered_.exchange(false)) {
@@ -226,6 +248,10 @@ void RoundRobinScheduler::incoming_acl_credits(uint16_t handle, uint16_t credits
     return;
   }
 
+  if (latency_tracker_ != nullptr) {
+    latency_tracker_->OnFragmentsCompleted(handle, credits);
+  }
+
   if (acl_queue_handler->second.number_of_sent_packets_ >= credits) {
     acl_queue_handler->second.number_of_sent_packets_ -= credits;
   } else {
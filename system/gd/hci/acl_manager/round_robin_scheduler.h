@@ -21,6 +21,7 @@
 #include "common/bidi_queue.h"
 #include "common/multi_priority_queue.h"
 #include "hci/acl_manager.h"
+#include "hci/acl_manager/acl_latency_tracker.h"
 #include "hci/controller.h"
 #include "hci/hci_packets.h"
 #include "os/handler.h"
@@ -32,7 +33,10 @@ namespace acl_manager {
 class RoundRobinScheduler {
  public:
   RoundRobinScheduler(
-      os::Handler* handler, Controller* controller, common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end);
+      os::Handler* handler,
+      Controller* controller,
+      common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end,
+      AclLatencyTracker* latency_tracker = nullptr);
   ~RoundRobinScheduler();
 
   enum ConnectionType { CLASSIC, LE };
@@ -53,6 +57,12 @@ class RoundRobinScheduler {
   uint16_t GetLeCredits();
 
  private:
+  struct acl_fragment {
+    ConnectionType connection_type_;
+    uint16_t handle_;
+    std::unique_ptr<AclBuilder> packet_;
+  };
+
   void start_round_robin();
   void buffer_packet(uint16_t acl_handle);
   void unregister_all_connections();
@@ -63,7 +73,7 @@ class RoundRobinScheduler {
   os::Handler* handler_ = nullptr;
   Controller* controller_ = nullptr;
   std::map<uint16_t, acl_queue_handler> acl_queue_handlers_;
-  common::MultiPriorityQueue<std::pair<ConnectionType, std::unique_ptr<AclBuilder>>, 2> fragments_to_send_;
+  common::MultiPriorityQueue<acl_fragment, 2> fragments_to_send_;
   uint16_t max_acl_packet_credits_ = 0;
   uint16_t acl_packet_credits_ = 0;
   uint16_t le_max_acl_packet_credits_ = 0;
@@ -72,6 +82,7 @@ class RoundRobinScheduler {
   size_t le_hci_mtu_{0};
   std::atomic_bool enqueue_registered_ = false;
   common::BidiQueueEnd<AclBuilder, AclView>* hci_queue_end_ = nullptr;
+  AclLatencyTracker* latency_tracker_ = nullptr;
   // first register queue end for the Round-robin schedule
   std::map<uint16_t, acl_queue_handler>::iterator starting_point_;
 };
@@ -83,7 +83,7 @@ class RoundRobinSchedulerTest : public ::testing::Test {
     thread_ = new Thread("thread", Thread::Priority::NORMAL);
     handler_ = new Handler(thread_);
     controller_ = new TestController();
-    round_robin_scheduler_ = new RoundRobinScheduler(handler_, controller_, hci_queue_.GetUpEnd());
+    round_robin_scheduler_ = new RoundRobinScheduler(handler_, controller_, hci_queue_.GetUpEnd(), &latency_tracker_);
     hci_queue_.GetDownEnd()->RegisterDequeue(
         handler_, common::Bind(&RoundRobinSchedulerTest::HciDownEndDequeue, common::Unretained(this)));
   }
@@ -163,6 +163,7 @@ class RoundRobinSchedulerTest : public ::testing::Test {
   Thread* thread_;
   Handler* handler_;
   TestController* controller_;
+  AclLatencyTracker latency_tracker_;
   RoundRobinScheduler* round_robin_scheduler_;
   std::queue<AclView> sent_acl_packets_;
   uint16_t packet_count_;
@@ -412,6 +413,26 @@ TEST_F(RoundRobinSchedulerTest, receive_le_credit_when_next_fragment_is_classic)
   round_robin_scheduler_->Unregister(le_handle);
 }
 
+TEST_F(RoundRobinSchedulerTest, track_latency_from_connection_queue) {
+  uint16_t handle = 0x01;
+  auto connection_queue = std::make_shared<AclConnection::Queue>(10);
+  round_robin_scheduler_->Register(RoundRobinScheduler::ConnectionType::CLASSIC, handle, connection_queue);
+
+  ASSERT_NO_FATAL_FAILURE(SetPacketFuture(1));
+  std::vector<uint8_t> packet = {0x01, 0x02, 0x03};
+  EnqueueAclUpEnd(connection_queue->GetUpEnd(), packet);
+  packet_future_->wait();
+  sync_handler();
+
+  auto stats = latency_tracker_.GetStats(handle);
+  ASSERT_TRUE(stats.has_value());
+  ASSERT_EQ(stats->tx_packets, 1u);
+  ASSERT_EQ(stats->queue_latency.count, 1u);
+  ASSERT_EQ(stats->scheduler_latency.count, 1u);
+
+  round_robin_scheduler_->Unregister(handle);
+}
+
 }  // namespace
 }  // namespace acl_manager
 }  // namespace hci
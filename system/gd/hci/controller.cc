@@ -225,7 +225,7 @@ struct Controller::impl {
     }
     auto complete_view = NumberOfCompletedPacketsView::Create(event);
     ASSERT(complete_view.IsValid());
-    for (auto completed_packets : complete_view.GetCompletedPackets()) {
+    for (const auto& completed_packets : complete_view.GetCompletedPacketsRange()) {
       uint16_t handle = completed_packets.connection_handle_;
       uint16_t credits = completed_packets.host_num_of_completed_packets_;
       acl_credits_callback_.Invoke(handle, credits);
@@ -63,6 +63,9 @@ class HciFacadeService : public HciFacade::Service {
         bit_inserter.insert_byte(b);
       }
     }
+    void SerializeToSpan(SpanInserter& span_inserter) const override {
+      span_inserter.insert_bytes(bytes_.data(), bytes_.size());
+    }
 
    private:
     std::vector<uint8_t> bytes_;
@@ -129,6 +132,9 @@ class HciFacadeService : public HciFacade::Service {
         bit_inserter.insert_byte(b);
       }
     }
+    void SerializeToSpan(SpanInserter& span_inserter) const override {
+      span_inserter.insert_bytes(bytes_.data(), bytes_.size());
+    }
 
    private:
     std::vector<uint8_t> bytes_;
@@ -203,6 +203,7 @@ using ::blueberry::facade::hci::EnableAdvertiserRequest;
 using ::blueberry::facade::hci::EnablePeriodicAdvertisingRequest;
 using ::blueberry::facade::hci::ExtendedCreateAdvertiserRequest;
 using ::blueberry::facade::hci::ExtendedCreateAdvertiserResponse;
+using ::blueberry::facade::hci::GetCommandCountsResponse;
 using ::blueberry::facade::hci::GetNumberOfAdvertisingInstancesResponse;
 using ::blueberry::facade::hci::GetOwnAddressRequest;
 using ::blueberry::facade::hci::LeAdvertisingManagerFacade;
@@ -366,6 +367,17 @@ class LeAdvertisingManagerFacadeService : public LeAdvertisingManagerFacade::Ser
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status GetCommandCounts(::grpc::ServerContext* context, const ::google::protobuf::Empty* request,
+                                  GetCommandCountsResponse* response) override {
+    auto counts = le_advertising_manager_->GetCommandCounts();
+    response->set_commands_sent(counts.commands_sent);
+    response->set_enable_commands(counts.enable_commands);
+    response->set_sets_enabled(counts.sets_enabled);
+    response->set_data_updates_skipped(counts.data_updates_skipped);
+    response->set_unchanged_data_updates(counts.unchanged_data_updates);
+    return ::grpc::Status::OK;
+  }
+
   ::grpc::Status RemoveAdvertiser(::grpc::ServerContext* context, const RemoveAdvertiserRequest* request,
                                   ::google::protobuf::Empty* response) override {
     if (request->advertiser_id() == LeAdvertisingManager::kInvalidId) {
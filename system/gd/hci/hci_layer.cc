@@ -16,11 +16,16 @@
 
 #include "hci/hci_layer.h"
 
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
 #include "common/bind.h"
 #include "common/init_flags.h"
 #include "common/stop_watch.h"
 #include "hci/hci_metrics_logging.h"
 #include "os/alarm.h"
+#include "os/fake_timer/fake_timerfd.h"
 #include "os/metrics.h"
 #include "os/queue.h"
 #include "packet/packet_builder.h"
@@ -58,6 +63,63 @@ static void abort_after_time_out(OpCode op_code) {
   ASSERT_LOG(false, "Done waiting for debug information after HCI timeout (%s)", OpCodeText(op_code).c_str());
 }
 
+// The time on the clock of the alarms, to arm the HCI timeout from the time a command was sent
+static std::chrono::milliseconds alarm_clock_now() {
+#ifdef USE_FAKE_TIMERS
+  return std::chrono::milliseconds(os::fake_timer::fake_timerfd_get_clock());
+#else
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+#endif
+}
+
+// Commands that can be sent while other commands are waiting for their response when
+// hci_command_pipelining is enabled. None of them changes state that another command
+// depends on, so the controller may process them in any order. Any other command waits
+// for all the commands sent before it, and holds back the commands queued after it.
+static const std::unordered_set<OpCode> kPipelinedCommands = {
+    OpCode::READ_LOCAL_VERSION_INFORMATION,
+    OpCode::READ_LOCAL_SUPPORTED_COMMANDS,
+    OpCode::READ_LOCAL_SUPPORTED_FEATURES,
+    OpCode::READ_LOCAL_EXTENDED_FEATURES,
+    OpCode::READ_LOCAL_SUPPORTED_CODECS_V1,
+    OpCode::READ_LOCAL_SUPPORTED_CODECS_V2,
+    OpCode::READ_BUFFER_SIZE,
+    OpCode::READ_BD_ADDR,
+    OpCode::READ_LOCAL_NAME,
+    OpCode::READ_CLASS_OF_DEVICE,
+    OpCode::READ_CLOCK_OFFSET,
+    OpCode::READ_REMOTE_VERSION_INFORMATION,
+    OpCode::READ_REMOTE_SUPPORTED_FEATURES,
+    OpCode::READ_REMOTE_EXTENDED_FEATURES,
+    OpCode::READ_RSSI,
+    OpCode::READ_LINK_QUALITY,
+    OpCode::READ_FAILED_CONTACT_COUNTER,
+    OpCode::READ_TRANSMIT_POWER_LEVEL,
+    OpCode::READ_AUTOMATIC_FLUSH_TIMEOUT,
+    OpCode::READ_ENCRYPTION_KEY_SIZE,
+    OpCode::LE_READ_BUFFER_SIZE_V1,
+    OpCode::LE_READ_BUFFER_SIZE_V2,
+    OpCode::LE_READ_LOCAL_SUPPORTED_FEATURES,
+    OpCode::LE_READ_SUPPORTED_STATES,
+    OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE,
+    OpCode::LE_READ_RESOLVING_LIST_SIZE,
+    OpCode::LE_READ_PERIODIC_ADVERTISER_LIST_SIZE,
+    OpCode::LE_READ_MAXIMUM_DATA_LENGTH,
+    OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH,
+    OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH,
+    OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS,
+    OpCode::LE_READ_ADVERTISING_PHYSICAL_CHANNEL_TX_POWER,
+    OpCode::LE_READ_TRANSMIT_POWER,
+    OpCode::LE_READ_PHY,
+    OpCode::LE_READ_REMOTE_FEATURES,
+    OpCode::LE_RAND,
+    // Entries only get added by these, and the controller processes commands with the
+    // same opcode in order
+    OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST,
+    OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST,
+    OpCode::LE_ADD_DEVICE_TO_PERIODIC_ADVERTISER_LIST,
+};
+
 class CommandQueueEntry {
  public:
   CommandQueueEntry(
@@ -76,7 +138,22 @@ class CommandQueueEntry {
 
   unique_ptr<CommandBuilder> command;
   unique_ptr<CommandView> command_view;
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
+
+  // Serializes the command the first time it is needed
+  OpCode GetOpCode() {
+    if (command_view == nullptr) {
+      command_bytes = std::make_shared<std::vector<uint8_t>>(command->size());
+      SpanInserter it(command_bytes->data(), command_bytes->size());
+      command->SerializeToSpan(it);
+      auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(command_bytes));
+      ASSERT(cmd_view.IsValid());
+      command_view = std::make_unique<CommandView>(std::move(cmd_view));
+    }
+    return command_view->GetOpCode();
+  }
 
+  std::chrono::milliseconds sent_time_{0};
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
   ContextualOnceCallback<void(CommandCompleteView)> on_complete;
@@ -113,6 +190,7 @@ struct HciLayer::impl {
       delete hci_abort_alarm_;
     }
     command_queue_.clear();
+    waiting_commands_.clear();
   }
 
   void drop(EventView event) {
@@ -121,25 +199,25 @@ struct HciLayer::impl {
 
   void on_outbound_acl_ready() {
     auto packet = acl_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
+    std::vector<uint8_t> bytes(packet->size());
+    SpanInserter it(bytes.data(), bytes.size());
+    packet->SerializeToSpan(it);
     hal_->sendAclData(bytes);
   }
 
   void on_outbound_sco_ready() {
     auto packet = sco_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
+    std::vector<uint8_t> bytes(packet->size());
+    SpanInserter it(bytes.data(), bytes.size());
+    packet->SerializeToSpan(it);
     hal_->sendScoData(bytes);
   }
 
   void on_outbound_iso_ready() {
     auto packet = iso_queue_.GetDownEnd()->TryDequeue();
-    std::vector<uint8_t> bytes;
-    BitInserter bi(bytes);
-    packet->Serialize(bi);
+    std::vector<uint8_t> bytes(packet->size());
+    SpanInserter it(bytes.data(), bytes.size());
+    packet->SerializeToSpan(it);
     hal_->sendIsoData(bytes);
   }
 
@@ -168,6 +246,13 @@ struct HciLayer::impl {
     handle_command_response<CommandCompleteView>(event, "complete");
   }
 
+  std::list<CommandQueueEntry>::iterator find_waiting_command(OpCode op_code) {
+    // Responses to commands with the same opcode come in the order the commands were sent
+    return std::find_if(waiting_commands_.begin(), waiting_commands_.end(), [op_code](CommandQueueEntry& entry) {
+      return entry.GetOpCode() == op_code;
+    });
+  }
+
   template <typename TResponse>
   void handle_command_response(EventView event, std::string logging_id) {
     TResponse response_view = TResponse::Create(event);
@@ -181,26 +266,28 @@ struct HciLayer::impl {
     bool is_status = logging_id == "status";
 
     ASSERT_LOG(
-        !command_queue_.empty(),
+        !waiting_commands_.empty(),
         "Unexpected %s event with OpCode 0x%02hx (%s)",
         logging_id.c_str(),
         op_code,
         OpCodeText(op_code).c_str());
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
+    OpCode waiting_command = waiting_commands_.front().GetOpCode();
+    if (waiting_command == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
       LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
       return;
     }
+    auto command = find_waiting_command(op_code);
     ASSERT_LOG(
-        waiting_command_ == op_code,
+        command != waiting_commands_.end(),
         "Waiting for 0x%02hx (%s), got 0x%02hx (%s)",
-        waiting_command_,
-        OpCodeText(waiting_command_).c_str(),
+        waiting_command,
+        OpCodeText(waiting_command).c_str(),
         op_code,
         OpCodeText(op_code).c_str());
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !command->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected,
       // we can't treat this as hard failure since we have no way of probing this lack of support at
@@ -208,37 +295,51 @@ struct HciLayer::impl {
       // packet, which will be interpreted as invalid response.
       CommandCompleteView command_complete_view = CommandCompleteView::Create(
           EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-      command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(
-          std::move(command_complete_view));
+      command->GetCallback<CommandCompleteView>()->Invoke(std::move(command_complete_view));
     } else {
       ASSERT_LOG(
-          command_queue_.front().waiting_for_status_ == is_status,
+          command->waiting_for_status_ == is_status,
           "0x%02hx (%s) was not expecting %s event",
           op_code,
           OpCodeText(op_code).c_str(),
           logging_id.c_str());
 
-      command_queue_.front().GetCallback<TResponse>()->Invoke(std::move(response_view));
+      command->GetCallback<TResponse>()->Invoke(std::move(response_view));
     }
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    bool was_oldest = command == waiting_commands_.begin();
+    waiting_commands_.erase(command);
     if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
+      if (was_oldest) {
+        hci_timeout_alarm_->Cancel();
+        schedule_hci_timeout();
+      }
       send_next_command();
     }
   }
 
+  // Times out the oldest command waiting for its response, kHciTimeoutMs after it was sent
+  void schedule_hci_timeout() {
+    if (waiting_commands_.empty()) {
+      return;
+    }
+    OpCode op_code = waiting_commands_.front().GetOpCode();
+    auto waited = alarm_clock_now() - waiting_commands_.front().sent_time_;
+    // A delay of 0 would disarm the alarm
+    auto timeout = std::max(kHciTimeoutMs - waited, std::chrono::milliseconds(1));
+    hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), timeout);
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     LOG_ERROR("Timed out waiting for 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
     // TODO: LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size());
+    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size() + waiting_commands_.size());
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    waiting_commands_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     // Ignore the response, since we don't know what might come back.
     enqueue_command(ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce([](CommandCompleteView) {}));
     // Don't time out for this one;
@@ -255,33 +356,34 @@ struct HciLayer::impl {
     }
   }
 
-  void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
+  bool can_send_next_command() {
+    if (waiting_commands_.empty()) {
+      return true;
     }
-    if (waiting_command_ != OpCode::NONE) {
-      return;
+    if (!common::init_flags::hci_command_pipelining_is_enabled()) {
+      return false;  // Only allow one outstanding command
     }
-    if (command_queue_.size() == 0) {
-      return;
+    if (kPipelinedCommands.count(command_queue_.front().GetOpCode()) == 0) {
+      return false;
     }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
-
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    ASSERT(cmd_view.IsValid());
-    OpCode op_code = cmd_view.GetOpCode();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
-    } else {
-      LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+    // Commands sent after one that is not pipelined wait for its response
+    return kPipelinedCommands.count(waiting_commands_.back().GetOpCode()) != 0;
+  }
+
+  void send_next_command() {
+    while (command_credits_ > 0 && !command_queue_.empty() && can_send_next_command()) {
+      OpCode op_code = command_queue_.front().GetOpCode();
+      hal_->sendHciCommand(*command_queue_.front().command_bytes);
+      log_link_layer_connection_command(command_queue_.front().command_view);
+      log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
+      command_queue_.front().sent_time_ = alarm_clock_now();
+      waiting_commands_.splice(waiting_commands_.end(), command_queue_, command_queue_.begin());
+      command_credits_--;
+      if (hci_timeout_alarm_ == nullptr) {
+        LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+      } else if (waiting_commands_.size() == 1) {
+        schedule_hci_timeout();
+      }
     }
   }
 
@@ -340,7 +442,7 @@ struct HciLayer::impl {
 
   void on_hci_event(EventView event) {
     ASSERT(event.IsValid());
-    if (command_queue_.empty()) {
+    if (waiting_commands_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -371,7 +473,7 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      log_hci_event(get_response_command_view(event), event, module_.GetDependency<storage::StorageModule>());
     }
     EventCode event_code = event.GetEventCode();
     // Root Inflamation is a special case, since it aborts here
@@ -409,6 +511,28 @@ struct HciLayer::impl {
     }
   }
 
+  // The command a Command Complete or Command Status event responds to, or else the oldest
+  // command waiting for its response
+  std::unique_ptr<CommandView>& get_response_command_view(EventView event) {
+    OpCode op_code = OpCode::NONE;
+    if (event.GetEventCode() == EventCode::COMMAND_COMPLETE) {
+      auto view = CommandCompleteView::Create(event);
+      if (view.IsValid()) {
+        op_code = view.GetCommandOpCode();
+      }
+    } else if (event.GetEventCode() == EventCode::COMMAND_STATUS) {
+      auto view = CommandStatusView::Create(event);
+      if (view.IsValid()) {
+        op_code = view.GetCommandOpCode();
+      }
+    }
+    auto command = find_waiting_command(op_code);
+    if (command == waiting_commands_.end()) {
+      return waiting_commands_.front().command_view;
+    }
+    return command->command_view;
+  }
+
   void on_le_meta_event(EventView event) {
     LeMetaEventView meta_event_view = LeMetaEventView::Create(event);
     ASSERT(meta_event_view.IsValid());
@@ -425,10 +549,11 @@ struct HciLayer::impl {
 
   // Command Handling
   std::list<CommandQueueEntry> command_queue_;
+  // Sent commands waiting for their response, oldest first
+  std::list<CommandQueueEntry> waiting_commands_;
 
   std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
   std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> subevent_handlers_;
-  OpCode waiting_command_{OpCode::NONE};
   uint8_t command_credits_{1};  // Send reset first
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
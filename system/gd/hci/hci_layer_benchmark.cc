@@ -0,0 +1,148 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "common/init_flags.h"
+#include "hal/hci_hal_fake.h"
+#include "hci/address.h"
+#include "hci/hci_layer.h"
+#include "module.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+constexpr std::chrono::milliseconds kRoundTrip = std::chrono::milliseconds(1);
+constexpr uint8_t kControllerCredits = 8;
+
+void CountCompletion(std::atomic<size_t>* completed, size_t total, std::promise<void>* done, CommandCompleteView) {
+  if (++*completed == total) {
+    done->set_value();
+  }
+}
+
+}  // namespace
+
+// HciLayer on the fake HAL, with a controller thread that answers every command after
+// kRoundTrip and takes up to kControllerCredits commands at a time
+class BM_HciLayer : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    hal_ = new hal::TestHciHal();
+    registry_ = std::make_unique<TestModuleRegistry>();
+    registry_->InjectTestModule(&hal::HciHal::Factory, hal_);
+    registry_->Start<HciLayer>(&registry_->GetTestThread());
+    hci_ = registry_->GetModuleUnderTest<HciLayer>();
+    handler_ = registry_->GetTestModuleHandler(&HciLayer::Factory);
+    ASSERT(hal_->GetSentCommand().has_value());
+    hal_->InjectEvent(ResetCompleteBuilder::Create(kControllerCredits, ErrorCode::SUCCESS));
+    registry_->SynchronizeModuleHandler(&HciLayer::Factory, std::chrono::seconds(1));
+  }
+
+  void TearDown(State& st) override {
+    registry_->SynchronizeModuleHandler(&HciLayer::Factory, std::chrono::seconds(1));
+    registry_->StopAll();
+    registry_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void SetPipelining(bool enabled) {
+    std::string flag = std::string("INIT_hci_command_pipelining=") + (enabled ? "true" : "false");
+    const char* flags[] = {flag.c_str(), nullptr};
+    common::InitFlags::Load(flags);
+  }
+
+  // Answers the commands sent until |done| is set and every command is answered
+  void RunController(std::atomic_bool* done) {
+    std::deque<std::pair<OpCode, std::chrono::steady_clock::time_point>> received;
+    auto receive = [this, &received](std::chrono::milliseconds timeout) {
+      auto command = hal_->GetSentCommand(timeout);
+      if (command.has_value()) {
+        received.emplace_back(command->GetOpCode(), std::chrono::steady_clock::now() + kRoundTrip);
+      }
+      return command.has_value();
+    };
+    while (!*done || !received.empty()) {
+      if (received.empty()) {
+        receive(std::chrono::milliseconds(10));
+        continue;
+      }
+      std::this_thread::sleep_until(received.front().second);
+      while (receive(std::chrono::milliseconds(0))) {
+      }
+      uint8_t credits = kControllerCredits - (received.size() - 1);
+      hal_->InjectEvent(CommandCompleteBuilder::Create(
+          credits, received.front().first, std::make_unique<packet::RawBuilder>(std::vector<uint8_t>{0x00})));
+      received.pop_front();
+    }
+  }
+
+  hal::TestHciHal* hal_ = nullptr;
+  HciLayer* hci_ = nullptr;
+  os::Handler* handler_ = nullptr;
+  std::unique_ptr<TestModuleRegistry> registry_;
+};
+
+// Time to complete a burst of accept list additions, one command at a time or pipelined
+BENCHMARK_DEFINE_F(BM_HciLayer, command_burst)(State& state) {
+  SetPipelining(state.range(0) != 0);
+  const size_t count = state.range(1);
+  for (auto _ : state) {
+    std::atomic_bool done = false;
+    std::thread controller(&BM_HciLayer::RunController, this, &done);
+
+    std::atomic<size_t> completed = 0;
+    std::promise<void> all_completed;
+    for (size_t i = 0; i < count; i++) {
+      Address address({0xA0, 0xA1, 0xA2, 0xA3, (uint8_t)(i >> 8), (uint8_t)i});
+      hci_->EnqueueCommand(
+          LeAddDeviceToFilterAcceptListBuilder::Create(FilterAcceptListAddressType::RANDOM, address),
+          handler_->BindOnce(&CountCompletion, &completed, count, &all_completed));
+    }
+    all_completed.get_future().wait();
+    done = true;
+    controller.join();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_REGISTER_F(BM_HciLayer, command_burst)
+    ->ArgNames({"pipelined", "commands"})
+    ->Args({0, 10})
+    ->Args({1, 10})
+    ->Args({0, 50})
+    ->Args({1, 50})
+    ->Args({0, 200})
+    ->Args({1, 200})
+    ->Iterations(5)
+    ->UseRealTime();
+
+}  // namespace hci
+}  // namespace bluetooth
@@ -435,5 +435,172 @@ TEST_F(HciLayerTest, command_status_callback_is_invoked_with_failure_status) {
   sync_handler();
 }
 
+class HciLayerPipeliningTest : public HciLayerTest {
+ protected:
+  void SetUp() override {
+    HciLayerTest::SetUp();
+    SetPipelining(true);
+    FailIfResetNotSent();
+  }
+
+  void TearDown() override {
+    // Do not leave pipelining on for the tests that run after this one
+    InitFlags::Load(nullptr);
+    HciLayerTest::TearDown();
+  }
+
+  void SetPipelining(bool enabled) {
+    std::string flag = std::string("INIT_hci_command_pipelining=") + (enabled ? "true" : "false");
+    const char* flags[] = {flag.c_str(), nullptr};
+    InitFlags::Load(flags);
+  }
+
+  void ExpectSentCommand(OpCode op_code) {
+    auto sent_command = hal_->GetSentCommand();
+    ASSERT_TRUE(sent_command.has_value());
+    ASSERT_EQ(sent_command->GetOpCode(), op_code);
+  }
+
+  void ExpectNoSentCommand() {
+    sync_handler();
+    ASSERT_FALSE(hal_->GetSentCommand(std::chrono::milliseconds(10)).has_value());
+  }
+
+  template <typename TResponse>
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> command, std::promise<void>* promise) {
+    hci_->EnqueueCommand(
+        std::move(command), hci_handler_->BindOnce([](std::promise<void>* promise, TResponse) { promise->set_value(); }, promise));
+  }
+
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> command, std::promise<void>* promise) {
+    EnqueueCommand<CommandCompleteView>(std::move(command), promise);
+  }
+};
+
+TEST_F(HciLayerPipeliningTest, pipelined_commands_use_all_command_credits) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(3, ErrorCode::SUCCESS));
+  std::promise<void> promises[4];
+  for (auto& promise : promises) {
+    EnqueueCommand(ReadBdAddrBuilder::Create(), &promise);
+  }
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(1, ErrorCode::SUCCESS, Address::kEmpty));
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  for (int i = 0; i < 3; i++) {
+    hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(1, ErrorCode::SUCCESS, Address::kEmpty));
+  }
+  for (auto& promise : promises) {
+    ASSERT_EQ(promise.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  }
+}
+
+TEST_F(HciLayerPipeliningTest, responses_are_matched_by_opcode) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  std::promise<void> read_bd_addr;
+  std::promise<void> le_rand;
+  std::promise<void> read_clock_offset;
+  auto read_bd_addr_future = read_bd_addr.get_future();
+  EnqueueCommand(ReadBdAddrBuilder::Create(), &read_bd_addr);
+  EnqueueCommand(LeRandBuilder::Create(), &le_rand);
+  EnqueueCommand<CommandStatusView>(ReadClockOffsetBuilder::Create(0x0001), &read_clock_offset);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectSentCommand(OpCode::LE_RAND);
+  ExpectSentCommand(OpCode::READ_CLOCK_OFFSET);
+
+  hal_->InjectEvent(ReadClockOffsetStatusBuilder::Create(ErrorCode::SUCCESS, 5));
+  hal_->InjectEvent(LeRandCompleteBuilder::Create(5, ErrorCode::SUCCESS, 0x1234));
+  ASSERT_EQ(read_clock_offset.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  ASSERT_EQ(le_rand.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  sync_handler();
+  ASSERT_EQ(read_bd_addr_future.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+  hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(5, ErrorCode::SUCCESS, Address::kEmpty));
+  ASSERT_EQ(read_bd_addr_future.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+}
+
+TEST_F(HciLayerPipeliningTest, commands_not_pipelined_are_sent_alone) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  std::promise<void> promises[3];
+  EnqueueCommand(ReadBdAddrBuilder::Create(), &promises[0]);
+  EnqueueCommand(LeClearFilterAcceptListBuilder::Create(), &promises[1]);
+  EnqueueCommand(LeRandBuilder::Create(), &promises[2]);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(5, ErrorCode::SUCCESS, Address::kEmpty));
+  ExpectSentCommand(OpCode::LE_CLEAR_FILTER_ACCEPT_LIST);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(LeClearFilterAcceptListCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  ExpectSentCommand(OpCode::LE_RAND);
+  hal_->InjectEvent(LeRandCompleteBuilder::Create(5, ErrorCode::SUCCESS, 0x1234));
+  for (auto& promise : promises) {
+    ASSERT_EQ(promise.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  }
+}
+
+TEST_F(HciLayerPipeliningTest, one_command_at_a_time_when_disabled) {
+  SetPipelining(false);
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  std::promise<void> promises[2];
+  EnqueueCommand(ReadBdAddrBuilder::Create(), &promises[0]);
+  EnqueueCommand(LeRandBuilder::Create(), &promises[1]);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectNoSentCommand();
+
+  hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(5, ErrorCode::SUCCESS, Address::kEmpty));
+  ExpectSentCommand(OpCode::LE_RAND);
+  hal_->InjectEvent(LeRandCompleteBuilder::Create(5, ErrorCode::SUCCESS, 0x1234));
+  for (auto& promise : promises) {
+    ASSERT_EQ(promise.get_future().wait_for(std::chrono::seconds(1)), std::future_status::ready);
+  }
+}
+
+TEST_F(HciLayerPipeliningTest, timeout_is_for_the_oldest_waiting_command) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  std::promise<void> promises[2];
+  EnqueueCommand(ReadBdAddrBuilder::Create(), &promises[0]);
+  EnqueueCommand(LeRandBuilder::Create(), &promises[1]);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectSentCommand(OpCode::LE_RAND);
+
+  // Answering a newer command does not restart the timer of the oldest
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  hal_->InjectEvent(LeRandCompleteBuilder::Create(5, ErrorCode::SUCCESS, 0x1234));
+  sync_handler();
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  sync_handler();
+
+  auto sent_command = hal_->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  auto debug_info_view = ControllerDebugInfoView::Create(VendorCommandView::Create(*sent_command));
+  ASSERT_TRUE(debug_info_view.IsValid());
+}
+
+TEST_F(HciLayerPipeliningTest, timeout_is_rearmed_from_when_the_command_was_sent) {
+  hal_->InjectEvent(ResetCompleteBuilder::Create(5, ErrorCode::SUCCESS));
+  std::promise<void> promises[2];
+  EnqueueCommand(ReadBdAddrBuilder::Create(), &promises[0]);
+  EnqueueCommand(LeRandBuilder::Create(), &promises[1]);
+  ExpectSentCommand(OpCode::READ_BD_ADDR);
+  ExpectSentCommand(OpCode::LE_RAND);
+
+  // The timer of the next oldest command keeps the time it has already waited
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  hal_->InjectEvent(ReadBdAddrCompleteBuilder::Create(5, ErrorCode::SUCCESS, Address::kEmpty));
+  sync_handler();
+  FakeTimerAdvance(HciLayer::kHciTimeoutMs.count() / 2);
+  sync_handler();
+
+  auto sent_command = hal_->GetSentCommand();
+  ASSERT_TRUE(sent_command.has_value());
+  auto debug_info_view = ControllerDebugInfoView::Create(VendorCommandView::Create(*sent_command));
+  ASSERT_TRUE(debug_info_view.IsValid());
+}
+
 }  // namespace hci
 }  // namespace bluetooth
@@ -16,6 +16,10 @@
 
 #include "hci/le_address_manager.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "common/init_flags.h"
 #include "os/log.h"
 #include "os/rand.h"
@@ -241,6 +245,11 @@ void LeAddressManager::pause_registered_clients() {
         break;
       case WAITING_FOR_RESUME:
       case RESUMED:
+        if (!pause_start_) {
+          std::lock_guard<std::mutex> lock(pause_metrics_mutex_);
+          pause_start_ = std::chrono::steady_clock::now();
+          pause_count_++;
+        }
         client.second = ClientState::WAITING_FOR_PAUSE;
         client.first->OnPause();
         break;
@@ -250,7 +259,8 @@ void LeAddressManager::pause_registered_clients() {
 
 void LeAddressManager::push_command(Command command) {
   pause_registered_clients();
-  cached_commands_.push(std::move(command));
+  cached_commands_.push_back(std::move(command));
+  coalesce_cached_commands_ = true;
 }
 
 void LeAddressManager::ack_pause(LeAddressManagerCallback* callback) {
@@ -292,6 +302,17 @@ void LeAddressManager::resume_registered_clients() {
   }
 
   LOG_INFO("Resuming registered clients");
+  if (pause_start_) {
+    std::lock_guard<std::mutex> lock(pause_metrics_mutex_);
+    auto paused_time = std::chrono::steady_clock::now() - *pause_start_;
+    total_paused_time_ += paused_time;
+    pause_start_.reset();
+    LOG_DEBUG(
+        "Paused for %lld ms (%zu pauses, %lld ms in total)",
+        (long long)std::chrono::duration_cast<std::chrono::milliseconds>(paused_time).count(),
+        pause_count_,
+        (long long)std::chrono::duration_cast<std::chrono::milliseconds>(total_paused_time_).count());
+  }
   for (auto& client : registered_clients_) {
     client.second = ClientState::WAITING_FOR_RESUME;
     client.first->OnResume();
@@ -306,7 +327,7 @@ void LeAddressManager::ack_resume(LeAddressManagerCallback* callback) {
 
 void LeAddressManager::prepare_to_rotate() {
   Command command = {CommandType::ROTATE_RANDOM_ADDRESS, RotateRandomAddressCommand{}};
-  cached_commands_.push(std::move(command));
+  cached_commands_.push_back(std::move(command));
   pause_registered_clients();
 }
 
@@ -347,7 +368,7 @@ void LeAddressManager::rotate_random_address() {
 
 void LeAddressManager::prepare_to_update_irk(UpdateIRKCommand update_irk_command) {
   Command command = {CommandType::UPDATE_IRK, update_irk_command};
-  cached_commands_.push(std::move(command));
+  cached_commands_.push_back(std::move(command));
   if (registered_clients_.empty()) {
     handle_next_command();
   } else {
@@ -441,9 +462,19 @@ void LeAddressManager::handle_next_command() {
     }
   }
 
+  if (coalesce_cached_commands_) {
+    coalesce_cached_commands();
+    if (cached_commands_.empty()) {
+      // The list commands cancelled each other out
+      resume_registered_clients();
+      return;
+    }
+  }
+
   ASSERT(!cached_commands_.empty());
   auto command = std::move(cached_commands_.front());
-  cached_commands_.pop();
+  cached_commands_.pop_front();
+  update_lists(command);
 
   std::visit(
       [this](auto&& command) {
@@ -461,10 +492,174 @@ void LeAddressManager::handle_next_command() {
       command.contents);
 }
 
+// Rewrites the list commands cached since the clients were paused into the fewest commands with the same effect on
+// the controller lists: only the last update of each device is kept, and only if it changes the list, the removals go
+// before the additions so that a full list does not reject them, and the resolving list updates share a single pair
+// of commands disabling and enabling address resolution. The additions that do not fit in a list are dropped.
+void LeAddressManager::coalesce_cached_commands() {
+  coalesce_cached_commands_ = false;
+  size_t num_cached = cached_commands_.size();
+
+  std::deque<Command> other_commands;
+  std::optional<Command> clear_filter_accept_list;
+  std::map<ListEntry, Command> filter_accept_list_updates;
+  std::optional<Command> clear_resolving_list;
+  std::map<ListEntry, std::vector<Command>> resolving_list_updates;
+  bool address_resolution_enable_cached = false;
+  for (auto& command : cached_commands_) {
+    switch (command.command_type) {
+      case CommandType::ADD_DEVICE_TO_CONNECT_LIST:
+      case CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST:
+        filter_accept_list_updates.insert_or_assign(command.list_entry, std::move(command));
+        break;
+      case CommandType::CLEAR_CONNECT_LIST:
+        filter_accept_list_updates.clear();
+        clear_filter_accept_list = std::move(command);
+        break;
+      case CommandType::ADD_DEVICE_TO_RESOLVING_LIST:
+      case CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST:
+      case CommandType::LE_SET_PRIVACY_MODE:
+        resolving_list_updates[command.list_entry].push_back(std::move(command));
+        break;
+      case CommandType::CLEAR_RESOLVING_LIST:
+        resolving_list_updates.clear();
+        clear_resolving_list = std::move(command);
+        break;
+      case CommandType::SET_ADDRESS_RESOLUTION_ENABLE:
+        // Added back around the resolving list updates below
+        address_resolution_enable_cached = true;
+        break;
+      default:
+        other_commands.push_back(std::move(command));
+        break;
+    }
+  }
+
+  std::deque<Command> removals;
+  std::deque<Command> additions;
+  for (auto& [entry, command] : filter_accept_list_updates) {
+    bool in_list = !clear_filter_accept_list && filter_accept_list_.count(entry) != 0;
+    if (command.command_type == CommandType::ADD_DEVICE_TO_CONNECT_LIST && !in_list) {
+      additions.push_back(std::move(command));
+    } else if (command.command_type == CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST && in_list) {
+      removals.push_back(std::move(command));
+    }
+  }
+  // The controller would reject the additions that do not fit
+  size_t filter_accept_list_size = (clear_filter_accept_list ? 0 : filter_accept_list_.size()) - removals.size();
+  size_t filter_accept_list_room =
+      connect_list_size_ > filter_accept_list_size ? connect_list_size_ - filter_accept_list_size : 0;
+  if (additions.size() > filter_accept_list_room) {
+    LOG_ERROR(
+        "Filter accept list of %d entries is full, dropping %zu of %zu additions",
+        connect_list_size_,
+        additions.size() - filter_accept_list_room,
+        additions.size());
+    additions.erase(additions.begin() + filter_accept_list_room, additions.end());
+  }
+  cached_commands_ = std::move(other_commands);
+  if (clear_filter_accept_list) {
+    cached_commands_.push_back(std::move(*clear_filter_accept_list));
+  }
+  std::move(removals.begin(), removals.end(), std::back_inserter(cached_commands_));
+  std::move(additions.begin(), additions.end(), std::back_inserter(cached_commands_));
+
+  removals.clear();
+  additions.clear();
+  // Each addition with the privacy mode set after it
+  std::deque<std::vector<Command>> added_devices;
+  for (auto& [entry, commands] : resolving_list_updates) {
+    bool in_list = !clear_resolving_list && resolving_list_.count(entry) != 0;
+    // Only the commands after the last removal matter, and among them the last addition and its privacy mode. An
+    // addition after a removal replaces the entry, e.g. with a new IRK.
+    auto last_removal = std::find_if(commands.rbegin(), commands.rend(), [](const Command& command) {
+      return command.command_type == CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST;
+    });
+    bool removed = last_removal != commands.rend();
+    auto last_addition = std::find_if(commands.rbegin(), last_removal, [](const Command& command) {
+      return command.command_type == CommandType::ADD_DEVICE_TO_RESOLVING_LIST;
+    });
+    bool added = last_addition != last_removal;
+    if (removed && in_list) {
+      removals.push_back(std::move(*last_removal));
+    }
+    if (added && (removed || !in_list)) {
+      added_devices.emplace_back(
+          std::make_move_iterator(std::prev(last_addition.base())), std::make_move_iterator(commands.end()));
+    } else if (!added && !removed) {
+      // The privacy mode of a device added just before
+      std::move(commands.begin(), commands.end(), std::back_inserter(additions));
+    }
+  }
+  size_t resolving_list_size = (clear_resolving_list ? 0 : resolving_list_.size()) - removals.size();
+  size_t resolving_list_room =
+      resolving_list_size_ > resolving_list_size ? resolving_list_size_ - resolving_list_size : 0;
+  if (added_devices.size() > resolving_list_room) {
+    LOG_ERROR(
+        "Resolving list of %d entries is full, dropping %zu of %zu additions",
+        resolving_list_size_,
+        added_devices.size() - resolving_list_room,
+        added_devices.size());
+    added_devices.erase(added_devices.begin() + resolving_list_room, added_devices.end());
+  }
+  for (auto& commands : added_devices) {
+    std::move(commands.begin(), commands.end(), std::back_inserter(additions));
+  }
+  if (clear_resolving_list || !removals.empty() || !additions.empty()) {
+    auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
+    cached_commands_.push_back({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}});
+    if (clear_resolving_list) {
+      cached_commands_.push_back(std::move(*clear_resolving_list));
+    }
+    std::move(removals.begin(), removals.end(), std::back_inserter(cached_commands_));
+    std::move(additions.begin(), additions.end(), std::back_inserter(cached_commands_));
+    auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
+    cached_commands_.push_back({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}});
+  } else if (address_resolution_enable_cached) {
+    // Only enabling address resolution is left of the updates sent before
+    auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
+    cached_commands_.push_back({CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}});
+  }
+
+  if (num_cached != cached_commands_.size()) {
+    LOG_DEBUG("Coalesced %zu cached commands into %zu", num_cached, cached_commands_.size());
+  }
+}
+
+void LeAddressManager::update_lists(const Command& command) {
+  switch (command.command_type) {
+    case CommandType::ADD_DEVICE_TO_CONNECT_LIST:
+      filter_accept_list_.insert(command.list_entry);
+      sent_addition_ = std::make_pair(command.command_type, command.list_entry);
+      break;
+    case CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST:
+      filter_accept_list_.erase(command.list_entry);
+      break;
+    case CommandType::CLEAR_CONNECT_LIST:
+      filter_accept_list_.clear();
+      break;
+    case CommandType::ADD_DEVICE_TO_RESOLVING_LIST:
+      resolving_list_.insert(command.list_entry);
+      sent_addition_ = std::make_pair(command.command_type, command.list_entry);
+      break;
+    case CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST:
+      resolving_list_.erase(command.list_entry);
+      break;
+    case CommandType::CLEAR_RESOLVING_LIST:
+      resolving_list_.clear();
+      break;
+    default:
+      break;
+  }
+}
+
 void LeAddressManager::AddDeviceToFilterAcceptList(
     FilterAcceptListAddressType connect_list_address_type, bluetooth::hci::Address address) {
   auto packet_builder = hci::LeAddDeviceToFilterAcceptListBuilder::Create(connect_list_address_type, address);
-  Command command = {CommandType::ADD_DEVICE_TO_CONNECT_LIST, HCICommand{std::move(packet_builder)}};
+  Command command = {
+      CommandType::ADD_DEVICE_TO_CONNECT_LIST,
+      HCICommand{std::move(packet_builder)},
+      ListEntry{static_cast<uint8_t>(connect_list_address_type), address}};
   handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command)).Invoke();
 }
 
@@ -480,24 +675,26 @@ void LeAddressManager::AddDeviceToResolvingList(
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
   Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}};
-  cached_commands_.push(std::move(disable));
+  cached_commands_.push_back(std::move(disable));
 
   auto packet_builder = hci::LeAddDeviceToResolvingListBuilder::Create(
       peer_identity_address_type, peer_identity_address, peer_irk, local_irk);
-  Command command = {CommandType::ADD_DEVICE_TO_RESOLVING_LIST, HCICommand{std::move(packet_builder)}};
-  cached_commands_.push(std::move(command));
+  ListEntry entry{static_cast<uint8_t>(peer_identity_address_type), peer_identity_address};
+  Command command = {CommandType::ADD_DEVICE_TO_RESOLVING_LIST, HCICommand{std::move(packet_builder)}, entry};
+  cached_commands_.push_back(std::move(command));
 
   if (supports_ble_privacy_) {
     auto packet_builder =
         hci::LeSetPrivacyModeBuilder::Create(peer_identity_address_type, peer_identity_address, PrivacyMode::DEVICE);
-    Command command = {CommandType::LE_SET_PRIVACY_MODE, HCICommand{std::move(packet_builder)}};
-    cached_commands_.push(std::move(command));
+    Command command = {CommandType::LE_SET_PRIVACY_MODE, HCICommand{std::move(packet_builder)}, entry};
+    cached_commands_.push_back(std::move(command));
   }
 
   // Enable Address resolution
   auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
   Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}};
-  cached_commands_.push(std::move(enable));
+  cached_commands_.push_back(std::move(enable));
+  coalesce_cached_commands_ = true;
 
   if (registered_clients_.empty()) {
     handler_->BindOnceOn(this, &LeAddressManager::handle_next_command).Invoke();
@@ -509,7 +706,10 @@ void LeAddressManager::AddDeviceToResolvingList(
 void LeAddressManager::RemoveDeviceFromFilterAcceptList(
     FilterAcceptListAddressType connect_list_address_type, bluetooth::hci::Address address) {
   auto packet_builder = hci::LeRemoveDeviceFromFilterAcceptListBuilder::Create(connect_list_address_type, address);
-  Command command = {CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST, HCICommand{std::move(packet_builder)}};
+  Command command = {
+      CommandType::REMOVE_DEVICE_FROM_CONNECT_LIST,
+      HCICommand{std::move(packet_builder)},
+      ListEntry{static_cast<uint8_t>(connect_list_address_type), address}};
   handler_->BindOnceOn(this, &LeAddressManager::push_command, std::move(command)).Invoke();
 }
 
@@ -522,17 +722,21 @@ void LeAddressManager::RemoveDeviceFromResolvingList(
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
   Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}};
-  cached_commands_.push(std::move(disable));
+  cached_commands_.push_back(std::move(disable));
 
   auto packet_builder =
       hci::LeRemoveDeviceFromResolvingListBuilder::Create(peer_identity_address_type, peer_identity_address);
-  Command command = {CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST, HCICommand{std::move(packet_builder)}};
-  cached_commands_.push(std::move(command));
+  Command command = {
+      CommandType::REMOVE_DEVICE_FROM_RESOLVING_LIST,
+      HCICommand{std::move(packet_builder)},
+      ListEntry{static_cast<uint8_t>(peer_identity_address_type), peer_identity_address}};
+  cached_commands_.push_back(std::move(command));
 
   // Enable Address resolution
   auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
   Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}};
-  cached_commands_.push(std::move(enable));
+  cached_commands_.push_back(std::move(enable));
+  coalesce_cached_commands_ = true;
 
   if (registered_clients_.empty()) {
     handler_->BindOnceOn(this, &LeAddressManager::handle_next_command).Invoke();
@@ -555,28 +759,30 @@ void LeAddressManager::ClearResolvingList() {
   // Disable Address resolution
   auto disable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::DISABLED);
   Command disable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(disable_builder)}};
-  cached_commands_.push(std::move(disable));
+  cached_commands_.push_back(std::move(disable));
 
   auto packet_builder = hci::LeClearResolvingListBuilder::Create();
   Command command = {CommandType::CLEAR_RESOLVING_LIST, HCICommand{std::move(packet_builder)}};
-  cached_commands_.push(std::move(command));
+  cached_commands_.push_back(std::move(command));
 
   // Enable Address resolution
   auto enable_builder = hci::LeSetAddressResolutionEnableBuilder::Create(hci::Enable::ENABLED);
   Command enable = {CommandType::SET_ADDRESS_RESOLUTION_ENABLE, HCICommand{std::move(enable_builder)}};
-  cached_commands_.push(std::move(enable));
+  cached_commands_.push_back(std::move(enable));
+  coalesce_cached_commands_ = true;
 
   handler_->BindOnceOn(this, &LeAddressManager::pause_registered_clients).Invoke();
 }
 
+// Returns false if the command failed
 template <class View>
-void LeAddressManager::on_command_complete(CommandCompleteView view) {
+bool LeAddressManager::on_command_complete(CommandCompleteView view) {
   auto op_code = view.GetCommandOpCode();
 
   auto complete_view = View::Create(view);
   if (!complete_view.IsValid()) {
     LOG_ERROR("Received %s complete with invalid packet", hci::OpCodeText(op_code).c_str());
-    return;
+    return false;
   }
   auto status = complete_view.GetStatus();
   if (status != ErrorCode::SUCCESS) {
@@ -584,7 +790,9 @@ void LeAddressManager::on_command_complete(CommandCompleteView view) {
         "Received %s complete with status %s",
         hci::OpCodeText(op_code).c_str(),
         ErrorCodeText(complete_view.GetStatus()).c_str());
+    return false;
   }
+  return true;
 }
 
 void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView view) {
@@ -624,7 +832,11 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST:
-      on_command_complete<LeAddDeviceToResolvingListCompleteView>(view);
+      if (!on_command_complete<LeAddDeviceToResolvingListCompleteView>(view) && sent_addition_ &&
+          sent_addition_->first == CommandType::ADD_DEVICE_TO_RESOLVING_LIST) {
+        resolving_list_.erase(sent_addition_->second);
+      }
+      sent_addition_.reset();
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_RESOLVING_LIST:
@@ -636,7 +848,11 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
       break;
 
     case OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST:
-      on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view);
+      if (!on_command_complete<LeAddDeviceToFilterAcceptListCompleteView>(view) && sent_addition_ &&
+          sent_addition_->first == CommandType::ADD_DEVICE_TO_CONNECT_LIST) {
+        filter_accept_list_.erase(sent_addition_->second);
+      }
+      sent_addition_.reset();
       break;
 
     case OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST:
@@ -15,9 +15,13 @@
  */
 #pragma once
 
+#include <chrono>
+#include <deque>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <tuple>
 #include <variant>
 
 #include "common/callback.h"
@@ -104,6 +108,16 @@ class LeAddressManager {
     return cached_commands_.size();
   }
 
+  // Number of times the registered clients were paused, and the time they spent paused, since the start
+  size_t GetPauseCount() const {
+    std::lock_guard<std::mutex> lock(pause_metrics_mutex_);
+    return pause_count_;
+  }
+  std::chrono::milliseconds GetTotalPausedTime() const {
+    std::lock_guard<std::mutex> lock(pause_metrics_mutex_);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(total_paused_time_);
+  }
+
  protected:
   AddressPolicy address_policy_ = AddressPolicy::POLICY_NOT_SET;
   std::chrono::milliseconds minimum_rotation_time_;
@@ -142,9 +156,19 @@ class LeAddressManager {
     std::unique_ptr<CommandBuilder> command;
   };
 
+  // The device a filter accept list or resolving list command applies to
+  struct ListEntry {
+    uint8_t address_type;
+    Address address;
+    bool operator<(const ListEntry& other) const {
+      return std::tie(address_type, address) < std::tie(other.address_type, other.address);
+    }
+  };
+
   struct Command {
-    CommandType command_type;  // Note that this field is only intended for logging, not control flow
+    CommandType command_type;  // Note that this field is only intended for logging and coalescing list commands
     std::variant<RotateRandomAddressCommand, UpdateIRKCommand, HCICommand> contents;
+    ListEntry list_entry{};  // Only for the commands adding or removing a device
   };
 
   void pause_registered_clients();
@@ -163,9 +187,11 @@ class LeAddressManager {
   hci::Address generate_rpa();
   hci::Address generate_nrpa();
   void handle_next_command();
+  void coalesce_cached_commands();
+  void update_lists(const Command& command);
   void check_cached_commands();
   template <class View>
-  void on_command_complete(CommandCompleteView view);
+  bool on_command_complete(CommandCompleteView view);
 
   common::Callback<void(std::unique_ptr<CommandBuilder>)> enqueue_command_;
   os::Handler* handler_;
@@ -178,8 +204,21 @@ class LeAddressManager {
   crypto_toolbox::Octet16 rotation_irk_;
   uint8_t connect_list_size_;
   uint8_t resolving_list_size_;
-  std::queue<Command> cached_commands_;
+  std::deque<Command> cached_commands_;
+  // Set when list commands were cached since the cached commands were last coalesced
+  bool coalesce_cached_commands_{false};
   bool supports_ble_privacy_{false};
+
+  // The devices in the controller lists, updated when the commands are sent and reverted if adding fails
+  std::set<ListEntry> filter_accept_list_;
+  std::set<ListEntry> resolving_list_;
+  std::optional<std::pair<CommandType, ListEntry>> sent_addition_;
+
+  // Updated on the handler, read from any thread
+  mutable std::mutex pause_metrics_mutex_;
+  size_t pause_count_{0};
+  std::chrono::steady_clock::duration total_paused_time_{};
+  std::optional<std::chrono::steady_clock::time_point> pause_start_;
 };
 
 }  // namespace hci
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "common/bind.h"
+#include "hci/le_address_manager.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace hci {
+
+namespace {
+
+packet::PacketView<packet::kLittleEndian> GetPacketView(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  packet::BitInserter i(*bytes);
+  bytes->reserve(packet->size());
+  packet->Serialize(i);
+  return packet::PacketView<packet::kLittleEndian>(bytes);
+}
+
+class BenchmarkClient : public LeAddressManagerCallback {
+ public:
+  explicit BenchmarkClient(LeAddressManager* le_address_manager) : le_address_manager_(le_address_manager) {}
+
+  void OnPause() override {
+    le_address_manager_->AckPause(this);
+  }
+
+  void OnResume() override {
+    le_address_manager_->AckResume(this);
+    if (resumed_ != nullptr) {
+      resumed_->set_value();
+      resumed_ = nullptr;
+    }
+  }
+
+  // Set on the handler, to the promise of the next resume
+  std::promise<void>* resumed_ = nullptr;
+
+ private:
+  LeAddressManager* le_address_manager_;
+};
+
+}  // namespace
+
+// LeAddressManager with one client, on a controller that completes every command right away
+class BM_LeAddressManager : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = std::make_unique<os::Thread>("le_address_manager_benchmark", os::Thread::Priority::NORMAL);
+    handler_ = std::make_unique<os::Handler>(thread_.get());
+    Address address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06});
+    le_address_manager_ = std::make_unique<LeAddressManager>(
+        common::Bind(&BM_LeAddressManager::EnqueueCommand, common::Unretained(this)),
+        handler_.get(),
+        address,
+        0xFF,
+        0xFF);
+    client_ = std::make_unique<BenchmarkClient>(le_address_manager_.get());
+
+    crypto_toolbox::Octet16 irk = {};
+    AddressWithType remote_address(Address::kEmpty, AddressType::RANDOM_DEVICE_ADDRESS);
+    le_address_manager_->SetPrivacyPolicyForInitiatorAddress(
+        LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
+        remote_address,
+        irk,
+        true,
+        std::chrono::minutes(7),
+        std::chrono::minutes(15));
+    RunUntilResumed(common::BindOnce(
+        &LeAddressManager::Register, common::Unretained(le_address_manager_.get()), client_.get()));
+  }
+
+  void TearDown(State& st) override {
+    le_address_manager_->Unregister(client_.get());
+    std::promise<void> promise;
+    handler_->Post(common::BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)));
+    promise.get_future().wait();
+    le_address_manager_ = nullptr;
+    client_ = nullptr;
+    handler_->Clear();
+    handler_ = nullptr;
+    thread_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void EnqueueCommand(std::unique_ptr<CommandBuilder> command) {
+    auto op_code = CommandView::Create(GetPacketView(std::move(command))).GetOpCode();
+    auto event = EventView::Create(GetPacketView(CommandCompleteBuilder::Create(
+        0x01, op_code, std::make_unique<packet::RawBuilder>(std::vector<uint8_t>{0x00}))));
+    commands_sent_++;
+    handler_->CallOn(
+        le_address_manager_.get(), &LeAddressManager::OnCommandComplete, CommandCompleteView::Create(event));
+  }
+
+  // Runs |task| on the handler, and waits for the client to be resumed after it
+  void RunUntilResumed(common::OnceClosure task) {
+    std::promise<void> resumed;
+    auto future = resumed.get_future();
+    handler_->Post(common::BindOnce(
+        [](BenchmarkClient* client, std::promise<void>* resumed, common::OnceClosure task) {
+          client->resumed_ = resumed;
+          std::move(task).Run();
+        },
+        client_.get(),
+        &resumed,
+        std::move(task)));
+    future.wait();
+  }
+
+  // Adds or removes |num_devices| devices to both lists, as the ACL manager does when loading the bonded devices
+  static void LoadDevices(LeAddressManager* le_address_manager, size_t num_devices, bool remove) {
+    crypto_toolbox::Octet16 irk = {};
+    for (size_t i = 0; i < num_devices; i++) {
+      Address address({0x01, 0x02, 0x03, 0x04, (uint8_t)(i >> 8), (uint8_t)i});
+      if (remove) {
+        le_address_manager->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::PUBLIC, address);
+        le_address_manager->RemoveDeviceFromResolvingList(PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, address);
+      } else {
+        le_address_manager->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::PUBLIC, address);
+        le_address_manager->AddDeviceToResolvingList(
+            PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, address, irk, irk);
+      }
+    }
+  }
+
+  std::unique_ptr<os::Thread> thread_;
+  std::unique_ptr<os::Handler> handler_;
+  std::unique_ptr<LeAddressManager> le_address_manager_;
+  std::unique_ptr<BenchmarkClient> client_;
+  std::atomic<size_t> commands_sent_{0};
+};
+
+// Adding every bonded device to the filter accept list and resolving list at once, and removing them again. Without
+// coalescing, every device takes five commands to add and four to remove.
+BENCHMARK_DEFINE_F(BM_LeAddressManager, bulk_load)(State& state) {
+  const size_t num_devices = state.range(0);
+  size_t commands_sent = commands_sent_;
+  size_t pauses = le_address_manager_->GetPauseCount();
+  for (auto _ : state) {
+    RunUntilResumed(common::BindOnce(&LoadDevices, le_address_manager_.get(), num_devices, false));
+    RunUntilResumed(common::BindOnce(&LoadDevices, le_address_manager_.get(), num_devices, true));
+  }
+  state.counters["commands"] =
+      ::benchmark::Counter(commands_sent_ - commands_sent, ::benchmark::Counter::kAvgIterations);
+  state.counters["pauses"] =
+      ::benchmark::Counter(le_address_manager_->GetPauseCount() - pauses, ::benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK_REGISTER_F(BM_LeAddressManager, bulk_load)->Arg(10)->Arg(50)->Arg(200)->UseRealTime();
+
+}  // namespace hci
+}  // namespace bluetooth
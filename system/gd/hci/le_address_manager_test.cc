@@ -18,6 +18,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+
 #include "common/init_flags.h"
 #include "os/log.h"
 #include "packet/raw_builder.h"
@@ -53,6 +56,15 @@ class TestHciLayer : public HciLayer {
   void EnqueueCommand(
       std::unique_ptr<CommandBuilder> command,
       common::ContextualOnceCallback<void(CommandCompleteView)> on_complete) override {
+    if (auto_complete_) {
+      // Completes every command right away, without keeping it
+      auto op_code = CommandView::Create(GetPacketView(std::move(command))).GetOpCode();
+      auto event = EventView::Create(GetPacketView(
+          CommandCompleteBuilder::Create(0x01, op_code, std::make_unique<RawBuilder>(std::vector<uint8_t>{0x00}))));
+      number_auto_completed_++;
+      std::move(on_complete).Invoke(CommandCompleteView::Create(event));
+      return;
+    }
     std::lock_guard<std::mutex> lock(mutex_);
     command_queue_.push(std::move(command));
     command_complete_callbacks.push_back(std::move(on_complete));
@@ -98,6 +110,19 @@ class TestHciLayer : public HciLayer {
     return command_packet_view;
   }
 
+  bool IsCommandQueueEmpty() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return command_queue_.empty();
+  }
+
+  void SetAutoComplete(bool auto_complete) {
+    auto_complete_ = auto_complete;
+  }
+
+  size_t NumberAutoCompleted() const {
+    return number_auto_completed_;
+  }
+
   void IncomingEvent(std::unique_ptr<EventBuilder> event_builder) {
     auto packet = GetPacketView(std::move(event_builder));
     EventView event = EventView::Create(packet);
@@ -122,6 +147,8 @@ class TestHciLayer : public HciLayer {
   std::unique_ptr<std::promise<void>> command_promise_;
   std::unique_ptr<std::future<void>> command_future_;
   mutable std::mutex mutex_;
+  std::atomic<bool> auto_complete_{false};
+  std::atomic<size_t> number_auto_completed_{0};
 };
 
 class RotatorClient : public LeAddressManagerCallback {
@@ -311,7 +338,7 @@ class LeAddressManagerWithSingleClientTest : public LeAddressManagerTest {
         LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
         remote_address,
         irk,
-        false,
+        supports_ble_privacy_,
         minimum_rotation_time,
         maximum_rotation_time);
 
@@ -337,6 +364,8 @@ class LeAddressManagerWithSingleClientTest : public LeAddressManagerTest {
     delete handler_;
     delete thread_;
   }
+
+  bool supports_ble_privacy_ = false;
 };
 
 TEST_F(LeAddressManagerWithSingleClientTest, add_device_to_connect_list) {
@@ -542,6 +571,202 @@ TEST_F(LeAddressManagerWithSingleClientTest, register_during_command_complete) {
   clients[1].get()->WaitForResume();
 }
 
+TEST_F(LeAddressManagerWithSingleClientTest, coalesce_filter_accept_list_updates) {
+  Address first, second, third;
+  Address::FromString("01:02:03:04:05:06", first);
+  Address::FromString("01:02:03:04:05:07", second);
+  Address::FromString("01:02:03:04:05:08", third);
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, first);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+
+  // Queued while the clients are paused for the first one
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, second);
+  le_address_manager_->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::RANDOM, second);
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, third);
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, third);
+  le_address_manager_->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::RANDOM, first);
+  sync_handler(handler_);
+  ASSERT_EQ(5UL, le_address_manager_->NumberCachedCommands());
+
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_REMOVE_DEVICE_FROM_FILTER_ACCEPT_LIST);
+    auto packet_view = LeRemoveDeviceFromFilterAcceptListView::Create(
+        LeConnectionManagementCommandView::Create(AclCommandView::Create(packet)));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(first, packet_view.GetAddress());
+  }
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeRemoveDeviceFromFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+    auto packet_view = LeAddDeviceToFilterAcceptListView::Create(
+        LeConnectionManagementCommandView::Create(AclCommandView::Create(packet)));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(third, packet_view.GetAddress());
+  }
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+  sync_handler(handler_);
+
+  ASSERT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+  ASSERT_EQ(1UL, le_address_manager_->GetPauseCount());
+}
+
+TEST_F(LeAddressManagerWithSingleClientTest, skip_updates_not_changing_filter_accept_list) {
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+
+  // Already in the list, only pauses and resumes the clients
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  sync_handler(handler_);  // |LeAddressManager::push_command|
+  sync_handler(handler_);  // |LeAddressManager::ack_pause|
+
+  ASSERT_FALSE(clients[0]->paused);
+  ASSERT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+  ASSERT_EQ(0UL, le_address_manager_->NumberCachedCommands());
+  ASSERT_EQ(2UL, le_address_manager_->GetPauseCount());
+}
+
+TEST_F(LeAddressManagerWithSingleClientTest, retry_failed_filter_accept_list_addition) {
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  test_hci_layer_->IncomingEvent(
+      LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  clients[0].get()->WaitForResume();
+
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+}
+
+class LeAddressManagerWithPrivacyTest : public LeAddressManagerWithSingleClientTest {
+ public:
+  void SetUp() override {
+    supports_ble_privacy_ = true;
+    LeAddressManagerWithSingleClientTest::SetUp();
+  }
+
+  // Adds and removes |num_devices| devices to both lists, from the handler as the ACL manager does
+  static void LoadDevices(LeAddressManager* le_address_manager, size_t num_devices, bool remove) {
+    Octet16 irk = {};
+    for (size_t i = 0; i < num_devices; i++) {
+      Address address({0x01, 0x02, 0x03, (uint8_t)(i >> 16), (uint8_t)(i >> 8), (uint8_t)i});
+      if (remove) {
+        le_address_manager->RemoveDeviceFromFilterAcceptList(FilterAcceptListAddressType::PUBLIC, address);
+        le_address_manager->RemoveDeviceFromResolvingList(PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, address);
+      } else {
+        le_address_manager->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::PUBLIC, address);
+        le_address_manager->AddDeviceToResolvingList(
+            PeerAddressType::PUBLIC_DEVICE_OR_IDENTITY_ADDRESS, address, irk, irk);
+      }
+    }
+  }
+};
+
+TEST_F(LeAddressManagerWithPrivacyTest, coalesce_resolving_list_updates) {
+  Address first, second;
+  Address::FromString("01:02:03:04:05:06", first);
+  Address::FromString("01:02:03:04:05:07", second);
+  Octet16 peer_irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05, 0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+  Octet16 local_irk = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, first);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+
+  // Queued while the clients are paused for the filter accept list
+  le_address_manager_->AddDeviceToResolvingList(
+      PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, first, peer_irk, local_irk);
+  le_address_manager_->AddDeviceToResolvingList(
+      PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, second, peer_irk, local_irk);
+  le_address_manager_->RemoveDeviceFromResolvingList(PeerAddressType::RANDOM_DEVICE_OR_IDENTITY_ADDRESS, second);
+  sync_handler(handler_);
+  ASSERT_EQ(11UL, le_address_manager_->NumberCachedCommands());
+
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE);
+    auto packet_view = LeSetAddressResolutionEnableView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(Enable::DISABLED, packet_view.GetAddressResolutionEnable());
+  }
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_RESOLVING_LIST);
+    auto packet_view = LeAddDeviceToResolvingListView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(first, packet_view.GetPeerIdentityAddress());
+    ASSERT_EQ(peer_irk, packet_view.GetPeerIrk());
+  }
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeAddDeviceToResolvingListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_SET_PRIVACY_MODE);
+    auto packet_view = LeSetPrivacyModeView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(first, packet_view.GetPeerIdentityAddress());
+  }
+  ASSERT_NO_FATAL_FAILURE(test_hci_layer_->SetCommandFuture());
+  test_hci_layer_->IncomingEvent(LeSetPrivacyModeCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  {
+    auto packet = test_hci_layer_->GetCommand(OpCode::LE_SET_ADDRESS_RESOLUTION_ENABLE);
+    auto packet_view = LeSetAddressResolutionEnableView::Create(LeSecurityCommandView::Create(packet));
+    ASSERT_TRUE(packet_view.IsValid());
+    ASSERT_EQ(Enable::ENABLED, packet_view.GetAddressResolutionEnable());
+  }
+  test_hci_layer_->IncomingEvent(LeSetAddressResolutionEnableCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  clients[0].get()->WaitForResume();
+  sync_handler(handler_);
+
+  ASSERT_TRUE(test_hci_layer_->IsCommandQueueEmpty());
+  ASSERT_EQ(1UL, le_address_manager_->GetPauseCount());
+}
+
+TEST_F(LeAddressManagerWithPrivacyTest, bulk_load_in_one_pause) {
+  test_hci_layer_->SetAutoComplete(true);
+  handler_->Post(common::BindOnce(
+      &LeAddressManagerWithPrivacyTest::LoadDevices, common::Unretained(le_address_manager_), 20, false));
+  sync_handler(handler_);
+  while (clients[0]->paused) sync_handler(handler_);
+
+  // The two lists, and one pair of commands disabling and enabling address resolution
+  ASSERT_EQ(20UL + 2 * 20 + 2, test_hci_layer_->NumberAutoCompleted());
+  ASSERT_EQ(1UL, le_address_manager_->GetPauseCount());
+}
+
+TEST_F(LeAddressManagerWithPrivacyTest, drop_additions_beyond_list_size) {
+  test_hci_layer_->SetAutoComplete(true);
+  handler_->Post(common::BindOnce(
+      &LeAddressManagerWithPrivacyTest::LoadDevices, common::Unretained(le_address_manager_), 0x3F + 5, false));
+  sync_handler(handler_);
+  while (clients[0]->paused) sync_handler(handler_);
+
+  // Only the first 0x3F devices fit in each list
+  ASSERT_EQ(0x3FUL + 2 * 0x3F + 2, test_hci_layer_->NumberAutoCompleted());
+
+  // The dropped devices are not removed
+  size_t sent = test_hci_layer_->NumberAutoCompleted();
+  handler_->Post(common::BindOnce(
+      &LeAddressManagerWithPrivacyTest::LoadDevices, common::Unretained(le_address_manager_), 0x3F + 5, true));
+  sync_handler(handler_);
+  while (clients[0]->paused) sync_handler(handler_);
+  ASSERT_EQ(sent + 0x3F + 0x3F + 2, test_hci_layer_->NumberAutoCompleted());
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -15,8 +15,11 @@
  */
 #include "hci/le_advertising_manager.h"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 #include "common/init_flags.h"
 #include "common/strings.h"
@@ -76,9 +79,22 @@ struct Advertiser {
   bool discoverable = false;
   bool directed = false;
   bool in_use = false;
+  bool legacy_pdus = false;
+  bool periodic_enabled = false;
+  bool periodic_include_adi = false;
   std::unique_ptr<os::Alarm> address_rotation_alarm;
+  // The data the controller was last given, to skip the updates that do not change it
+  std::optional<std::vector<GapData>> advertising_data;
+  std::optional<std::vector<GapData>> scan_response_data;
+  std::optional<std::vector<GapData>> periodic_data;
 };
 
+static bool is_same_data(const std::vector<GapData>& a, const std::vector<GapData>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const GapData& x, const GapData& y) {
+    return x.data_type_ == y.data_type_ && x.data_ == y.data_;
+  });
+}
+
 /**
  * Determines the address type to use, based on the requested type and the address manager policy,
  * by selecting the "strictest" of the two. Strictness is defined in ascending order as
@@ -197,6 +213,16 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     return num_instances_;
   }
 
+  LeAdvertisingManager::CommandCounts get_command_counts() const {
+    return LeAdvertisingManager::CommandCounts{
+        commands_sent_,
+        enable_commands_,
+        sets_enabled_,
+        data_updates_skipped_,
+        unchanged_data_updates_,
+    };
+  }
+
   AdvertisingApiType get_advertising_api_type() const {
     return advertising_api_type_;
   }
@@ -348,7 +374,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
     if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeRemoveAdvertisingSetBuilder::Create(advertiser_id),
           module_handler_->BindOnce(impl::check_status<LeRemoveAdvertisingSetCompleteView>));
 
@@ -456,7 +482,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         }
         set_data(id, false, config.advertisement);
         if (advertising_sets_[id].address_type != AdvertiserAddressType::PUBLIC) {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeMultiAdvtSetRandomAddrBuilder::Create(advertising_sets_[id].current_address.GetAddress(), id),
               module_handler_->BindOnce(impl::check_status<LeMultiAdvtCompleteView>));
         }
@@ -559,7 +585,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         AddressType::PUBLIC_DEVICE_ADDRESS) {
       // if we aren't using the public address type at the HCI level, we need to set the random
       // address
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetAdvertisingSetRandomAddressBuilder::Create(
               id, advertising_sets_[id].current_address.GetAddress()),
           module_handler_->BindOnceOn(
@@ -619,26 +645,27 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     // Thus, we should disable it before removing it.
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY):
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetAdvertisingEnableBuilder::Create(Enable::DISABLED),
             module_handler_->BindOnce(impl::check_status<LeSetAdvertisingEnableCompleteView>));
         break;
       case (AdvertisingApiType::ANDROID_HCI):
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeMultiAdvtSetEnableBuilder::Create(Enable::DISABLED, advertiser_id),
             module_handler_->BindOnce(impl::check_status<LeMultiAdvtCompleteView>));
         break;
       case (AdvertisingApiType::EXTENDED): {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_vector),
             module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
 
         // Only set periodic advertising if supported.
         if (controller_->SupportsBlePeriodicAdvertising()) {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetPeriodicAdvertisingEnableBuilder::Create(false, false, advertiser_id),
               module_handler_->BindOnce(
                   impl::check_status<LeSetPeriodicAdvertisingEnableCompleteView>));
+          advertising_sets_[advertiser_id].periodic_enabled = false;
         }
       } break;
     }
@@ -650,7 +677,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   void rotate_advertiser_address(AdvertiserId advertiser_id) {
     if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
       AddressWithType address_with_type = new_advertiser_address(advertiser_id);
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetAdvertisingSetRandomAddressBuilder::Create(advertiser_id, address_with_type.GetAddress()),
           module_handler_->BindOnceOn(
               this,
@@ -679,7 +706,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
     // For connectable advertising, we should disable it first
     if (advertising_sets_[advertiser_id].connectable) {
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_sets),
           module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
     }
@@ -691,7 +718,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     // DISABLED and ENABLED commands are enqueued synchronously, so OnResume() doesn't need an
     // analogous check.
     if (advertising_sets_[advertiser_id].connectable && !paused) {
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
           module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
     }
@@ -727,6 +754,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     advertising_sets_[advertiser_id].discoverable = config.discoverable;
     advertising_sets_[advertiser_id].tx_power = config.tx_power;
     advertising_sets_[advertiser_id].directed = config.directed;
+    advertising_sets_[advertiser_id].legacy_pdus = config.legacy_pdus;
+    // Send the data again after new parameters rather than rely on the controller keeping it
+    advertising_sets_[advertiser_id].advertising_data.reset();
+    advertising_sets_[advertiser_id].scan_response_data.reset();
+    advertising_sets_[advertiser_id].periodic_data.reset();
 
     // based on logic in new_advertiser_address
     auto own_address_type = static_cast<OwnAddressType>(
@@ -734,7 +766,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetAdvertisingParametersBuilder::Create(
                 config.interval_min,
                 config.interval_max,
@@ -750,7 +782,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                 advertiser_id));
       } break;
       case (AdvertisingApiType::ANDROID_HCI): {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeMultiAdvtParamBuilder::Create(
                 config.interval_min,
                 config.interval_max,
@@ -786,7 +818,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
             legacy_properties = LegacyAdvertisingEventProperties::ADV_NONCONN_IND;
           }
 
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               LeSetExtendedAdvertisingParametersLegacyBuilder::Create(
                   advertiser_id,
                   legacy_properties,
@@ -815,7 +847,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           extended_properties.anonymous_ = config.anonymous;
           extended_properties.tx_power_ = config.include_tx_power;
 
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetExtendedAdvertisingParametersBuilder::Create(
                   advertiser_id,
                   extended_properties,
@@ -937,27 +969,33 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    if (skip_unchanged_data(advertiser_id, set_scan_rsp, data)) {
+      return;
+    }
+
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
+        last_data(advertiser_id, set_scan_rsp) = data;
         if (set_scan_rsp) {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetScanResponseDataBuilder::Create(data),
               module_handler_->BindOnceOn(
                   this, &impl::check_status_with_id<LeSetScanResponseDataCompleteView>, advertiser_id));
         } else {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetAdvertisingDataBuilder::Create(data),
               module_handler_->BindOnceOn(
                   this, &impl::check_status_with_id<LeSetAdvertisingDataCompleteView>, advertiser_id));
         }
       } break;
       case (AdvertisingApiType::ANDROID_HCI): {
+        last_data(advertiser_id, set_scan_rsp) = data;
         if (set_scan_rsp) {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeMultiAdvtSetScanRespBuilder::Create(data, advertiser_id),
               module_handler_->BindOnceOn(this, &impl::check_status_with_id<LeMultiAdvtCompleteView>, advertiser_id));
         } else {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeMultiAdvtSetDataBuilder::Create(data, advertiser_id),
               module_handler_->BindOnceOn(this, &impl::check_status_with_id<LeMultiAdvtCompleteView>, advertiser_id));
         }
@@ -998,6 +1036,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           return;
         }
 
+        // Only the complete data can be sent, fragments cannot update a part of it
+        last_data(advertiser_id, set_scan_rsp) = data;
         if (data_len <= kLeMaximumFragmentLength) {
           send_data_fragment(advertiser_id, set_scan_rsp, data, Operation::COMPLETE_ADVERTISEMENT);
         } else {
@@ -1025,12 +1065,12 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       AdvertiserId advertiser_id, bool set_scan_rsp, std::vector<GapData> data, Operation operation) {
     if (operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT) {
       if (set_scan_rsp) {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetExtendedScanResponseDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
             module_handler_->BindOnceOn(
                 this, &impl::check_status_with_id<LeSetExtendedScanResponseDataCompleteView>, advertiser_id));
       } else {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetExtendedAdvertisingDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
             module_handler_->BindOnceOn(
                 this, &impl::check_status_with_id<LeSetExtendedAdvertisingDataCompleteView>, advertiser_id));
@@ -1038,17 +1078,74 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     } else {
       // For first and intermediate fragment, do not trigger advertising_callbacks_.
       if (set_scan_rsp) {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetExtendedScanResponseDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
             module_handler_->BindOnce(impl::check_status<LeSetExtendedScanResponseDataCompleteView>));
       } else {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetExtendedAdvertisingDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
             module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingDataCompleteView>));
       }
     }
   }
 
+  std::optional<std::vector<GapData>>& last_data(AdvertiserId advertiser_id, bool set_scan_rsp) {
+    return set_scan_rsp ? advertising_sets_[advertiser_id].scan_response_data
+                        : advertising_sets_[advertiser_id].advertising_data;
+  }
+
+  bool is_advertising(AdvertiserId advertiser_id) {
+    return !paused && enabled_sets_[advertiser_id].advertising_handle_ != kInvalidHandle;
+  }
+
+  // Returns true if the controller already has |data| for the set, and completes the update without sending the
+  // data again. The advertising data of a set advertising extended PDUs is updated with the Unchanged Data operation
+  // instead, which still changes the Advertising DID for the scanners filtering duplicates.
+  bool skip_unchanged_data(AdvertiserId advertiser_id, bool set_scan_rsp, const std::vector<GapData>& data) {
+    const auto& last = last_data(advertiser_id, set_scan_rsp);
+    if (!last.has_value() || !is_same_data(*last, data)) {
+      return false;
+    }
+
+    if (advertising_api_type_ == AdvertisingApiType::EXTENDED && !set_scan_rsp && !data.empty() &&
+        !advertising_sets_[advertiser_id].legacy_pdus && is_advertising(advertiser_id)) {
+      unchanged_data_updates_++;
+      enqueue_command(
+          hci::LeSetExtendedAdvertisingDataBuilder::Create(
+              advertiser_id, Operation::UNCHANGED_DATA, kFragment_preference, {}),
+          module_handler_->BindOnceOn(
+              this, &impl::check_status_with_id<LeSetExtendedAdvertisingDataCompleteView>, advertiser_id));
+      return true;
+    }
+
+    data_updates_skipped_++;
+    on_data_unchanged(
+        advertiser_id,
+        set_scan_rsp ? OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA : OpCode::LE_SET_EXTENDED_ADVERTISING_DATA);
+    return true;
+  }
+
+  // Reports a data update that was not sent, as check_status_with_id() does when the command completes
+  void on_data_unchanged(AdvertiserId id, OpCode opcode) {
+    if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal) {
+      return;
+    }
+
+    switch (opcode) {
+      case OpCode::LE_SET_EXTENDED_ADVERTISING_DATA:
+        advertising_callbacks_->OnAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+      case OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA:
+        advertising_callbacks_->OnScanResponseDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+      case OpCode::LE_SET_PERIODIC_ADVERTISING_DATA:
+        advertising_callbacks_->OnPeriodicAdvertisingDataSet(id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        break;
+      default:
+        LOG_WARN("Unexpected data opcode %s", OpCodeText(opcode).c_str());
+    }
+  }
+
   void enable_advertiser(
       AdvertiserId advertiser_id, bool enable, uint16_t duration, uint8_t max_extended_advertising_events) {
     EnabledSet curr_set;
@@ -1065,7 +1162,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeSetAdvertisingEnableBuilder::Create(enable_value),
             module_handler_->BindOnceOn(
                 this,
@@ -1075,7 +1172,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                 true /* trigger callbacks */));
       } break;
       case (AdvertisingApiType::ANDROID_HCI): {
-        le_advertising_interface_->EnqueueCommand(
+        enqueue_command(
             hci::LeMultiAdvtSetEnableBuilder::Create(enable_value, advertiser_id),
             module_handler_->BindOnceOn(
                 this,
@@ -1085,15 +1182,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                 true /* trigger callbacks */));
       } break;
       case (AdvertisingApiType::EXTENDED): {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingEnableBuilder::Create(enable_value, enabled_sets),
-            module_handler_->BindOnceOn(
-                this,
-                &impl::on_set_extended_advertising_enable_complete<
-                    LeSetExtendedAdvertisingEnableCompleteView>,
-                enable,
-                enabled_sets,
-                true /* trigger callbacks */));
+        queue_extended_enable(enable, curr_set);
       } break;
     }
 
@@ -1110,12 +1199,86 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // The sets enabled or disabled while the handler runs the callers go in one command, sent once they are done or
+  // before the next command, so that the controller still sees the commands in the order they were made.
+  void queue_extended_enable(bool enable, EnabledSet enabled_set) {
+    if (!pending_enables_.empty() && pending_enables_.back().enable == enable &&
+        std::none_of(
+            pending_enables_.back().sets.begin(), pending_enables_.back().sets.end(), [&](const EnabledSet& set) {
+              return set.advertising_handle_ == enabled_set.advertising_handle_;
+            })) {
+      pending_enables_.back().sets.push_back(enabled_set);
+    } else {
+      pending_enables_.push_back({enable, {enabled_set}});
+    }
+
+    if (!pending_enables_posted_) {
+      pending_enables_posted_ = true;
+      module_handler_->CallOn(this, &impl::on_pending_enables);
+    }
+  }
+
+  void on_pending_enables() {
+    pending_enables_posted_ = false;
+    send_pending_enables();
+  }
+
+  void send_pending_enables() {
+    std::vector<PendingEnable> pending_enables;
+    pending_enables.swap(pending_enables_);
+    for (auto& pending_enable : pending_enables) {
+      send_extended_enable(pending_enable.enable, pending_enable.sets, true /* trigger_callbacks */);
+    }
+  }
+
+  void send_extended_enable(bool enable, std::vector<EnabledSet> sets, bool trigger_callbacks) {
+    enable_commands_++;
+    sets_enabled_ += sets.size();
+    commands_sent_++;
+    le_advertising_interface_->EnqueueCommand(
+        hci::LeSetExtendedAdvertisingEnableBuilder::Create(enable ? Enable::ENABLED : Enable::DISABLED, sets),
+        module_handler_->BindOnceOn(
+            this,
+            &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
+            enable,
+            sets,
+            trigger_callbacks));
+  }
+
+  // The controller changes none of the sets of a command when one of them is invalid, so each set of a failed batch
+  // is sent again on its own. Sets enabled or disabled again since then are left to the newer command, and fail.
+  std::vector<EnabledSet> retry_extended_enable(
+      bool enable, const std::vector<EnabledSet>& enabled_sets, bool trigger_callbacks) {
+    send_pending_enables();
+    std::vector<EnabledSet> superseded_sets;
+    for (const EnabledSet& enabled_set : enabled_sets) {
+      uint8_t id = enabled_set.advertising_handle_;
+      if (id >= enabled_sets_.size()) {
+        continue;
+      }
+      if ((enabled_sets_[id].advertising_handle_ != kInvalidHandle) == enable) {
+        LOG_INFO("Retrying to %s advertising set %d on its own", enable ? "enable" : "disable", id);
+        send_extended_enable(enable, {enabled_set}, trigger_callbacks);
+      } else {
+        superseded_sets.push_back(enabled_set);
+      }
+    }
+    return superseded_sets;
+  }
+
+  template <class Callback>
+  void enqueue_command(std::unique_ptr<LeAdvertisingCommandBuilder> command, Callback on_complete) {
+    send_pending_enables();
+    commands_sent_++;
+    le_advertising_interface_->EnqueueCommand(std::move(command), std::move(on_complete));
+  }
+
   void set_periodic_parameter(
       AdvertiserId advertiser_id, PeriodicAdvertisingParameters periodic_advertising_parameters) {
     uint8_t include_tx_power = periodic_advertising_parameters.properties >>
                                PeriodicAdvertisingParameters::AdvertisingProperty::INCLUDE_TX_POWER;
 
-    le_advertising_interface_->EnqueueCommand(
+    enqueue_command(
         hci::LeSetPeriodicAdvertisingParametersBuilder::Create(
             advertiser_id,
             periodic_advertising_parameters.min_interval,
@@ -1152,6 +1315,22 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    auto& advertiser = advertising_sets_[advertiser_id];
+    if (advertiser.periodic_data.has_value() && is_same_data(*advertiser.periodic_data, data)) {
+      if (advertiser.periodic_enabled && advertiser.periodic_include_adi && !data.empty()) {
+        unchanged_data_updates_++;
+        enqueue_command(
+            hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, Operation::UNCHANGED_DATA, {}),
+            module_handler_->BindOnceOn(
+                this, &impl::check_status_with_id<LeSetPeriodicAdvertisingDataCompleteView>, advertiser_id));
+      } else {
+        data_updates_skipped_++;
+        on_data_unchanged(advertiser_id, OpCode::LE_SET_PERIODIC_ADVERTISING_DATA);
+      }
+      return;
+    }
+    advertiser.periodic_data = data;
+
     if (data_len <= kLeMaximumFragmentLength) {
       send_periodic_data_fragment(advertiser_id, data, Operation::COMPLETE_ADVERTISEMENT);
     } else {
@@ -1175,13 +1354,13 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void send_periodic_data_fragment(AdvertiserId advertiser_id, std::vector<GapData> data, Operation operation) {
     if (operation == Operation::COMPLETE_ADVERTISEMENT || operation == Operation::LAST_FRAGMENT) {
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, operation, data),
           module_handler_->BindOnceOn(
               this, &impl::check_status_with_id<LeSetPeriodicAdvertisingDataCompleteView>, advertiser_id));
     } else {
       // For first and intermediate fragment, do not trigger advertising_callbacks_.
-      le_advertising_interface_->EnqueueCommand(
+      enqueue_command(
           hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, operation, data),
           module_handler_->BindOnce(impl::check_status<LeSetPeriodicAdvertisingDataCompleteView>));
     }
@@ -1195,7 +1374,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (include_adi && !controller_->SupportsBlePeriodicAdvertisingAdi()) {
       include_adi = false;
     }
-    le_advertising_interface_->EnqueueCommand(
+    advertising_sets_[advertiser_id].periodic_include_adi = include_adi;
+    enqueue_command(
         hci::LeSetPeriodicAdvertisingEnableBuilder::Create(enable, include_adi, advertiser_id),
         module_handler_->BindOnceOn(
             this,
@@ -1221,7 +1401,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
       switch (advertising_api_type_) {
         case (AdvertisingApiType::LEGACY): {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetAdvertisingEnableBuilder::Create(Enable::DISABLED),
               module_handler_->BindOnce(impl::check_status<LeSetAdvertisingEnableCompleteView>));
         } break;
@@ -1229,7 +1409,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           for (size_t i = 0; i < enabled_sets_.size(); i++) {
             uint8_t id = enabled_sets_[i].advertising_handle_;
             if (id != kInvalidHandle) {
-              le_advertising_interface_->EnqueueCommand(
+              enqueue_command(
                   hci::LeMultiAdvtSetEnableBuilder::Create(Enable::DISABLED, id),
                   module_handler_->BindOnce(impl::check_status<LeMultiAdvtCompleteView>));
             }
@@ -1237,7 +1417,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         } break;
         case (AdvertisingApiType::EXTENDED): {
           if (enabled_sets.size() != 0) {
-            le_advertising_interface_->EnqueueCommand(
+            enqueue_command(
                 hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::DISABLED, enabled_sets),
                 module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingEnableCompleteView>));
           }
@@ -1264,7 +1444,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
       switch (advertising_api_type_) {
         case (AdvertisingApiType::LEGACY): {
-          le_advertising_interface_->EnqueueCommand(
+          enqueue_command(
               hci::LeSetAdvertisingEnableBuilder::Create(Enable::ENABLED),
               common::init_flags::
                       trigger_advertising_callbacks_on_first_resume_after_pause_is_enabled()
@@ -1282,7 +1462,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
           for (size_t i = 0; i < enabled_sets_.size(); i++) {
             uint8_t id = enabled_sets_[i].advertising_handle_;
             if (id != kInvalidHandle) {
-              le_advertising_interface_->EnqueueCommand(
+              enqueue_command(
                   hci::LeMultiAdvtSetEnableBuilder::Create(Enable::ENABLED, id),
                   common::init_flags::
                           trigger_advertising_callbacks_on_first_resume_after_pause_is_enabled()
@@ -1298,7 +1478,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         } break;
         case (AdvertisingApiType::EXTENDED): {
           if (enabled_sets.size() != 0) {
-            le_advertising_interface_->EnqueueCommand(
+            enqueue_command(
                 hci::LeSetExtendedAdvertisingEnableBuilder::Create(Enable::ENABLED, enabled_sets),
                 common::init_flags::
                         trigger_advertising_callbacks_on_first_resume_after_pause_is_enabled()
@@ -1360,6 +1540,19 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   AdvertisingApiType advertising_api_type_{0};
 
+  struct PendingEnable {
+    bool enable;
+    std::vector<EnabledSet> sets;
+  };
+  std::vector<PendingEnable> pending_enables_;
+  bool pending_enables_posted_ = false;
+
+  std::atomic<size_t> commands_sent_ = 0;
+  std::atomic<size_t> enable_commands_ = 0;
+  std::atomic<size_t> sets_enabled_ = 0;
+  std::atomic<size_t> data_updates_skipped_ = 0;
+  std::atomic<size_t> unchanged_data_updates_ = 0;
+
   void on_read_advertising_physical_channel_tx_power(CommandCompleteView view) {
     auto complete_view = LeReadAdvertisingPhysicalChannelTxPowerCompleteView::Create(view);
     if (!complete_view.IsValid()) {
@@ -1434,6 +1627,9 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (complete_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(complete_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      if (enabled_sets.size() > 1) {
+        enabled_sets = retry_extended_enable(enable, enabled_sets, trigger_callbacks);
+      }
     }
 
     if (advertising_callbacks_ == nullptr) {
@@ -1494,6 +1690,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (complete_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(complete_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+    } else {
+      advertising_sets_[id].periodic_enabled = enable;
     }
 
     if (advertising_callbacks_ == nullptr || !advertising_sets_[id].started || id_map_[id] == kIdLocal) {
@@ -1535,6 +1733,13 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (status_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(status_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      // The controller may have kept any part of the data, send it all again next time
+      auto advertiser = advertising_sets_.find(id);
+      if (advertiser != advertising_sets_.end()) {
+        advertiser->second.advertising_data.reset();
+        advertiser->second.scan_response_data.reset();
+        advertiser->second.periodic_data.reset();
+      }
     }
 
     // Do not trigger callback if the advertiser not stated yet, or the advertiser is not register
@@ -1634,6 +1839,10 @@ std::string LeAdvertisingManager::ToString() const {
   return "Le Advertising Manager";
 }
 
+LeAdvertisingManager::CommandCounts LeAdvertisingManager::GetCommandCounts() const {
+  return pimpl_->get_command_counts();
+}
+
 size_t LeAdvertisingManager::GetNumberOfAdvertisingInstances() const {
   return pimpl_->GetNumberOfAdvertisingInstances();
 }
@@ -111,6 +111,15 @@ class LeAdvertisingManager : public bluetooth::Module {
 
   size_t GetNumberOfAdvertisingInstances() const;
 
+  struct CommandCounts {
+    size_t commands_sent;           // HCI commands sent to the controller
+    size_t enable_commands;         // LE Set Extended Advertising Enable commands sent for EnableAdvertiser()
+    size_t sets_enabled;            // Sets enabled or disabled by these commands
+    size_t data_updates_skipped;    // Data updates not sent as they did not change the data
+    size_t unchanged_data_updates;  // Data updates sent as Unchanged Data, to only update the DID
+  };
+  CommandCounts GetCommandCounts() const;
+
   void ExtendedCreateAdvertiser(
       int reg_id,
       const AdvertisingConfig config,
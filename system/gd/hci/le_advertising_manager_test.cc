@@ -1111,6 +1111,216 @@ TEST_F(LeExtendedAdvertisingAPITest, disable_after_enable) {
   sync_client_handler();
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, enable_advertisers_in_one_command) {
+  // start a second advertising set
+  AdvertisingConfig advertising_config{};
+  advertising_config.advertising_type = AdvertisingType::ADV_IND;
+  advertising_config.requested_advertiser_address_type = AdvertiserAddressType::PUBLIC;
+  advertising_config.channel_map = 1;
+  AdvertiserId second_id = LeAdvertisingManager::kInvalidId;
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, _, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .WillOnce(SaveArg<1>(&second_id));
+  le_advertising_manager_->ExtendedCreateAdvertiser(
+      0x01, advertising_config, scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+      uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, second_id);
+  auto counts = le_advertising_manager_->GetCommandCounts();
+
+  // disable both sets while the handler is busy
+  std::promise<void> busy_promise;
+  fake_registry_.GetTestModuleHandler(&LeAdvertisingManager::Factory)
+      ->Post(common::BindOnce([](std::future<void> future) { future.wait(); }, busy_promise.get_future()));
+  le_advertising_manager_->EnableAdvertiser(advertiser_id_, false, 0x00, 0x00);
+  le_advertising_manager_->EnableAdvertiser(second_id, false, 0x00, 0x00);
+  busy_promise.set_value();
+
+  auto enable_view =
+      LeSetExtendedAdvertisingEnableView::Create(LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(enable_view.IsValid());
+  ASSERT_EQ(Enable::DISABLED, enable_view.GetEnable());
+  ASSERT_EQ(2u, enable_view.GetEnabledSets().size());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(advertiser_id_, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(second_id, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+
+  auto new_counts = le_advertising_manager_->GetCommandCounts();
+  ASSERT_EQ(counts.commands_sent + 1, new_counts.commands_sent);
+  ASSERT_EQ(counts.enable_commands + 1, new_counts.enable_commands);
+  ASSERT_EQ(counts.sets_enabled + 2, new_counts.sets_enabled);
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, retry_advertisers_after_failed_batch) {
+  // start a second advertising set
+  AdvertisingConfig advertising_config{};
+  advertising_config.advertising_type = AdvertisingType::ADV_IND;
+  advertising_config.requested_advertiser_address_type = AdvertiserAddressType::PUBLIC;
+  advertising_config.channel_map = 1;
+  AdvertiserId second_id = LeAdvertisingManager::kInvalidId;
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0x01, _, -23, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .WillOnce(SaveArg<1>(&second_id));
+  le_advertising_manager_->ExtendedCreateAdvertiser(
+      0x01, advertising_config, scan_callback, set_terminated_callback, 0, 0, client_handler_);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
+      uint8_t{1}, ErrorCode::SUCCESS, static_cast<uint8_t>(-23)));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+  ASSERT_NE(LeAdvertisingManager::kInvalidId, second_id);
+  auto counts = le_advertising_manager_->GetCommandCounts();
+
+  // disable both sets in one command, which the controller rejects for the second set
+  std::promise<void> busy_promise;
+  fake_registry_.GetTestModuleHandler(&LeAdvertisingManager::Factory)
+      ->Post(common::BindOnce([](std::future<void> future) { future.wait(); }, busy_promise.get_future()));
+  le_advertising_manager_->EnableAdvertiser(advertiser_id_, false, 0x00, 0x00);
+  le_advertising_manager_->EnableAdvertiser(second_id, false, 0x00, 0x00);
+  busy_promise.set_value();
+
+  auto enable_view =
+      LeSetExtendedAdvertisingEnableView::Create(LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(enable_view.IsValid());
+  ASSERT_EQ(2u, enable_view.GetEnabledSets().size());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(
+      uint8_t{1}, ErrorCode::UNKNOWN_ADVERTISING_IDENTIFIER));
+
+  // each set is sent again on its own, and only the invalid one fails
+  AdvertiserId ids[] = {advertiser_id_, second_id};
+  for (AdvertiserId id : ids) {
+    enable_view =
+        LeSetExtendedAdvertisingEnableView::Create(LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+    ASSERT_TRUE(enable_view.IsValid());
+    ASSERT_EQ(Enable::DISABLED, enable_view.GetEnable());
+    ASSERT_EQ(1u, enable_view.GetEnabledSets().size());
+    ASSERT_EQ(id, enable_view.GetEnabledSets()[0].advertising_handle_);
+  }
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(advertiser_id_, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(second_id, false, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(
+      uint8_t{1}, ErrorCode::UNKNOWN_ADVERTISING_IDENTIFIER));
+  sync_client_handler();
+
+  auto new_counts = le_advertising_manager_->GetCommandCounts();
+  ASSERT_EQ(counts.commands_sent + 3, new_counts.commands_sent);
+  ASSERT_EQ(counts.enable_commands + 3, new_counts.enable_commands);
+  ASSERT_EQ(counts.sets_enabled + 4, new_counts.sets_enabled);
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, set_unchanged_data_test) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::TX_POWER_LEVEL;
+  data_item.data_ = {0x00};
+  advertising_data.push_back(data_item);
+  std::vector<GapData> response_data{};
+  GapData data_item2{};
+  data_item2.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item2.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  response_data.push_back(data_item2);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(3);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnScanResponseDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(2);
+
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id_, true, response_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetExtendedScanResponseDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+  auto counts = le_advertising_manager_->GetCommandCounts();
+
+  // The same advertising data only updates the DID, as the set is advertising
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  auto data_view =
+      LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(data_view.IsValid());
+  ASSERT_EQ(Operation::UNCHANGED_DATA, data_view.GetOperation());
+  ASSERT_TRUE(data_view.GetAdvertisingData().empty());
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The same scan response data is not sent at all
+  le_advertising_manager_->SetData(advertiser_id_, true, response_data);
+  sync_client_handler();
+
+  // Nor is the same advertising data once the set is disabled
+  le_advertising_manager_->EnableAdvertiser(advertiser_id_, false, 0x00, 0x00);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingEnabled(advertiser_id_, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  sync_client_handler();
+
+  auto new_counts = le_advertising_manager_->GetCommandCounts();
+  ASSERT_EQ(counts.commands_sent + 2, new_counts.commands_sent);
+  ASSERT_EQ(counts.unchanged_data_updates + 1, new_counts.unchanged_data_updates);
+  ASSERT_EQ(counts.data_updates_skipped + 2, new_counts.data_updates_skipped);
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, set_data_again_after_failure) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::TX_POWER_LEVEL;
+  data_item.data_ = {0x00};
+  advertising_data.push_back(data_item);
+
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  sync_client_handler();
+
+  // The controller may not have the data, so all of it is sent again
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  auto data_view =
+      LeSetExtendedAdvertisingDataView::Create(LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(data_view.IsValid());
+  ASSERT_EQ(Operation::COMPLETE_ADVERTISEMENT, data_view.GetOperation());
+  ASSERT_EQ(1u, data_view.GetAdvertisingData().size());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
 TEST_F(LeExtendedAdvertisingAPITest, set_periodic_parameter) {
   PeriodicAdvertisingParameters advertising_config{};
   advertising_config.max_interval = 0x1000;
@@ -1172,6 +1382,32 @@ TEST_F(LeExtendedAdvertisingAPITest, set_periodic_data_fragments_test) {
   test_hci_layer_->IncomingEvent(LeSetPeriodicAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, set_unchanged_periodic_data_test) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::TX_POWER_LEVEL;
+  data_item.data_ = {0x00};
+  advertising_data.push_back(data_item);
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnPeriodicAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(2);
+
+  le_advertising_manager_->SetPeriodicData(advertiser_id_, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_PERIODIC_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  test_hci_layer_->IncomingEvent(LeSetPeriodicAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+  auto counts = le_advertising_manager_->GetCommandCounts();
+
+  // Without the ADI there is no DID to update, the same data is not sent
+  le_advertising_manager_->SetPeriodicData(advertiser_id_, advertising_data);
+  sync_client_handler();
+
+  auto new_counts = le_advertising_manager_->GetCommandCounts();
+  ASSERT_EQ(counts.commands_sent, new_counts.commands_sent);
+  ASSERT_EQ(counts.data_updates_skipped + 1, new_counts.data_updates_skipped);
+}
+
 TEST_F(LeExtendedAdvertisingAPITest, set_perodic_data_with_invalid_ad_structure) {
   // Set advertising data with AD structure that length greater than 251
   std::vector<GapData> advertising_data{};
@@ -331,13 +331,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       LOG_INFO("Dropping invalid advertising event");
       return;
     }
-    std::vector<LeAdvertisingResponseRaw> reports = event_view.GetResponses();
+    auto reports = event_view.GetResponsesRange();
     if (reports.empty()) {
       LOG_INFO("Zero results in advertising event");
       return;
     }
 
-    for (LeAdvertisingResponseRaw report : reports) {
+    for (const LeAdvertisingResponseRaw& report : reports) {
       uint16_t extended_event_type = 0;
       switch (report.event_type_) {
         case AdvertisingEventType::ADV_IND:
@@ -388,13 +388,13 @@ struct LeScanningManager::impl : public LeAddressManagerCallback {
       return;
     }
 
-    std::vector<LeExtendedAdvertisingResponseRaw> reports = event_view.GetResponses();
+    auto reports = event_view.GetResponsesRange();
     if (reports.empty()) {
       LOG_INFO("Zero results in advertising event");
       return;
     }
 
-    for (LeExtendedAdvertisingResponseRaw& report : reports) {
+    for (const LeExtendedAdvertisingResponseRaw& report : reports) {
       uint16_t event_type = report.connectable_ | (report.scannable_ << kScannableBit) |
                             (report.directed_ << kDirectedBit) | (report.scan_response_ << kScanResponseBit) |
                             (report.legacy_ << kLegacyBit) | ((uint16_t)report.data_status_ << kDataStatusBits);
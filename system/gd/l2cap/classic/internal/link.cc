@@ -20,6 +20,7 @@
 #include <memory>
 
 #include "common/bind.h"
+#include "common/init_flags.h"
 #include "hci/acl_manager/classic_acl_connection.h"
 #include "l2cap/classic/dynamic_channel_manager.h"
 #include "l2cap/classic/internal/fixed_channel_impl.h"
@@ -45,7 +46,13 @@ Link::Link(
     LinkManager* link_manager)
     : l2cap_handler_(l2cap_handler),
       acl_connection_(std::move(acl_connection)),
-      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd()),
+      data_pipeline_manager_(
+          l2cap_handler,
+          this,
+          acl_connection_->GetAclQueueEnd(),
+          bluetooth::common::init_flags::l2cap_weighted_fair_scheduler_is_enabled()
+              ? l2cap::internal::DataPipelineManager::SchedulerType::WEIGHTED_FAIR
+              : l2cap::internal::DataPipelineManager::SchedulerType::FIFO),
       parameter_provider_(parameter_provider),
       dynamic_service_manager_(dynamic_service_manager),
       fixed_service_manager_(fixed_service_manager),
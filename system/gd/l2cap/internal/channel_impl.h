@@ -19,6 +19,7 @@
 #include "common/bidi_queue.h"
 #include "l2cap/cid.h"
 #include "l2cap/l2cap_packets.h"
+#include "l2cap/psm.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -47,6 +48,13 @@ class ChannelImpl {
   virtual Cid GetCid() const = 0;
 
   virtual Cid GetRemoteCid() const = 0;
+
+  /**
+   * Return the PSM of a dynamic channel, or kDefaultPsm for a fixed channel
+   */
+  virtual Psm GetPsm() const {
+    return kDefaultPsm;
+  }
 };
 
 }  // namespace internal
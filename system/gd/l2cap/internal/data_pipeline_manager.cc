@@ -31,6 +31,7 @@ void DataPipelineManager::AttachChannel(Cid cid, std::shared_ptr<ChannelImpl> ch
   ASSERT(sender_map_.find(cid) == sender_map_.end());
   sender_map_.emplace(std::piecewise_construct, std::forward_as_tuple(cid),
                       std::forward_as_tuple(handler_, link_, scheduler_.get(), channel, mode));
+  scheduler_->SetChannelWeight(cid, WeightedFair::GetChannelWeight(cid, channel->GetPsm()));
 }
 
 void DataPipelineManager::DetachChannel(Cid cid) {
@@ -62,6 +63,11 @@ void DataPipelineManager::SetChannelTxPriority(Cid cid, bool high_priority) {
   scheduler_->SetChannelTxPriority(cid, high_priority);
 }
 
+void DataPipelineManager::SetChannelWeight(Cid cid, uint16_t weight) {
+  ASSERT(sender_map_.find(cid) != sender_map_.end());
+  scheduler_->SetChannelWeight(cid, weight);
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -28,6 +28,7 @@
 #include "l2cap/internal/receiver.h"
 #include "l2cap/internal/scheduler.h"
 #include "l2cap/internal/scheduler_fifo.h"
+#include "l2cap/internal/scheduler_weighted_fair.h"
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/mtu.h"
 #include "os/handler.h"
@@ -55,8 +56,17 @@ class DataPipelineManager {
   using LowerDequeue = UpperEnqueue;
   using LowerQueueUpEnd = common::BidiQueueEnd<LowerEnqueue, LowerDequeue>;
 
-  DataPipelineManager(os::Handler* handler, ILink* link, LowerQueueUpEnd* link_queue_up_end)
-      : handler_(handler), link_(link), scheduler_(std::make_unique<Fifo>(this, link_queue_up_end, handler)),
+  enum class SchedulerType {
+    FIFO,
+    WEIGHTED_FAIR,
+  };
+
+  DataPipelineManager(
+      os::Handler* handler,
+      ILink* link,
+      LowerQueueUpEnd* link_queue_up_end,
+      SchedulerType scheduler_type = SchedulerType::FIFO)
+      : handler_(handler), link_(link), scheduler_(CreateScheduler(scheduler_type, link_queue_up_end, handler)),
         receiver_(link_queue_up_end, handler, this) {}
 
   using ChannelMode = Sender::ChannelMode;
@@ -67,9 +77,18 @@ class DataPipelineManager {
   virtual void OnPacketSent(Cid cid);
   virtual void UpdateClassicConfiguration(Cid cid, classic::internal::ChannelConfigurationState config);
   virtual void SetChannelTxPriority(Cid cid, bool high_priority);
+  virtual void SetChannelWeight(Cid cid, uint16_t weight);
   virtual ~DataPipelineManager() = default;
 
  private:
+  std::unique_ptr<Scheduler> CreateScheduler(
+      SchedulerType scheduler_type, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler) {
+    if (scheduler_type == SchedulerType::WEIGHTED_FAIR) {
+      return std::make_unique<WeightedFair>(this, link_queue_up_end, handler);
+    }
+    return std::make_unique<Fifo>(this, link_queue_up_end, handler);
+  }
+
   os::Handler* handler_;
   ILink* link_;
   std::unordered_map<Cid, Sender> sender_map_;
@@ -16,15 +16,16 @@
 
 #include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
 
-#include <map>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <queue>
 #include <vector>
 
 #include "common/bind.h"
 #include "l2cap/internal/ilink.h"
 #include "os/alarm.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/bit_inserter.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -78,13 +79,30 @@ struct ErtmController::impl {
   bool remote_busy_ = false;
   bool local_busy_ = false;
   int unacked_frames_ = 0;
-  // TODO: Instead of having a map, we may consider about a better data structure
-  // Map from TxSeq to (SAR, SDU size for START packet, information payload)
-  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, std::shared_ptr<packet::RawBuilder>>> unacked_list_;
-  // Stores (SAR, SDU size for START packet, information payload)
-  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, std::unique_ptr<packet::RawBuilder>>> pending_frames_;
+
+  // Information payload of an I-frame, a slice of an SDU buffer
+  struct Segment {
+    std::shared_ptr<const std::vector<uint8_t>> sdu;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  struct Frame {
+    SegmentationAndReassembly sar = SegmentationAndReassembly::UNSEGMENTED;
+    uint16_t sdu_size = 0;  // Only for START packet
+    Segment segment;
+    int retry_count = 0;  // Number of times sent, 0 when the slot is free
+  };
+
+  // Sent frames waiting for ack, indexed by TxSeq
+  std::array<Frame, kMaxTxWin> unacked_list_;
+
+  // Frames waiting for the remote window to open, in a circular buffer that only grows
+  std::vector<Frame> pending_frames_;
+  size_t pending_frames_head_ = 0;
+  size_t pending_frames_count_ = 0;
+
   int retry_count_ = 0;
-  std::map<uint8_t /* tx_seq, */, int /* count */> retry_i_frames_;
   bool rnr_sent_ = false;
   bool rej_actioned_ = false;
   bool srej_actioned_ = false;
@@ -97,14 +115,14 @@ struct ErtmController::impl {
 
   // Events (@see 8.6.5.4)
 
-  void data_request(SegmentationAndReassembly sar, std::unique_ptr<packet::RawBuilder> pdu, uint16_t sdu_size = 0) {
+  void data_request(SegmentationAndReassembly sar, Segment segment, uint16_t sdu_size = 0) {
     // Note: sdu_size only applies to START packet
     if (tx_state_ == TxState::XMIT && !remote_busy() && rem_window_not_full()) {
-      send_data(sar, sdu_size, std::move(pdu));
+      send_data(sar, sdu_size, std::move(segment));
     } else if (tx_state_ == TxState::XMIT && (remote_busy() || rem_window_full())) {
-      pend_data(sar, sdu_size, std::move(pdu));
+      pend_data(sar, sdu_size, std::move(segment));
     } else if (tx_state_ == TxState::WAIT_F) {
-      pend_data(sar, sdu_size, std::move(pdu));
+      pend_data(sar, sdu_size, std::move(segment));
     }
   }
 
@@ -483,7 +501,7 @@ struct ErtmController::impl {
   }
 
   bool retry_i_frames_less_than_max_transmit(uint8_t req_seq) {
-    return retry_i_frames_[req_seq] < controller_->local_max_transmit_;
+    return unacked_list_[req_seq % kMaxTxWin].retry_count < controller_->local_max_transmit_;
   }
 
   bool retry_count_less_than_max_transmit() {
@@ -574,8 +592,9 @@ struct ErtmController::impl {
 
   // Actions (@see 8.6.5.6)
 
-  void _send_i_frame(SegmentationAndReassembly sar, std::unique_ptr<CopyablePacketBuilder> segment, uint8_t req_seq,
-                     uint8_t tx_seq, uint16_t sdu_size = 0, Final f = Final::NOT_SET) {
+  void _send_i_frame(SegmentationAndReassembly sar, const Segment& payload, uint8_t req_seq, uint8_t tx_seq,
+                     uint16_t sdu_size = 0, Final f = Final::NOT_SET) {
+    auto segment = std::make_unique<SegmentBuilder>(payload.sdu, payload.begin, payload.end);
     std::unique_ptr<packet::BasePacketBuilder> builder;
     if (sar == SegmentationAndReassembly::START) {
       if (controller_->fcs_enabled_) {
@@ -597,30 +616,39 @@ struct ErtmController::impl {
     controller_->send_pdu(std::move(builder));
   }
 
-  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> segment,
-                 Final f = Final::NOT_SET) {
-    std::shared_ptr<packet::RawBuilder> shared_segment(segment.release());
-    unacked_list_.emplace(std::piecewise_construct, std::forward_as_tuple(next_tx_seq_),
-                          std::forward_as_tuple(sar, sdu_size, shared_segment));
-
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(next_tx_seq_)->second));
-    _send_i_frame(sar, std::move(copyable_packet_builder), buffer_seq_, next_tx_seq_, sdu_size, f);
+  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, Segment segment, Final f = Final::NOT_SET) {
+    Frame& frame = unacked_list_[next_tx_seq_];
+    frame.sar = sar;
+    frame.sdu_size = sdu_size;
+    frame.segment = std::move(segment);
+    frame.retry_count = 1;
+    _send_i_frame(sar, frame.segment, buffer_seq_, next_tx_seq_, sdu_size, f);
     unacked_frames_++;
     frames_sent_++;
-    retry_i_frames_[next_tx_seq_] = 1;
     next_tx_seq_ = (next_tx_seq_ + 1) % kMaxTxWin;
     start_retrans_timer();
   }
 
-  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> data) {
-    pending_frames_.emplace(std::make_tuple(sar, sdu_size, std::move(data)));
+  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, Segment segment) {
+    if (pending_frames_count_ == pending_frames_.size()) {
+      // Grow and unwrap the circular buffer
+      std::vector<Frame> frames(std::max<size_t>(kMaxTxWin, pending_frames_.size() * 2));
+      for (size_t i = 0; i < pending_frames_count_; i++) {
+        frames[i] = std::move(pending_frames_[(pending_frames_head_ + i) % pending_frames_.size()]);
+      }
+      pending_frames_ = std::move(frames);
+      pending_frames_head_ = 0;
+    }
+    Frame& frame = pending_frames_[(pending_frames_head_ + pending_frames_count_) % pending_frames_.size()];
+    frame.sar = sar;
+    frame.sdu_size = sdu_size;
+    frame.segment = std::move(segment);
+    pending_frames_count_++;
   }
 
   void process_req_seq(uint8_t req_seq) {
-    for (int i = expected_ack_seq_; i < req_seq; i++) {
-      unacked_list_.erase(i);
-      retry_i_frames_[i] = 0;
+    for (uint8_t i = expected_ack_seq_; i != req_seq % kMaxTxWin; i = (i + 1) % kMaxTxWin) {
+      unacked_list_[i] = {};
     }
     unacked_frames_ -= ((req_seq - expected_ack_seq_) + kMaxTxWin) % kMaxTxWin;
     expected_ack_seq_ = req_seq;
@@ -725,7 +753,7 @@ struct ErtmController::impl {
   void send_ack(Final f = Final::NOT_SET) {
     if (local_busy()) {
       send_rnr(f);
-    } else if (!remote_busy() && !pending_frames_.empty() && rem_window_not_full()) {
+    } else if (!remote_busy() && pending_frames_count_ > 0 && rem_window_not_full()) {
       send_pending_i_frames(f);
     } else {
       send_rr(f);
@@ -749,38 +777,34 @@ struct ErtmController::impl {
   }
 
   void retransmit_i_frames(uint8_t req_seq, Poll p = Poll::NOT_SET) {
-    uint8_t i = req_seq;
+    uint8_t i = req_seq % kMaxTxWin;
     Final f = (p == Poll::NOT_SET ? Final::NOT_SET : Final::POLL_RESPONSE);
-    while (unacked_list_.find(i) != unacked_list_.end()) {
-      if (retry_i_frames_[i] == controller_->local_max_transmit_) {
+    while (i != next_tx_seq_ && unacked_list_[i].retry_count > 0) {
+      Frame& frame = unacked_list_[i];
+      if (frame.retry_count == controller_->local_max_transmit_) {
         CloseChannel();
         return;
       }
-      std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-          std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(i)->second));
-      _send_i_frame(std::get<0>(unacked_list_.find(i)->second), std::move(copyable_packet_builder), buffer_seq_, i,
-                    std::get<1>(unacked_list_.find(i)->second), f);
-      retry_i_frames_[i]++;
+      _send_i_frame(frame.sar, frame.segment, buffer_seq_, i, frame.sdu_size, f);
+      frame.retry_count++;
       frames_sent_++;
       f = Final::NOT_SET;
-      i++;
+      i = (i + 1) % kMaxTxWin;
     }
-    if (i != req_seq) {
+    if (i != req_seq % kMaxTxWin) {
       start_retrans_timer();
     }
   }
 
   void retransmit_requested_i_frame(uint8_t req_seq, Poll p) {
     Final f = p == Poll::POLL ? Final::POLL_RESPONSE : Final::NOT_SET;
-    if (unacked_list_.find(req_seq) == unacked_list_.end()) {
+    Frame& frame = unacked_list_[req_seq % kMaxTxWin];
+    if (frame.retry_count == 0) {
       LOG_ERROR("Received invalid SREJ");
       return;
     }
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(req_seq)->second));
-    _send_i_frame(std::get<0>(unacked_list_.find(req_seq)->second), std::move(copyable_packet_builder), buffer_seq_,
-                  req_seq, std::get<1>(unacked_list_.find(req_seq)->second), f);
-    retry_i_frames_[req_seq]++;
+    _send_i_frame(frame.sar, frame.segment, buffer_seq_, req_seq, frame.sdu_size, f);
+    frame.retry_count++;
     start_retrans_timer();
   }
 
@@ -788,10 +812,12 @@ struct ErtmController::impl {
     if (p_bit_outstanding()) {
       return;
     }
-    while (rem_window_not_full() && !pending_frames_.empty()) {
-      auto& frame = pending_frames_.front();
-      send_data(std::get<0>(frame), std::get<1>(frame), std::move(std::get<2>(frame)), f);
-      pending_frames_.pop();
+    while (rem_window_not_full() && pending_frames_count_ > 0) {
+      Frame& frame = pending_frames_[pending_frames_head_];
+      send_data(frame.sar, frame.sdu_size, std::move(frame.segment), f);
+      frame = {};
+      pending_frames_head_ = (pending_frames_head_ + 1) % pending_frames_.size();
+      pending_frames_count_--;
       f = Final::NOT_SET;
     }
   }
@@ -812,21 +838,43 @@ struct ErtmController::impl {
 // Segmentation is handled here
 void ErtmController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
   auto sdu_size = sdu->size();
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
-  auto size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
-                           (fcs_enabled_ ? 2 : 0));
-  packet::FragmentingInserter fragmenting_inserter(size_each_packet, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
-  if (segments.size() == 1) {
-    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, std::move(segments[0]));
+  size_t size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
+                             (fcs_enabled_ ? 2 : 0));
+  auto buffer = acquire_sdu_buffer();
+  buffer->reserve(sdu_size);
+  BitInserter it(*buffer);
+  sdu->Serialize(it);
+  std::shared_ptr<const std::vector<uint8_t>> sdu_buffer = std::move(buffer);
+
+  if (sdu_size <= size_each_packet) {
+    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, {sdu_buffer, 0, sdu_size});
     return;
   }
-  pimpl_->data_request(SegmentationAndReassembly::START, std::move(segments[0]), sdu_size);
-  for (size_t i = 1; i < segments.size() - 1; i++) {
-    pimpl_->data_request(SegmentationAndReassembly::CONTINUATION, std::move(segments[i]));
+  pimpl_->data_request(SegmentationAndReassembly::START, {sdu_buffer, 0, size_each_packet}, sdu_size);
+  size_t begin = size_each_packet;
+  for (; sdu_size - begin > size_each_packet; begin += size_each_packet) {
+    pimpl_->data_request(SegmentationAndReassembly::CONTINUATION, {sdu_buffer, begin, begin + size_each_packet});
   }
-  pimpl_->data_request(SegmentationAndReassembly::END, std::move(segments.back()));
+  pimpl_->data_request(SegmentationAndReassembly::END, {sdu_buffer, begin, sdu_size});
+}
+
+std::shared_ptr<std::vector<uint8_t>> ErtmController::acquire_sdu_buffer() {
+  // A buffer only referenced by the pool has no segment left in the window, the pending queue or the link queue
+  for (size_t i = 0; i < sdu_buffer_pool_.size(); i++) {
+    auto& buffer = sdu_buffer_pool_[(sdu_buffer_pool_next_ + i) % sdu_buffer_pool_.size()];
+    if (buffer.use_count() == 1) {
+      // Pairs with the release of the last reference, which may have been dropped on another thread
+      std::atomic_thread_fence(std::memory_order_acquire);
+      sdu_buffer_pool_next_ = (sdu_buffer_pool_next_ + i + 1) % sdu_buffer_pool_.size();
+      buffer->clear();
+      return buffer;
+    }
+  }
+  auto buffer = std::make_shared<std::vector<uint8_t>>();
+  if (sdu_buffer_pool_.size() < kSduBufferPoolSize) {
+    sdu_buffer_pool_.push_back(buffer);
+  }
+  return buffer;
 }
 
 void ErtmController::OnPdu(packet::PacketView<true> pdu) {
@@ -1049,12 +1097,18 @@ void ErtmController::close_channel() {
   link_->SendDisconnectionRequest(cid_, remote_cid_);
 }
 
-size_t ErtmController::CopyablePacketBuilder::size() const {
-  return builder_->size();
+size_t ErtmController::SegmentBuilder::size() const {
+  return end_ - begin_;
+}
+
+void ErtmController::SegmentBuilder::Serialize(BitInserter& it) const {
+  for (size_t i = begin_; i < end_; i++) {
+    it.insert_byte((*sdu_)[i]);
+  }
 }
 
-void ErtmController::CopyablePacketBuilder::Serialize(BitInserter& it) const {
-  builder_->Serialize(it);
+void ErtmController::SegmentBuilder::SerializeToSpan(SpanInserter& it) const {
+  it.insert_bytes(sdu_->data() + begin_, end_ - begin_);
 }
 
 }  // namespace internal
@@ -19,6 +19,7 @@
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/bidi_queue.h"
 #include "l2cap/cid.h"
@@ -80,18 +81,31 @@ class ErtmController : public DataController {
     }
   };
 
-  class CopyablePacketBuilder : public packet::BasePacketBuilder {
+  // Payload of an I-frame: bytes [begin, end) of an SDU serialized by OnSdu(). All segments of an SDU, and every
+  // retransmission of them, share that one buffer.
+  class SegmentBuilder : public packet::BasePacketBuilder {
    public:
-    CopyablePacketBuilder(std::shared_ptr<packet::RawBuilder> builder) : builder_(std::move(builder)) {}
+    SegmentBuilder(std::shared_ptr<const std::vector<uint8_t>> sdu, size_t begin, size_t end)
+        : sdu_(std::move(sdu)), begin_(begin), end_(end) {}
 
     void Serialize(BitInserter& it) const override;
 
+    void SerializeToSpan(SpanInserter& it) const override;
+
     size_t size() const override;
 
    private:
-    std::shared_ptr<packet::RawBuilder> builder_;
+    std::shared_ptr<const std::vector<uint8_t>> sdu_;
+    size_t begin_;
+    size_t end_;
   };
 
+  // Serialized SDU buffers, reused once no segment refers to them any more
+  static constexpr size_t kSduBufferPoolSize = 64;
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> sdu_buffer_pool_;
+  size_t sdu_buffer_pool_next_ = 0;
+  std::shared_ptr<std::vector<uint8_t>> acquire_sdu_buffer();
+
   PacketViewForReassembly reassembly_stage_{PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>())};
   SegmentationAndReassembly sar_state_ = SegmentationAndReassembly::END;
   uint16_t remaining_sdu_continuation_packet_size_ = 0;
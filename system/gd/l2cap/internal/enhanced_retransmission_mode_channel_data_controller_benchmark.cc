@@ -0,0 +1,134 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/internal/enhanced_retransmission_mode_channel_data_controller.h"
+#include "l2cap/internal/ilink_mock.h"
+#include "l2cap/internal/scheduler_mock.h"
+#include "l2cap/l2cap_packets.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+// Pushes SDUs through an ERTM channel one full transmit window at a time: segment and send them, serialize the
+// resulting I-frames as the link would, then ack the whole window with a single RR.
+class BM_ErtmThroughput : public ::benchmark::Fixture {
+ protected:
+  static constexpr Cid kCid = 0x40;
+  static constexpr uint8_t kTxWindow = 63;
+  static constexpr uint16_t kMps = 1010;
+
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    thread_ = new os::Thread("ertm_benchmark_thread", os::Thread::Priority::NORMAL);
+    handler_ = new os::Handler(thread_);
+    channel_queue_ = new common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue>(10);
+    controller_ = new ErtmController(&link_, kCid, kCid, channel_queue_->GetDownEnd(), handler_, &scheduler_);
+
+    RetransmissionAndFlowControlConfigurationOption option;
+    option.mode_ = RetransmissionAndFlowControlModeOption::ENHANCED_RETRANSMISSION;
+    option.tx_window_size_ = kTxWindow;
+    option.max_transmit_ = 20;
+    option.retransmission_time_out_ = 2000;
+    option.monitor_time_out_ = 12000;
+    option.maximum_pdu_size_ = kMps;
+    controller_->SetRetransmissionAndFlowControlOptions(option);
+  }
+
+  void TearDown(State& st) override {
+    delete controller_;
+    delete channel_queue_;
+    handler_->Clear();
+    delete handler_;
+    delete thread_;
+    controller_ = nullptr;
+    channel_queue_ = nullptr;
+    handler_ = nullptr;
+    thread_ = nullptr;
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  // Serializes every queued PDU and returns how many there were
+  size_t DrainPdus(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      auto pdu = controller_->GetNextPacket();
+      wire_.clear();
+      BitInserter it(wire_);
+      pdu->Serialize(it);
+    }
+    return count;
+  }
+
+  void Ack(uint8_t req_seq) {
+    auto rr = EnhancedSupervisoryFrameBuilder::Create(
+        kCid, SupervisoryFunction::RECEIVER_READY, Poll::NOT_SET, Final::NOT_SET, req_seq);
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    BitInserter it(*bytes);
+    rr->Serialize(it);
+    controller_->OnPdu(packet::PacketView<kLittleEndian>(bytes));
+  }
+
+  os::Thread* thread_ = nullptr;
+  os::Handler* handler_ = nullptr;
+  ::testing::NiceMock<testing::MockScheduler> scheduler_;
+  ::testing::NiceMock<testing::MockILink> link_;
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue>* channel_queue_ = nullptr;
+  ErtmController* controller_ = nullptr;
+  std::vector<uint8_t> wire_;
+};
+
+BENCHMARK_DEFINE_F(BM_ErtmThroughput, send_window_and_ack)(State& state) {
+  const size_t sdu_size = state.range(0);
+  const size_t segments_per_sdu = (sdu_size + kMps - 9) / (kMps - 8);
+  const size_t sdus_per_window = std::max<size_t>(1, kTxWindow / segments_per_sdu);
+  std::vector<uint8_t> sdu(sdu_size, 0x5a);
+  uint8_t next_seq = 0;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < sdus_per_window; i++) {
+      auto builder = std::make_unique<packet::RawBuilder>();
+      builder->AddOctets(sdu);
+      controller_->OnSdu(std::move(builder));
+    }
+    size_t frames = DrainPdus(sdus_per_window * segments_per_sdu);
+    next_seq = (next_seq + frames) % 64;
+    Ack(next_seq);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * sdus_per_window * sdu_size);
+}
+
+BENCHMARK_REGISTER_F(BM_ErtmThroughput, send_window_and_ack)
+    ->Arg(48)
+    ->Arg(672)
+    ->Arg(4000)
+    ->Arg(32000)
+    ->Iterations(2000)
+    ->UseRealTime();
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -204,6 +204,75 @@ TEST_F(ErtmDataControllerTest, receive_packet_with_fcs) {
   EXPECT_EQ(data, "abcd");
 }
 
+TEST_F(ErtmDataControllerTest, transmit_segmented_sdu) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  RetransmissionAndFlowControlConfigurationOption option;
+  option.tx_window_size_ = 10;
+  option.max_transmit_ = 20;
+  option.retransmission_time_out_ = 2000;
+  option.monitor_time_out_ = 12000;
+  option.maximum_pdu_size_ = 8 /* headers */ + 3;
+  controller.SetRetransmissionAndFlowControlOptions(option);
+  EXPECT_CALL(scheduler, OnPacketsReady(1, 1)).Times(3);
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}));
+
+  auto start_view = GetPacketView(controller.GetNextPacket());
+  auto start_frame_view = EnhancedInformationStartFrameView::Create(
+      EnhancedInformationFrameView::Create(StandardFrameView::Create(BasicFrameView::Create(start_view))));
+  EXPECT_TRUE(start_frame_view.IsValid());
+  EXPECT_EQ(start_frame_view.GetL2capSduLength(), 8);
+  auto payload = start_frame_view.GetPayload();
+  EXPECT_EQ(std::string(payload.begin(), payload.end()), "abc");
+
+  std::vector<std::pair<SegmentationAndReassembly, std::string>> expected = {
+      {SegmentationAndReassembly::CONTINUATION, "def"}, {SegmentationAndReassembly::END, "gh"}};
+  for (const auto& [sar, data] : expected) {
+    auto view = GetPacketView(controller.GetNextPacket());
+    auto i_frame_view = EnhancedInformationFrameView::Create(StandardFrameView::Create(BasicFrameView::Create(view)));
+    EXPECT_TRUE(i_frame_view.IsValid());
+    EXPECT_EQ(i_frame_view.GetSar(), sar);
+    payload = i_frame_view.GetPayload();
+    EXPECT_EQ(std::string(payload.begin(), payload.end()), data);
+  }
+}
+
+TEST_F(ErtmDataControllerTest, retransmit_across_tx_seq_wrap_around) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  ::testing::NiceMock<testing::MockScheduler> scheduler;
+  testing::MockILink link;
+  ErtmController controller{&link, 1, 1, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+
+  // Send and ack frames until tx_seq is close to wrapping around
+  constexpr uint8_t kAcked = 62;
+  for (uint8_t i = 0; i < kAcked; i++) {
+    controller.OnSdu(CreateSdu({i}));
+    controller.GetNextPacket();
+    controller.OnPdu(GetPacketView(EnhancedSupervisoryFrameBuilder::Create(
+        1, SupervisoryFunction::RECEIVER_READY, Poll::NOT_SET, Final::NOT_SET, i + 1)));
+  }
+
+  // Frames 62, 63, 0 and 1 stay unacked
+  for (uint8_t i = 0; i < 4; i++) {
+    controller.OnSdu(CreateSdu({i}));
+    controller.GetNextPacket();
+  }
+
+  EXPECT_CALL(link, SendDisconnectionRequest).Times(0);
+  controller.OnPdu(GetPacketView(
+      EnhancedSupervisoryFrameBuilder::Create(1, SupervisoryFunction::REJECT, Poll::NOT_SET, Final::NOT_SET, kAcked)));
+  std::vector<uint8_t> retransmitted;
+  for (int i = 0; i < 4; i++) {
+    auto view = GetPacketView(controller.GetNextPacket());
+    auto i_frame_view = EnhancedInformationFrameView::Create(StandardFrameView::Create(BasicFrameView::Create(view)));
+    ASSERT_TRUE(i_frame_view.IsValid());
+    retransmitted.push_back(i_frame_view.GetTxSeq());
+  }
+  EXPECT_EQ(retransmitted, std::vector<uint8_t>({62, 63, 0, 1}));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace l2cap
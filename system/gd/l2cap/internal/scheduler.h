@@ -60,6 +60,12 @@ class Scheduler {
    */
   virtual void SetChannelTxPriority(Cid cid, bool high_priority) {}
 
+  /**
+   * Relative share of the link given to the specified cid when other channels also have packets ready.
+   * Ignored by schedulers that serve channels in arrival order.
+   */
+  virtual void SetChannelWeight(Cid cid, uint16_t weight) {}
+
   /**
    * Called by data controller to indicate that a channel is closed and packets should be dropped
    */
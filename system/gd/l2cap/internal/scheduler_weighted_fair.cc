@@ -0,0 +1,216 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_weighted_fair.h"
+
+#include <algorithm>
+
+#include "l2cap/internal/data_pipeline_manager.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+constexpr Psm kPsmHidControl = 0x0011;
+constexpr Psm kPsmHidInterrupt = 0x0013;
+constexpr Psm kPsmAvctp = 0x0017;
+constexpr Psm kPsmAvdtp = 0x0019;
+constexpr Psm kPsmAvctpBrowse = 0x001B;
+constexpr Psm kPsmEatt = 0x0027;
+
+}  // namespace
+
+void WeightedFair::LatencyHistogram::Record(std::chrono::steady_clock::duration latency) {
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(latency).count();
+  size_t bucket = 0;
+  while (ms > 0 && bucket < kNumBuckets - 1) {
+    ms >>= 1;
+    bucket++;
+  }
+  buckets[bucket]++;
+}
+
+WeightedFair::WeightedFair(
+    DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler)
+    : data_pipeline_manager_(data_pipeline_manager), link_queue_up_end_(link_queue_up_end), handler_(handler) {
+  ASSERT(link_queue_up_end_ != nullptr && handler_ != nullptr);
+}
+
+// Invoked from some external Handler context
+WeightedFair::~WeightedFair() {
+  try_unregister_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::OnPacketsReady(Cid cid, int number_packets) {
+  if (number_packets <= 0) {
+    return;
+  }
+  auto& channel = channels_[cid];
+  if (channel.ready_times.empty()) {
+    channel.deficit = kQuantumBytes * channel.weight;
+    band_of(channel).push_back(cid);
+  }
+  channel.ready_times.insert(channel.ready_times.end(), number_packets, std::chrono::steady_clock::now());
+  try_register_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::SetChannelTxPriority(Cid cid, bool high_priority) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    if (!high_priority) {
+      return;
+    }
+    it = channels_.emplace(cid, ChannelState{}).first;
+  }
+  auto& channel = it->second;
+  if (channel.high_priority == high_priority) {
+    return;
+  }
+  if (!channel.ready_times.empty()) {
+    remove_from_band(cid, band_of(channel));
+    channel.high_priority = high_priority;
+    band_of(channel).push_back(cid);
+  } else {
+    channel.high_priority = high_priority;
+  }
+}
+
+// Invoked within L2CAP Handler context
+void WeightedFair::SetChannelWeight(Cid cid, uint16_t weight) {
+  channels_[cid].weight = std::max<uint16_t>(weight, 1);
+}
+
+void WeightedFair::RemoveChannel(Cid cid) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    return;
+  }
+  const auto& buckets = it->second.latency.buckets;
+  uint32_t total = 0;
+  for (auto count : buckets) {
+    total += count;
+  }
+  if (total != 0) {
+    LOG_DEBUG(
+        "cid:0x%04hx sent:%u <1ms:%u <4ms:%u <16ms:%u <64ms:%u >=64ms:%u",
+        cid,
+        total,
+        buckets[0],
+        buckets[1] + buckets[2],
+        buckets[3] + buckets[4],
+        buckets[5] + buckets[6],
+        total - (buckets[0] + buckets[1] + buckets[2] + buckets[3] + buckets[4] + buckets[5] + buckets[6]));
+  }
+  if (!it->second.ready_times.empty()) {
+    remove_from_band(cid, band_of(it->second));
+  }
+  channels_.erase(it);
+  if (active_channels_[0].empty() && active_channels_[1].empty()) {
+    try_unregister_link_queue_enqueue();
+  }
+}
+
+uint16_t WeightedFair::GetChannelWeight(Cid cid, Psm psm) {
+  switch (cid) {
+    case kClassicSignallingCid:
+    case kLeSignallingCid:
+    case kSmpCid:
+    case kSmpBrCid:
+      return kLatencySensitiveWeight;
+    case kLeAttributeCid:
+      return kInteractiveWeight;
+    default:
+      break;
+  }
+  switch (psm) {
+    case kPsmHidControl:
+    case kPsmHidInterrupt:
+    case kPsmAvdtp:
+      return kLatencySensitiveWeight;
+    case kPsmAvctp:
+    case kPsmAvctpBrowse:
+    case kPsmEatt:
+      return kInteractiveWeight;
+    default:
+      return kDefaultWeight;
+  }
+}
+
+WeightedFair::LatencyHistogram WeightedFair::GetLatencyHistogram(Cid cid) const {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    return {};
+  }
+  return it->second.latency;
+}
+
+std::deque<Cid>& WeightedFair::band_of(const ChannelState& channel) {
+  return active_channels_[channel.high_priority ? 1 : 0];
+}
+
+void WeightedFair::remove_from_band(Cid cid, std::deque<Cid>& band) {
+  band.erase(std::remove(band.begin(), band.end(), cid), band.end());
+}
+
+// Invoked from some external Queue Reactable context
+std::unique_ptr<WeightedFair::LowerEnqueue> WeightedFair::link_queue_enqueue_callback() {
+  auto& band = active_channels_[1].empty() ? active_channels_[0] : active_channels_[1];
+  ASSERT(!band.empty());
+  Cid cid = band.front();
+  auto& channel = channels_[cid];
+
+  auto packet = data_pipeline_manager_->GetDataController(cid)->GetNextPacket();
+  channel.latency.Record(std::chrono::steady_clock::now() - channel.ready_times.front());
+  channel.ready_times.pop_front();
+  channel.deficit -= packet->size();
+
+  if (channel.ready_times.empty()) {
+    band.pop_front();
+  } else if (channel.deficit <= 0) {
+    // Round is over for this channel, carry the overdraft into the next one
+    band.pop_front();
+    band.push_back(cid);
+    channel.deficit += kQuantumBytes * channel.weight;
+  }
+
+  data_pipeline_manager_->OnPacketSent(cid);
+  if (active_channels_[0].empty() && active_channels_[1].empty()) {
+    try_unregister_link_queue_enqueue();
+  }
+  return packet;
+}
+
+void WeightedFair::try_register_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(true)) {
+    return;
+  }
+  link_queue_up_end_->RegisterEnqueue(
+      handler_, common::Bind(&WeightedFair::link_queue_enqueue_callback, common::Unretained(this)));
+}
+
+void WeightedFair::try_unregister_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(false)) {
+    link_queue_up_end_->UnregisterEnqueue();
+  }
+}
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
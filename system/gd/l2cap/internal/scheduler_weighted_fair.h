@@ -0,0 +1,109 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+#include "common/bidi_queue.h"
+#include "common/bind.h"
+#include "l2cap/cid.h"
+#include "l2cap/psm.h"
+#include "l2cap/internal/scheduler.h"
+#include "os/handler.h"
+#include "os/queue.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+class DataPipelineManager;
+
+/**
+ * Deficit round robin over the channels of a link.
+ *
+ * Each channel with packets ready may send up to weight * kQuantumBytes per round before the next channel gets its
+ * turn, so a bulk channel cannot hold back small packets of interactive channels on the same ACL. The size of a
+ * packet is only known once the data controller hands it over, so a channel may overdraw its deficit by one packet;
+ * the overdraft is paid back in its next round. High priority channels (SetChannelTxPriority) are served first, and
+ * share their band the same way.
+ */
+class WeightedFair : public Scheduler {
+ public:
+  // Bytes a channel of weight 1 may send per round, about one full BR/EDR ACL packet
+  static constexpr int kQuantumBytes = 1021;
+  static constexpr uint16_t kDefaultWeight = 1;
+  // Weight of channels whose traffic is small and bursty but delays user visible behaviour (ATT, AVCTP)
+  static constexpr uint16_t kInteractiveWeight = 2;
+  // Weight of signalling, pairing and latency sensitive streaming channels (HID, AVDTP)
+  static constexpr uint16_t kLatencySensitiveWeight = 4;
+
+  // Time from OnPacketsReady() until the packet is handed to the link queue. Bucket i counts packets that waited less
+  // than 2^i ms; the last bucket also counts everything slower.
+  struct LatencyHistogram {
+    static constexpr size_t kNumBuckets = 12;
+    std::array<uint32_t, kNumBuckets> buckets = {};
+
+    void Record(std::chrono::steady_clock::duration latency);
+  };
+
+  WeightedFair(DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler);
+  ~WeightedFair();
+  void OnPacketsReady(Cid cid, int number_packets) override;
+  void SetChannelTxPriority(Cid cid, bool high_priority) override;
+  void SetChannelWeight(Cid cid, uint16_t weight) override;
+  void RemoveChannel(Cid cid) override;
+
+  LatencyHistogram GetLatencyHistogram(Cid cid) const;
+
+  /**
+   * Weight of a channel by traffic class, from its fixed CID or the PSM of a dynamic channel. Channels that carry bulk
+   * data (RFCOMM, OBEX, unknown PSMs) keep kDefaultWeight.
+   */
+  static uint16_t GetChannelWeight(Cid cid, Psm psm);
+
+ private:
+  struct ChannelState {
+    uint16_t weight = kDefaultWeight;
+    bool high_priority = false;
+    int deficit = 0;
+    // One entry per packet ready to be dequeued
+    std::deque<std::chrono::steady_clock::time_point> ready_times;
+    LatencyHistogram latency;
+  };
+
+  DataPipelineManager* data_pipeline_manager_;
+  LowerQueueUpEnd* link_queue_up_end_;
+  os::Handler* handler_;
+  std::unordered_map<Cid, ChannelState> channels_;
+  // Channels with packets ready, in round robin order. Index 1 is the high priority band.
+  std::array<std::deque<Cid>, 2> active_channels_;
+  std::atomic_bool link_queue_enqueue_registered_ = false;
+
+  std::deque<Cid>& band_of(const ChannelState& channel);
+  void remove_from_band(Cid cid, std::deque<Cid>& band);
+  void try_register_link_queue_enqueue();
+  void try_unregister_link_queue_enqueue();
+  std::unique_ptr<LowerEnqueue> link_queue_enqueue_callback();
+};
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_weighted_fair.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <numeric>
+
+#include "l2cap/internal/channel_impl_mock.h"
+#include "l2cap/internal/data_controller_mock.h"
+#include "l2cap/internal/data_pipeline_manager_mock.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::Return;
+
+// Basic frame header is 4 bytes, so a frame carrying this payload costs exactly one quantum
+constexpr size_t kBulkPayloadSize = WeightedFair::kQuantumBytes - 4;
+constexpr size_t kInteractivePayloadSize = 8;
+
+std::unique_ptr<packet::BasePacketBuilder> CreateFrame(Cid cid, size_t payload_size) {
+  auto raw_builder = std::make_unique<packet::RawBuilder>();
+  raw_builder->AddOctets(std::vector<uint8_t>(payload_size, static_cast<uint8_t>(cid)));
+  return BasicFrameBuilder::Create(cid, std::move(raw_builder));
+}
+
+Cid GetChannelId(std::unique_ptr<packet::BasePacketBuilder> packet) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  BitInserter i(*bytes);
+  bytes->reserve(packet->size());
+  packet->Serialize(i);
+  auto basic_frame_view = BasicFrameView::Create(packet::PacketView<packet::kLittleEndian>(bytes));
+  EXPECT_TRUE(basic_frame_view.IsValid());
+  return basic_frame_view.GetChannelId();
+}
+
+class MyDataController : public testing::MockDataController {
+ public:
+  std::unique_ptr<BasePacketBuilder> GetNextPacket() override {
+    auto next = std::move(next_packets.front());
+    next_packets.pop();
+    return next;
+  }
+
+  std::queue<std::unique_ptr<BasePacketBuilder>> next_packets;
+};
+
+class L2capSchedulerWeightedFairTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new os::Thread("test_thread", os::Thread::Priority::NORMAL);
+    queue_handler_ = new os::Handler(thread_);
+    mock_data_pipeline_manager_ = new testing::MockDataPipelineManager(queue_handler_, &queue_end_);
+    scheduler_ = new WeightedFair(mock_data_pipeline_manager_, &queue_end_, queue_handler_);
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(1)).WillRepeatedly(Return(&data_controller_1_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(2)).WillRepeatedly(Return(&data_controller_2_));
+    EXPECT_CALL(*mock_data_pipeline_manager_, OnPacketSent(_)).Times(::testing::AnyNumber());
+  }
+
+  void TearDown() override {
+    delete scheduler_;
+    delete mock_data_pipeline_manager_;
+    queue_handler_->Clear();
+    delete queue_handler_;
+    delete thread_;
+  }
+
+  void QueuePackets(Cid cid, MyDataController* data_controller, int count, size_t payload_size) {
+    for (int i = 0; i < count; i++) {
+      data_controller->next_packets.push(CreateFrame(cid, payload_size));
+    }
+    scheduler_->OnPacketsReady(cid, count);
+  }
+
+  std::vector<Cid> RunEnqueue(unsigned times) {
+    enqueue_.run_enqueue(times);
+    std::vector<Cid> cids;
+    while (!enqueue_.enqueued.empty()) {
+      cids.push_back(GetChannelId(std::move(enqueue_.enqueued.front())));
+      enqueue_.enqueued.pop();
+    }
+    return cids;
+  }
+
+  os::Thread* thread_ = nullptr;
+  os::Handler* queue_handler_ = nullptr;
+  os::MockIQueueDequeue<Scheduler::LowerDequeue> dequeue_;
+  os::MockIQueueEnqueue<Scheduler::LowerEnqueue> enqueue_;
+  common::BidiQueueEnd<Scheduler::LowerEnqueue, Scheduler::LowerDequeue> queue_end_{&enqueue_, &dequeue_};
+  testing::MockDataPipelineManager* mock_data_pipeline_manager_ = nullptr;
+  MyDataController data_controller_1_;
+  MyDataController data_controller_2_;
+  WeightedFair* scheduler_ = nullptr;
+};
+
+TEST_F(L2capSchedulerWeightedFairTest, send_packet) {
+  QueuePackets(1, &data_controller_1_, 1, kInteractivePayloadSize);
+  ASSERT_EQ(RunEnqueue(1), std::vector<Cid>({1}));
+  ASSERT_EQ(enqueue_.registered_handler, nullptr);
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, interactive_channel_not_stuck_behind_bulk_backlog) {
+  QueuePackets(1, &data_controller_1_, 10, kBulkPayloadSize);
+  QueuePackets(2, &data_controller_2_, 1, kInteractivePayloadSize);
+  ASSERT_EQ(RunEnqueue(11), std::vector<Cid>({1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, small_packets_share_one_quantum) {
+  QueuePackets(1, &data_controller_1_, 2, kBulkPayloadSize);
+  QueuePackets(2, &data_controller_2_, 3, kInteractivePayloadSize);
+  // The interactive channel drains all its packets within a single turn
+  ASSERT_EQ(RunEnqueue(5), std::vector<Cid>({1, 2, 2, 2, 1}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, share_follows_weight) {
+  scheduler_->SetChannelWeight(1, 2);
+  QueuePackets(1, &data_controller_1_, 8, kBulkPayloadSize);
+  QueuePackets(2, &data_controller_2_, 8, kBulkPayloadSize);
+  auto cids = RunEnqueue(9);
+  ASSERT_EQ(cids, std::vector<Cid>({1, 1, 2, 1, 1, 2, 1, 1, 2}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, traffic_classes_share_by_weight) {
+  // A HID interrupt channel and an RFCOMM channel, weighted the way DataPipelineManager::AttachChannel does
+  scheduler_->SetChannelWeight(1, WeightedFair::GetChannelWeight(0x0040, 0x0013));
+  scheduler_->SetChannelWeight(2, WeightedFair::GetChannelWeight(0x0041, 0x0003));
+  QueuePackets(1, &data_controller_1_, 8, kBulkPayloadSize);
+  QueuePackets(2, &data_controller_2_, 8, kBulkPayloadSize);
+  auto cids = RunEnqueue(10);
+  ASSERT_EQ(cids, std::vector<Cid>({1, 1, 1, 1, 2, 1, 1, 1, 1, 2}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, prioritize_channel) {
+  scheduler_->SetChannelTxPriority(2, true);
+  QueuePackets(1, &data_controller_1_, 2, kInteractivePayloadSize);
+  QueuePackets(2, &data_controller_2_, 2, kBulkPayloadSize);
+  ASSERT_EQ(RunEnqueue(4), std::vector<Cid>({2, 2, 1, 1}));
+
+  scheduler_->SetChannelTxPriority(2, false);
+  QueuePackets(2, &data_controller_2_, 2, kBulkPayloadSize);
+  QueuePackets(1, &data_controller_1_, 1, kInteractivePayloadSize);
+  ASSERT_EQ(RunEnqueue(3), std::vector<Cid>({2, 1, 2}));
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, remove_channel) {
+  QueuePackets(1, &data_controller_1_, 1, kInteractivePayloadSize);
+  QueuePackets(2, &data_controller_2_, 1, kInteractivePayloadSize);
+  scheduler_->RemoveChannel(1);
+  ASSERT_EQ(RunEnqueue(2), std::vector<Cid>({2}));
+
+  QueuePackets(2, &data_controller_2_, 1, kInteractivePayloadSize);
+  scheduler_->RemoveChannel(2);
+  ASSERT_EQ(enqueue_.registered_handler, nullptr);
+}
+
+TEST_F(L2capSchedulerWeightedFairTest, latency_histogram) {
+  QueuePackets(1, &data_controller_1_, 4, kBulkPayloadSize);
+  QueuePackets(2, &data_controller_2_, 2, kInteractivePayloadSize);
+  RunEnqueue(6);
+
+  auto histogram_1 = scheduler_->GetLatencyHistogram(1);
+  auto histogram_2 = scheduler_->GetLatencyHistogram(2);
+  ASSERT_EQ(std::accumulate(histogram_1.buckets.begin(), histogram_1.buckets.end(), 0u), 4u);
+  ASSERT_EQ(std::accumulate(histogram_2.buckets.begin(), histogram_2.buckets.end(), 0u), 2u);
+
+  auto unknown = scheduler_->GetLatencyHistogram(3);
+  ASSERT_EQ(std::accumulate(unknown.buckets.begin(), unknown.buckets.end(), 0u), 0u);
+}
+
+TEST(L2capChannelWeightTest, weight_by_traffic_class) {
+  ASSERT_EQ(WeightedFair::GetChannelWeight(kClassicSignallingCid, kDefaultPsm), WeightedFair::kLatencySensitiveWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(kSmpCid, kDefaultPsm), WeightedFair::kLatencySensitiveWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(kLeAttributeCid, kDefaultPsm), WeightedFair::kInteractiveWeight);
+  // HID interrupt, AVDTP, AVCTP and EATT
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x0013), WeightedFair::kLatencySensitiveWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x0019), WeightedFair::kLatencySensitiveWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x0017), WeightedFair::kInteractiveWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x0027), WeightedFair::kInteractiveWeight);
+  // RFCOMM and a dynamic PSM
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x0003), WeightedFair::kDefaultWeight);
+  ASSERT_EQ(WeightedFair::GetChannelWeight(0x0040, 0x1001), WeightedFair::kDefaultWeight);
+}
+
+TEST(L2capLatencyHistogramTest, record) {
+  WeightedFair::LatencyHistogram histogram;
+  histogram.Record(std::chrono::microseconds(500));
+  histogram.Record(std::chrono::milliseconds(1));
+  histogram.Record(std::chrono::milliseconds(3));
+  histogram.Record(std::chrono::milliseconds(100));
+  histogram.Record(std::chrono::seconds(60));
+  ASSERT_EQ(histogram.buckets[0], 1u);
+  ASSERT_EQ(histogram.buckets[1], 1u);
+  ASSERT_EQ(histogram.buckets[2], 1u);
+  ASSERT_EQ(histogram.buckets[7], 1u);
+  ASSERT_EQ(histogram.buckets[WeightedFair::LatencyHistogram::kNumBuckets - 1], 1u);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
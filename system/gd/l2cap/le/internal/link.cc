@@ -19,6 +19,7 @@
 #include <chrono>
 #include <memory>
 
+#include "common/init_flags.h"
 #include "hci/acl_manager/le_acl_connection.h"
 #include "l2cap/internal/dynamic_channel_impl.h"
 #include "l2cap/internal/parameter_provider.h"
@@ -40,7 +41,10 @@ Link::Link(os::Handler* l2cap_handler, std::unique_ptr<hci::acl_manager::LeAclCo
            DynamicChannelServiceManagerImpl* dynamic_service_manager,
            FixedChannelServiceManagerImpl* fixed_service_manager, LinkManager* link_manager)
     : l2cap_handler_(l2cap_handler), acl_connection_(std::move(acl_connection)),
-      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd()),
+      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd(),
+                             bluetooth::common::init_flags::l2cap_weighted_fair_scheduler_is_enabled()
+                                 ? l2cap::internal::DataPipelineManager::SchedulerType::WEIGHTED_FAIR
+                                 : l2cap::internal::DataPipelineManager::SchedulerType::FIFO),
       parameter_provider_(parameter_provider), dynamic_service_manager_(dynamic_service_manager),
       signalling_manager_(l2cap_handler_, this, &data_pipeline_manager_, dynamic_service_manager_,
                           &dynamic_channel_allocator_),
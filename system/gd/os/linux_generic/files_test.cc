@@ -82,6 +82,15 @@ TEST(FilesTest, write_read_empty_string_test) {
   EXPECT_TRUE(std::filesystem::remove(temp_file));
 }
 
+TEST(FilesTest, write_read_binary_test) {
+  auto temp_dir = std::filesystem::temp_directory_path();
+  auto temp_file = temp_dir / "file_1.bin";
+  std::string data("\x01\x00\xff\x00\n", 5);
+  ASSERT_TRUE(WriteToFile(temp_file.string(), data));
+  EXPECT_THAT(ReadSmallFile(temp_file.string()), Optional(StrEq(data)));
+  EXPECT_TRUE(std::filesystem::remove(temp_file));
+}
+
 TEST(FilesTest, read_non_existing_file_test) {
   EXPECT_FALSE(ReadSmallFile("/woof"));
 }
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "packet/bit_inserter.h"
+#include "packet/span_inserter.h"
 
 namespace bluetooth {
 namespace packet {
@@ -38,6 +39,15 @@ class BasePacketBuilder {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Write to memory allocated up front for size() bytes. Generated code overrides this to write the fields
+  // in place; other subclasses are serialized to a vector first.
+  virtual void SerializeToSpan(SpanInserter& it) const {
+    std::vector<uint8_t> bytes;
+    BitInserter bi(bytes);
+    Serialize(bi);
+    it.insert_bytes(bytes.data(), bytes.size());
+  }
+
   void SetFlushable(bool is_flushable) {
     is_flushable_ = is_flushable;
   }
@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "packet/bit_inserter.h"
+#include "packet/span_inserter.h"
 
 namespace bluetooth {
 namespace packet {
@@ -37,6 +38,15 @@ class BaseStruct {
   // Write to the vector with the given iterator.
   virtual void Serialize(BitInserter& it) const = 0;
 
+  // Write to memory allocated up front for size() bytes. Generated code overrides this to write the fields
+  // in place; other subclasses are serialized to a vector first.
+  virtual void SerializeToSpan(SpanInserter& it) const {
+    std::vector<uint8_t> bytes;
+    BitInserter bi(bytes);
+    Serialize(bi);
+    it.insert_bytes(bytes.data(), bytes.size());
+  }
+
  protected:
   BaseStruct() = default;
 };
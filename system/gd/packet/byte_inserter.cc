@@ -48,5 +48,11 @@ void ByteInserter::insert_byte(uint8_t byte) {
   std::back_insert_iterator<std::vector<uint8_t>>::operator=(byte);
 }
 
+void ByteInserter::insert_bytes(const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    insert_byte(bytes[i]);
+  }
+}
+
 }  // namespace packet
 }  // namespace bluetooth
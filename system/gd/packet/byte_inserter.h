@@ -33,6 +33,9 @@ class ByteInserter : public std::back_insert_iterator<std::vector<uint8_t>> {
 
   virtual void insert_byte(uint8_t byte);
 
+  // Insert |size| bytes one at a time, so subclasses overriding insert_byte() see every byte.
+  void insert_bytes(const uint8_t* bytes, size_t size);
+
   void RegisterObserver(const ByteObserver& observer);
 
   ByteObserver UnregisterObserver();
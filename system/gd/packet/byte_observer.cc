@@ -26,6 +26,12 @@ void ByteObserver::OnByte(uint8_t byte) {
   on_byte_(byte);
 }
 
+void ByteObserver::OnBytes(const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    on_byte_(bytes[i]);
+  }
+}
+
 uint64_t ByteObserver::GetValue() {
   return get_value_();
 }
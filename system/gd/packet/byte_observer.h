@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 
@@ -28,6 +29,8 @@ class ByteObserver {
 
   void OnByte(uint8_t byte);
 
+  void OnBytes(const uint8_t* bytes, size_t size);
+
   uint64_t GetValue();
 
  private:
@@ -20,17 +20,30 @@
 #include <forward_list>
 #include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "os/log.h"
 #include "packet/bit_inserter.h"
 #include "packet/custom_field_fixed_size_interface.h"
+#include "packet/span_inserter.h"
 
 namespace bluetooth {
 namespace packet {
 
+template <typename T, typename = void>
+struct has_serialize_to_span : std::false_type {};
+
+template <typename T>
+struct has_serialize_to_span<
+    T,
+    std::void_t<decltype(std::declval<const T&>().SerializeToSpan(std::declval<SpanInserter&>()))>>
+    : std::true_type {};
+
 // Abstract base class that is subclassed to provide insert() functions.
 // The template parameter little_endian controls the generation of insert().
+// The functions take either a BitInserter or a SpanInserter.
 template <bool little_endian>
 class EndianInserter {
  public:
@@ -39,8 +52,11 @@ class EndianInserter {
 
  protected:
   // Write sizeof(FixedWidthPODType) bytes using the iterator
-  template <typename FixedWidthPODType, typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
-  void insert(FixedWidthPODType value, BitInserter& it) const {
+  template <
+      typename FixedWidthPODType,
+      typename Inserter,
+      typename std::enable_if<std::is_pod<FixedWidthPODType>::value, int>::type = 0>
+  void insert(FixedWidthPODType value, Inserter& it) const {
     uint8_t* raw_bytes = (uint8_t*)&value;
     for (size_t i = 0; i < sizeof(FixedWidthPODType); i++) {
       if (little_endian == true) {
@@ -54,9 +70,14 @@ class EndianInserter {
   // Write sizeof(FixedWidthCustomType) bytes using the iterator
   template <
       typename T,
+      typename Inserter,
       typename std::enable_if<std::is_base_of<CustomFieldFixedSizeInterface<T>, T>::value, int>::type = 0>
-  void insert(const T& value, BitInserter& it) const {
+  void insert(const T& value, Inserter& it) const {
     auto* raw_bytes = value.data();
+    if (little_endian == true) {
+      it.insert_bytes(raw_bytes, CustomFieldFixedSizeInterface<T>::length());
+      return;
+    }
     for (size_t i = 0; i < CustomFieldFixedSizeInterface<T>::length(); i++) {
       if (little_endian == true) {
         it.insert_byte(raw_bytes[i]);
@@ -67,9 +88,11 @@ class EndianInserter {
   }
 
   // Write num_bits bits using the iterator
-  template <typename FixedWidthIntegerType,
-            typename std::enable_if<std::is_pod<FixedWidthIntegerType>::value, int>::type = 0>
-  void insert(FixedWidthIntegerType value, BitInserter& it, size_t num_bits) const {
+  template <
+      typename FixedWidthIntegerType,
+      typename Inserter,
+      typename std::enable_if<std::is_pod<FixedWidthIntegerType>::value, int>::type = 0>
+  void insert(FixedWidthIntegerType value, Inserter& it, size_t num_bits) const {
     ASSERT(num_bits <= (sizeof(FixedWidthIntegerType) * 8));
 
     for (size_t i = 0; i < num_bits / 8; i++) {
@@ -85,20 +108,43 @@ class EndianInserter {
   }
 
   // Specialized insert that allows inserting enums without casting
-  template <typename Enum, typename std::enable_if<std::is_enum_v<Enum>, int>::type = 0>
-  inline void insert(Enum value, BitInserter& it) const {
+  template <typename Enum, typename Inserter, typename std::enable_if<std::is_enum_v<Enum>, int>::type = 0>
+  inline void insert(Enum value, Inserter& it) const {
     using enum_type = typename std::underlying_type_t<Enum>;
     static_assert(std::is_unsigned_v<enum_type>, "Enum type is signed. Did you forget to specify the enum size?");
     insert<enum_type>(static_cast<enum_type>(value), it);
   }
 
+  // Write a struct, a payload or a custom field which serializes itself
+  template <typename T>
+  void insert_serializable(const T& value, BitInserter& it) const {
+    value.Serialize(it);
+  }
+
+  // Custom fields and hand-written builders without SerializeToSpan() are serialized to a vector first
+  template <typename T>
+  void insert_serializable(const T& value, SpanInserter& it) const {
+    if constexpr (has_serialize_to_span<T>::value) {
+      value.SerializeToSpan(it);
+    } else {
+      std::vector<uint8_t> bytes;
+      BitInserter bi(bytes);
+      value.Serialize(bi);
+      it.insert_bytes(bytes.data(), bytes.size());
+    }
+  }
+
   // Write a vector of FixedWidthIntegerType using the iterator
-  template <typename FixedWidthIntegerType>
-  void insert_vector(const std::vector<FixedWidthIntegerType>& vec, BitInserter& it) const {
+  template <typename FixedWidthIntegerType, typename Inserter>
+  void insert_vector(const std::vector<FixedWidthIntegerType>& vec, Inserter& it) const {
     static_assert(std::is_pod<FixedWidthIntegerType>::value,
                   "EndianInserter::insert requires a vector with elements of a fixed-size.");
-    for (const auto& element : vec) {
-      insert(element, it);
+    if constexpr (std::is_same_v<FixedWidthIntegerType, uint8_t>) {
+      it.insert_bytes(vec.data(), vec.size());
+    } else {
+      for (const auto& element : vec) {
+        insert(element, it);
+      }
     }
   }
 };
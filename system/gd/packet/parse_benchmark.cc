@@ -0,0 +1,151 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "packet/bit_inserter.h"
+#include "packet/packet_view.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace packet {
+namespace {
+
+// Events received while scanning in a crowded place, each with as many reports as the controller fits
+constexpr size_t kStormEvents = 1000;
+constexpr size_t kLegacyReportsPerEvent = 5;
+constexpr size_t kExtendedReportsPerEvent = 3;
+
+hci::Address StormAddress(size_t event, size_t report) {
+  return hci::Address({0xc0, 0x11, static_cast<uint8_t>(event >> 8), static_cast<uint8_t>(event),
+                       static_cast<uint8_t>(report), 0x5a});
+}
+
+std::vector<uint8_t> StormData(size_t size, size_t seed) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; i++) {
+    data[i] = static_cast<uint8_t>(seed + i);
+  }
+  return data;
+}
+
+std::vector<PacketView<kLittleEndian>> ToPacketViews(
+    std::vector<std::unique_ptr<BasePacketBuilder>> builders) {
+  std::vector<PacketView<kLittleEndian>> events;
+  for (auto& builder : builders) {
+    auto bytes = std::make_shared<std::vector<uint8_t>>();
+    BitInserter it(*bytes);
+    builder->Serialize(it);
+    events.emplace_back(bytes);
+  }
+  return events;
+}
+
+std::vector<PacketView<kLittleEndian>> CreateLegacyStorm() {
+  std::vector<std::unique_ptr<BasePacketBuilder>> builders;
+  for (size_t event = 0; event < kStormEvents; event++) {
+    std::vector<hci::LeAdvertisingResponseRaw> responses(kLegacyReportsPerEvent);
+    for (size_t report = 0; report < responses.size(); report++) {
+      responses[report].event_type_ = hci::AdvertisingEventType::ADV_IND;
+      responses[report].address_type_ = hci::AddressType::RANDOM_DEVICE_ADDRESS;
+      responses[report].address_ = StormAddress(event, report);
+      responses[report].advertising_data_ = StormData(31, event + report);
+      responses[report].rssi_ = static_cast<uint8_t>(-60);
+    }
+    builders.push_back(hci::LeAdvertisingReportRawBuilder::Create(responses));
+  }
+  return ToPacketViews(std::move(builders));
+}
+
+std::vector<PacketView<kLittleEndian>> CreateExtendedStorm() {
+  std::vector<std::unique_ptr<BasePacketBuilder>> builders;
+  for (size_t event = 0; event < kStormEvents; event++) {
+    std::vector<hci::LeExtendedAdvertisingResponseRaw> responses(kExtendedReportsPerEvent);
+    for (size_t report = 0; report < responses.size(); report++) {
+      responses[report].connectable_ = 1;
+      responses[report].data_status_ = hci::DataStatus::COMPLETE;
+      responses[report].address_type_ = hci::DirectAdvertisingAddressType::RANDOM_DEVICE_ADDRESS;
+      responses[report].address_ = StormAddress(event, report);
+      responses[report].primary_phy_ = hci::PrimaryPhyType::LE_1M;
+      responses[report].secondary_phy_ = hci::SecondaryPhyType::LE_2M;
+      responses[report].rssi_ = static_cast<uint8_t>(-60);
+      responses[report].advertising_data_ = StormData(50, event + report);
+    }
+    builders.push_back(hci::LeExtendedAdvertisingReportRawBuilder::Create(responses));
+  }
+  return ToPacketViews(std::move(builders));
+}
+
+template <typename View>
+View CreateReportView(const PacketView<kLittleEndian>& event) {
+  return View::Create(hci::LeMetaEventView::Create(hci::EventView::Create(event)));
+}
+
+template <typename View>
+void BM_ParseReportsToVector(State& state, std::vector<PacketView<kLittleEndian>> (*create)()) {
+  auto events = create();
+  size_t reports = 0;
+  for (auto _ : state) {
+    for (const auto& event : events) {
+      auto view = CreateReportView<View>(event);
+      if (!view.IsValid()) {
+        state.SkipWithError("invalid advertising report");
+        return;
+      }
+      for (const auto& report : view.GetResponses()) {
+        ::benchmark::DoNotOptimize(report.advertising_data_.data());
+        reports++;
+      }
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(reports));
+}
+
+template <typename View>
+void BM_ParseReportsInRange(State& state, std::vector<PacketView<kLittleEndian>> (*create)()) {
+  auto events = create();
+  size_t reports = 0;
+  for (auto _ : state) {
+    for (const auto& event : events) {
+      auto view = CreateReportView<View>(event);
+      if (!view.IsValid()) {
+        state.SkipWithError("invalid advertising report");
+        return;
+      }
+      for (const auto& report : view.GetResponsesRange()) {
+        ::benchmark::DoNotOptimize(report.advertising_data_.data());
+        reports++;
+      }
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(reports));
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_ParseReportsToVector<hci::LeAdvertisingReportRawView>, legacy_storm, CreateLegacyStorm);
+BENCHMARK_CAPTURE(BM_ParseReportsInRange<hci::LeAdvertisingReportRawView>, legacy_storm, CreateLegacyStorm);
+BENCHMARK_CAPTURE(
+    BM_ParseReportsToVector<hci::LeExtendedAdvertisingReportRawView>, extended_storm, CreateExtendedStorm);
+BENCHMARK_CAPTURE(
+    BM_ParseReportsInRange<hci::LeExtendedAdvertisingReportRawView>, extended_storm, CreateExtendedStorm);
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -85,7 +85,7 @@ void CustomField::GenParameterValidator(std::ostream&) const {
 }
 
 void CustomField::GenInserter(std::ostream& s) const {
-  s << GetName() << "_.Serialize(i);";
+  s << "insert_serializable(" << GetName() << "_, i);";
 }
 
 void CustomField::GenValidator(std::ostream&) const {
@@ -77,7 +77,7 @@ void StructField::GenParameterValidator(std::ostream&) const {
 }
 
 void StructField::GenInserter(std::ostream& s) const {
-  s << GetName() << "_.Serialize(i);";
+  s << "insert_serializable(" << GetName() << "_, i);";
 }
 
 void StructField::GenValidator(std::ostream&) const {
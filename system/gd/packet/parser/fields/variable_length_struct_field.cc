@@ -40,6 +40,10 @@ std::string VariableLengthStructField::GetDataType() const {
   return ret;
 }
 
+const std::string& VariableLengthStructField::GetTypeName() const {
+  return type_name_;
+}
+
 void VariableLengthStructField::GenExtractor(std::ostream& s, int, bool) const {
   s << GetName() << "_ptr = Parse" << type_name_ << "(" << GetName() << "_it);";
   s << "if (" << GetName() << "_ptr != nullptr) {";
@@ -84,7 +88,7 @@ void VariableLengthStructField::GenParameterValidator(std::ostream&) const {
 }
 
 void VariableLengthStructField::GenInserter(std::ostream& s) const {
-  s << GetName() << "_->Serialize(i);";
+  s << "insert_serializable(*" << GetName() << "_, i);";
 }
 
 void VariableLengthStructField::GenValidator(std::ostream&) const {
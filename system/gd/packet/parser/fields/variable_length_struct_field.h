@@ -33,6 +33,9 @@ class VariableLengthStructField : public PacketField {
 
   virtual std::string GetDataType() const override;
 
+  // The struct type, without the std::unique_ptr.
+  const std::string& GetTypeName() const;
+
   virtual void GenExtractor(std::ostream& s, int num_leading_bits, bool for_struct) const override;
 
   virtual std::string GetGetterFunctionName() const override;
@@ -18,6 +18,9 @@
 
 #include "fields/count_field.h"
 #include "fields/custom_field.h"
+#include "fields/scalar_field.h"
+#include "fields/struct_field.h"
+#include "fields/variable_length_struct_field.h"
 #include "util.h"
 
 const std::string VectorField::kFieldType = "VectorField";
@@ -163,6 +166,35 @@ void VectorField::GenGetter(std::ostream& s, Size start_offset, Size end_offset)
 
   s << "return " << GetName() << "_value;";
   s << "}\n";
+
+  // Vectors of structs also get a range, which parses the elements as it is iterated
+  bool is_struct = element_field_->GetFieldType() == StructField::kFieldType;
+  bool is_variable_length_struct = element_field_->GetFieldType() == VariableLengthStructField::kFieldType;
+  if (!is_struct && !is_variable_length_struct) {
+    return;
+  }
+  s << "auto " << GetGetterFunctionName() << "Range() {";
+  s << "ASSERT(was_validated_);";
+  s << "size_t end_index = size();";
+  s << "auto to_bound = begin();";
+  GenBounds(s, start_offset, end_offset, GetSize());
+  s << "size_t count = ";
+  if (size_field_ != nullptr && size_field_->GetFieldType() == CountField::kFieldType) {
+    s << "Get" << util::UnderscoreToCamelCase(size_field_->GetName()) << "();";
+  } else {
+    s << "::bluetooth::packet::kUncountedField;";
+  }
+  // The same bound on the bytes left as the getter
+  s << "size_t element_size = " << (element_size_.empty() ? 1 : element_size_.bytes()) << ";";
+  if (is_struct) {
+    s << "return ::bluetooth::packet::MakeStructRange<" << element_field_->GetDataType() << ">(";
+    s << GetName() << "_it, count, element_size);";
+  } else {
+    const auto& type_name = static_cast<const VariableLengthStructField*>(element_field_)->GetTypeName();
+    s << "return ::bluetooth::packet::MakeVariableLengthStructRange<" << type_name << ">(";
+    s << GetName() << "_it, count, element_size, &Parse" << type_name << ");";
+  }
+  s << "}\n";
 }
 
 std::string VectorField::GetBuilderParameterType() const {
@@ -197,6 +229,10 @@ void VectorField::GenParameterValidator(std::ostream&) const {
 }
 
 void VectorField::GenInserter(std::ostream& s) const {
+  if (element_field_->GetFieldType() == ScalarField::kFieldType && element_field_->GetSize().bits() == 8) {
+    s << "i.insert_bytes(" << GetName() << "_.data(), " << GetName() << "_.size());";
+    return;
+  }
   s << "for (const auto& val_ : " << GetName() << "_) {";
   element_field_->GenInserter(s);
   s << "}\n";
@@ -93,6 +93,8 @@ bool generate_cpp_headers_one_file(
 #include "packet/packet_builder.h"
 #include "packet/packet_struct.h"
 #include "packet/packet_view.h"
+#include "packet/span_inserter.h"
+#include "packet/struct_range.h"
 #include "packet/checksum_type_checker.h"
 #include "packet/custom_type_checker.h"
 #include "os/log.h"
@@ -140,6 +142,7 @@ using ::bluetooth::packet::kLittleEndian;
 using ::bluetooth::packet::PacketBuilder;
 using ::bluetooth::packet::PacketStruct;
 using ::bluetooth::packet::PacketView;
+using ::bluetooth::packet::SpanInserter;
 using ::bluetooth::packet::parser::ChecksumTypeChecker;
 )";
 
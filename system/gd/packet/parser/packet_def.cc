@@ -479,6 +479,10 @@ void PacketDef::GenTestDefine(std::ostream& s) const {
   s << "BitInserter it(*packet_bytes);";
   s << "packet->Serialize(it);";
   s << "ASSERT_EQ(*packet_bytes, captured_packet);";
+  s << "std::vector<uint8_t> span_bytes(packet->size());";
+  s << "SpanInserter span_it(span_bytes.data(), span_bytes.size());";
+  s << "packet->SerializeToSpan(span_it);";
+  s << "ASSERT_EQ(span_bytes, captured_packet);";
   s << "}";
   s << "};";
   s << "TEST_P(" << name_ << "ReflectionTest, generatedReflectionTest) {";
@@ -521,6 +525,10 @@ void PacketDef::GenReflectTestDefine(std::ostream& s) const {
   s << "packet_bytes->reserve(packet->size());";
   s << "BitInserter it(*packet_bytes);";
   s << "packet->Serialize(it);";
+  s << "std::vector<uint8_t> span_bytes(packet->size());";
+  s << "SpanInserter span_it(span_bytes.data(), span_bytes.size());";
+  s << "packet->SerializeToSpan(span_it);";
+  s << "ASSERT(span_bytes == *packet_bytes);";
   s << "}";
   s << "\n#endif\n";
 }
@@ -361,8 +361,9 @@ void ParentDef::GenSerialize(std::ostream& s) const {
   auto header_fields = fields_.GetFieldsBeforePayloadOrBody();
   auto footer_fields = fields_.GetFieldsAfterPayloadOrBody();
 
+  // The header and footer are shared by the BitInserter and the SpanInserter paths.
   s << "protected:";
-  s << "void SerializeHeader(BitInserter&";
+  s << "template <class Inserter> void SerializeHeader(Inserter&";
   if (parent_ != nullptr || header_fields.size() != 0) {
     s << " i ";
   }
@@ -461,7 +462,7 @@ void ParentDef::GenSerialize(std::ostream& s) const {
   }
   s << "}\n\n";
 
-  s << "void SerializeFooter(BitInserter&";
+  s << "template <class Inserter> void SerializeFooter(Inserter&";
   if (parent_ != nullptr || footer_fields.size() != 0) {
     s << " i ";
   }
@@ -486,7 +487,14 @@ void ParentDef::GenSerialize(std::ostream& s) const {
     s << "payload_->Serialize(i);";
   }
   s << "SerializeFooter(i);";
+  s << "}\n";
 
+  s << "virtual void SerializeToSpan(SpanInserter& i) const override {";
+  s << "SerializeHeader(i);";
+  if (fields_.HasPayload()) {
+    s << "payload_->SerializeToSpan(i);";
+  }
+  s << "SerializeFooter(i);";
   s << "}\n";
 }
 
@@ -25,10 +25,13 @@
 #include "packet/parser/test/six_bytes.h"
 #include "packet/parser/test/test_packets.h"
 #include "packet/raw_builder.h"
+#include "packet/span_inserter.h"
 
+using ::bluetooth::packet::BasePacketBuilder;
 using ::bluetooth::packet::BitInserter;
 using ::bluetooth::packet::kLittleEndian;
 using ::bluetooth::packet::RawBuilder;
+using ::bluetooth::packet::SpanInserter;
 using ::bluetooth::packet::parser::test::SixBytes;
 using std::vector;
 
@@ -993,6 +996,15 @@ TEST(GeneratedPacketTest, testVectorOfStruct) {
     ASSERT_EQ(array[i].id_, copy_array[i].id_);
     ASSERT_EQ(array[i].count_, copy_array[i].count_);
   }
+
+  size_t index = 0;
+  for (const auto& element : view.GetArrayRange()) {
+    ASSERT_LT(index, copy_array.size());
+    ASSERT_EQ(element.id_, copy_array[index].id_);
+    ASSERT_EQ(element.count_, copy_array[index].count_);
+    index++;
+  }
+  ASSERT_EQ(copy_array.size(), index);
 }
 
 TEST(GeneratedPacketTest, testArrayOfStruct) {
@@ -1653,6 +1665,16 @@ TEST(GeneratedPacketTest, testOneGenericStructArray) {
                 TwoByteStruct::Specialize(an_array[i].get())->two_bytes_);
     }
   }
+
+  size_t index = 0;
+  for (auto& element : view.GetAnArrayRange()) {
+    ASSERT_LT(index, vector_copy.size());
+    ASSERT_NE(nullptr, element);
+    ASSERT_EQ(vector_copy[index]->struct_type_, element->struct_type_);
+    ASSERT_EQ(vector_copy[index]->size(), element->size());
+    index++;
+  }
+  ASSERT_EQ(vector_copy.size(), index);
 }
 
 TEST(GeneratedPacketTest, testOneGenericStructFourArray) {
@@ -1762,6 +1784,29 @@ TEST(GeneratedPacketTest, testOneLengthTypeValueStruct) {
   }
 }
 
+TEST(GeneratedPacketTest, testOneLengthTypeValueStructRange) {
+  // Each truncation of the packet gives the same entries from the range as from the vector
+  for (size_t size = 0; size <= one_length_type_value_struct.size(); size++) {
+    std::shared_ptr<std::vector<uint8_t>> packet_bytes = std::make_shared<std::vector<uint8_t>>(
+        one_length_type_value_struct.begin(), one_length_type_value_struct.begin() + size);
+
+    PacketView<kLittleEndian> packet_bytes_view(packet_bytes);
+    auto view = OneLengthTypeValueStructView::Create(packet_bytes_view);
+    ASSERT_TRUE(view.IsValid());
+    auto one = view.GetOneArray();
+    auto range = view.GetOneArrayRange();
+    ASSERT_EQ(one.empty(), range.empty()) << "size " << size;
+    size_t entry_id = 0;
+    for (const auto& entry : range) {
+      ASSERT_LT(entry_id, one.size()) << "size " << size;
+      ASSERT_EQ(one[entry_id].type_, entry.type_) << "size " << size;
+      ASSERT_EQ(one[entry_id].value_, entry.value_) << "size " << size;
+      entry_id++;
+    }
+    ASSERT_EQ(one.size(), entry_id) << "size " << size;
+  }
+}
+
 vector<uint8_t> one_length_type_value_struct_padded_10{
     0x20,                                                        // _size_(payload),
     0x14,                                                        // valid bytes
@@ -1965,6 +2010,57 @@ TEST(GeneratedPacketTest, testToStringOneFixedTypesStruct) {
       view.ToString());
 }
 
+namespace {
+std::vector<uint8_t> SerializeToSpan(const BasePacketBuilder& packet) {
+  std::vector<uint8_t> bytes(packet.size());
+  SpanInserter it(bytes.data(), bytes.size());
+  packet.SerializeToSpan(it);
+  EXPECT_EQ(bytes.size(), it.written());
+  return bytes;
+}
+}  // namespace
+
+TEST(GeneratedPacketTest, testSerializeToSpan) {
+  // Nested checksums
+  ASSERT_EQ(child_with_nested_sum, SerializeToSpan(*ChildWithNestedSumBuilder::Create(0x1211, 0x2221, 0x34333231)));
+
+  // A custom field without SerializeToSpan()
+  ASSERT_EQ(one_variable, SerializeToSpan(*OneVariableBuilder::Create(Variable{"one"})));
+
+  // Bit fields across byte boundaries
+  ASSERT_EQ(bit_field_group_packet, SerializeToSpan(*BitFieldGroupPacketBuilder::Create(0x77, 0x5, 0x15)));
+
+  // A struct with a checksum, a byte array and a fixed size custom field
+  StructWithFixedTypes swf;
+  swf.four_bits_ = FourBits::FIVE;
+  swf.id_ = 0x0d;
+  swf.array_ = {{0x01, 0x02, 0x03}};
+  swf.six_bytes_ = SixBytes{{0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6}};
+  ASSERT_EQ(one_fixed_types_struct, SerializeToSpan(*OneFixedTypesStructBuilder::Create(swf)));
+
+  // Byte arrays, vectors of structs and a payload give the same bytes as the BitInserter
+  std::array<uint8_t, 32> byte_array;
+  for (uint8_t i = 0; i < byte_array.size(); i++) byte_array[i] = i;
+  std::array<uint32_t, 8> word_array;
+  for (uint32_t i = 0; i < word_array.size(); i++) word_array[i] = i;
+  auto arrays = PacketWithFixedArraysOfBytesBuilder::Create(byte_array, word_array);
+  ASSERT_EQ(arrays->SerializeToBytes(), SerializeToSpan(*arrays));
+
+  std::vector<TwoRelatedNumbers> count_array;
+  for (uint8_t i = 1; i < 5; i++) {
+    TwoRelatedNumbers trn;
+    trn.id_ = i;
+    trn.count_ = 0x0201 * i;
+    count_array.push_back(trn);
+  }
+  auto vector_of_struct = VectorOfStructBuilder::Create(count_array);
+  ASSERT_EQ(vector_of_struct->SerializeToBytes(), SerializeToSpan(*vector_of_struct));
+
+  auto with_payload =
+      ParentWithSumBuilder::Create(0x1211, 0x2221, std::make_unique<RawBuilder>(std::vector<uint8_t>{1, 2, 3}));
+  ASSERT_EQ(with_payload->SerializeToBytes(), SerializeToSpan(*with_payload));
+}
+
 }  // namespace parser
 }  // namespace packet
 }  // namespace bluetooth
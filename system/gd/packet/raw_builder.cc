@@ -96,6 +96,10 @@ void RawBuilder::Serialize(BitInserter& it) const {
   }
 }
 
+void RawBuilder::SerializeToSpan(SpanInserter& it) const {
+  it.insert_bytes(payload_.data(), payload_.size());
+}
+
 size_t RawBuilder::size() const {
   return payload_.size();
 }
@@ -22,6 +22,7 @@
 
 #include "packet/bit_inserter.h"
 #include "packet/packet_builder.h"
+#include "packet/span_inserter.h"
 
 namespace bluetooth {
 namespace packet {
@@ -37,6 +38,8 @@ class RawBuilder : public PacketBuilder<true> {
 
   virtual void Serialize(BitInserter& it) const;
 
+  virtual void SerializeToSpan(SpanInserter& it) const override;
+
   // Return true if |num_bytes| can be added to the payload.
   bool CanAddOctets(size_t num_bytes) const;
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "hci/hci_packets.h"
+#include "l2cap/l2cap_packets.h"
+#include "packet/base_packet_builder.h"
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+#include "packet/span_inserter.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace packet {
+namespace {
+
+std::unique_ptr<RawBuilder> CreatePayload(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t i = 0; i < size; i++) {
+    bytes[i] = static_cast<uint8_t>(i);
+  }
+  return std::make_unique<RawBuilder>(bytes);
+}
+
+// A full 2-DH5 ACL packet
+std::unique_ptr<BasePacketBuilder> CreateAcl() {
+  return hci::AclBuilder::Create(
+      0x123,
+      hci::PacketBoundaryFlag::FIRST_AUTOMATICALLY_FLUSHABLE,
+      hci::BroadcastFlag::POINT_TO_POINT,
+      CreatePayload(679));
+}
+
+// A vector of structs with byte arrays
+std::unique_ptr<BasePacketBuilder> CreateLeSetExtendedAdvertisingData() {
+  std::vector<hci::GapData> gap_data(10);
+  for (auto& data : gap_data) {
+    data.data_type_ = hci::GapDataType::MANUFACTURER_SPECIFIC_DATA;
+    data.data_ = std::vector<uint8_t>(22, 0x5a);
+  }
+  return hci::LeSetExtendedAdvertisingDataBuilder::Create(
+      1, hci::Operation::COMPLETE_ADVERTISEMENT, hci::FragmentPreference::CONTROLLER_SHOULD_NOT, gap_data);
+}
+
+// A fixed size byte array
+std::unique_ptr<BasePacketBuilder> CreateWriteLocalName() {
+  std::array<uint8_t, 248> name{};
+  std::fill_n(name.begin(), 20, 'n');
+  return hci::WriteLocalNameBuilder::Create(name);
+}
+
+std::unique_ptr<BasePacketBuilder> CreateBasicFrame() {
+  return l2cap::BasicFrameBuilder::Create(0x40, CreatePayload(1017));
+}
+
+// Checksummed over the whole frame
+std::unique_ptr<BasePacketBuilder> CreateEnhancedInformationFrameWithFcs() {
+  return l2cap::EnhancedInformationFrameWithFcsBuilder::Create(
+      0x40, 1, l2cap::Final::NOT_SET, 2, l2cap::SegmentationAndReassembly::UNSEGMENTED, CreatePayload(1010));
+}
+
+void BM_SerializeWithBitInserter(State& state, std::unique_ptr<BasePacketBuilder> (*create)()) {
+  auto builder = create();
+  for (auto _ : state) {
+    std::vector<uint8_t> bytes;
+    BitInserter it(bytes);
+    builder->Serialize(it);
+    ::benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * builder->size()));
+}
+
+void BM_SerializeToSpan(State& state, std::unique_ptr<BasePacketBuilder> (*create)()) {
+  auto builder = create();
+  for (auto _ : state) {
+    std::vector<uint8_t> bytes(builder->size());
+    SpanInserter it(bytes.data(), bytes.size());
+    builder->SerializeToSpan(it);
+    ::benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * builder->size()));
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_SerializeWithBitInserter, acl, CreateAcl);
+BENCHMARK_CAPTURE(BM_SerializeToSpan, acl, CreateAcl);
+BENCHMARK_CAPTURE(BM_SerializeWithBitInserter, le_set_extended_advertising_data, CreateLeSetExtendedAdvertisingData);
+BENCHMARK_CAPTURE(BM_SerializeToSpan, le_set_extended_advertising_data, CreateLeSetExtendedAdvertisingData);
+BENCHMARK_CAPTURE(BM_SerializeWithBitInserter, write_local_name, CreateWriteLocalName);
+BENCHMARK_CAPTURE(BM_SerializeToSpan, write_local_name, CreateWriteLocalName);
+BENCHMARK_CAPTURE(BM_SerializeWithBitInserter, l2cap_basic_frame, CreateBasicFrame);
+BENCHMARK_CAPTURE(BM_SerializeToSpan, l2cap_basic_frame, CreateBasicFrame);
+BENCHMARK_CAPTURE(BM_SerializeWithBitInserter, l2cap_i_frame_with_fcs, CreateEnhancedInformationFrameWithFcs);
+BENCHMARK_CAPTURE(BM_SerializeToSpan, l2cap_i_frame_with_fcs, CreateEnhancedInformationFrameWithFcs);
+
+}  // namespace packet
+}  // namespace bluetooth
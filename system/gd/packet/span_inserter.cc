@@ -0,0 +1,43 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/span_inserter.h"
+
+namespace bluetooth {
+namespace packet {
+
+SpanInserter::SpanInserter(uint8_t* begin, size_t size) : begin_(begin), it_(begin), end_(begin + size) {}
+
+SpanInserter::~SpanInserter() {
+  ASSERT(num_saved_bits_ == 0);
+  ASSERT(registered_observers_.empty());
+}
+
+void SpanInserter::RegisterObserver(const ByteObserver& observer) {
+  ASSERT(num_saved_bits_ == 0);
+  registered_observers_.emplace_back(observer, written());
+}
+
+ByteObserver SpanInserter::UnregisterObserver() {
+  ASSERT(num_saved_bits_ == 0);
+  auto [observer, start] = registered_observers_.back();
+  registered_observers_.pop_back();
+  observer.OnBytes(begin_ + start, written() - start);
+  return observer;
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "os/log.h"
+#include "packet/byte_observer.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Writes a packet into memory allocated up front, usually size() bytes of the builder.
+// Unlike BitInserter nothing is virtual, byte arrays are copied at once, and the observers
+// see the bytes written since they were registered in one pass when they are unregistered.
+class SpanInserter {
+ public:
+  SpanInserter(uint8_t* begin, size_t size);
+  ~SpanInserter();
+
+  void insert_bits(uint8_t byte, size_t num_bits) {
+    size_t total_bits = num_bits + num_saved_bits_;
+    uint16_t new_value = static_cast<uint8_t>(saved_bits_) | (static_cast<uint16_t>(byte) << num_saved_bits_);
+    if (total_bits >= 8) {
+      put(static_cast<uint8_t>(new_value));
+      total_bits -= 8;
+      new_value = new_value >> 8;
+    }
+    num_saved_bits_ = total_bits;
+    uint8_t mask = static_cast<uint8_t>(0xff) >> (8 - num_saved_bits_);
+    saved_bits_ = static_cast<uint8_t>(new_value) & mask;
+  }
+
+  void insert_byte(uint8_t byte) {
+    if (num_saved_bits_ != 0) {
+      insert_bits(byte, 8);
+      return;
+    }
+    put(byte);
+  }
+
+  void insert_bytes(const uint8_t* bytes, size_t size) {
+    if (num_saved_bits_ != 0) {
+      for (size_t i = 0; i < size; i++) {
+        insert_bits(bytes[i], 8);
+      }
+      return;
+    }
+    ASSERT_LOG(size <= static_cast<size_t>(end_ - it_), "%zu bytes past the end", size - (end_ - it_));
+    if (size != 0) {
+      std::memcpy(it_, bytes, size);
+    }
+    it_ += size;
+  }
+
+  void RegisterObserver(const ByteObserver& observer);
+
+  ByteObserver UnregisterObserver();
+
+  // Number of bytes written so far.
+  size_t written() const {
+    return it_ - begin_;
+  }
+
+ private:
+  void put(uint8_t byte) {
+    ASSERT_LOG(it_ != end_, "Writing past the end");
+    *it_++ = byte;
+  }
+
+  uint8_t* begin_;
+  uint8_t* it_;
+  uint8_t* end_;
+  size_t num_saved_bits_{0};
+  uint8_t saved_bits_{0};
+  // Observers with the offset of the first byte they observe
+  std::vector<std::pair<ByteObserver, size_t>> registered_observers_;
+};
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/span_inserter.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "packet/bit_inserter.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace packet {
+
+TEST(SpanInserterTest, addMoreBits) {
+  std::vector<uint8_t> bytes(5);
+  SpanInserter it(bytes.data(), bytes.size());
+
+  for (size_t i = 0; i < 9; i++) {
+    it.insert_bits(static_cast<uint8_t>(i), i);
+  }
+  it.insert_bits(static_cast<uint8_t>(0b1010), 4);
+  std::vector<uint8_t> result = {0b00011101 /* 3 2 1 */, 0b00010101 /* 5 4 */, 0b11100011 /* 7 6 */, 0b10000000 /* 8 */,
+                                 0b10100000 /* filled with 1010 */};
+
+  ASSERT_EQ(result, bytes);
+  ASSERT_EQ(result.size(), it.written());
+}
+
+TEST(SpanInserterTest, insertBytes) {
+  std::vector<uint8_t> bytes(8);
+  SpanInserter it(bytes.data(), bytes.size());
+  std::vector<uint8_t> octets = {1, 2, 3};
+
+  it.insert_byte(0xaa);
+  it.insert_bytes(octets.data(), octets.size());
+  // Not on a byte boundary
+  it.insert_bits(0x0f, 4);
+  it.insert_bytes(octets.data(), octets.size());
+  it.insert_bits(0x0b, 4);
+
+  std::vector<uint8_t> result = {0xaa, 1, 2, 3, 0x1f, 0x20, 0x30, 0xb0};
+  ASSERT_EQ(result, bytes);
+}
+
+TEST(SpanInserterTest, matchesBitInserter) {
+  std::vector<uint8_t> expected;
+  BitInserter bit_inserter(expected);
+  std::vector<uint8_t> bytes(6);
+  SpanInserter span_inserter(bytes.data(), bytes.size());
+
+  for (uint8_t byte : {0x12, 0x34}) {
+    bit_inserter.insert_byte(byte);
+    span_inserter.insert_byte(byte);
+  }
+  bit_inserter.insert_bits(0x5, 3);
+  span_inserter.insert_bits(0x5, 3);
+  bit_inserter.insert_bits(0x1c, 5);
+  span_inserter.insert_bits(0x1c, 5);
+  std::vector<uint8_t> octets = {0xfe, 0xdc, 0xba};
+  bit_inserter.insert_bytes(octets.data(), octets.size());
+  span_inserter.insert_bytes(octets.data(), octets.size());
+
+  ASSERT_EQ(expected, bytes);
+}
+
+TEST(SpanInserterTest, observerTest) {
+  std::vector<uint8_t> bytes(6);
+  SpanInserter it(bytes.data(), bytes.size());
+  std::vector<uint8_t> copy;
+  std::vector<uint8_t> inner_copy;
+
+  uint64_t checksum = 0x0123456789abcdef;
+  it.insert_byte(0x01);
+  it.RegisterObserver(ByteObserver([&copy](uint8_t byte) { copy.push_back(byte); }, [checksum]() { return checksum; }));
+  it.insert_byte(0x02);
+  it.RegisterObserver(ByteObserver([&inner_copy](uint8_t byte) { inner_copy.push_back(byte); }, []() { return 0; }));
+  std::vector<uint8_t> octets = {0x03, 0x04};
+  it.insert_bytes(octets.data(), octets.size());
+
+  // The observers see the bytes when they are unregistered
+  ASSERT_TRUE(copy.empty());
+  it.UnregisterObserver();
+  ASSERT_EQ(octets, inner_copy);
+  it.insert_byte(0x05);
+  ByteObserver observer = it.UnregisterObserver();
+  ASSERT_EQ(std::vector<uint8_t>({0x02, 0x03, 0x04, 0x05}), copy);
+  ASSERT_EQ(checksum, observer.GetValue());
+
+  it.insert_byte(0x06);
+  ASSERT_EQ(std::vector<uint8_t>({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), bytes);
+  ASSERT_EQ(4u, copy.size());
+}
+
+TEST(SpanInserterTest, rawBuilder) {
+  std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+  RawBuilder builder(payload);
+
+  std::vector<uint8_t> bytes(builder.size());
+  SpanInserter it(bytes.data(), bytes.size());
+  builder.SerializeToSpan(it);
+  ASSERT_EQ(payload, bytes);
+}
+
+TEST(SpanInserterDeathTest, writePastTheEnd) {
+  std::vector<uint8_t> bytes(2);
+  std::vector<uint8_t> octets = {1, 2, 3};
+  ASSERT_DEATH(
+      {
+        SpanInserter it(bytes.data(), bytes.size());
+        it.insert_bytes(octets.data(), octets.size());
+      },
+      "");
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+
+#include "packet/iterator.h"
+
+namespace bluetooth {
+namespace packet {
+
+// The elements of a repeated struct field of a packet view, parsed one at a time as the range is iterated instead of
+// into a vector up front. The range stops where the vector getter would: after |count| elements, or when fewer than
+// |element_size| bytes are left.
+//
+// The iterator parses into a single element it owns and reuses for the next one, so the vectors in the element keep
+// their capacity and a reference to the element is only valid until the iterator is incremented.
+template <typename T, bool little_endian>
+class StructRange {
+ public:
+  class const_iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator(Iterator<little_endian> it, size_t count, size_t element_size, bool end)
+        : it_(it), count_(count), element_size_(element_size), end_(end) {
+      if (!end_) {
+        Next();
+      }
+    }
+
+    reference operator*() const {
+      return value_;
+    }
+
+    pointer operator->() const {
+      return &value_;
+    }
+
+    const_iterator& operator++() {
+      Next();
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return end_ == other.end_ && (end_ || (it_ == other.it_ && count_ == other.count_));
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    void Next() {
+      if (count_ == 0 || it_.NumBytesRemaining() < element_size_) {
+        end_ = true;
+        return;
+      }
+      count_--;
+      // Copy assignment from an empty element clears the vectors without freeing them
+      static const T kEmpty{};
+      value_ = kEmpty;
+      it_ = T::Parse(&value_, it_);
+    }
+
+    Iterator<little_endian> it_;
+    size_t count_;
+    size_t element_size_;
+    bool end_;
+    T value_{};
+  };
+
+  StructRange(Iterator<little_endian> it, size_t count, size_t element_size)
+      : it_(it), count_(count), element_size_(element_size) {}
+
+  const_iterator begin() const {
+    return const_iterator(it_, count_, element_size_, false);
+  }
+
+  const_iterator end() const {
+    return const_iterator(it_, 0, element_size_, true);
+  }
+
+  bool empty() const {
+    return begin() == end();
+  }
+
+ private:
+  Iterator<little_endian> it_;
+  size_t count_;
+  size_t element_size_;
+};
+
+// Same as StructRange, for structs of variable length which are parsed into a new object. The iterator yields the
+// parsed object, which can be moved out of it.
+template <typename T, bool little_endian>
+class VariableLengthStructRange {
+ public:
+  using ParseFunction = std::unique_ptr<T> (*)(Iterator<little_endian>);
+
+  class iterator {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::unique_ptr<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::unique_ptr<T>*;
+    using reference = std::unique_ptr<T>&;
+
+    iterator(Iterator<little_endian> it, size_t count, size_t element_size, ParseFunction parse, bool end)
+        : it_(it), count_(count), element_size_(element_size), parse_(parse), end_(end) {
+      if (!end_) {
+        Next();
+      }
+    }
+
+    reference operator*() {
+      return value_;
+    }
+
+    pointer operator->() {
+      return &value_;
+    }
+
+    iterator& operator++() {
+      Next();
+      return *this;
+    }
+
+    bool operator==(const iterator& other) const {
+      return end_ == other.end_ && (end_ || (it_ == other.it_ && count_ == other.count_));
+    }
+
+    bool operator!=(const iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    void Next() {
+      if (count_ == 0 || it_.NumBytesRemaining() < element_size_) {
+        end_ = true;
+        return;
+      }
+      count_--;
+      value_ = parse_(it_);
+      if (value_ == nullptr) {
+        // The vector getter skips the rest of the field too
+        end_ = true;
+        return;
+      }
+      it_ = it_ + value_->size();
+    }
+
+    Iterator<little_endian> it_;
+    size_t count_;
+    size_t element_size_;
+    ParseFunction parse_;
+    bool end_;
+    std::unique_ptr<T> value_;
+  };
+
+  VariableLengthStructRange(Iterator<little_endian> it, size_t count, size_t element_size, ParseFunction parse)
+      : it_(it), count_(count), element_size_(element_size), parse_(parse) {}
+
+  iterator begin() const {
+    return iterator(it_, count_, element_size_, parse_, false);
+  }
+
+  iterator end() const {
+    return iterator(it_, 0, element_size_, parse_, true);
+  }
+
+ private:
+  Iterator<little_endian> it_;
+  size_t count_;
+  size_t element_size_;
+  ParseFunction parse_;
+};
+
+// Count of a field without a count field, which ends with the bytes.
+constexpr size_t kUncountedField = std::numeric_limits<size_t>::max();
+
+template <typename T, bool little_endian>
+StructRange<T, little_endian> MakeStructRange(Iterator<little_endian> it, size_t count, size_t element_size) {
+  return StructRange<T, little_endian>(it, count, element_size);
+}
+
+template <typename T, bool little_endian>
+VariableLengthStructRange<T, little_endian> MakeVariableLengthStructRange(
+    Iterator<little_endian> it,
+    size_t count,
+    size_t element_size,
+    typename VariableLengthStructRange<T, little_endian>::ParseFunction parse) {
+  return VariableLengthStructRange<T, little_endian>(it, count, element_size, parse);
+}
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/struct_range.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "packet/packet_view.h"
+
+namespace bluetooth {
+namespace packet {
+namespace {
+
+// Like a generated struct: a length, then that many bytes
+struct LengthValue {
+  static Iterator<kLittleEndian> Parse(LengthValue* to_fill, Iterator<kLittleEndian> it) {
+    if (it.NumBytesRemaining() < 1) {
+      return it.Subrange(it.NumBytesRemaining(), 0);
+    }
+    auto value_it = it + 1;
+    uint8_t length = *it;
+    for (uint8_t i = 0; i < length && value_it.NumBytesRemaining() > 0; i++) {
+      to_fill->value_.push_back(*value_it);
+      ++value_it;
+    }
+    return it + to_fill->size();
+  }
+
+  size_t size() const {
+    return 1 + value_.size();
+  }
+
+  std::vector<uint8_t> value_;
+};
+
+// Like a generated variable length struct: nullptr when the bytes are not one
+std::unique_ptr<LengthValue> ParseLengthValue(Iterator<kLittleEndian> it) {
+  if (it.NumBytesRemaining() < 1 || *it == 0xff) {
+    return nullptr;
+  }
+  auto parsed = std::make_unique<LengthValue>();
+  LengthValue::Parse(parsed.get(), it);
+  return parsed;
+}
+
+PacketView<kLittleEndian> MakeView(const std::vector<uint8_t>& bytes) {
+  return PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(bytes));
+}
+
+}  // namespace
+
+TEST(StructRangeTest, parseAll) {
+  auto view = MakeView({3, 'o', 'n', 'e', 0, 5, 't', 'h', 'r', 'e', 'e', 2, 't', 'w'});
+  auto range = MakeStructRange<LengthValue>(view.begin(), kUncountedField, 1);
+  ASSERT_FALSE(range.empty());
+
+  std::vector<std::vector<uint8_t>> values;
+  for (const auto& element : range) {
+    values.push_back(element.value_);
+  }
+  std::vector<std::vector<uint8_t>> expected = {{'o', 'n', 'e'}, {}, {'t', 'h', 'r', 'e', 'e'}, {'t', 'w'}};
+  ASSERT_EQ(expected, values);
+}
+
+TEST(StructRangeTest, count) {
+  auto view = MakeView({1, 'a', 1, 'b', 1, 'c'});
+  size_t count = 0;
+  for (const auto& element : MakeStructRange<LengthValue>(view.begin(), 2, 1)) {
+    ASSERT_EQ(1u, element.value_.size());
+    count++;
+  }
+  ASSERT_EQ(2u, count);
+  ASSERT_TRUE(MakeStructRange<LengthValue>(view.begin(), 0, 1).empty());
+}
+
+TEST(StructRangeTest, elementSize) {
+  // Stops when fewer than element_size bytes are left
+  auto view = MakeView({1, 'a', 1, 'b', 3, 'c'});
+  size_t count = 0;
+  for (const auto& element : MakeStructRange<LengthValue>(view.begin(), kUncountedField, 3)) {
+    (void)element;
+    count++;
+  }
+  ASSERT_EQ(2u, count);
+  ASSERT_TRUE(MakeStructRange<LengthValue>(MakeView({}).begin(), kUncountedField, 1).empty());
+}
+
+TEST(StructRangeTest, reusesElement) {
+  auto view = MakeView({5, 'f', 'i', 'r', 's', 't', 2, 'n', 'd'});
+  auto range = MakeStructRange<LengthValue>(view.begin(), kUncountedField, 1);
+  auto it = range.begin();
+  const uint8_t* data = it->value_.data();
+  ++it;
+  ASSERT_NE(range.end(), it);
+  ASSERT_EQ(std::vector<uint8_t>({'n', 'd'}), it->value_);
+  // The second element was parsed into the storage of the first
+  ASSERT_EQ(data, it->value_.data());
+  ++it;
+  ASSERT_EQ(range.end(), it);
+}
+
+TEST(VariableLengthStructRangeTest, stopsAtInvalidElement) {
+  auto view = MakeView({1, 'a', 2, 'b', 'c', 0xff, 1, 'd'});
+  auto range = MakeVariableLengthStructRange<LengthValue>(view.begin(), kUncountedField, 1, &ParseLengthValue);
+
+  std::vector<std::unique_ptr<LengthValue>> elements;
+  for (auto& element : range) {
+    ASSERT_NE(nullptr, element);
+    elements.push_back(std::move(element));
+  }
+  ASSERT_EQ(2u, elements.size());
+  ASSERT_EQ(std::vector<uint8_t>({'a'}), elements[0]->value_);
+  ASSERT_EQ(std::vector<uint8_t>({'b', 'c'}), elements[1]->value_);
+}
+
+}  // namespace packet
+}  // namespace bluetooth
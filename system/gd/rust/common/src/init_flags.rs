@@ -363,12 +363,14 @@ init_flags!(
         always_send_services_if_gatt_disc_done = true,
         always_use_private_gatt_for_debugging,
         asynchronously_start_l2cap_coc = true,
+        bonded_devices_snapshot,
         btaa_hci = true,
         bta_dm_clear_conn_id_on_client_close = true,
         btm_dm_flush_discovery_queue_on_search_cancel,
         classic_discovery_only,
         clear_hidd_interrupt_cid_on_disconnect = true,
         delay_hidh_cleanup_until_hidh_ready_start = true,
+        device_iot_config_cache,
         device_iot_config_logging,
         dynamic_avrcp_version_enhancement = true,
         finite_att_timeout = true,
@@ -382,8 +384,10 @@ init_flags!(
         gd_remote_name_request,
         gd_rust,
         hci_adapter: i32,
+        hci_command_pipelining,
         hfp_dynamic_version = true,
         irk_rotation,
+        l2cap_weighted_fair_scheduler,
         leaudio_targeted_announcement_reconnection_mode = true,
         pass_phy_update_callback = true,
         pbap_pse_dynamic_version_upgrade = false,
@@ -395,6 +399,7 @@ init_flags!(
         rust_event_loop = true,
         sco_codec_select_lc3,
         sco_codec_timeout_clear,
+        sdp_discovery_cache,
         sdp_serialization = true,
         sdp_skip_rnr_if_known = true,
         bluetooth_quality_report_callback = true,
@@ -14,6 +14,7 @@ mod ffi {
         fn always_send_services_if_gatt_disc_done_is_enabled() -> bool;
         fn always_use_private_gatt_for_debugging_is_enabled() -> bool;
         fn asynchronously_start_l2cap_coc_is_enabled() -> bool;
+        fn bonded_devices_snapshot_is_enabled() -> bool;
         fn btaa_hci_is_enabled() -> bool;
         fn bta_dm_clear_conn_id_on_client_close_is_enabled() -> bool;
         fn delay_hidh_cleanup_until_hidh_ready_start_is_enabled() -> bool;
@@ -21,6 +22,7 @@ mod ffi {
         fn btm_dm_flush_discovery_queue_on_search_cancel_is_enabled() -> bool;
         fn classic_discovery_only_is_enabled() -> bool;
         fn clear_hidd_interrupt_cid_on_disconnect_is_enabled() -> bool;
+        fn device_iot_config_cache_is_enabled() -> bool;
         fn device_iot_config_logging_is_enabled() -> bool;
         fn dynamic_avrcp_version_enhancement_is_enabled() -> bool;
         fn finite_att_timeout_is_enabled() -> bool;
@@ -36,8 +38,10 @@ mod ffi {
         fn get_log_level_for_tag(tag: &str) -> i32;
         fn get_asha_packet_drop_frequency_threshold() -> i32;
         fn get_asha_phy_update_retry_limit() -> i32;
+        fn hci_command_pipelining_is_enabled() -> bool;
         fn hfp_dynamic_version_is_enabled() -> bool;
         fn irk_rotation_is_enabled() -> bool;
+        fn l2cap_weighted_fair_scheduler_is_enabled() -> bool;
         fn leaudio_targeted_announcement_reconnection_mode_is_enabled() -> bool;
         fn pass_phy_update_callback_is_enabled() -> bool;
         fn pbap_pse_dynamic_version_upgrade_is_enabled() -> bool;
@@ -49,6 +53,7 @@ mod ffi {
         fn rust_event_loop_is_enabled() -> bool;
         fn sco_codec_select_lc3_is_enabled() -> bool;
         fn sco_codec_timeout_clear_is_enabled() -> bool;
+        fn sdp_discovery_cache_is_enabled() -> bool;
         fn sdp_serialization_is_enabled() -> bool;
         fn sdp_skip_rnr_if_known_is_enabled() -> bool;
         fn bluetooth_quality_report_callback_is_enabled() -> bool;
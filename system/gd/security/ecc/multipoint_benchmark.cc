@@ -0,0 +1,75 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <iterator>
+
+#include "benchmark/benchmark.h"
+#include "security/ecc/p_256_ecc_pp.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace security {
+namespace ecc {
+
+namespace {
+
+// Private key of the Bluetooth Core Specification, Version 5.0 | Vol 2, Part G | 7.1.2, Data Set 1
+constexpr uint32_t kPrivateKey[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b, 0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+
+}  // namespace
+
+// Public key generation, n * G with the precomputed table of the base point
+static void BM_EccKeyGeneration(State& state) {
+  uint32_t key[KEY_LENGTH_DWORDS_P256];
+  std::copy(std::begin(kPrivateKey), std::end(kPrivateKey), key);
+  Point public_key;
+  for (auto _ : state) {
+    key[0]++;
+    ECC_PointMult(&public_key, &curve_p256.G, key);
+    benchmark::DoNotOptimize(public_key);
+  }
+  if (!ECC_ValidatePoint(public_key)) {
+    state.SkipWithError("Public key not on the curve");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EccKeyGeneration)->UseRealTime();
+
+// DHKey computation, n * P for the public key P of the peer
+static void BM_EccDhKey(State& state) {
+  Point peer_public_key;
+  ECC_PointMult(&peer_public_key, &curve_p256.G, kPrivateKey);
+  uint32_t key[KEY_LENGTH_DWORDS_P256];
+  std::copy(std::begin(kPrivateKey), std::end(kPrivateKey), key);
+  Point dhkey;
+  for (auto _ : state) {
+    key[0]++;
+    ECC_PointMult(&dhkey, &peer_public_key, key);
+    benchmark::DoNotOptimize(dhkey);
+  }
+  if (!ECC_ValidatePoint(dhkey)) {
+    state.SkipWithError("DHKey not on the curve");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EccDhKey)->UseRealTime();
+
+}  // namespace ecc
+}  // namespace security
+}  // namespace bluetooth
@@ -17,6 +17,10 @@
  ******************************************************************************/
 
 #include <gtest/gtest.h>
+#include <string.h>
+
+#include <chrono>
+#include <cstdio>
 
 #include "security/ecc/p_256_ecc_pp.h"
 
@@ -76,8 +80,8 @@ TEST(SmpEccValidationTest, test_valid_points) {
 
 TEST(SmpEccValidationTest, test_invalid_points) {
   Point p;
-  multiprecision_init(p.x);
-  multiprecision_init(p.y);
+  memset(p.x, 0, sizeof(p.x));
+  memset(p.y, 0, sizeof(p.y));
 
   EXPECT_FALSE(ECC_ValidatePoint(p));
 
@@ -107,6 +111,63 @@ TEST(SmpEccValidationTest, test_invalid_points) {
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
 
+// Test data from Bluetooth Core Specification
+// Version 5.0 | Vol 2, Part G | 7.1.2, Data Set 1
+TEST(SmpEccPointMultTest, test_public_key) {
+  const uint32_t private_key[KEY_LENGTH_DWORDS_P256] = {
+      0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b, 0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+  const uint32_t public_key_x[KEY_LENGTH_DWORDS_P256] = {
+      0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111, 0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2};
+  const uint32_t public_key_y[KEY_LENGTH_DWORDS_P256] = {
+      0x1589d28b, 0x741c8ed0, 0x8fed3024, 0x766345c2, 0x5a52155c, 0x63329abf, 0x652aeb6d, 0xdc809c49};
+
+  Point q;
+  ECC_PointMult(&q, &curve_p256.G, private_key);
+  EXPECT_EQ(memcmp(q.x, public_key_x, sizeof(q.x)), 0);
+  EXPECT_EQ(memcmp(q.y, public_key_y, sizeof(q.y)), 0);
+
+  // Same result without the precomputed table of G
+  Point g = curve_p256.G;
+  Point one_g;
+  const uint32_t one[KEY_LENGTH_DWORDS_P256] = {1};
+  ECC_PointMult(&one_g, &g, one);
+  EXPECT_EQ(memcmp(&one_g, &curve_p256.G, sizeof(Point)), 0);
+  Point two_g;
+  const uint32_t two[KEY_LENGTH_DWORDS_P256] = {2};
+  ECC_PointMult(&two_g, &g, two);
+  Point q2;
+  ECC_PointMult(&q2, &two_g, private_key);
+  Point q2_base;
+  uint32_t double_private_key[KEY_LENGTH_DWORDS_P256];
+  uint32_t carry = 0;
+  for (int i = 0; i < KEY_LENGTH_DWORDS_P256; i++) {
+    double_private_key[i] = (private_key[i] << 1) | carry;
+    carry = private_key[i] >> 31;
+  }
+  ECC_PointMult(&q2_base, &curve_p256.G, double_private_key);
+  EXPECT_EQ(memcmp(&q2, &q2_base, sizeof(Point)), 0);
+}
+
+TEST(SmpEccPointMultTest, test_shared_secret) {
+  uint32_t key_a[KEY_LENGTH_DWORDS_P256];
+  uint32_t key_b[KEY_LENGTH_DWORDS_P256];
+  for (int round = 0; round < 16; round++) {
+    for (int i = 0; i < KEY_LENGTH_DWORDS_P256; i++) {
+      key_a[i] = 0x9e3779b9 * (round * 16 + i + 1);
+      key_b[i] = 0x85ebca6b * (round * 16 + i + 1);
+    }
+    Point public_a, public_b, secret_a, secret_b;
+    ECC_PointMult(&public_a, &curve_p256.G, key_a);
+    ECC_PointMult(&public_b, &curve_p256.G, key_b);
+    EXPECT_TRUE(ECC_ValidatePoint(public_a));
+    EXPECT_TRUE(ECC_ValidatePoint(public_b));
+    ECC_PointMult(&secret_a, &public_b, key_a);
+    ECC_PointMult(&secret_b, &public_a, key_b);
+    EXPECT_TRUE(ECC_ValidatePoint(secret_a));
+    EXPECT_EQ(memcmp(&secret_a, &secret_b, sizeof(Point)), 0);
+  }
+}
+
 }  // namespace ecc
 }  // namespace security
 }  // namespace bluetooth
@@ -21,244 +21,594 @@
  *  This file contains simple pairing algorithms using Elliptic Curve
  *  Cryptography for private public key
  *
+ *  Field elements are kept in the Montgomery domain as four 64 bit limbs.
+ *  Scalar multiplications run the same sequence of operations for every
+ *  scalar and read all table entries with masks.
+ *
+ *  Multiples of G use a comb table with 8 teeth that is computed on first use
+ *  and the complete projective formulas of Renes, Costello and Batina
+ *  (a = -3), which have no exceptional cases. Multiples of other points use a
+ *  fixed window in Jacobian coordinates, whose doubling is cheaper; the
+ *  scalar is reduced modulo the group order first so that only the point at
+ *  infinity needs special handling.
+ *
  ******************************************************************************/
 #include "security/ecc/p_256_ecc_pp.h"
-#include <stdio.h>
-#include <stdlib.h>
+
 #include <string.h>
-#include "security/ecc/multprecision.h"
+
+#include <array>
 
 namespace bluetooth {
 namespace security {
 namespace ecc {
 
-const uint32_t* modp = curve_p256.p;
+namespace {
+
+constexpr int kLimbs = 4;
+
+// x * 2^256 mod p, little endian
+struct Fe {
+  uint64_t v[kLimbs];
+};
+
+struct AffinePoint {
+  Fe x;
+  Fe y;
+};
+
+// (x / z, y / z)
+struct ProjectivePoint {
+  Fe x;
+  Fe y;
+  Fe z;
+};
+
+// (x / z^2, y / z^3)
+struct JacobianPoint {
+  Fe x;
+  Fe y;
+  Fe z;
+};
+
+constexpr Fe kP = {{0xffffffffffffffff, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001}};
+// 2^512 mod p, converts into the Montgomery domain
+constexpr Fe kRR = {{0x0000000000000003, 0xfffffffbffffffff, 0xfffffffffffffffe, 0x00000004fffffffd}};
+// 1 and b in the Montgomery domain
+constexpr Fe kOne = {{0x0000000000000001, 0xffffffff00000000, 0xffffffffffffffff, 0x00000000fffffffe}};
+constexpr Fe kB = {{0xd89cdf6229c4bddf, 0xacf005cd78843090, 0xe5a220abf7212ed6, 0xdc30061d04874834}};
+constexpr Fe kPMinus2 = {{0xfffffffffffffffd, 0x00000000ffffffff, 0x0000000000000000, 0xffffffff00000001}};
+// Order of G
+constexpr uint32_t kN[KEY_LENGTH_DWORDS_P256] = {0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad,
+                                                 0xffffffff, 0xffffffff, 0x00000000, 0xffffffff};
+
+// Comb for multiples of G: bit i of the index of an entry selects 2^(32 i) G
+constexpr int kCombTeeth = 8;
+constexpr int kCombSpacing = 32;
+constexpr int kCombEntries = 1 << kCombTeeth;
+
+// Fixed window for multiples of other points
+constexpr int kWindowBits = 4;
+constexpr int kWindowEntries = 1 << kWindowBits;
+
+// Returns the low half of a * b + c + *carry, stores the high half in *carry
+inline uint64_t mac(uint64_t a, uint64_t b, uint64_t c, uint64_t* carry) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 t = (unsigned __int128)a * b + c + *carry;
+  *carry = (uint64_t)(t >> 64);
+  return (uint64_t)t;
+#else
+  uint64_t lo_lo = (a & 0xffffffff) * (b & 0xffffffff);
+  uint64_t hi_lo = (a >> 32) * (b & 0xffffffff);
+  uint64_t lo_hi = (a & 0xffffffff) * (b >> 32);
+  uint64_t hi_hi = (a >> 32) * (b >> 32);
+  uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+  uint64_t hi = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  uint64_t lo = (cross << 32) | (lo_lo & 0xffffffff);
+  lo += c;
+  hi += lo < c;
+  lo += *carry;
+  hi += lo < *carry;
+  *carry = hi;
+  return lo;
+#endif
+}
+
+// Returns a + b + *carry and stores the carry out in *carry
+inline uint64_t adc(uint64_t a, uint64_t b, uint64_t* carry) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 t = (unsigned __int128)a + b + *carry;
+  *carry = (uint64_t)(t >> 64);
+  return (uint64_t)t;
+#else
+  uint64_t t = a + *carry;
+  uint64_t c = t < a;
+  t += b;
+  *carry = c | (t < b);
+  return t;
+#endif
+}
+
+// Returns a - b - *borrow and stores the borrow out in *borrow
+inline uint64_t sbb(uint64_t a, uint64_t b, uint64_t* borrow) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 t = (unsigned __int128)a - b - *borrow;
+  *borrow = (uint64_t)(t >> 64) & 1;
+  return (uint64_t)t;
+#else
+  uint64_t t = a - b;
+  uint64_t c = a < b;
+  uint64_t r = t - *borrow;
+  *borrow = c | (t < *borrow);
+  return r;
+#endif
+}
+
+// All ones if a == b, zero otherwise. a ^ b must be below 2^63.
+inline uint64_t eq_mask(uint64_t a, uint64_t b) {
+  return 0 - (((a ^ b) - 1) >> 63);
+}
+
+// r = a + carry * 2^256 reduced once modulo p, for values below 2p
+void fe_reduce_once(Fe* r, const uint64_t* a, uint64_t carry) {
+  uint64_t d[kLimbs];
+  uint64_t borrow = 0;
+  for (int i = 0; i < kLimbs; i++) d[i] = sbb(a[i], kP.v[i], &borrow);
+  uint64_t keep = 0 - (borrow & (carry ^ 1));
+  for (int i = 0; i < kLimbs; i++) r->v[i] = (a[i] & keep) | (d[i] & ~keep);
+}
+
+void fe_add(Fe* r, const Fe& a, const Fe& b) {
+  uint64_t t[kLimbs];
+  uint64_t carry = 0;
+  for (int i = 0; i < kLimbs; i++) t[i] = adc(a.v[i], b.v[i], &carry);
+  fe_reduce_once(r, t, carry);
+}
 
-static void p_256_init_point(Point* q) {
-  memset(q, 0, sizeof(Point));
+void fe_sub(Fe* r, const Fe& a, const Fe& b) {
+  uint64_t t[kLimbs];
+  uint64_t borrow = 0;
+  for (int i = 0; i < kLimbs; i++) t[i] = sbb(a.v[i], b.v[i], &borrow);
+  uint64_t mask = 0 - borrow;
+  uint64_t carry = 0;
+  for (int i = 0; i < kLimbs; i++) r->v[i] = adc(t[i], kP.v[i] & mask, &carry);
 }
 
-static void p_256_copy_point(Point* q, const Point* p) {
-  memcpy(q, p, sizeof(Point));
+// r = a * b / 2^256 mod p, interleaving the product with the Montgomery
+// reduction. -p^-1 mod 2^64 is 1, so the multiple m of p that clears the
+// lowest limb is that limb itself, and the special form of p turns m * p into
+// shifts and a single multiplication:
+//   (t + m * p) / 2^64 = t / 2^64 + m * 2^32 + m * p[3] * 2^128
+void fe_mul(Fe* r, const Fe& a, const Fe& b) {
+  uint64_t t[kLimbs + 1] = {0};
+  for (int i = 0; i < kLimbs; i++) {
+    uint64_t carry = 0;
+    for (int j = 0; j < kLimbs; j++) t[j] = mac(a.v[j], b.v[i], t[j], &carry);
+    uint64_t top = 0;
+    t[kLimbs] = adc(t[kLimbs], carry, &top);
+
+    uint64_t m = t[0];
+    uint64_t c = 0;
+    t[0] = adc(t[1], m << 32, &c);
+    t[1] = adc(t[2], m >> 32, &c);
+    t[2] = mac(m, kP.v[3], t[3], &c);
+    t[3] = adc(t[4], 0, &c);
+    t[kLimbs] = top + c;
+  }
+  fe_reduce_once(r, t, t[kLimbs]);
 }
 
-// q=2q
-static void ECC_Double(Point* q, const Point* p) {
-  uint32_t t1[KEY_LENGTH_DWORDS_P256];
-  uint32_t t2[KEY_LENGTH_DWORDS_P256];
-  uint32_t t3[KEY_LENGTH_DWORDS_P256];
-  const uint32_t* x1;
-  uint32_t* x3;
-  const uint32_t* y1;
-  uint32_t* y3;
-  const uint32_t* z1;
-  uint32_t* z3;
-
-  if (multiprecision_iszero(p->z)) {
-    multiprecision_init(q->z);
-    return;  // return infinity
+// r = a^(p - 2) = a^-1, or zero for a = 0. The exponent is public.
+void fe_inv(Fe* r, const Fe& a) {
+  Fe t = kOne;
+  for (int i = 255; i >= 0; i--) {
+    fe_mul(&t, t, t);
+    if ((kPMinus2.v[i / 64] >> (i % 64)) & 1) fe_mul(&t, t, a);
   }
+  *r = t;
+}
 
-  x1 = p->x;
-  y1 = p->y;
-  z1 = p->z;
-  x3 = q->x;
-  y3 = q->y;
-  z3 = q->z;
-
-  multiprecision_mersenns_squa_mod(t1, z1, modp);      // t1=z1^2
-  multiprecision_sub_mod(t2, x1, t1, modp);            // t2=x1-t1
-  multiprecision_add_mod(t1, x1, t1, modp);            // t1=x1+t1
-  multiprecision_mersenns_mult_mod(t2, t1, t2, modp);  // t2=t2*t1
-  multiprecision_lshift_mod(t3, t2, modp);
-  multiprecision_add_mod(t2, t3, t2, modp);  // t2=3t2
-
-  multiprecision_mersenns_mult_mod(z3, y1, z1, modp);  // z3=y1*z1
-  multiprecision_lshift_mod(z3, z3, modp);
-
-  multiprecision_mersenns_squa_mod(y3, y1, modp);  // y3=y1^2
-  multiprecision_lshift_mod(y3, y3, modp);
-  multiprecision_mersenns_mult_mod(t3, y3, x1, modp);  // t3=y3*x1=x1*y1^2
-  multiprecision_lshift_mod(t3, t3, modp);
-  multiprecision_mersenns_squa_mod(y3, y3, modp);  // y3=y3^2=y1^4
-  multiprecision_lshift_mod(y3, y3, modp);
-
-  multiprecision_mersenns_squa_mod(x3, t2, modp);      // x3=t2^2
-  multiprecision_lshift_mod(t1, t3, modp);             // t1=2t3
-  multiprecision_sub_mod(x3, x3, t1, modp);            // x3=x3-t1
-  multiprecision_sub_mod(t1, t3, x3, modp);            // t1=t3-x3
-  multiprecision_mersenns_mult_mod(t1, t1, t2, modp);  // t1=t1*t2
-  multiprecision_sub_mod(y3, t1, y3, modp);            // y3=t1-y3
+// Loads 32 bit words into the Montgomery domain. Returns false if the value is
+// not below p.
+bool fe_from_words(Fe* r, const uint32_t* words) {
+  Fe a;
+  for (int i = 0; i < kLimbs; i++) a.v[i] = words[2 * i] | (uint64_t)words[2 * i + 1] << 32;
+  uint64_t borrow = 0;
+  for (int i = 0; i < kLimbs; i++) sbb(a.v[i], kP.v[i], &borrow);
+  fe_mul(r, a, kRR);
+  return borrow;
 }
 
-// q=q+p,     zp must be 1
-static void ECC_Add(Point* r, Point* p, const Point* q) {
-  uint32_t t1[KEY_LENGTH_DWORDS_P256];
-  uint32_t t2[KEY_LENGTH_DWORDS_P256];
-  uint32_t* x1;
-  const uint32_t* x2;
-  uint32_t* x3;
-  uint32_t* y1;
-  const uint32_t* y2;
-  uint32_t* y3;
-  uint32_t* z1;
-  const uint32_t* z2;
-  uint32_t* z3;
-
-  x1 = p->x;
-  y1 = p->y;
-  z1 = p->z;
-  x2 = q->x;
-  y2 = q->y;
-  z2 = q->z;
-  x3 = r->x;
-  y3 = r->y;
-  z3 = r->z;
-
-  // if Q=infinity, return p
-  if (multiprecision_iszero(z2)) {
-    p_256_copy_point(r, p);
-    return;
+void fe_to_words(uint32_t* words, const Fe& a) {
+  Fe t;
+  fe_mul(&t, a, Fe{{1, 0, 0, 0}});
+  for (int i = 0; i < kLimbs; i++) {
+    words[2 * i] = (uint32_t)t.v[i];
+    words[2 * i + 1] = (uint32_t)(t.v[i] >> 32);
   }
+}
+
+// r = a where mask is all ones, r unchanged where mask is zero
+void fe_cmov(Fe* r, const Fe& a, uint64_t mask) {
+  for (int i = 0; i < kLimbs; i++) r->v[i] = (r->v[i] & ~mask) | (a.v[i] & mask);
+}
+
+// All ones if a is zero, zero otherwise
+uint64_t fe_zero_mask(const Fe& a) {
+  uint64_t bits = a.v[0] | a.v[1] | a.v[2] | a.v[3];
+  return ((bits | (0 - bits)) >> 63) - 1;
+}
+
+constexpr ProjectivePoint kInfinity = {{{0}}, kOne, {{0}}};
+
+// Algorithm 6 of Renes, Costello, Batina, "Complete addition formulas for
+// prime order elliptic curves"
+void point_double(ProjectivePoint* r, const ProjectivePoint& p) {
+  Fe t0, t1, t2, t3, x3, y3, z3;
+  fe_mul(&t0, p.x, p.x);
+  fe_mul(&t1, p.y, p.y);
+  fe_mul(&t2, p.z, p.z);
+  fe_mul(&t3, p.x, p.y);
+  fe_add(&t3, t3, t3);
+  fe_mul(&z3, p.x, p.z);
+  fe_add(&z3, z3, z3);
+  fe_mul(&y3, kB, t2);
+  fe_sub(&y3, y3, z3);
+  fe_add(&x3, y3, y3);
+  fe_add(&y3, x3, y3);
+  fe_sub(&x3, t1, y3);
+  fe_add(&y3, t1, y3);
+  fe_mul(&y3, x3, y3);
+  fe_mul(&x3, x3, t3);
+  fe_add(&t3, t2, t2);
+  fe_add(&t2, t2, t3);
+  fe_mul(&z3, kB, z3);
+  fe_sub(&z3, z3, t2);
+  fe_sub(&z3, z3, t0);
+  fe_add(&t3, z3, z3);
+  fe_add(&z3, z3, t3);
+  fe_add(&t3, t0, t0);
+  fe_add(&t0, t3, t0);
+  fe_sub(&t0, t0, t2);
+  fe_mul(&t0, t0, z3);
+  fe_add(&y3, y3, t0);
+  fe_mul(&t0, p.y, p.z);
+  fe_add(&t0, t0, t0);
+  fe_mul(&z3, t0, z3);
+  fe_sub(&x3, x3, z3);
+  fe_mul(&z3, t0, t1);
+  fe_add(&z3, z3, z3);
+  fe_add(&z3, z3, z3);
+  r->x = x3;
+  r->y = y3;
+  r->z = z3;
+}
 
-  // if P=infinity, return q
-  if (multiprecision_iszero(z1)) {
-    p_256_copy_point(r, q);
-    return;
+// Algorithm 4 of Renes, Costello, Batina
+void point_add(ProjectivePoint* r, const ProjectivePoint& p, const ProjectivePoint& q) {
+  Fe t0, t1, t2, t3, t4, x3, y3, z3;
+  fe_mul(&t0, p.x, q.x);
+  fe_mul(&t1, p.y, q.y);
+  fe_mul(&t2, p.z, q.z);
+  fe_add(&t3, p.x, p.y);
+  fe_add(&t4, q.x, q.y);
+  fe_mul(&t3, t3, t4);
+  fe_add(&t4, t0, t1);
+  fe_sub(&t3, t3, t4);
+  fe_add(&t4, p.y, p.z);
+  fe_add(&x3, q.y, q.z);
+  fe_mul(&t4, t4, x3);
+  fe_add(&x3, t1, t2);
+  fe_sub(&t4, t4, x3);
+  fe_add(&x3, p.x, p.z);
+  fe_add(&y3, q.x, q.z);
+  fe_mul(&x3, x3, y3);
+  fe_add(&y3, t0, t2);
+  fe_sub(&y3, x3, y3);
+  fe_mul(&z3, kB, t2);
+  fe_sub(&x3, y3, z3);
+  fe_add(&z3, x3, x3);
+  fe_add(&x3, x3, z3);
+  fe_sub(&z3, t1, x3);
+  fe_add(&x3, t1, x3);
+  fe_mul(&y3, kB, y3);
+  fe_add(&t1, t2, t2);
+  fe_add(&t2, t1, t2);
+  fe_sub(&y3, y3, t2);
+  fe_sub(&y3, y3, t0);
+  fe_add(&t1, y3, y3);
+  fe_add(&y3, t1, y3);
+  fe_add(&t1, t0, t0);
+  fe_add(&t0, t1, t0);
+  fe_sub(&t0, t0, t2);
+  fe_mul(&t1, t4, y3);
+  fe_mul(&t2, t0, y3);
+  fe_mul(&y3, x3, z3);
+  fe_add(&y3, y3, t2);
+  fe_mul(&x3, t3, x3);
+  fe_sub(&x3, x3, t1);
+  fe_mul(&z3, t4, z3);
+  fe_mul(&t1, t3, t0);
+  fe_add(&z3, z3, t1);
+  r->x = x3;
+  r->y = y3;
+  r->z = z3;
+}
+
+// Algorithm 5 of Renes, Costello, Batina. q can not be the point at infinity.
+void point_add_mixed(ProjectivePoint* r, const ProjectivePoint& p, const AffinePoint& q) {
+  Fe t0, t1, t2, t3, t4, x3, y3, z3;
+  fe_mul(&t0, p.x, q.x);
+  fe_mul(&t1, p.y, q.y);
+  fe_add(&t3, q.x, q.y);
+  fe_add(&t4, p.x, p.y);
+  fe_mul(&t3, t3, t4);
+  fe_add(&t4, t0, t1);
+  fe_sub(&t3, t3, t4);
+  fe_mul(&t4, q.y, p.z);
+  fe_add(&t4, t4, p.y);
+  fe_mul(&y3, q.x, p.z);
+  fe_add(&y3, y3, p.x);
+  fe_mul(&z3, kB, p.z);
+  fe_sub(&x3, y3, z3);
+  fe_add(&z3, x3, x3);
+  fe_add(&x3, x3, z3);
+  fe_sub(&z3, t1, x3);
+  fe_add(&x3, t1, x3);
+  fe_mul(&y3, kB, y3);
+  fe_add(&t1, p.z, p.z);
+  fe_add(&t2, t1, p.z);
+  fe_sub(&y3, y3, t2);
+  fe_sub(&y3, y3, t0);
+  fe_add(&t1, y3, y3);
+  fe_add(&y3, t1, y3);
+  fe_add(&t1, t0, t0);
+  fe_add(&t0, t1, t0);
+  fe_sub(&t0, t0, t2);
+  fe_mul(&t1, t4, y3);
+  fe_mul(&t2, t0, y3);
+  fe_mul(&y3, x3, z3);
+  fe_add(&y3, y3, t2);
+  fe_mul(&x3, x3, t3);
+  fe_sub(&x3, x3, t1);
+  fe_mul(&z3, t4, z3);
+  fe_mul(&t1, t3, t0);
+  fe_add(&z3, z3, t1);
+  r->x = x3;
+  r->y = y3;
+  r->z = z3;
+}
+
+void point_to_affine(AffinePoint* r, const ProjectivePoint& p) {
+  Fe z_inv;
+  fe_inv(&z_inv, p.z);
+  fe_mul(&r->x, p.x, z_inv);
+  fe_mul(&r->y, p.y, z_inv);
+}
+
+std::array<AffinePoint, kCombEntries> compute_comb_table() {
+  std::array<ProjectivePoint, kCombEntries> points;
+  points[0] = kInfinity;
+  ProjectivePoint tooth;
+  fe_from_words(&tooth.x, curve_p256.G.x);
+  fe_from_words(&tooth.y, curve_p256.G.y);
+  tooth.z = kOne;
+  for (int i = 0; i < kCombTeeth; i++) {
+    for (int j = 1 << i; j < 2 << i; j++) point_add(&points[j], points[j - (1 << i)], tooth);
+    for (int k = 0; k < kCombSpacing; k++) point_double(&tooth, tooth);
   }
 
-  multiprecision_mersenns_squa_mod(t1, z1, modp);      // t1=z1^2
-  multiprecision_mersenns_mult_mod(t2, z1, t1, modp);  // t2=t1*z1
-  multiprecision_mersenns_mult_mod(t1, x2, t1, modp);  // t1=t1*x2
-  multiprecision_mersenns_mult_mod(t2, y2, t2, modp);  // t2=t2*y2
+  // Entry 0 is never read
+  std::array<AffinePoint, kCombEntries> table;
+  for (int j = 0; j < kCombEntries; j++) point_to_affine(&table[j], points[j]);
+  return table;
+}
 
-  multiprecision_sub_mod(t1, t1, x1, modp);  // t1=t1-x1
-  multiprecision_sub_mod(t2, t2, y1, modp);  // t2=t2-y1
+const std::array<AffinePoint, kCombEntries>& comb_table() {
+  static const std::array<AffinePoint, kCombEntries> table = compute_comb_table();
+  return table;
+}
 
-  if (multiprecision_iszero(t1)) {
-    if (multiprecision_iszero(t2)) {
-      ECC_Double(r, q);
-      return;
-    } else {
-      multiprecision_init(z3);
-      return;  // return infinity
+// r = n * G. Column c of the comb takes bit c of each 32 bit word of n.
+void scalar_mult_base(ProjectivePoint* r, const uint32_t* n) {
+  static_assert(kCombTeeth * kCombSpacing == 256 && kCombSpacing == 32, "comb must span the words of n");
+  const std::array<AffinePoint, kCombEntries>& table = comb_table();
+  ProjectivePoint acc = kInfinity;
+  for (int c = kCombSpacing - 1; c >= 0; c--) {
+    point_double(&acc, acc);
+
+    uint64_t index = 0;
+    for (int i = 0; i < kCombTeeth; i++) index |= (uint64_t)((n[i] >> c) & 1) << i;
+    AffinePoint entry = table[1];
+    for (int j = 2; j < kCombEntries; j++) {
+      uint64_t mask = eq_mask(index, j);
+      fe_cmov(&entry.x, table[j].x, mask);
+      fe_cmov(&entry.y, table[j].y, mask);
     }
+
+    ProjectivePoint sum;
+    point_add_mixed(&sum, acc, entry);
+    uint64_t mask = ~eq_mask(index, 0);
+    fe_cmov(&acc.x, sum.x, mask);
+    fe_cmov(&acc.y, sum.y, mask);
+    fe_cmov(&acc.z, sum.z, mask);
   }
+  *r = acc;
+}
 
-  multiprecision_mersenns_mult_mod(z3, z1, t1, modp);  // z3=z1*t1
-  multiprecision_mersenns_squa_mod(y3, t1, modp);      // t3=t1^2
-  multiprecision_mersenns_mult_mod(z1, y3, t1, modp);  // t4=t3*t1
-  multiprecision_mersenns_mult_mod(y3, y3, x1, modp);  // t3=t3*x1
-  multiprecision_lshift_mod(t1, y3, modp);             // t1=2*t3
-  multiprecision_mersenns_squa_mod(x3, t2, modp);      // x3=t2^2
-  multiprecision_sub_mod(x3, x3, t1, modp);            // x3=x3-t1
-  multiprecision_sub_mod(x3, x3, z1, modp);            // x3=x3-t4
-  multiprecision_sub_mod(y3, y3, x3, modp);            // t3=t3-x3
-  multiprecision_mersenns_mult_mod(y3, y3, t2, modp);  // t3=t3*t2
-  multiprecision_mersenns_mult_mod(z1, z1, y1, modp);  // t4=t4*t1
-  multiprecision_sub_mod(y3, y3, z1, modp);
+void jacobian_cmov(JacobianPoint* r, const JacobianPoint& a, uint64_t mask) {
+  fe_cmov(&r->x, a.x, mask);
+  fe_cmov(&r->y, a.y, mask);
+  fe_cmov(&r->z, a.z, mask);
 }
 
-// Computing the Non-Adjacent Form of a positive integer
-static void ECC_NAF(uint8_t* naf, uint32_t* NumNAF, uint32_t* k) {
-  uint32_t sign;
-  int i = 0;
-  int j;
-  uint32_t var;
-
-  while ((var = multiprecision_most_signbits(k)) >= 1) {
-    if (k[0] & 0x01)  // k is odd
-    {
-      sign = (k[0] & 0x03);  // 1 or 3
-
-      // k = k-naf[i]
-      if (sign == 1)
-        k[0] = k[0] & 0xFFFFFFFE;
-      else {
-        k[0] = k[0] + 1;
-        if (k[0] == 0)  // overflow
-        {
-          j = 1;
-          do {
-            k[j]++;
-          } while (k[j++] == 0);  // overflow
-        }
-      }
-    } else
-      sign = 0;
-
-    multiprecision_rshift(k, k);
-    naf[i / 4] |= (sign) << ((i % 4) * 2);
-    i++;
-  }
+// "dbl-2001-b" of the Explicit-Formulas Database. The point at infinity
+// (z = 0) doubles to itself.
+void jacobian_double(JacobianPoint* r, const JacobianPoint& p) {
+  Fe delta, gamma, beta, alpha, t0, t1, x3, y3, z3;
+  fe_mul(&delta, p.z, p.z);
+  fe_mul(&gamma, p.y, p.y);
+  fe_mul(&beta, p.x, gamma);
+  fe_sub(&t0, p.x, delta);
+  fe_add(&t1, p.x, delta);
+  fe_mul(&alpha, t0, t1);
+  fe_add(&t0, alpha, alpha);
+  fe_add(&alpha, alpha, t0);
+  fe_add(&z3, p.y, p.z);
+  fe_mul(&z3, z3, z3);
+  fe_sub(&z3, z3, gamma);
+  fe_sub(&z3, z3, delta);
+  fe_add(&beta, beta, beta);
+  fe_add(&beta, beta, beta);
+  fe_mul(&x3, alpha, alpha);
+  fe_add(&t0, beta, beta);
+  fe_sub(&x3, x3, t0);
+  fe_sub(&t0, beta, x3);
+  fe_mul(&y3, alpha, t0);
+  fe_mul(&gamma, gamma, gamma);
+  fe_add(&gamma, gamma, gamma);
+  fe_add(&gamma, gamma, gamma);
+  fe_add(&gamma, gamma, gamma);
+  fe_sub(&y3, y3, gamma);
+  r->x = x3;
+  r->y = y3;
+  r->z = z3;
+}
+
+// "add-2007-bl" of the Explicit-Formulas Database. Either input can be the
+// point at infinity, but p and q must not be equal.
+void jacobian_add(JacobianPoint* r, const JacobianPoint& p, const JacobianPoint& q) {
+  Fe z1z1, z2z2, u1, u2, s1, s2, h, i, j, rr, v, t;
+  fe_mul(&z1z1, p.z, p.z);
+  fe_mul(&z2z2, q.z, q.z);
+  fe_mul(&u1, p.x, z2z2);
+  fe_mul(&u2, q.x, z1z1);
+  fe_mul(&s1, p.y, q.z);
+  fe_mul(&s1, s1, z2z2);
+  fe_mul(&s2, q.y, p.z);
+  fe_mul(&s2, s2, z1z1);
+  fe_sub(&h, u2, u1);
+  fe_add(&i, h, h);
+  fe_mul(&i, i, i);
+  fe_mul(&j, h, i);
+  fe_sub(&rr, s2, s1);
+  fe_add(&rr, rr, rr);
+  fe_mul(&v, u1, i);
+
+  JacobianPoint sum;
+  fe_mul(&sum.x, rr, rr);
+  fe_sub(&sum.x, sum.x, j);
+  fe_sub(&sum.x, sum.x, v);
+  fe_sub(&sum.x, sum.x, v);
+  fe_sub(&t, v, sum.x);
+  fe_mul(&sum.y, rr, t);
+  fe_mul(&t, s1, j);
+  fe_add(&t, t, t);
+  fe_sub(&sum.y, sum.y, t);
+  fe_add(&t, p.z, q.z);
+  fe_mul(&t, t, t);
+  fe_sub(&t, t, z1z1);
+  fe_sub(&t, t, z2z2);
+  fe_mul(&sum.z, t, h);
+
+  uint64_t p_is_infinity = fe_zero_mask(p.z);
+  uint64_t q_is_infinity = fe_zero_mask(q.z);
+  jacobian_cmov(&sum, q, p_is_infinity);
+  jacobian_cmov(&sum, p, q_is_infinity);
+  *r = sum;
+}
 
-  *NumNAF = i;
+// k = n mod the group order. n is below 2^256, less than twice the order.
+void scalar_reduce(uint32_t* k, const uint32_t* n) {
+  uint32_t d[KEY_LENGTH_DWORDS_P256];
+  uint64_t borrow = 0;
+  for (int i = 0; i < KEY_LENGTH_DWORDS_P256; i++) {
+    uint64_t t = (uint64_t)n[i] - kN[i] - borrow;
+    d[i] = (uint32_t)t;
+    borrow = (t >> 32) & 1;
+  }
+  uint32_t keep = 0 - (uint32_t)borrow;
+  for (int i = 0; i < KEY_LENGTH_DWORDS_P256; i++) k[i] = (n[i] & keep) | (d[i] & ~keep);
 }
 
-// Binary Non-Adjacent Form for point multiplication
-void ECC_PointMult_Bin_NAF(Point* q, const Point* p, uint32_t* n) {
-  uint32_t sign;
-  uint8_t naf[256 / 4 + 1];
-  uint32_t NumNaf;
-  Point minus_p;
-  Point r;
-
-  p_256_init_point(&r);
-
-  // initialization
-  p_256_init_point(q);
-
-  // -p
-  multiprecision_copy(minus_p.x, p->x);
-  multiprecision_sub(minus_p.y, modp, p->y);
-
-  multiprecision_init(minus_p.z);
-  minus_p.z[0] = 1;
-
-  // NAF
-  memset(naf, 0, sizeof(naf));
-  ECC_NAF(naf, &NumNaf, n);
-
-  for (int i = NumNaf - 1; i >= 0; i--) {
-    p_256_copy_point(&r, q);
-    ECC_Double(q, &r);
-    sign = (naf[i / 4] >> ((i % 4) * 2)) & 0x03;
-
-    if (sign == 1) {
-      p_256_copy_point(&r, q);
-      ECC_Add(q, &r, p);
-    } else if (sign == 3) {
-      p_256_copy_point(&r, q);
-      ECC_Add(q, &r, &minus_p);
+// r = n * p with a fixed window of kWindowBits. The accumulator is a multiple
+// of p by a prefix of the reduced scalar times 2^kWindowBits, which can not be
+// equal to the multiple of p being added unless both are zero.
+void scalar_mult(JacobianPoint* r, const AffinePoint& p, const uint32_t* n) {
+  uint32_t k[KEY_LENGTH_DWORDS_P256];
+  scalar_reduce(k, n);
+
+  JacobianPoint table[kWindowEntries];
+  table[0] = {kOne, kOne, {{0}}};
+  table[1] = {p.x, p.y, kOne};
+  for (int i = 2; i < kWindowEntries; i++) {
+    if (i % 2 == 0) {
+      jacobian_double(&table[i], table[i / 2]);
+    } else {
+      jacobian_add(&table[i], table[i - 1], table[1]);
     }
   }
 
-  multiprecision_inv_mod(minus_p.x, q->z, modp);
-  multiprecision_mersenns_squa_mod(q->z, minus_p.x, modp);
-  multiprecision_mersenns_mult_mod(q->x, q->x, q->z, modp);
-  multiprecision_mersenns_mult_mod(q->z, q->z, minus_p.x, modp);
-  multiprecision_mersenns_mult_mod(q->y, q->y, q->z, modp);
+  JacobianPoint acc = table[0];
+  for (int w = 256 / kWindowBits - 1; w >= 0; w--) {
+    for (int i = 0; i < kWindowBits; i++) jacobian_double(&acc, acc);
+
+    int bit = w * kWindowBits;
+    uint64_t index = (k[bit / 32] >> (bit % 32)) & (kWindowEntries - 1);
+    JacobianPoint entry = table[0];
+    for (int j = 1; j < kWindowEntries; j++) jacobian_cmov(&entry, table[j], eq_mask(index, j));
+    jacobian_add(&acc, acc, entry);
+  }
+  *r = acc;
+}
+
+}  // namespace
+
+void ECC_PointMult(Point* q, const Point* p, const uint32_t* n) {
+  AffinePoint result;
+  if (memcmp(p->x, curve_p256.G.x, sizeof(p->x)) == 0 && memcmp(p->y, curve_p256.G.y, sizeof(p->y)) == 0) {
+    ProjectivePoint r;
+    scalar_mult_base(&r, n);
+    point_to_affine(&result, r);
+  } else {
+    AffinePoint a;
+    fe_from_words(&a.x, p->x);
+    fe_from_words(&a.y, p->y);
+    JacobianPoint r;
+    scalar_mult(&r, a, n);
+    Fe z_inv, z_inv2;
+    fe_inv(&z_inv, r.z);
+    fe_mul(&z_inv2, z_inv, z_inv);
+    fe_mul(&result.x, r.x, z_inv2);
+    fe_mul(&z_inv2, z_inv2, z_inv);
+    fe_mul(&result.y, r.y, z_inv2);
+  }
+
+  fe_to_words(q->x, result.x);
+  fe_to_words(q->y, result.y);
+  memset(q->z, 0, sizeof(q->z));
+  q->z[0] = 1;
 }
 
 bool ECC_ValidatePoint(const Point& pt) {
-  // Ensure y^2 = x^3 + a*x + b (mod p); a = -3
-
-  // y^2 mod p
-  uint32_t y2_mod[KEY_LENGTH_DWORDS_P256] = {0};
-  multiprecision_mersenns_squa_mod(y2_mod, (uint32_t*)pt.y, modp);
-
-  // Right hand side calculation
-  uint32_t rhs[KEY_LENGTH_DWORDS_P256] = {0};
-  multiprecision_mersenns_squa_mod(rhs, (uint32_t*)pt.x, modp);
-  uint32_t three[KEY_LENGTH_DWORDS_P256] = {0};
-  three[0] = 3;
-  multiprecision_sub_mod(rhs, rhs, three, modp);
-  multiprecision_mersenns_mult_mod(rhs, rhs, (uint32_t*)pt.x, modp);
-  multiprecision_add_mod(rhs, rhs, curve_p256.b, modp);
-
-  return multiprecision_compare(rhs, y2_mod) == 0;
+  // Ensure x, y < p and y^2 = x^3 + a*x + b (mod p); a = -3
+  Fe x, y;
+  if (!fe_from_words(&x, pt.x) || !fe_from_words(&y, pt.y)) return false;
+
+  Fe y2;
+  fe_mul(&y2, y, y);
+
+  Fe rhs, three_x;
+  fe_mul(&rhs, x, x);
+  fe_mul(&rhs, rhs, x);
+  fe_add(&three_x, x, x);
+  fe_add(&three_x, three_x, x);
+  fe_sub(&rhs, rhs, three_x);
+  fe_add(&rhs, rhs, kB);
+
+  return memcmp(&rhs, &y2, sizeof(Fe)) == 0;
 }
 
 }  // namespace ecc
 }  // namespace security
-}  // namespace bluetooth
\ No newline at end of file
+}  // namespace bluetooth
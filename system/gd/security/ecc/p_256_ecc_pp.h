@@ -25,12 +25,14 @@
 
 #pragma once
 
-#include "security/ecc/multprecision.h"
+#include <cstdint>
 
 namespace bluetooth {
 namespace security {
 namespace ecc {
 
+#define KEY_LENGTH_DWORDS_P256 8
+
 struct Point {
   uint32_t x[KEY_LENGTH_DWORDS_P256];
   uint32_t y[KEY_LENGTH_DWORDS_P256];
@@ -67,9 +69,10 @@ static constexpr elliptic_curve_t curve_p256{
 /* This function checks that point is on the elliptic curve*/
 bool ECC_ValidatePoint(const Point& point);
 
-void ECC_PointMult_Bin_NAF(Point* q, const Point* p, uint32_t* n);
-
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+/* Computes q = n * p for the little endian 256 bit scalar n and returns q in
+ * affine coordinates (z = 1). p must be on the curve. The running time does
+ * not depend on n. A precomputed table is used when p is the base point G. */
+void ECC_PointMult(Point* q, const Point* p, const uint32_t* n);
 
 }  // namespace ecc
 }  // namespace security
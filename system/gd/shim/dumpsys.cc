@@ -17,13 +17,18 @@
 
 #include "dumpsys/dumpsys.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <future>
 #include <string>
 
 #include "dumpsys/filter.h"
 #include "module.h"
+#include "os/handler.h"
 #include "os/log.h"
 #include "os/system_properties.h"
+#include "os/thread.h"
 #include "shim/dumpsys.h"
 #include "shim/dumpsys_args.h"
 
@@ -35,15 +40,17 @@ static const std::string kReadOnlyDebuggableProperty = "ro.debuggable";
 namespace {
 constexpr char kModuleName[] = "shim::Dumpsys";
 constexpr char kDumpsysTitle[] = "----- Gd Dumpsys ------";
+constexpr std::chrono::milliseconds kDumpThreadStopTimeout = std::chrono::milliseconds(2000);
 }  // namespace
 
 struct Dumpsys::impl {
  public:
   void DumpWithArgsSync(int fd, const char** args, std::promise<void> promise);
   int GetNumberOfBundledSchemas() const;
+  void AddSnapshotStats(DumpsysModuleDataBuilder* builder) const;
 
   impl(const Dumpsys& dumpsys_module, const dumpsys::ReflectionSchema& reflection_schema);
-  ~impl() = default;
+  ~impl();
 
  protected:
   void FilterAsUser(std::string* dumpsys_data);
@@ -53,34 +60,74 @@ struct Dumpsys::impl {
   bool IsDebuggable() const;
 
  private:
-  void DumpWithArgsAsync(int fd, const char** args);
+  void DumpWithArgsAsync(int fd, const char** args, std::string dumpsys_data, std::promise<void> promise);
 
   const Dumpsys& dumpsys_module_;
   const dumpsys::ReflectionSchema reflection_schema_;
+  const dumpsys::PrivacyFilter user_filter_;
+  const dumpsys::PrivacyFilter developer_filter_;
+
+  // Filtering, printing and writing the dumps is left to this thread, the
+  // stack thread only takes the snapshot of the modules.
+  os::Thread dump_thread_{"bt_dumpsys_thread", os::Thread::Priority::NORMAL};
+  os::Handler* dump_handler_;
+
+  // Time the stack thread spent taking the snapshots.
+  int number_of_snapshots_{0};
+  int64_t last_snapshot_time_us_{0};
+  int64_t max_snapshot_time_us_{0};
+  // Time the dump thread spent filtering, printing and writing them, that the
+  // stack thread used to spend. Updated on the dump thread.
+  std::atomic<int64_t> last_dump_time_us_{0};
+  std::atomic<int64_t> max_dump_time_us_{0};
 };
 
 const ModuleFactory Dumpsys::Factory =
     ModuleFactory([]() { return new Dumpsys(bluetooth::dumpsys::GetBundledSchemaData()); });
 
 Dumpsys::impl::impl(const Dumpsys& dumpsys_module, const dumpsys::ReflectionSchema& reflection_schema)
-    : dumpsys_module_(dumpsys_module), reflection_schema_(std::move(reflection_schema)) {}
+    : dumpsys_module_(dumpsys_module),
+      reflection_schema_(std::move(reflection_schema)),
+      user_filter_(dumpsys::FilterType::AS_USER, reflection_schema_),
+      developer_filter_(dumpsys::FilterType::AS_DEVELOPER, reflection_schema_),
+      dump_handler_(new os::Handler(&dump_thread_)) {}
+
+Dumpsys::impl::~impl() {
+  // Let the dumps in progress finish.
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  dump_handler_->CallOn(&promise, &std::promise<void>::set_value);
+  future.wait();
+
+  dump_handler_->Clear();
+  dump_handler_->WaitUntilStopped(kDumpThreadStopTimeout);
+  delete dump_handler_;
+}
 
 int Dumpsys::impl::GetNumberOfBundledSchemas() const {
   return reflection_schema_.GetNumberOfBundledSchemas();
 }
 
+void Dumpsys::impl::AddSnapshotStats(DumpsysModuleDataBuilder* builder) const {
+  builder->add_number_of_snapshots(number_of_snapshots_);
+  builder->add_last_snapshot_time_us(last_snapshot_time_us_);
+  builder->add_max_snapshot_time_us(max_snapshot_time_us_);
+  builder->add_last_dump_time_us(last_dump_time_us_);
+  builder->add_max_dump_time_us(max_dump_time_us_);
+}
+
 bool Dumpsys::impl::IsDebuggable() const {
   return (os::GetSystemProperty(kReadOnlyDebuggableProperty) == "1");
 }
 
 void Dumpsys::impl::FilterAsDeveloper(std::string* dumpsys_data) {
   ASSERT(dumpsys_data != nullptr);
-  dumpsys::FilterInPlace(dumpsys::FilterType::AS_DEVELOPER, reflection_schema_, dumpsys_data);
+  developer_filter_.FilterInPlace(dumpsys_data);
 }
 
 void Dumpsys::impl::FilterAsUser(std::string* dumpsys_data) {
   ASSERT(dumpsys_data != nullptr);
-  dumpsys::FilterInPlace(dumpsys::FilterType::AS_USER, reflection_schema_, dumpsys_data);
+  user_filter_.FilterInPlace(dumpsys_data);
 }
 
 std::string Dumpsys::impl::PrintAsJson(std::string* dumpsys_data) const {
@@ -117,23 +164,39 @@ std::string Dumpsys::impl::PrintAsJson(std::string* dumpsys_data) const {
   return jsongen;
 }
 
-void Dumpsys::impl::DumpWithArgsAsync(int fd, const char** args) {
+void Dumpsys::impl::DumpWithArgsAsync(
+    int fd, const char** args, std::string dumpsys_data, std::promise<void> promise) {
   ParsedDumpsysArgs parsed_dumpsys_args(args);
-  const auto registry = dumpsys_module_.GetModuleRegistry();
-
-  ModuleDumper dumper(*registry, kDumpsysTitle);
-  std::string dumpsys_data;
-  dumper.DumpState(&dumpsys_data);
 
+  auto start = std::chrono::steady_clock::now();
   dprintf(fd, " ----- Filtering as Developer -----\n");
   FilterAsDeveloper(&dumpsys_data);
 
   dprintf(fd, "%s", PrintAsJson(&dumpsys_data).c_str());
+  int64_t dump_time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  last_dump_time_us_ = dump_time_us;
+  max_dump_time_us_ = std::max(max_dump_time_us_.load(), dump_time_us);
+  promise.set_value();
 }
 
+// Runs on the stack thread, takes the snapshot and hands it over to the dump thread.
 void Dumpsys::impl::DumpWithArgsSync(int fd, const char** args, std::promise<void> promise) {
-  DumpWithArgsAsync(fd, args);
-  promise.set_value();
+  const auto registry = dumpsys_module_.GetModuleRegistry();
+
+  auto start = std::chrono::steady_clock::now();
+  ModuleDumper dumper(*registry, kDumpsysTitle);
+  std::string dumpsys_data;
+  dumper.DumpState(&dumpsys_data);
+  auto snapshot_time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+  number_of_snapshots_++;
+  last_snapshot_time_us_ = snapshot_time_us;
+  max_snapshot_time_us_ = std::max(max_snapshot_time_us_, last_snapshot_time_us_);
+
+  dump_handler_->CallOn(this, &Dumpsys::impl::DumpWithArgsAsync, fd, args, std::move(dumpsys_data), std::move(promise));
 }
 
 Dumpsys::Dumpsys(const std::string& pre_bundled_schema)
@@ -180,6 +243,7 @@ DumpsysDataFinisher Dumpsys::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_b
   DumpsysModuleDataBuilder builder(*fb_builder);
   builder.add_title(name);
   builder.add_number_of_bundled_schemas(pimpl_->GetNumberOfBundledSchemas());
+  pimpl_->AddSnapshotStats(&builder);
   auto dumpsys_data = builder.Finish();
 
   return [dumpsys_data](DumpsysDataBuilder* builder) { builder->add_shim_dumpsys_data(dumpsys_data); };
@@ -635,6 +635,21 @@
 #define SDP_MAX_LIST_BYTE_COUNT 4096
 #endif
 
+/* How long, in seconds, a cached discovery result of a peer may be used. */
+#ifndef SDP_DISC_CACHE_TTL_S
+#define SDP_DISC_CACHE_TTL_S (24 * 60 * 60)
+#endif
+
+/* The maximum number of discovery results cached for each peer. */
+#ifndef SDP_DISC_CACHE_MAX_ENTRIES
+#define SDP_DISC_CACHE_MAX_ENTRIES 4
+#endif
+
+/* The largest response, in bytes, kept by the discovery cache. */
+#ifndef SDP_DISC_CACHE_MAX_LIST_LEN
+#define SDP_DISC_CACHE_MAX_LIST_LEN 1024
+#endif
+
 /* The maximum number of parameters in an SDP protocol element. */
 #ifndef SDP_MAX_PROTOCOL_PARAMS
 #define SDP_MAX_PROTOCOL_PARAMS 2
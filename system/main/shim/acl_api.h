@@ -36,6 +36,9 @@ void ACL_IgnoreLeConnectionFrom(const tBLE_BD_ADDR& legacy_address_with_type);
 void ACL_Disconnect(uint16_t handle, bool is_classic, tHCI_STATUS reason,
                     std::string comment);
 void ACL_WriteData(uint16_t handle, BT_HDR* p_buf);
+// Same as ACL_WriteData() but leaves |p_buf| owned by the caller, which may
+// keep it around (e.g. for retransmission) once this returns.
+void ACL_WriteDataCopy(uint16_t handle, const BT_HDR* p_buf);
 void ACL_ConfigureLePrivacy(bool is_le_privacy_enabled);
 void ACL_Shutdown();
 void ACL_IgnoreAllLeConnections();
@@ -1131,10 +1131,9 @@ void Device::HandleGetFolderItems(uint8_t label,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
-          base::Bind(&Device::GetVFSListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetCurrentFolderListing(base::Bind(&Device::GetVFSListResponse,
+                                         weak_ptr_factory_.GetWeakPtr(), label,
+                                         pkt));
       break;
     case Scope::NOW_PLAYING:
       media_interface_->GetNowPlayingList(
@@ -1168,8 +1167,7 @@ void Device::HandleGetTotalNumberOfItems(
       break;
     }
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetCurrentFolderListing(
           base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
@@ -1193,8 +1191,8 @@ void Device::GetTotalNumberOfItemsMediaPlayersResponse(
   send_message(label, true, std::move(builder));
 }
 
-void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                              std::vector<ListItem> list) {
+void Device::GetTotalNumberOfItemsVFSResponse(
+    uint8_t label, const std::vector<ListItem>& list) {
   DEVICE_VLOG(2) << __func__ << ": num_items=" << list.size();
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
@@ -1252,17 +1250,17 @@ void Device::HandleChangePath(uint8_t label,
                    << "\"";
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
-      base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
-                 label, pkt));
+  // The listing fetched here is cached for the new folder, so the
+  // GetFolderItems requests that usually follow are served without calling up.
+  InvalidateFolderListing();
+  GetCurrentFolderListing(base::Bind(&Device::ChangePathResponse,
+                                     weak_ptr_factory_.GetWeakPtr(), label,
+                                     pkt));
 }
 
 void Device::ChangePathResponse(uint8_t label,
                                 std::shared_ptr<ChangePathRequest> pkt,
-                                std::vector<ListItem> list) {
-  // TODO (apanicke): Reconstruct the VFS ID's here. Right now it gets
-  // reconstructed in GetFolderItemsVFS
+                                const std::vector<ListItem>& list) {
   auto builder =
       ChangePathResponseBuilder::MakeBuilder(Status::NO_ERROR, list.size());
   send_message(label, true, std::move(builder));
@@ -1299,8 +1297,7 @@ void Device::HandleGetItemAttributes(
       // then we can auto send the error without calling up. We do this check
       // later right now though in order to prevent race conditions with updates
       // on the media layer.
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetCurrentFolderListing(
           base::Bind(&Device::GetItemAttributesVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -1363,7 +1360,7 @@ void Device::GetItemAttributesNowPlayingResponse(
 
 void Device::GetItemAttributesVFSResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::vector<ListItem> item_list) {
+    const std::vector<ListItem>& item_list) {
   DEVICE_VLOG(2) << __func__ << ": uid=" << loghex(pkt->GetUid());
 
   auto media_id = vfs_ids_.get_media_id(pkt->GetUid());
@@ -1477,18 +1474,29 @@ std::set<AttributeEntry> filter_attributes_requested(
   return result;
 }
 
-void Device::GetVFSListResponse(uint8_t label,
-                                std::shared_ptr<GetFolderItemsRequest> pkt,
-                                std::vector<ListItem> items) {
-  DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
-                 << " end_item=" << pkt->GetEndItem();
+void Device::GetCurrentFolderListing(FolderListingCallback cb) {
+  if (folder_listing_valid_) {
+    DEVICE_VLOG(3) << __func__ << ": cached num_items="
+                   << folder_listing_.size();
+    cb.Run(folder_listing_);
+    return;
+  }
 
-  // The builder will automatically correct the status if there are zero items
-  auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
-      Status::NO_ERROR, 0x0000, browse_mtu_);
+  media_interface_->GetFolderItems(
+      curr_browsed_player_id_, CurrentFolder(),
+      base::Bind(&Device::CurrentFolderListingReceived,
+                 weak_ptr_factory_.GetWeakPtr(), folder_listing_generation_,
+                 cb));
+}
 
-  // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
-  // an operation.
+void Device::CurrentFolderListingReceived(uint32_t generation,
+                                          FolderListingCallback cb,
+                                          std::vector<ListItem> items) {
+  DEVICE_VLOG(3) << __func__ << ": num_items=" << items.size();
+
+  // Map the items to UIDs once per listing rather than on every request for
+  // a window of it. These do not need to correspond with the now playing list
+  // as the UID's only need to be unique in the context of the current scope.
   for (const auto& item : items) {
     if (item.type == ListItem::FOLDER) {
       vfs_ids_.insert(item.folder.media_id);
@@ -1497,15 +1505,40 @@ void Device::GetVFSListResponse(uint8_t label,
     }
   }
 
-  // Add the elements retrieved in the last get folder items request and map
-  // them to UIDs The maps will be cleared every time a directory change
-  // happens. These items do not need to correspond with the now playing list as
-  // the UID's only need to be unique in the context of the current scope and
-  // the current folder
+  // Don't cache a listing of a folder that was left or changed while it was
+  // being fetched.
+  if (generation != folder_listing_generation_) {
+    cb.Run(items);
+    return;
+  }
+
+  folder_listing_ = std::move(items);
+  folder_listing_valid_ = true;
+  cb.Run(folder_listing_);
+}
+
+void Device::InvalidateFolderListing() {
+  folder_listing_generation_++;
+  folder_listing_valid_ = false;
+  folder_listing_.clear();
+}
+
+void Device::GetVFSListResponse(uint8_t label,
+                                std::shared_ptr<GetFolderItemsRequest> pkt,
+                                const std::vector<ListItem>& items) {
+  DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
+                 << " end_item=" << pkt->GetEndItem();
+
+  // The builder will automatically correct the status if there are zero items
+  auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, browse_mtu_);
+
+  // Only the requested window of the listing is converted. The items were
+  // mapped to UIDs when the listing was received.
   for (auto i = pkt->GetStartItem(); i <= pkt->GetEndItem() && i < items.size();
        i++) {
     if (items[i].type == ListItem::FOLDER) {
-      auto folder = items[i].folder;
+      const auto& folder = items[i].folder;
       // right now we always use folders of mixed type
       FolderItem folder_item(vfs_ids_.get_uid(folder.media_id), 0x00,
                              folder.is_playable, folder.name);
@@ -1624,6 +1657,7 @@ void Device::SetBrowsedPlayerResponse(
   // Clear the path and push the new root.
   current_path_ = std::stack<std::string>();
   current_path_.push(root_id);
+  InvalidateFolderListing();
 
   auto response = SetBrowsedPlayerResponseBuilder::MakeBuilder(
       Status::NO_ERROR, 0x0000, num_items, 0, "");
@@ -1664,6 +1698,11 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   if (addressed_player) {
     HandleAddressedPlayerUpdate();
   }
+
+  // The contents of the browsed folder may have changed
+  if (uids) {
+    InvalidateFolderListing();
+  }
 }
 
 void Device::HandleTrackUpdate() {
@@ -1872,6 +1911,10 @@ std::ostream& operator<<(std::ostream& out, const Device& d) {
   out << "Last Play State: " << d.last_play_status_.state << std::endl;
   out << "Last Song Sent ID: \"" << d.last_song_info_.media_id << "\"\n";
   out << "Current Folder: \"" << d.CurrentFolder() << "\"\n";
+  out << "Cached Folder Items: "
+      << (d.folder_listing_valid_ ? std::to_string(d.folder_listing_.size())
+                                  : "none")
+      << " (VFS UIDs: " << d.vfs_ids_.size() << ")\n";
   out << "MTU Sizes: CTRL=" << d.ctrl_mtu_ << " BROWSE=" << d.browse_mtu_
       << std::endl;
   // TODO (apanicke): Add supported features as well as media keys
@@ -222,7 +222,7 @@ class Device {
       uint16_t curr_player, std::vector<MediaPlayerInfo> players);
   virtual void GetVFSListResponse(uint8_t label,
                                   std::shared_ptr<GetFolderItemsRequest> pkt,
-                                  std::vector<ListItem> items);
+                                  const std::vector<ListItem>& items);
   virtual void GetNowPlayingListResponse(
       uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
       std::string curr_song_id, std::vector<SongInfo> song_list);
@@ -232,8 +232,8 @@ class Device {
       uint8_t label, std::shared_ptr<GetTotalNumberOfItemsRequest> pkt);
   virtual void GetTotalNumberOfItemsMediaPlayersResponse(
       uint8_t label, uint16_t curr_player, std::vector<MediaPlayerInfo> list);
-  virtual void GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                                std::vector<ListItem> items);
+  virtual void GetTotalNumberOfItemsVFSResponse(
+      uint8_t label, const std::vector<ListItem>& items);
   virtual void GetTotalNumberOfItemsNowPlayingResponse(
       uint8_t label, std::string curr_song_id, std::vector<SongInfo> song_list);
 
@@ -245,7 +245,7 @@ class Device {
       std::string curr_media_id, std::vector<SongInfo> song_list);
   virtual void GetItemAttributesVFSResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::vector<ListItem> item_list);
+      const std::vector<ListItem>& item_list);
 
   // SET BROWSED PLAYER
   virtual void HandleSetBrowsedPlayer(
@@ -259,7 +259,7 @@ class Device {
                                 std::shared_ptr<ChangePathRequest> request);
   virtual void ChangePathResponse(uint8_t label,
                                   std::shared_ptr<ChangePathRequest> request,
-                                  std::vector<ListItem> list);
+                                  const std::vector<ListItem>& list);
 
   // PLAY ITEM
   virtual void HandlePlayItem(uint8_t label,
@@ -321,6 +321,22 @@ class Device {
     return current_path_.top();
   }
 
+  using FolderListingCallback =
+      base::Callback<void(const std::vector<ListItem>&)>;
+
+  // Runs |cb| with the items of the current folder on the browsed player. The
+  // folder is only fetched from the media interface if it is not cached yet,
+  // so that a remote paging through a large folder does not pull the whole
+  // folder again for every window it asks for.
+  void GetCurrentFolderListing(FolderListingCallback cb);
+  void CurrentFolderListingReceived(uint32_t generation,
+                                    FolderListingCallback cb,
+                                    std::vector<ListItem> items);
+
+  // Drops the cached folder listing. Called whenever the browsed player, the
+  // current folder or the UIDs of the browsed player change.
+  void InvalidateFolderListing();
+
   void send_message(uint8_t label, bool browse,
                     std::unique_ptr<::bluetooth::PacketBuilder> message) {
     active_labels_.erase(label);
@@ -345,6 +361,12 @@ class Device {
 
   std::stack<std::string> current_path_;
 
+  // Cached listing of the current folder. A listing is only kept if no
+  // invalidation happened while it was being fetched.
+  bool folder_listing_valid_ = false;
+  uint32_t folder_listing_generation_ = 0;
+  std::vector<ListItem> folder_listing_;
+
   // Notification Trackers
   using Notification = std::pair<bool, uint8_t>;
   Notification track_changed_ = Notification(false, 0);
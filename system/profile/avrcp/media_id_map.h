@@ -16,7 +16,10 @@
 
 #pragma once
 
-#include <map>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace bluetooth {
 namespace avrcp {
@@ -24,6 +27,10 @@ namespace avrcp {
 // A helper class to convert Media ID's (represented as strings) that are
 // received from the AVRCP Media Interface layer into UID's to be used
 // with connected devices.
+//
+// UID's are handed out sequentially starting at 1, so the reverse lookup is
+// an index into a vector that refers to the strings held by the hash map
+// rather than a second copy of every Media ID.
 class MediaIdMap {
  public:
   void clear() {
@@ -31,32 +38,32 @@ class MediaIdMap {
     uid_to_media_id_.clear();
   }
 
-  std::string get_media_id(uint64_t uid) {
-    const auto& uid_it = uid_to_media_id_.find(uid);
-    if (uid_it == uid_to_media_id_.end()) return "";
-    return uid_it->second;
+  size_t size() const { return uid_to_media_id_.size(); }
+
+  std::string get_media_id(uint64_t uid) const {
+    if (uid == 0 || uid > uid_to_media_id_.size()) return "";
+    return *uid_to_media_id_[uid - 1];
   }
 
-  uint64_t get_uid(std::string media_id) {
+  uint64_t get_uid(const std::string& media_id) const {
     const auto& media_id_it = media_id_to_uid_.find(media_id);
     if (media_id_it == media_id_to_uid_.end()) return 0;
     return media_id_it->second;
   }
 
-  uint64_t insert(std::string media_id) {
-    if (media_id_to_uid_.find(media_id) != media_id_to_uid_.end()) {
-      return media_id_to_uid_[media_id];
-    }
+  uint64_t insert(const std::string& media_id) {
+    uint64_t uid = uid_to_media_id_.size() + 1;
+    auto result = media_id_to_uid_.emplace(media_id, uid);
+    if (!result.second) return result.first->second;
 
-    uint64_t uid = media_id_to_uid_.size() + 1;
-    media_id_to_uid_.insert(std::pair<std::string, uint64_t>(media_id, uid));
-    uid_to_media_id_.insert(std::pair<uint64_t, std::string>(uid, media_id));
+    // Keys of an unordered_map are not moved when it rehashes
+    uid_to_media_id_.push_back(&result.first->first);
     return uid;
   }
 
  private:
-  std::map<std::string, uint64_t> media_id_to_uid_;
-  std::map<uint64_t, std::string> uid_to_media_id_;
+  std::unordered_map<std::string, uint64_t> media_id_to_uid_;
+  std::vector<const std::string*> uid_to_media_id_;
 };
 
 }  // namespace avrcp
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/functional/bind.h>
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "avrcp_packet.h"
+#include "avrcp_test_helper.h"
+#include "device.h"
+#include "stack_config.h"
+#include "tests/packet_test_helper.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace avrcp {
+
+namespace {
+
+using ::testing::_;
+using ::testing::NiceMock;
+
+constexpr int kWindowSize = 20;
+
+bool get_pts_avrcp_test(void) { return false; }
+
+const stack_config_t interface = {nullptr, get_pts_avrcp_test,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr};
+
+void CountResponse(int* responses, uint8_t label, bool browse,
+                   AvrcpResponse response) {
+  (*responses)++;
+}
+
+}  // namespace
+
+// Pages through the VFS root folder of a synthetic library of state.range(0)
+// songs, kWindowSize items at a time, the way a head unit fills its list. Each
+// iteration is a new connection, so the folder is fetched from the media
+// interface at least once per pass.
+void BM_AvrcpGetFolderItemsPaging(State& state) {
+  const int num_items = state.range(0);
+  std::vector<ListItem> list;
+  for (int i = 0; i < num_items; i++) {
+    SongInfo song = {
+        "song_" + std::to_string(i),
+        {AttributeEntry(Attribute::TITLE, "Song " + std::to_string(i)),
+         AttributeEntry(Attribute::ARTIST_NAME, "Test Artist"),
+         AttributeEntry(Attribute::ALBUM_NAME, "Test Album")}};
+    list.push_back({ListItem::SONG, FolderInfo(), song});
+  }
+
+  NiceMock<MockMediaInterface> media_interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+  int fetches = 0;
+  ON_CALL(media_interface, GetFolderItems(_, "", _))
+      .WillByDefault([&list, &fetches](uint16_t, std::string,
+                                       MediaInterface::FolderItemsCallback cb) {
+        fetches++;
+        cb.Run(list);
+      });
+
+  std::vector<std::shared_ptr<TestBrowsePacket>> requests;
+  for (int i = 0; i < num_items; i += kWindowSize) {
+    auto request = TestBrowsePacket::Make();
+    GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, i,
+                                              i + kWindowSize - 1, {})
+        ->Serialize(request);
+    requests.push_back(request);
+  }
+
+  int responses = 0;
+  for (auto _ : state) {
+    Device device(RawAddress::kAny, true,
+                  base::Bind(&CountResponse, &responses), 0xFFFF, 0xFFFF);
+    device.RegisterInterfaces(&media_interface, &a2dp_interface, nullptr,
+                              nullptr);
+    for (const auto& request : requests) {
+      device.BrowseMessageReceived(1, request);
+    }
+  }
+
+  if (responses != (int)(state.iterations() * requests.size())) {
+    state.SkipWithError("A window got no response");
+  }
+  state.SetItemsProcessed(state.iterations() * num_items);
+  state.counters["windows"] = requests.size();
+  state.counters["fetches"] =
+      ::benchmark::Counter(fetches, ::benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_AvrcpGetFolderItemsPaging)->Arg(1000)->Arg(10000)->Arg(50000);
+
+}  // namespace avrcp
+}  // namespace bluetooth
+
+const stack_config_t* stack_config_get_interface(void) {
+  return &bluetooth::avrcp::interface;
+}
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
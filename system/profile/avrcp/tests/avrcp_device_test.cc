@@ -1046,6 +1046,93 @@ TEST_F(AvrcpDeviceTest, getFolderItemsMtuTest) {
       1, TestBrowsePacket::Make(get_folder_items_request_vfs));
 }
 
+TEST_F(AvrcpDeviceTest, getFolderItemsCachedTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr,
+                                  nullptr);
+
+  std::vector<ListItem> list;
+  for (int i = 0; i < 4; i++) {
+    std::string id = "test_id" + std::to_string(i);
+    std::string name = "Test Folder" + std::to_string(i);
+    list.push_back({ListItem::FOLDER, {id, true, name}, SongInfo()});
+  }
+
+  // Both windows and the item count come from a single fetch
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(1)
+      .WillOnce(InvokeCb<2>(list));
+
+  auto first_window = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  first_window->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  first_window->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb, Call(1, true, matchPacket(std::move(first_window))))
+      .Times(1);
+  auto request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 0, 1, {})
+      ->Serialize(request);
+  SendBrowseMessage(1, request);
+
+  auto second_window = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  second_window->AddFolder(FolderItem(3, 0, true, "Test Folder2"));
+  second_window->AddFolder(FolderItem(4, 0, true, "Test Folder3"));
+  EXPECT_CALL(response_cb, Call(2, true, matchPacket(std::move(second_window))))
+      .Times(1);
+  request = TestBrowsePacket::Make();
+  GetFolderItemsRequestBuilder::MakeBuilder(Scope::VFS, 2, 3, {})
+      ->Serialize(request);
+  SendBrowseMessage(2, request);
+
+  auto total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, list.size());
+  EXPECT_CALL(response_cb, Call(3, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      3, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+}
+
+TEST_F(AvrcpDeviceTest, getFolderItemsUidsChangedTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr,
+                                  nullptr);
+
+  std::vector<ListItem> list0 = {
+      {ListItem::FOLDER, {"test_id0", true, "Test Folder0"}, SongInfo()}};
+  std::vector<ListItem> list1 = {
+      {ListItem::FOLDER, {"test_id0", true, "Test Folder0"}, SongInfo()},
+      {ListItem::FOLDER, {"test_id1", true, "Test Folder1"}, SongInfo()}};
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(2)
+      .WillOnce(InvokeCb<2>(list0))
+      .WillOnce(InvokeCb<2>(list1));
+
+  auto response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0, list0.size());
+  EXPECT_CALL(response_cb, Call(1, true, matchPacket(std::move(response))))
+      .Times(1);
+  SendBrowseMessage(
+      1, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+
+  // The folder contents changed so the listing has to be fetched again. The
+  // UID of the item that was already known is kept.
+  test_device->SendFolderUpdate(false, false, true);
+
+  auto folder_items_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+      Status::NO_ERROR, 0x0000, 0xFFFF);
+  folder_items_response->AddFolder(FolderItem(1, 0, true, "Test Folder0"));
+  folder_items_response->AddFolder(FolderItem(2, 0, true, "Test Folder1"));
+  EXPECT_CALL(response_cb,
+              Call(2, true, matchPacket(std::move(folder_items_response))))
+      .Times(1);
+  SendBrowseMessage(2, TestBrowsePacket::Make(get_folder_items_request_vfs));
+}
+
 TEST_F(AvrcpDeviceTest, changePathTest) {
   MockMediaInterface interface;
   NiceMock<MockA2dpInterface> a2dp_interface;
@@ -1069,8 +1156,10 @@ TEST_F(AvrcpDeviceTest, changePathTest) {
   ListItem item3 = {ListItem::FOLDER, info3, SongInfo()};
   ListItem item4 = {ListItem::FOLDER, info4, SongInfo()};
   std::vector<ListItem> list1 = {item2, item3, item4};
+  // Fetched when changing into the folder and when changing back up into it.
+  // The GetFolderItems request in between is served from the cached listing.
   EXPECT_CALL(interface, GetFolderItems(_, "test_id1", _))
-      .Times(3)
+      .Times(2)
       .WillRepeatedly(InvokeCb<2>(list1));
 
   std::vector<ListItem> list2 = {};
@@ -25,6 +25,7 @@
 #include <string.h>
 
 #include "a2dp_aac.h"
+#include "a2dp_rate_controller.h"
 #include "common/time_util.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
@@ -38,6 +39,10 @@
 // A2DP AAC encoder interval in milliseconds
 #define A2DP_AAC_ENCODER_INTERVAL_MS 20
 
+// Lowest bit rate and bit rate step of the adaptive bit rate (in bps)
+#define A2DP_AAC_ADAPTIVE_MIN_BITRATE 128000
+#define A2DP_AAC_ADAPTIVE_BITRATE_STEP 32000
+
 // offset
 #if (BTA_AV_CO_CP_SCMS_T == TRUE)
 #define A2DP_AAC_OFFSET (AVDT_MEDIA_OFFSET + 1)
@@ -87,11 +92,14 @@ typedef struct {
   tA2DP_FEEDING_PARAMS feeding_params;
   tA2DP_AAC_ENCODER_PARAMS aac_encoder_params;
   tA2DP_AAC_FEEDING_STATE aac_feeding_state;
+  size_t TxQueueLength;
+  uint64_t TxQueueDelayUs;
 
   a2dp_aac_encoder_stats_t stats;
 } tA2DP_AAC_ENCODER_CB;
 
 static tA2DP_AAC_ENCODER_CB a2dp_aac_encoder_cb;
+static A2dpRateController a2dp_aac_rate_controller;
 
 static uint32_t a2dp_aac_encoder_interval_ms = A2DP_AAC_ENCODER_INTERVAL_MS;
 
@@ -106,6 +114,7 @@ static void a2dp_aac_encode_frames(uint8_t nb_frame);
 static bool a2dp_aac_read_feeding(uint8_t* read_buffer, uint32_t* bytes_read);
 static uint16_t adjust_effective_mtu(
     const tA2DP_ENCODER_INIT_PEER_PARAMS& peer_params);
+static void a2dp_aac_set_bitrate(uint32_t bit_rate);
 
 bool A2DP_LoadEncoderAac(void) {
   // Nothing to do - the library is statically linked
@@ -126,6 +135,7 @@ void a2dp_aac_encoder_init(const tA2DP_ENCODER_INIT_PEER_PARAMS* p_peer_params,
   if (a2dp_aac_encoder_cb.has_aac_handle)
     aacEncClose(&a2dp_aac_encoder_cb.aac_handle);
   memset(&a2dp_aac_encoder_cb, 0, sizeof(a2dp_aac_encoder_cb));
+  a2dp_aac_rate_controller.Reset(0, 0, 0);
 
   a2dp_aac_encoder_cb.stats.session_start_us =
       bluetooth::common::time_get_os_boottime_us();
@@ -159,7 +169,7 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config,
       &a2dp_aac_encoder_cb.aac_encoder_params;
   uint8_t codec_info[AVDT_CODEC_SIZE];
   AACENC_ERROR aac_error;
-  int aac_param_value, aac_sampling_freq, aac_peak_bit_rate;
+  int aac_param_value, aac_sampling_freq, aac_bit_rate, aac_peak_bit_rate;
 
   *p_restart_input = false;
   *p_restart_output = false;
@@ -306,6 +316,7 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config,
         __func__, aac_param_value, aac_error);
     return;  // TODO: Return an error?
   }
+  aac_bit_rate = aac_param_value;  // Save for extra usage below
 
   // Set the encoder's parameters: PEAK Bit Rate
   aac_error = aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle,
@@ -399,6 +410,15 @@ static void a2dp_aac_encoder_update(A2dpCodecConfig* a2dp_codec_config,
     return;  // TODO: Return an error?
   }
 
+  // The adaptive bit rate only drives the constant bit rate mode: the
+  // variable modes ignore AACENC_BITRATE.
+  if (aac_param_value == A2DP_AAC_VARIABLE_BIT_RATE_DISABLED) {
+    a2dp_aac_rate_controller.Reset(A2DP_AAC_ADAPTIVE_MIN_BITRATE, aac_bit_rate,
+                                   A2DP_AAC_ADAPTIVE_BITRATE_STEP);
+    a2dp_aac_rate_controller.RecordBitrate(
+        bluetooth::common::time_get_os_boottime_us(), aac_bit_rate);
+  }
+
   // Mark the end of setting the encoder's parameters
   aac_error =
       aacEncEncode(a2dp_aac_encoder_cb.aac_handle, NULL, NULL, NULL, NULL);
@@ -434,6 +454,7 @@ void a2dp_aac_encoder_cleanup(void) {
   if (a2dp_aac_encoder_cb.has_aac_handle)
     aacEncClose(&a2dp_aac_encoder_cb.aac_handle);
   memset(&a2dp_aac_encoder_cb, 0, sizeof(a2dp_aac_encoder_cb));
+  a2dp_aac_rate_controller.Reset(0, 0, 0);
 }
 
 void a2dp_aac_feeding_reset(void) {
@@ -486,6 +507,11 @@ void a2dp_aac_send_frames(uint64_t timestamp_us) {
   uint8_t nb_frame = 0;
   uint8_t nb_iterations = 0;
 
+  if (a2dp_aac_rate_controller.Update(a2dp_aac_encoder_cb.TxQueueLength,
+                                      a2dp_aac_encoder_cb.TxQueueDelayUs)) {
+    a2dp_aac_set_bitrate(a2dp_aac_rate_controller.Rate());
+  }
+
   a2dp_aac_get_num_frame_iteration(&nb_iterations, &nb_frame, timestamp_us);
   LOG_VERBOSE("%s: Sending %d frames per iteration, %d iterations", __func__,
               nb_frame, nb_iterations);
@@ -497,6 +523,34 @@ void a2dp_aac_send_frames(uint64_t timestamp_us) {
   }
 }
 
+void a2dp_aac_set_transmit_queue_length(size_t transmit_queue_length) {
+  a2dp_aac_encoder_cb.TxQueueLength = transmit_queue_length;
+}
+
+void a2dp_aac_set_transmit_queue_delay(uint64_t transmit_queue_delay_us) {
+  a2dp_aac_encoder_cb.TxQueueDelayUs = transmit_queue_delay_us;
+}
+
+// Switches the AAC encoder to |bit_rate| (in bps). The encoder applies it
+// from the next frame on.
+static void a2dp_aac_set_bitrate(uint32_t bit_rate) {
+  if (!a2dp_aac_encoder_cb.has_aac_handle) return;
+
+  AACENC_ERROR aac_error = aacEncoder_SetParam(a2dp_aac_encoder_cb.aac_handle,
+                                               AACENC_BITRATE, bit_rate);
+  if (aac_error != AACENC_OK) {
+    LOG_ERROR(
+        "%s: Cannot set AAC parameter AACENC_BITRATE to %u: "
+        "AAC error 0x%x",
+        __func__, bit_rate, aac_error);
+    return;
+  }
+  LOG_INFO("%s: bit rate %u, TX queue length %zu", __func__, bit_rate,
+           a2dp_aac_encoder_cb.TxQueueLength);
+  a2dp_aac_rate_controller.RecordBitrate(
+      bluetooth::common::time_get_os_boottime_us(), bit_rate);
+}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
@@ -742,4 +796,7 @@ void A2dpCodecConfigAacSource::debug_codec_dump(int fd) {
           "%zu\n",
           stats->media_read_total_expected_read_bytes,
           stats->media_read_total_actual_read_bytes);
+
+  a2dp_aac_rate_controller.Dump(fd,
+                                bluetooth::common::time_get_os_boottime_us());
 }
@@ -26,6 +26,7 @@
 
 #include "a2dp_api.h"
 
+#include <base/functional/bind.h>
 #include <string.h>
 
 #include "a2dp_int.h"
@@ -36,6 +37,7 @@
 #include "osi/include/log.h"
 #include "sdpdefs.h"
 #include "stack/include/bt_types.h"
+#include "stack/include/btu.h"  // do_in_main_thread
 #include "types/bluetooth/uuid.h"
 #include "types/raw_address.h"
 
@@ -313,6 +315,14 @@ tA2DP_STATUS A2DP_FindService(uint16_t service_uuid, const RawAddress& bd_addr,
   a2dp_cb.find.service_uuid = service_uuid;
   a2dp_cb.find.p_cback = p_cback;
 
+  /* Reuse the result of an earlier search of the peer, if it was cached */
+  if (SDP_FindInDiscoveryCache(bd_addr, a2dp_cb.find.p_db)) {
+    LOG_INFO("A2DP service discovery for peer %s UUID 0x%04x: cached",
+             ADDRESS_TO_LOGGABLE_CSTR(bd_addr), service_uuid);
+    do_in_main_thread(FROM_HERE, base::BindOnce(&a2dp_sdp_cback, SDP_SUCCESS));
+    return A2DP_SUCCESS;
+  }
+
   /* perform service search */
   if (!SDP_ServiceSearchAttributeRequest(bd_addr, a2dp_cb.find.p_db,
                                          a2dp_sdp_cback)) {
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "a2dp_rate_controller.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <algorithm>
+
+void A2dpRateController::Reset(uint32_t min_rate, uint32_t max_rate,
+                               uint32_t step) {
+  min_rate_ = std::min(min_rate, max_rate);
+  max_rate_ = max_rate;
+  step_ = std::max<uint32_t>(step, 1);
+  rate_ = max_rate;
+  ticks_since_change_ = 0;
+  clear_ticks_ = 0;
+  step_downs_ = 0;
+  step_ups_ = 0;
+  timeline_.clear();
+}
+
+bool A2dpRateController::Update(size_t transmit_queue_length,
+                                uint64_t transmit_queue_delay_us) {
+  if (!IsEnabled()) return false;
+
+  if (ticks_since_change_ < kStepDownHoldoffTicks) ticks_since_change_++;
+
+  if (transmit_queue_length >= kCongestedQueueLength ||
+      transmit_queue_delay_us >= kCongestedQueueDelayUs) {
+    clear_ticks_ = 0;
+    if (rate_ == min_rate_ || ticks_since_change_ < kStepDownHoldoffTicks) {
+      return false;
+    }
+    rate_ = rate_ - min_rate_ > step_ ? rate_ - step_ : min_rate_;
+    ticks_since_change_ = 0;
+    step_downs_++;
+    return true;
+  }
+
+  if (transmit_queue_length > kClearQueueLength) {
+    // Neither congested nor keeping up: hold the current rate
+    clear_ticks_ = 0;
+    return false;
+  }
+
+  if (rate_ == max_rate_ || ++clear_ticks_ < kStepUpTicks) return false;
+  rate_ = max_rate_ - rate_ > step_ ? rate_ + step_ : max_rate_;
+  clear_ticks_ = 0;
+  ticks_since_change_ = 0;
+  step_ups_++;
+  return true;
+}
+
+void A2dpRateController::RecordBitrate(uint64_t timestamp_us,
+                                       uint32_t bitrate_bps) {
+  if (timeline_.size() == kTimelineSize) timeline_.pop_front();
+  timeline_.push_back({timestamp_us, bitrate_bps});
+}
+
+void A2dpRateController::Dump(int fd, uint64_t now_us) const {
+  if (!IsEnabled()) return;
+
+  dprintf(fd,
+          "  Adaptive bit rate adjustments (down/up)                 : %zu / "
+          "%zu\n",
+          step_downs_, step_ups_);
+  dprintf(fd, "  Adaptive bit rate timeline (ms ago: bps):");
+  for (auto it = timeline_.rbegin(); it != timeline_.rend(); ++it) {
+    dprintf(fd, " %" PRIu64 ": %u",
+            (now_us - std::min(now_us, it->timestamp_us)) / 1000,
+            it->bitrate_bps);
+  }
+  dprintf(fd, "\n");
+}
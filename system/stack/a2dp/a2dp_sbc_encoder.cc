@@ -25,6 +25,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "a2dp_rate_controller.h"
 #include "a2dp_sbc.h"
 #include "a2dp_sbc_up_sample.h"
 #include "common/time_util.h"
@@ -53,6 +54,10 @@
 /* Define the bitrate step when trying to match bitpool value */
 #define A2DP_SBC_BITRATE_STEP 5
 
+/* Bitpool step of the adaptive bit rate. It goes down to the bitpool of
+ * A2DP_SBC_NON_EDR_MAX_RATE at most. */
+#define A2DP_SBC_ADAPTIVE_BITPOOL_STEP 6
+
 /* Readability constants */
 #define A2DP_SBC_FRAME_HEADER_SIZE_BYTES 4  // A2DP Spec v1.3, 12.4, Table 12.12
 #define A2DP_SBC_SCALE_FACTOR_BITS 4        // A2DP Spec v1.3, 12.4, Table 12.13
@@ -102,11 +107,14 @@ typedef struct {
   tA2DP_FEEDING_PARAMS feeding_params;
   tA2DP_SBC_FEEDING_STATE feeding_state;
   int16_t pcmBuffer[SBC_MAX_PCM_BUFFER_SIZE];
+  size_t TxQueueLength;
+  uint64_t TxQueueDelayUs;
 
   a2dp_sbc_encoder_stats_t stats;
 } tA2DP_SBC_ENCODER_CB;
 
 static tA2DP_SBC_ENCODER_CB a2dp_sbc_encoder_cb;
+static A2dpRateController a2dp_sbc_rate_controller;
 
 static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config,
                                     bool* p_restart_input,
@@ -122,6 +130,9 @@ static uint16_t adjust_effective_mtu(
 static uint8_t calculate_max_frames_per_packet(void);
 static uint16_t a2dp_sbc_source_rate(bool is_peer_edr);
 static uint32_t a2dp_sbc_frame_length(void);
+static uint16_t a2dp_sbc_bitpool_rate(int16_t bitpool);
+static void a2dp_sbc_setup_rate_controller(int min_bitpool);
+static void a2dp_sbc_set_bitpool(int16_t bitpool);
 
 bool A2DP_LoadEncoderSbc(void) {
   // Nothing to do - the library is statically linked
@@ -137,6 +148,7 @@ void a2dp_sbc_encoder_init(const tA2DP_ENCODER_INIT_PEER_PARAMS* p_peer_params,
                            a2dp_source_read_callback_t read_callback,
                            a2dp_source_enqueue_callback_t enqueue_callback) {
   memset(&a2dp_sbc_encoder_cb, 0, sizeof(a2dp_sbc_encoder_cb));
+  a2dp_sbc_rate_controller.Reset(0, 0, 0);
 
   a2dp_sbc_encoder_cb.stats.session_start_us =
       bluetooth::common::time_get_os_boottime_us();
@@ -337,10 +349,47 @@ static void a2dp_sbc_encoder_update(A2dpCodecConfig* a2dp_codec_config,
   /* Reset the SBC encoder */
   SBC_Encoder_Init(&a2dp_sbc_encoder_cb.sbc_encoder_params);
   a2dp_sbc_encoder_cb.tx_sbc_frames = calculate_max_frames_per_packet();
+  a2dp_sbc_setup_rate_controller(min_bitpool);
+}
+
+// Lets the adaptive bit rate lower the bitpool from the one just configured
+// down to the bitpool of A2DP_SBC_NON_EDR_MAX_RATE, or |min_bitpool| if the
+// peer does not accept it.
+static void a2dp_sbc_setup_rate_controller(int min_bitpool) {
+  int16_t max_bitpool = a2dp_sbc_encoder_cb.sbc_encoder_params.s16BitPool;
+  int16_t bitpool = max_bitpool;
+  while (bitpool > min_bitpool &&
+         a2dp_sbc_bitpool_rate(bitpool) > A2DP_SBC_NON_EDR_MAX_RATE) {
+    bitpool--;
+  }
+  LOG_INFO("%s: adaptive bitpool range %d - %d", __func__, bitpool,
+           max_bitpool);
+  a2dp_sbc_rate_controller.Reset(bitpool, max_bitpool,
+                                 A2DP_SBC_ADAPTIVE_BITPOOL_STEP);
+  a2dp_sbc_rate_controller.RecordBitrate(
+      bluetooth::common::time_get_os_boottime_us(),
+      a2dp_sbc_bitpool_rate(max_bitpool) * 1000);
+}
+
+// Switches the SBC encoder to |bitpool| for the next frame. The bitpool is
+// carried in every frame header, so the encoder does not need a reset.
+static void a2dp_sbc_set_bitpool(int16_t bitpool) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+
+  p_encoder_params->s16BitPool = bitpool;
+  p_encoder_params->u16BitRate = a2dp_sbc_bitpool_rate(bitpool);
+  a2dp_sbc_encoder_cb.tx_sbc_frames = calculate_max_frames_per_packet();
+  LOG_INFO("%s: bit pool %d, bit rate %d, TX queue length %zu", __func__,
+           bitpool, p_encoder_params->u16BitRate,
+           a2dp_sbc_encoder_cb.TxQueueLength);
+  a2dp_sbc_rate_controller.RecordBitrate(
+      bluetooth::common::time_get_os_boottime_us(),
+      p_encoder_params->u16BitRate * 1000);
 }
 
 void a2dp_sbc_encoder_cleanup(void) {
   memset(&a2dp_sbc_encoder_cb, 0, sizeof(a2dp_sbc_encoder_cb));
+  a2dp_sbc_rate_controller.Reset(0, 0, 0);
 }
 
 void a2dp_sbc_feeding_reset(void) {
@@ -376,6 +425,11 @@ void a2dp_sbc_send_frames(uint64_t timestamp_us) {
   uint8_t nb_frame = 0;
   uint8_t nb_iterations = 0;
 
+  if (a2dp_sbc_rate_controller.Update(a2dp_sbc_encoder_cb.TxQueueLength,
+                                      a2dp_sbc_encoder_cb.TxQueueDelayUs)) {
+    a2dp_sbc_set_bitpool(a2dp_sbc_rate_controller.Rate());
+  }
+
   a2dp_sbc_get_num_frame_iteration(&nb_iterations, &nb_frame, timestamp_us);
   LOG_VERBOSE("%s: Sending %d frames per iteration, %d iterations", __func__,
               nb_frame, nb_iterations);
@@ -387,6 +441,14 @@ void a2dp_sbc_send_frames(uint64_t timestamp_us) {
   }
 }
 
+void a2dp_sbc_set_transmit_queue_length(size_t transmit_queue_length) {
+  a2dp_sbc_encoder_cb.TxQueueLength = transmit_queue_length;
+}
+
+void a2dp_sbc_set_transmit_queue_delay(uint64_t transmit_queue_delay_us) {
+  a2dp_sbc_encoder_cb.TxQueueDelayUs = transmit_queue_delay_us;
+}
+
 // Obtains the number of frames to send and number of iterations
 // to be used. |num_of_iterations| and |num_of_frames| parameters
 // are used as output param for returning the respective values.
@@ -868,6 +930,20 @@ static uint32_t a2dp_sbc_frame_length(void) {
   return frame_len;
 }
 
+// Returns the bit rate (in kbps) of the current SBC parameters with |bitpool|.
+static uint16_t a2dp_sbc_bitpool_rate(int16_t bitpool) {
+  SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
+  int16_t current_bitpool = p_encoder_params->s16BitPool;
+
+  p_encoder_params->s16BitPool = bitpool;
+  uint32_t frame_len = a2dp_sbc_frame_length();
+  p_encoder_params->s16BitPool = current_bitpool;
+
+  return (8 * frame_len * a2dp_sbc_encoder_cb.feeding_params.sample_rate) /
+         (p_encoder_params->s16NumOfSubBands *
+          p_encoder_params->s16NumOfBlocks * 1000);
+}
+
 uint32_t a2dp_sbc_get_bitrate() {
   SBC_ENC_PARAMS* p_encoder_params = &a2dp_sbc_encoder_cb.sbc_encoder_params;
   LOG_INFO("%s: bit rate %d ", __func__, p_encoder_params->u16BitRate);
@@ -922,4 +998,7 @@ void A2dpCodecConfigSbcSource::debug_codec_dump(int fd) {
           "%zu\n",
           stats->media_read_total_expected_frames,
           stats->media_read_total_dropped_frames);
+
+  a2dp_sbc_rate_controller.Dump(fd,
+                                bluetooth::common::time_get_os_boottime_us());
 }
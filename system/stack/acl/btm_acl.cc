@@ -2844,6 +2844,28 @@ void acl_send_data_packet_ble(const RawAddress& bd_addr, BT_HDR* p_buf) {
     return bluetooth::shim::ACL_WriteData(p_acl->hci_handle, p_buf);
 }
 
+void acl_send_data_packet_copy_br_edr(const RawAddress& bd_addr,
+                                      const BT_HDR* p_buf) {
+  tACL_CONN* p_acl = internal_.btm_bda_to_acl(bd_addr, BT_TRANSPORT_BR_EDR);
+  if (p_acl == nullptr) {
+    LOG_WARN("Acl br_edr data write for unknown device:%s",
+             ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    return;
+  }
+  bluetooth::shim::ACL_WriteDataCopy(p_acl->hci_handle, p_buf);
+}
+
+void acl_send_data_packet_copy_ble(const RawAddress& bd_addr,
+                                   const BT_HDR* p_buf) {
+  tACL_CONN* p_acl = internal_.btm_bda_to_acl(bd_addr, BT_TRANSPORT_LE);
+  if (p_acl == nullptr) {
+    LOG_WARN("Acl le data write for unknown device:%s",
+             ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    return;
+  }
+  bluetooth::shim::ACL_WriteDataCopy(p_acl->hci_handle, p_buf);
+}
+
 void acl_write_automatic_flush_timeout(const RawAddress& bd_addr,
                                        uint16_t flush_timeout_in_ticks) {
   tACL_CONN* p_acl = internal_.btm_bda_to_acl(bd_addr, BT_TRANSPORT_BR_EDR);
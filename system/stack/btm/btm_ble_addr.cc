@@ -25,6 +25,8 @@
 #include <base/functional/bind.h>
 #include <string.h>
 
+#include <vector>
+
 #include "btm_ble_int.h"
 #include "device/include/controller.h"
 #include "gap_api.h"
@@ -116,25 +118,7 @@ bool btm_ble_init_pseudo_addr(tBTM_SEC_DEV_REC* p_dev_rec,
 /* Return true if given Resolvable Privae Address |rpa| matches Identity
  * Resolving Key |irk| */
 static bool rpa_matches_irk(const RawAddress& rpa, const Octet16& irk) {
-  /* use the 3 MSB of bd address as prand */
-  uint8_t rand[3];
-  rand[0] = rpa.address[2];
-  rand[1] = rpa.address[1];
-  rand[2] = rpa.address[0];
-
-  /* generate X = E irk(R0, R1, R2) and R is random address 3 LSO */
-  Octet16 x = crypto_toolbox::aes_128(irk, &rand[0], 3);
-
-  rand[0] = rpa.address[5];
-  rand[1] = rpa.address[4];
-  rand[2] = rpa.address[3];
-
-  if (memcmp(x.data(), &rand[0], 3) == 0) {
-    // match
-    return true;
-  }
-  // not a match
-  return false;
+  return crypto_toolbox::rpa_find_irk(rpa.address, &irk, 1) == 0;
 }
 
 /** This function checks if a RPA is resolvable by the device key.
@@ -154,37 +138,31 @@ bool btm_ble_addr_resolvable(const RawAddress& rpa,
   return false;
 }
 
-/** This function match the random address to the appointed device record,
- * starting from calculating IRK. If the record index exceeds the maximum record
- * number, matching failed and send a callback. */
-static bool btm_ble_match_random_bda(void* data, void* context) {
-  tBTM_SEC_DEV_REC* p_dev_rec = static_cast<tBTM_SEC_DEV_REC*>(data);
-  RawAddress* random_bda = static_cast<RawAddress*>(context);
-
-  if (!(p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) ||
-      !(p_dev_rec->ble.key_type & BTM_LE_KEY_PID))
-    // Match fails preconditions
-    return true;
-
-  if (rpa_matches_irk(*random_bda, p_dev_rec->ble.keys.irk)) {
-    // Matched
-    return false;
-  }
-
-  // This item not a match, continue iteration
-  return true;
-}
-
 /** This function is called to resolve a random address.
  * Returns pointer to the security record of the device whom a random address is
  * matched to.
  */
 tBTM_SEC_DEV_REC* btm_ble_resolve_random_addr(const RawAddress& random_bda) {
   if (btm_cb.sec_dev_rec == nullptr) return nullptr;
-  list_node_t* n = list_foreach(btm_cb.sec_dev_rec, btm_ble_match_random_bda,
-                                (void*)&random_bda);
-  return (n == nullptr) ? (nullptr)
-                        : (static_cast<tBTM_SEC_DEV_REC*>(list_node(n)));
+
+  /* Check the address against the IRKs of all devices in one batch */
+  std::vector<tBTM_SEC_DEV_REC*> records;
+  std::vector<Octet16> irks;
+  list_node_t* end = list_end(btm_cb.sec_dev_rec);
+  for (list_node_t* node = list_begin(btm_cb.sec_dev_rec); node != end;
+       node = list_next(node)) {
+    tBTM_SEC_DEV_REC* p_dev_rec =
+        static_cast<tBTM_SEC_DEV_REC*>(list_node(node));
+    if (!(p_dev_rec->device_type & BT_DEVICE_TYPE_BLE) ||
+        !(p_dev_rec->ble.key_type & BTM_LE_KEY_PID))
+      continue;
+    records.push_back(p_dev_rec);
+    irks.push_back(p_dev_rec->ble.keys.irk);
+  }
+
+  size_t index = crypto_toolbox::rpa_find_irk(random_bda.address, irks.data(),
+                                              irks.size());
+  return (index == irks.size()) ? nullptr : records[index];
 }
 
 /*******************************************************************************
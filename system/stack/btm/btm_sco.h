@@ -25,6 +25,14 @@
 
 #define BTM_MSBC_CODE_SIZE 240
 
+/* Used by PLC */
+#define BTM_MSBC_FS 120 /* Frame Size */
+
+#define BTM_PLC_WL 256 /* 16ms - Window Length for pattern matching */
+#define BTM_PLC_TL 64  /* 4ms - Template Length for matching */
+#define BTM_PLC_HL \
+  (BTM_PLC_WL + BTM_MSBC_FS - 1) /* Length of History buffer required */
+
 constexpr uint16_t kMaxScoLinks = static_cast<uint16_t>(BTM_MAX_SCO_LINKS);
 
 /* SCO-over-HCI audio related definitions */
@@ -110,6 +118,16 @@ size_t encode(int16_t* data, size_t len);
  */
 size_t dequeue_packet(const uint8_t** output);
 
+/* Find the substitution samples of a lost frame in the sample history.
+ * Args:
+ *    hist - The last BTM_PLC_HL samples received.
+ * Returns:
+ *    The offset in the history whose following BTM_PLC_TL samples have the
+ *    highest normalized cross correlation with the last BTM_PLC_TL samples of
+ *    the history, between 0 and BTM_PLC_WL - 1.
+ */
+int plc_pattern_match(const int16_t* hist);
+
 }  // namespace bluetooth::audio::sco::wbs
 
 #ifndef CASE_RETURN_TEXT
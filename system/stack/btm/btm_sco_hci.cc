@@ -47,12 +47,7 @@
 
 /* Used by PLC */
 #define BTM_MSBC_SAMPLE_SIZE 2 /* 2 bytes*/
-#define BTM_MSBC_FS 120        /* Frame Size */
 
-#define BTM_PLC_WL 256 /* 16ms - Window Length for pattern matching */
-#define BTM_PLC_TL 64  /* 4ms - Template Length for matching */
-#define BTM_PLC_HL \
-  (BTM_PLC_WL + BTM_MSBC_FS - 1) /* Length of History buffer required */
 #define BTM_PLC_SBCRL 36         /* SBC Reconvergence sample Length */
 #define BTM_PLC_OLAL 16          /* OverLap-Add Length */
 
@@ -200,6 +195,42 @@ struct tBTM_MSBC_BTM_PLC_WINDOW {
   }
 };
 
+/* Returns the dot product of BTM_PLC_TL samples. The products are summed as
+ * integers so the loop vectorizes and the result is exact. */
+static int64_t plc_dot_product(const int16_t* x, const int16_t* y) {
+  int64_t sum = 0;
+  for (int i = 0; i < BTM_PLC_TL; i++) sum += (int32_t)x[i] * y[i];
+  return sum;
+}
+
+/* The energy of the template is constant over the search and the energy of
+ * the candidate is updated incrementally as the window slides, so only the
+ * dot product is computed in full for each offset. */
+int plc_pattern_match(const int16_t* hist) {
+  const int16_t* x = &hist[BTM_PLC_HL - BTM_PLC_TL];
+  int best = 0;
+  float cn, max_cn = FLT_MIN;
+
+  int64_t x2 = plc_dot_product(x, x);
+  int64_t y2 = plc_dot_product(hist, hist);
+  if (x2 == 0) return best;
+
+  for (int i = 0; i < BTM_PLC_WL; i++) {
+    if (i > 0) {
+      y2 += (int32_t)hist[i + BTM_PLC_TL - 1] * hist[i + BTM_PLC_TL - 1] -
+            (int32_t)hist[i - 1] * hist[i - 1];
+    }
+    if (y2 == 0) continue;
+
+    cn = plc_dot_product(x, &hist[i]) / sqrtf((float)x2 * (float)y2);
+    if (cn > max_cn) {
+      best = i;
+      max_cn = cn;
+    }
+  }
+  return best;
+}
+
 /* The PLC is specifically designed for mSBC. The algorithm searches the
  * history of receiving samples to find the best match samples and constructs
  * substitutions for the lost samples. The selection is based on pattern
@@ -238,31 +269,6 @@ struct tBTM_MSBC_PLC {
     }
   }
 
-  float cross_correlation(int16_t* x, int16_t* y) {
-    float sum = 0, x2 = 0, y2 = 0;
-
-    for (int i = 0; i < BTM_PLC_TL; i++) {
-      sum += ((float)x[i]) * y[i];
-      x2 += ((float)x[i]) * x[i];
-      y2 += ((float)y[i]) * y[i];
-    }
-    return sum / sqrtf(x2 * y2);
-  }
-
-  int pattern_match(int16_t* hist) {
-    int best = 0;
-    float cn, max_cn = FLT_MIN;
-
-    for (int i = 0; i < BTM_PLC_WL; i++) {
-      cn = cross_correlation(&hist[BTM_PLC_HL - BTM_PLC_TL], &hist[i]);
-      if (cn > max_cn) {
-        best = i;
-        max_cn = cn;
-      }
-    }
-    return best;
-  }
-
   float amplitude_match(int16_t* x, int16_t* y) {
     uint32_t sum_x = 0, sum_y = 0;
     float scaler;
@@ -310,7 +316,7 @@ struct tBTM_MSBC_PLC {
     if (!pl_window->is_packet_loss_too_high()) {
       if (handled_bad_frames == 0) {
         /* Finds the best matching samples and amplitude */
-        best_lag = pattern_match(hist) + BTM_PLC_TL;
+        best_lag = plc_pattern_match(hist) + BTM_PLC_TL;
         best_match_hist = &hist[best_lag];
         scaler =
             amplitude_match(&hist[BTM_PLC_HL - BTM_MSBC_FS], best_match_hist);
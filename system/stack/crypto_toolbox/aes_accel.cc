@@ -0,0 +1,184 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* AES-128 encryption using the AES instructions of x86 (AES-NI) and ARMv8
+ * (Cryptography Extension) CPUs.
+ *
+ * The keys are expanded on the fly, one round ahead of the encryption, which
+ * suits callers that use every key only once such as resolving a private
+ * address against all known IRKs. Up to kLanes keys are processed together so
+ * that the rounds of independent blocks overlap in the CPU pipeline.
+ */
+
+#include "stack/crypto_toolbox/aes_accel.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <wmmintrin.h>
+#define AES_ACCEL_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_AES
+#define HWCAP_AES (1 << 3)
+#endif
+#define AES_ACCEL_ARM
+#endif
+
+namespace crypto_toolbox {
+
+namespace {
+
+constexpr size_t kLanes = 4;
+
+#if defined(AES_ACCEL_X86)
+
+#define AES_ACCEL_TARGET __attribute__((target("aes,sse2")))
+
+AES_ACCEL_TARGET inline __m128i expand_key_round(__m128i key, __m128i assist) {
+  assist = _mm_shuffle_epi32(assist, 0xff);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, assist);
+}
+
+/* The round constant of aeskeygenassist must be an immediate */
+#define AES_ACCEL_ROUND(rcon)                                           \
+  for (size_t i = 0; i < n; i++) {                                      \
+    key[i] = expand_key_round(key[i],                                   \
+                              _mm_aeskeygenassist_si128(key[i], rcon)); \
+    state[i] = _mm_aesenc_si128(state[i], key[i]);                      \
+  }
+
+AES_ACCEL_TARGET void encrypt_lanes(const uint8_t (*keys)[16], size_t n,
+                                    const uint8_t* in, uint8_t (*out)[16]) {
+  __m128i key[kLanes];
+  __m128i state[kLanes];
+  __m128i block = _mm_loadu_si128((const __m128i*)in);
+
+  for (size_t i = 0; i < n; i++) {
+    key[i] = _mm_loadu_si128((const __m128i*)keys[i]);
+    state[i] = _mm_xor_si128(block, key[i]);
+  }
+  AES_ACCEL_ROUND(0x01);
+  AES_ACCEL_ROUND(0x02);
+  AES_ACCEL_ROUND(0x04);
+  AES_ACCEL_ROUND(0x08);
+  AES_ACCEL_ROUND(0x10);
+  AES_ACCEL_ROUND(0x20);
+  AES_ACCEL_ROUND(0x40);
+  AES_ACCEL_ROUND(0x80);
+  AES_ACCEL_ROUND(0x1b);
+  for (size_t i = 0; i < n; i++) {
+    key[i] = expand_key_round(key[i], _mm_aeskeygenassist_si128(key[i], 0x36));
+    state[i] = _mm_aesenclast_si128(state[i], key[i]);
+    _mm_storeu_si128((__m128i*)out[i], state[i]);
+  }
+}
+
+#undef AES_ACCEL_ROUND
+
+bool cpu_supports_aes() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+  return (ecx & bit_AES) && (edx & bit_SSE2);
+}
+
+#elif defined(AES_ACCEL_ARM)
+
+/* The Cryptography Extension is optional in ARMv8.0 so the baseline build does
+ * not enable it, only the functions that cpu_supports_aes() guards. */
+#if defined(__clang__)
+#define AES_ACCEL_TARGET __attribute__((target("aes")))
+#else
+#define AES_ACCEL_TARGET __attribute__((target("+crypto")))
+#endif
+
+constexpr uint8_t kRcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10,
+                               0x20, 0x40, 0x80, 0x1b, 0x36};
+
+/* AESE with a zero round key is SubBytes(ShiftRows(x)). ShiftRows has no
+ * effect when all four columns hold the same word. */
+AES_ACCEL_TARGET inline uint32_t sub_word(uint32_t word) {
+  uint8x16_t v = vreinterpretq_u8_u32(vdupq_n_u32(word));
+  v = vaeseq_u8(v, vdupq_n_u8(0));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(v), 0);
+}
+
+/* The words are loaded little endian, so RotWord is a rotation right by one
+ * byte and the round constant goes into the lowest byte. */
+AES_ACCEL_TARGET inline uint32x4_t expand_key_round(uint32x4_t key,
+                                                    uint8_t rcon) {
+  uint32_t w3 = vgetq_lane_u32(key, 3);
+  uint32_t t = sub_word((w3 >> 8) | (w3 << 24)) ^ rcon;
+  uint32_t w0 = vgetq_lane_u32(key, 0) ^ t;
+  uint32_t w1 = vgetq_lane_u32(key, 1) ^ w0;
+  uint32_t w2 = vgetq_lane_u32(key, 2) ^ w1;
+  uint32_t words[4] = {w0, w1, w2, w3 ^ w2};
+  return vld1q_u32(words);
+}
+
+AES_ACCEL_TARGET void encrypt_lanes(const uint8_t (*keys)[16], size_t n,
+                                    const uint8_t* in, uint8_t (*out)[16]) {
+  uint32x4_t key[kLanes];
+  uint8x16_t state[kLanes];
+  uint8x16_t block = vld1q_u8(in);
+
+  for (size_t i = 0; i < n; i++) {
+    key[i] = vreinterpretq_u32_u8(vld1q_u8(keys[i]));
+    state[i] = block;
+  }
+  for (size_t round = 0; round < 9; round++) {
+    for (size_t i = 0; i < n; i++) {
+      state[i] = vaesmcq_u8(vaeseq_u8(state[i], vreinterpretq_u8_u32(key[i])));
+      key[i] = expand_key_round(key[i], kRcon[round]);
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    state[i] = vaeseq_u8(state[i], vreinterpretq_u8_u32(key[i]));
+    key[i] = expand_key_round(key[i], kRcon[9]);
+    vst1q_u8(out[i], veorq_u8(state[i], vreinterpretq_u8_u32(key[i])));
+  }
+}
+
+bool cpu_supports_aes() { return getauxval(AT_HWCAP) & HWCAP_AES; }
+
+#else
+
+void encrypt_lanes(const uint8_t (*keys)[16], size_t n, const uint8_t* in,
+                   uint8_t (*out)[16]) {}
+
+bool cpu_supports_aes() { return false; }
+
+#endif
+
+}  // namespace
+
+bool aes_accel_supported() {
+  static const bool supported = cpu_supports_aes();
+  return supported;
+}
+
+void aes_accel_encrypt_multi_key(const uint8_t (*keys)[16], size_t num_keys,
+                                 const uint8_t* in, uint8_t (*out)[16]) {
+  for (size_t i = 0; i < num_keys; i += kLanes) {
+    size_t n = num_keys - i < kLanes ? num_keys - i : kLanes;
+    encrypt_lanes(&keys[i], n, in, &out[i]);
+  }
+}
+
+}  // namespace crypto_toolbox
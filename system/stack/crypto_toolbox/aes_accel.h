@@ -0,0 +1,34 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crypto_toolbox {
+
+/* Returns true if the CPU has AES instructions aes_accel_encrypt_multi_key()
+ * can use. The result is computed once. */
+bool aes_accel_supported();
+
+/* Encrypts the block |in| with each of the |num_keys| AES-128 keys in |keys|
+ * and stores the results in |out|. Keys and blocks are in the byte order of
+ * FIPS-197. Must only be called if aes_accel_supported() returned true. */
+void aes_accel_encrypt_multi_key(const uint8_t (*keys)[16], size_t num_keys,
+                                 const uint8_t* in, uint8_t (*out)[16]);
+
+}  // namespace crypto_toolbox
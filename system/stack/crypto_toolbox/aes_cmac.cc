@@ -25,8 +25,11 @@
 #include <base/logging.h>
 #include <base/strings/string_number_conversions.h>
 
+#include <algorithm>
+
 #include "check.h"
 #include "stack/crypto_toolbox/aes.h"
+#include "stack/crypto_toolbox/aes_accel.h"
 #include "stack/crypto_toolbox/crypto_toolbox.h"
 #include "stack/include/bt_octets.h"
 
@@ -62,19 +65,44 @@ static void xor_128(Octet16* a, const Octet16& b) {
 
 /* This function computes AES_128(key, message) */
 Octet16 aes_128(const Octet16& key, const Octet16& message) {
-  Octet16 key_reversed;
-  Octet16 message_reversed;
   Octet16 output;
+  aes_128_multi_key(&key, 1, message, &output);
+  return output;
+}
 
-  std::reverse_copy(key.begin(), key.end(), key_reversed.begin());
+void aes_128_multi_key(const Octet16* keys, size_t num_keys,
+                       const Octet16& message, Octet16* output) {
+  /* Keys and blocks are little endian here and big endian for AES */
+  Octet16 message_reversed;
   std::reverse_copy(message.begin(), message.end(), message_reversed.begin());
 
-  aes_context ctx;
-  aes_set_key(key_reversed.data(), key_reversed.size(), &ctx);
-  aes_encrypt(message_reversed.data(), output.data(), &ctx);
-
-  std::reverse(output.begin(), output.end());
-  return output;
+  constexpr size_t kChunk = 16;
+  uint8_t keys_reversed[kChunk][OCTET16_LEN];
+  uint8_t outputs[kChunk][OCTET16_LEN];
+
+  for (size_t i = 0; i < num_keys; i += kChunk) {
+    size_t n = std::min(kChunk, num_keys - i);
+    for (size_t j = 0; j < n; j++) {
+      std::reverse_copy(keys[i + j].begin(), keys[i + j].end(),
+                        keys_reversed[j]);
+    }
+
+    if (aes_accel_supported()) {
+      aes_accel_encrypt_multi_key(keys_reversed, n, message_reversed.data(),
+                                  outputs);
+    } else {
+      aes_context ctx;
+      for (size_t j = 0; j < n; j++) {
+        aes_set_key(keys_reversed[j], OCTET16_LEN, &ctx);
+        aes_encrypt(message_reversed.data(), outputs[j], &ctx);
+      }
+    }
+
+    for (size_t j = 0; j < n; j++) {
+      std::reverse_copy(outputs[j], outputs[j] + OCTET16_LEN,
+                        output[i + j].begin());
+    }
+  }
 }
 
 /** utility function to padding the given text to be a 128 bits data. The
@@ -20,6 +20,7 @@
 #include <base/strings/string_number_conversions.h>
 
 #include <algorithm>
+#include <cstring>
 
 #include "stack/crypto_toolbox/aes.h"
 #include "stack/include/bt_octets.h"
@@ -187,4 +188,25 @@ Octet16 link_key_to_ltk(const Octet16& link_key, bool use_h7) {
   return h6(iltk, keyID_brle);
 }
 
+size_t rpa_find_irk(const uint8_t* rpa, const Octet16* irks, size_t num_irks) {
+  /* The random part of the address is encrypted with each IRK and the 3 LSB
+   * of the result are compared to the hash part. */
+  Octet16 prand{0};
+  prand[0] = rpa[2];
+  prand[1] = rpa[1];
+  prand[2] = rpa[0];
+  const uint8_t hash[3] = {rpa[5], rpa[4], rpa[3]};
+
+  constexpr size_t kChunk = 16;
+  Octet16 output[kChunk];
+  for (size_t i = 0; i < num_irks; i += kChunk) {
+    size_t n = std::min(kChunk, num_irks - i);
+    aes_128_multi_key(&irks[i], n, prand, output);
+    for (size_t j = 0; j < n; j++) {
+      if (memcmp(output[j].data(), hash, sizeof(hash)) == 0) return i + j;
+    }
+  }
+  return num_irks;
+}
+
 }  // namespace crypto_toolbox
@@ -24,6 +24,11 @@
 namespace crypto_toolbox {
 
 Octet16 aes_128(const Octet16& key, const Octet16& message);
+/* Computes AES_128 of |message| with each of the |num_keys| keys in |keys| and
+ * stores the results in |output|. Uses the AES instructions of the CPU when it
+ * has them. */
+void aes_128_multi_key(const Octet16* keys, size_t num_keys,
+                       const Octet16& message, Octet16* output);
 Octet16 aes_cmac(const Octet16& key, const uint8_t* message, uint16_t length);
 Octet16 f4(const uint8_t* u, const uint8_t* v, const Octet16& x, uint8_t z);
 void f5(const uint8_t* w, const Octet16& n1, const Octet16& n2, uint8_t* a1,
@@ -37,6 +42,11 @@ uint32_t g2(const uint8_t* u, const uint8_t* v, const Octet16& x,
 Octet16 ltk_to_link_key(const Octet16& ltk, bool use_h7);
 Octet16 link_key_to_ltk(const Octet16& link_key, bool use_h7);
 
+/* Returns the index of the first of the |num_irks| keys in |irks| that the
+ * resolvable private address |rpa| was generated with, or |num_irks| if there
+ * is none. |rpa| is 6 bytes, most significant first as in RawAddress. */
+size_t rpa_find_irk(const uint8_t* rpa, const Octet16* irks, size_t num_irks);
+
 /* This function computes AES_128(key, message). |key| must be 128bit.
  * |message| can be at most 16 bytes long, it's length in bytes is given in
  * |length| */
@@ -80,4 +80,10 @@ int a2dp_aac_get_effective_frame_size();
 // |timestamp_us| is the current timestamp (in microseconds).
 void a2dp_aac_send_frames(uint64_t timestamp_us);
 
+// Set transmit queue length for the A2DP AAC adaptive bit rate mechanism.
+void a2dp_aac_set_transmit_queue_length(size_t transmit_queue_length);
+
+// Set transmit queue delay for the A2DP AAC adaptive bit rate mechanism.
+void a2dp_aac_set_transmit_queue_delay(uint64_t transmit_queue_delay_us);
+
 #endif  // A2DP_AAC_ENCODER_H
@@ -521,6 +521,10 @@ typedef struct {
 
   // Set transmit queue length for the A2DP encoder.
   void (*set_transmit_queue_length)(size_t transmit_queue_length);
+
+  // Set the time (in microseconds) the packets in the transmit queue have
+  // been waiting for the link to take one, or 0 if the queue is empty.
+  void (*set_transmit_queue_delay)(uint64_t transmit_queue_delay_us);
 } tA2DP_ENCODER_INTERFACE;
 
 // Prototype for a callback to receive decoded audio data from a
@@ -0,0 +1,95 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//
+// Adaptive bit rate control for the A2DP Source encoders that do not come
+// with their own (SBC and AAC).
+//
+
+#ifndef A2DP_RATE_CONTROLLER_H
+#define A2DP_RATE_CONTROLLER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+
+// Picks the encoder rate from the state of the transmit path, once per media
+// tick. The rate is in the units of the encoder (e.g. SBC bitpool or AAC bits
+// per second) and moves by one step at a time between a minimum and the rate
+// the stream was configured with.
+//
+// The rate goes down as soon as the transmit queue builds up or the link
+// stops taking packets, and back up only after the link has kept up for a
+// while, so that a short burst of interference costs some quality instead of
+// a gap in the audio.
+class A2dpRateController {
+ public:
+  // The link is congested when this many packets wait to be sent...
+  static constexpr size_t kCongestedQueueLength = 4;
+  // ...or when the oldest of them has waited this long.
+  static constexpr uint64_t kCongestedQueueDelayUs = 60 * 1000;
+  // The link keeps up when no more than this many packets wait to be sent.
+  static constexpr size_t kClearQueueLength = 1;
+  // Ticks to wait after a change before stepping down again, to see the
+  // effect of the previous step.
+  static constexpr unsigned kStepDownHoldoffTicks = 5;
+  // Ticks the link must keep up before stepping up again.
+  static constexpr unsigned kStepUpTicks = 100;
+  // Number of bit rate changes kept for the dumpsys.
+  static constexpr size_t kTimelineSize = 32;
+
+  // Starts a new stream at |max_rate|. The controller never goes below
+  // |min_rate| and does nothing if |min_rate| is not below |max_rate|.
+  void Reset(uint32_t min_rate, uint32_t max_rate, uint32_t step);
+
+  // Runs one media tick. |transmit_queue_length| is the number of packets
+  // waiting to be sent and |transmit_queue_delay_us| the time they have
+  // been waiting for the link to take one.
+  // Returns true if Rate() changed.
+  bool Update(size_t transmit_queue_length, uint64_t transmit_queue_delay_us);
+
+  // The rate the encoder should run at.
+  uint32_t Rate() const { return rate_; }
+
+  // True if the rate can change at all.
+  bool IsEnabled() const { return min_rate_ < max_rate_; }
+
+  // Adds the bit rate the encoder runs at after a change to the timeline.
+  void RecordBitrate(uint64_t timestamp_us, uint32_t bitrate_bps);
+
+  // Dumps the adjustments and the timeline. |now_us| is on the clock of the
+  // timestamps given to RecordBitrate().
+  void Dump(int fd, uint64_t now_us) const;
+
+ private:
+  struct TimelineEntry {
+    uint64_t timestamp_us;
+    uint32_t bitrate_bps;
+  };
+
+  uint32_t min_rate_ = 0;
+  uint32_t max_rate_ = 0;
+  uint32_t step_ = 0;
+  uint32_t rate_ = 0;
+  unsigned ticks_since_change_ = 0;
+  unsigned clear_ticks_ = 0;
+  size_t step_downs_ = 0;
+  size_t step_ups_ = 0;
+  std::deque<TimelineEntry> timeline_;
+};
+
+#endif  // A2DP_RATE_CONTROLLER_H
@@ -36,6 +36,11 @@ bool acl_create_le_connection_with_id(uint8_t id, const RawAddress& bd_addr,
 void acl_reject_connection_request(const RawAddress& bd_addr, uint8_t reason);
 void acl_send_data_packet_br_edr(const RawAddress& bd_addr, BT_HDR* p_buf);
 void acl_send_data_packet_ble(const RawAddress& bd_addr, BT_HDR* p_buf);
+// Like the above, but the caller keeps ownership of |p_buf|
+void acl_send_data_packet_copy_br_edr(const RawAddress& bd_addr,
+                                      const BT_HDR* p_buf);
+void acl_send_data_packet_copy_ble(const RawAddress& bd_addr,
+                                   const BT_HDR* p_buf);
 void acl_write_automatic_flush_timeout(const RawAddress& bd_addr,
                                        uint16_t flush_timeout);
 
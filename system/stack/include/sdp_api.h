@@ -277,6 +277,48 @@ bool SDP_ServiceSearchAttributeRequest2(const RawAddress& p_bd_addr,
                                         tSDP_DISC_CMPL_CB2* p_cb,
                                         const void* user_data);
 
+/*******************************************************************************
+ *
+ * Function         SDP_FindInDiscoveryCache
+ *
+ * Description      This function looks for the result of an earlier service
+ *                  search attribute request to the peer with the same UUID
+ *                  and attribute filters as the database, and fills the
+ *                  database with it. Profiles call this before
+ *                  SDP_ServiceSearchAttributeRequest, and only start the
+ *                  discovery if nothing was found. Only the results of
+ *                  bonded peers are cached.
+ *
+ * Returns          true if the database was filled from the cache, else false
+ *
+ ******************************************************************************/
+bool SDP_FindInDiscoveryCache(const RawAddress& bd_addr,
+                              tSDP_DISCOVERY_DB* p_db);
+
+/*******************************************************************************
+ *
+ * Function         SDP_InvalidateDiscoveryCache
+ *
+ * Description      This function drops the cached discovery results of a
+ *                  peer, e.g. when it is unpaired or when its cached records
+ *                  turned out to be wrong.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void SDP_InvalidateDiscoveryCache(const RawAddress& bd_addr);
+
+/*******************************************************************************
+ *
+ * Function         SDP_Dumpsys
+ *
+ * Description      This function dumps the discovery cache statistics.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void SDP_Dumpsys(int fd);
+
 /* API of utilities to find data in the local discovery database */
 
 /*******************************************************************************
@@ -1379,12 +1379,22 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
  *
  * Description      Get the next SDU segment to transmit.
  *
+ *                  In ERTM mode a new I-frame is not cloned for the
+ *                  retransmission queue. Instead *p_retain is set, and the
+ *                  caller must hand the buffer back through
+ *                  l2c_fcr_retain_sent_buf() once the lower layer has copied
+ *                  it, rather than freeing it.
+ *
  * Returns          pointer to buffer with segment or NULL
  *
  ******************************************************************************/
 BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
-                                      uint16_t max_packet_length) {
+                                      uint16_t max_packet_length,
+                                      bool* p_retain) {
   CHECK(p_ccb != NULL);
+  CHECK(p_retain != NULL);
+
+  *p_retain = false;
 
   bool first_seg = false, /* The segment is the first part of data  */
       mid_seg = false,    /* The segment is the middle part of data */
@@ -1493,32 +1503,50 @@ BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
 
   prepare_I_frame(p_ccb, p_xmit, false);
 
-  if (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE) {
-    BT_HDR* p_wack =
-        l2c_fcr_clone_buf(p_xmit, HCI_DATA_PREAMBLE_SIZE, p_xmit->len);
-
-    if (!p_wack) {
-      L2CAP_TRACE_ERROR(
-          "L2CAP - no buffer for xmit cloning, CID: 0x%04x  Length: %u",
-          p_ccb->local_cid, p_xmit->len);
+  /* The frame goes to the waiting-for-ack queue once it has been sent */
+  if (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE) *p_retain = true;
 
-      /* We will not save the FCS in case we reconfigure and change options */
-      p_xmit->len -= L2CAP_FCS_LEN;
+  return (p_xmit);
+}
 
-      /* Pretend we sent it and it got lost */
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_xmit);
-      return (NULL);
-    } else {
-      /* We will not save the FCS in case we reconfigure and change options */
-      p_wack->len -= L2CAP_FCS_LEN;
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_retain_sent_buf
+ *
+ * Description      Take back an I-frame returned by
+ *                  l2c_fcr_get_next_xmit_sdu_seg() with *p_retain set, once
+ *                  its contents have been handed to the controller, and hold
+ *                  it in the waiting-for-ack queue until the peer acks it.
+ *                  The buffer is freed if its channel has gone away or is no
+ *                  longer in ERTM mode.
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+void l2c_fcr_retain_sent_buf(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+  CHECK(p_lcb != NULL);
+  CHECK(p_buf != NULL);
+  tL2C_CCB* p_ccb = NULL;
+  uint16_t cid = p_buf->event;
 
-      p_wack->layer_specific = p_xmit->layer_specific;
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_wack);
-    }
+  if (cid >= L2CAP_BASE_APPL_CID) {
+    p_ccb = l2cu_find_ccb_by_cid(p_lcb, cid);
+  } else if (cid >= L2CAP_FIRST_FIXED_CHNL && cid <= L2CAP_LAST_FIXED_CHNL) {
+    p_ccb = p_lcb->p_fixed_ccbs[cid - L2CAP_FIRST_FIXED_CHNL];
+  }
 
+  if (p_ccb == NULL || p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_ERTM_MODE) {
+    L2CAP_TRACE_WARNING("L2CAP - dropping sent I-frame, CID: 0x%04x", cid);
+    osi_free(p_buf);
+    return;
   }
 
-  return (p_xmit);
+  /* Strip the HCI header added for transmission. We will not save the FCS in
+   * case we reconfigure and change options, prepare_I_frame() adds it back */
+  p_buf->offset += HCI_DATA_PREAMBLE_SIZE;
+  p_buf->len -= HCI_DATA_PREAMBLE_SIZE + L2CAP_FCS_LEN;
+
+  fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_buf);
 }
 
 /** Get the next PDU to transmit for LE connection oriented channel. Returns
@@ -846,7 +846,9 @@ BT_HDR* l2c_fcr_clone_buf(BT_HDR* p_buf, uint16_t new_offset,
                           uint16_t no_of_bytes);
 bool l2c_fcr_is_flow_controlled(tL2C_CCB* p_ccb);
 BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
-                                      uint16_t max_packet_length);
+                                      uint16_t max_packet_length,
+                                      bool* p_retain);
+void l2c_fcr_retain_sent_buf(tL2C_LCB* p_lcb, BT_HDR* p_buf);
 void l2c_fcr_start_timer(tL2C_CCB* p_ccb);
 void l2c_lcc_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf);
 BT_HDR* l2c_lcc_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb, bool* last_piece_of_sdu);
@@ -55,8 +55,9 @@ void btm_acl_set_paging(bool value);
 void btm_ble_decrement_link_topology_mask(uint8_t link_role);
 void btm_sco_acl_removed(const RawAddress* bda);
 
-static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf);
-static BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb);
+static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                   bool retain);
+static BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb, bool* p_retain);
 
 /*******************************************************************************
  *
@@ -897,6 +898,7 @@ static bool l2c_link_check_power_mode(tL2C_LCB* p_lcb) {
 void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
                               BT_HDR* p_buf) {
   bool single_write = false;
+  bool retain = false;
 
   /* Save the channel ID for faster counting */
   if (p_buf) {
@@ -963,7 +965,7 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
         LOG_VERBOSE("Sending to lower layer");
         p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
         list_remove(p_lcb->link_xmit_data_q, p_buf);
-        l2c_link_send_to_lower(p_lcb, p_buf);
+        l2c_link_send_to_lower(p_lcb, p_buf, false);
       } else if (single_write) {
         /* If only doing one write, break out */
         LOG_DEBUG("single_write is true, skipping");
@@ -972,10 +974,10 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
       /* If nothing on the link queue, check the channel queue */
       else {
         LOG_DEBUG("Check next buffer");
-        p_buf = l2cu_get_next_buffer_to_send(p_lcb);
+        p_buf = l2cu_get_next_buffer_to_send(p_lcb, &retain);
         if (p_buf != NULL) {
           LOG_DEBUG("Sending next buffer");
-          l2c_link_send_to_lower(p_lcb, p_buf);
+          l2c_link_send_to_lower(p_lcb, p_buf, retain);
         }
       }
     }
@@ -1018,7 +1020,7 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
       LOG_VERBOSE("Sending to lower layer");
       p_buf = (BT_HDR*)list_front(p_lcb->link_xmit_data_q);
       list_remove(p_lcb->link_xmit_data_q, p_buf);
-      l2c_link_send_to_lower(p_lcb, p_buf);
+      l2c_link_send_to_lower(p_lcb, p_buf, false);
     }
 
     if (!single_write) {
@@ -1029,13 +1031,13 @@ void l2c_link_check_send_pkts(tL2C_LCB* p_lcb, uint16_t local_cid,
               (l2cb.controller_le_xmit_window != 0 &&
                (p_lcb->transport == BT_TRANSPORT_LE))) &&
              (p_lcb->sent_not_acked < p_lcb->link_xmit_quota)) {
-        p_buf = l2cu_get_next_buffer_to_send(p_lcb);
+        p_buf = l2cu_get_next_buffer_to_send(p_lcb, &retain);
         if (p_buf == NULL) {
           LOG_VERBOSE("No next buffer, skipping");
           break;
         }
         LOG_VERBOSE("Sending to lower layer");
-        l2c_link_send_to_lower(p_lcb, p_buf);
+        l2c_link_send_to_lower(p_lcb, p_buf, retain);
       }
     }
 
@@ -1066,48 +1068,63 @@ void l2c_OnHciModeChangeSendPendingPackets(RawAddress remote) {
  *
  * Function         l2c_link_send_to_lower
  *
- * Description      This function queues the buffer for HCI transmission
+ * Description      This function queues the buffer for HCI transmission.
+ *                  If |retain| is set the buffer is copied out and handed
+ *                  back to FCR for retransmission instead of being freed.
  *
  ******************************************************************************/
-static void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+static void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                          bool retain) {
   const uint16_t link_xmit_quota = p_lcb->link_xmit_quota;
 
   if (link_xmit_quota == 0) {
     l2cb.round_robin_unacked++;
   }
   p_lcb->sent_not_acked++;
-  p_buf->layer_specific = 0;
   l2cb.controller_xmit_window--;
 
-  acl_send_data_packet_br_edr(p_lcb->remote_bd_addr, p_buf);
+  if (retain) {
+    acl_send_data_packet_copy_br_edr(p_lcb->remote_bd_addr, p_buf);
+    l2c_fcr_retain_sent_buf(p_lcb, p_buf);
+  } else {
+    p_buf->layer_specific = 0;
+    acl_send_data_packet_br_edr(p_lcb->remote_bd_addr, p_buf);
+  }
   LOG_VERBOSE("TotalWin=%d,Hndl=0x%x,Quota=%d,Unack=%d,RRQuota=%d,RRUnack=%d",
               l2cb.controller_xmit_window, p_lcb->Handle(),
               p_lcb->link_xmit_quota, p_lcb->sent_not_acked,
               l2cb.round_robin_quota, l2cb.round_robin_unacked);
 }
 
-static void l2c_link_send_to_lower_ble(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+static void l2c_link_send_to_lower_ble(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                       bool retain) {
   const uint16_t link_xmit_quota = p_lcb->link_xmit_quota;
 
   if (link_xmit_quota == 0) {
     l2cb.ble_round_robin_unacked++;
   }
   p_lcb->sent_not_acked++;
-  p_buf->layer_specific = 0;
   l2cb.controller_le_xmit_window--;
 
-  acl_send_data_packet_ble(p_lcb->remote_bd_addr, p_buf);
+  if (retain) {
+    acl_send_data_packet_copy_ble(p_lcb->remote_bd_addr, p_buf);
+    l2c_fcr_retain_sent_buf(p_lcb, p_buf);
+  } else {
+    p_buf->layer_specific = 0;
+    acl_send_data_packet_ble(p_lcb->remote_bd_addr, p_buf);
+  }
   LOG_DEBUG("TotalWin=%d,Hndl=0x%x,Quota=%d,Unack=%d,RRQuota=%d,RRUnack=%d",
             l2cb.controller_le_xmit_window, p_lcb->Handle(),
             p_lcb->link_xmit_quota, p_lcb->sent_not_acked,
             l2cb.ble_round_robin_quota, l2cb.ble_round_robin_unacked);
 }
 
-static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf) {
+static void l2c_link_send_to_lower(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                   bool retain) {
   if (p_lcb->transport == BT_TRANSPORT_BR_EDR) {
-    l2c_link_send_to_lower_br_edr(p_lcb, p_buf);
+    l2c_link_send_to_lower_br_edr(p_lcb, p_buf, retain);
   } else {
-    l2c_link_send_to_lower_ble(p_lcb, p_buf);
+    l2c_link_send_to_lower_ble(p_lcb, p_buf, retain);
   }
 }
 
@@ -1330,13 +1347,18 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
  * Description      get the next buffer to send on a link. It also adjusts the
  *                  CCB queue to do a basic priority and round-robin scheduling.
  *
+ *                  *p_retain is set when the buffer must be sent with
+ *                  l2c_link_send_to_lower(..., retain=true).
+ *
  * Returns          pointer to buffer or NULL
  *
  ******************************************************************************/
-BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
+BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb, bool* p_retain) {
   tL2C_CCB* p_ccb;
   BT_HDR* p_buf;
 
+  *p_retain = false;
+
   /* Highest priority are fixed channels */
   int xx;
 
@@ -1358,7 +1380,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
           continue;
       }
 
-      p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0);
+      p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0, p_retain);
       if (p_buf != NULL) {
         l2cu_check_channel_congestion(p_ccb);
         l2cu_set_acl_hci_header(p_buf, p_ccb);
@@ -1403,7 +1425,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
 
   } else {
     if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
-      p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0);
+      p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb, 0, p_retain);
       if (p_buf == NULL) return (NULL);
     } else {
       p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_ccb->xmit_hold_q);
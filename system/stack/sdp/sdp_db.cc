@@ -25,7 +25,14 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "bt_target.h"
 #include "osi/include/allocator.h"
@@ -35,61 +42,184 @@
 #include "stack/sdp/sdpint.h"
 #include "types/bluetooth/uuid.h"
 
+using bluetooth::Uuid;
+
+namespace {
+
+/* Server database record, with the state derived from its attributes */
+struct tSDP_DB_ENTRY {
+  tSDP_RECORD record;
+  /* Every UUID a service search can match in the record */
+  std::vector<Uuid> uuids;
+  /* Attribute entries of the record as sent to peers, built on first use.
+   * Entry i is encoded[encoded_offsets[i]] up to encoded[encoded_offsets[i+1]]
+   */
+  bool encoded_valid;
+  std::vector<uint8_t> encoded;
+  std::array<uint16_t, SDP_MAX_REC_ATTR + 1> encoded_offsets;
+};
+
+/* Records of the server database, in handle order */
+std::map<uint32_t, std::unique_ptr<tSDP_DB_ENTRY>> sdp_db_records;
+
+/* Handles of the records containing each UUID */
+std::unordered_map<Uuid, std::set<uint32_t>> sdp_db_uuid_index;
+
+}  // namespace
+
 /******************************************************************************/
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
-static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
-                             const uint8_t* p_his_uuid, uint16_t his_len,
-                             int nest_level);
+static void collect_uuids_in_seq(uint8_t* p, uint32_t seq_len,
+                                 int nest_level, std::vector<Uuid>* p_uuids);
+static bool add_attribute_to_record(tSDP_RECORD* p_rec, uint16_t attr_id,
+                                    uint8_t attr_type, uint32_t attr_len,
+                                    uint8_t* p_val);
+static bool delete_attribute_from_record(tSDP_RECORD* p_rec,
+                                         uint16_t attr_id);
+
+/*******************************************************************************
+ *
+ * Function         uuid_from_array
+ *
+ * Description      This function converts a BE UUID of 2, 4 or 16 bytes, as
+ *                  found in records and requests, to its 128-bit form.
+ *
+ * Returns          true if the UUID has a valid length, else false
+ *
+ ******************************************************************************/
+static bool uuid_from_array(const uint8_t* p_uuid, uint32_t len,
+                            Uuid* p_out) {
+  switch (len) {
+    case Uuid::kNumBytes16:
+      *p_out = Uuid::From16Bit((p_uuid[0] << 8) | p_uuid[1]);
+      return true;
+    case Uuid::kNumBytes32:
+      *p_out = Uuid::From32Bit((p_uuid[0] << 24) | (p_uuid[1] << 16) |
+                               (p_uuid[2] << 8) | p_uuid[3]);
+      return true;
+    case Uuid::kNumBytes128:
+      *p_out = Uuid::From128BitBE(p_uuid);
+      return true;
+    default:
+      return false;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         find_db_entry
+ *
+ * Description      This function finds the database entry holding a record.
+ *
+ * Returns          Pointer to the entry, or NULL if the record is not part of
+ *                  the database (e.g. a copy made for a single response).
+ *
+ ******************************************************************************/
+static tSDP_DB_ENTRY* find_db_entry(const tSDP_RECORD* p_rec) {
+  auto it = sdp_db_records.find(p_rec->record_handle);
+  if (it == sdp_db_records.end() || &it->second->record != p_rec) return NULL;
+  return it->second.get();
+}
+
+/*******************************************************************************
+ *
+ * Function         unindex_db_entry
+ *
+ * Description      This function removes a record from the UUID index.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void unindex_db_entry(const tSDP_DB_ENTRY& entry) {
+  for (const Uuid& uuid : entry.uuids) {
+    auto it = sdp_db_uuid_index.find(uuid);
+    if (it == sdp_db_uuid_index.end()) continue;
+    it->second.erase(entry.record.record_handle);
+    if (it->second.empty()) sdp_db_uuid_index.erase(it);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_db_record_changed
+ *
+ * Description      This function is called after the attributes of a record
+ *                  changed. It re-indexes the UUIDs of the record and drops its
+ *                  encoded attributes.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void sdp_db_record_changed(const tSDP_RECORD* p_rec) {
+  tSDP_DB_ENTRY* p_entry = find_db_entry(p_rec);
+  if (p_entry == NULL) return;
+
+  unindex_db_entry(*p_entry);
+  p_entry->uuids.clear();
+
+  /* The same attributes sdp_db_service_search used to look into */
+  const tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
+  for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
+    Uuid uuid;
+    if (p_attr->type == UUID_DESC_TYPE) {
+      if (uuid_from_array(p_attr->value_ptr, p_attr->len, &uuid))
+        p_entry->uuids.push_back(uuid);
+    } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
+      collect_uuids_in_seq(p_attr->value_ptr, p_attr->len, 0,
+                           &p_entry->uuids);
+    }
+  }
+
+  for (const Uuid& uuid : p_entry->uuids) {
+    sdp_db_uuid_index[uuid].insert(p_rec->record_handle);
+  }
+  p_entry->encoded_valid = false;
+}
 
 /*******************************************************************************
  *
  * Function         sdp_db_service_search
  *
  * Description      This function searches for a record that contains the
- *                  specified UIDs. It is passed either NULL to start at the
- *                  beginning, or the previous record found.
+ *                  specified UIDs. It is passed either 0 to start at the
+ *                  beginning, or the handle of the previous record found.
  *
  * Returns          Pointer to the record, or NULL if not found.
  *
  ******************************************************************************/
-const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
+const tSDP_RECORD* sdp_db_service_search(uint32_t prev_handle,
                                          const tSDP_UUID_SEQ* p_seq) {
-  uint16_t xx, yy;
-  const tSDP_ATTRIBUTE* p_attr;
-  tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
+  Uuid uuids[MAX_UUIDS_PER_SEQ];
+  const std::set<uint32_t>* p_candidates = NULL;
 
-  /* If NULL, start at the beginning, else start at the first specified record
-   */
-  if (!p_rec)
-    p_rec = &sdp_cb.server_db.record[0];
-  else
-    p_rec++;
+  if (p_seq->num_uids == 0) {
+    auto it = sdp_db_records.upper_bound(prev_handle);
+    return (it == sdp_db_records.end()) ? NULL : &it->second->record;
+  }
+
+  /* The spec says that a match occurs if the record contains all the passed
+   * UUIDs in it. Walk the records holding the rarest one. */
+  for (uint16_t yy = 0; yy < p_seq->num_uids; yy++) {
+    if (!uuid_from_array(p_seq->uuid_entry[yy].value,
+                         p_seq->uuid_entry[yy].len, &uuids[yy]))
+      return (NULL);
+    auto it = sdp_db_uuid_index.find(uuids[yy]);
+    if (it == sdp_db_uuid_index.end()) return (NULL);
+    if (p_candidates == NULL || it->second.size() < p_candidates->size())
+      p_candidates = &it->second;
+  }
 
-  /* Look through the records. The spec says that a match occurs if */
-  /* the record contains all the passed UUIDs in it.                */
-  for (; p_rec < p_end; p_rec++) {
+  for (auto it = p_candidates->upper_bound(prev_handle);
+       it != p_candidates->end(); it++) {
+    const tSDP_DB_ENTRY& entry = *sdp_db_records.at(*it);
+    uint16_t yy;
     for (yy = 0; yy < p_seq->num_uids; yy++) {
-      p_attr = &p_rec->attribute[0];
-      for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
-        if (p_attr->type == UUID_DESC_TYPE) {
-          if (sdpu_compare_uuid_arrays(p_attr->value_ptr, p_attr->len,
-                                       &p_seq->uuid_entry[yy].value[0],
-                                       p_seq->uuid_entry[yy].len))
-            break;
-        } else if (p_attr->type == DATA_ELE_SEQ_DESC_TYPE) {
-          if (find_uuid_in_seq(p_attr->value_ptr, p_attr->len,
-                               &p_seq->uuid_entry[yy].value[0],
-                               p_seq->uuid_entry[yy].len, 0))
-            break;
-        }
-      }
-      /* If any UUID was not found,  on to the next record */
-      if (xx == p_rec->num_attributes) break;
+      if (std::find(entry.uuids.begin(), entry.uuids.end(), uuids[yy]) ==
+          entry.uuids.end())
+        break;
     }
-
-    /* If every UUID was found in the record, return the record */
-    if (yy == p_seq->num_uids) return (p_rec);
+    if (yy == p_seq->num_uids) return (&entry.record);
   }
 
   /* If here, no more records found */
@@ -98,22 +228,22 @@ const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
 
 /*******************************************************************************
  *
- * Function         find_uuid_in_seq
+ * Function         collect_uuids_in_seq
  *
- * Description      This function searches a data element sequenct for a UUID.
+ * Description      This function collects the UUIDs of a data element
+ *                  sequence, and of the sequences nested in it.
  *
- * Returns          true if found, else false
+ * Returns          void
  *
  ******************************************************************************/
-static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
-                             const uint8_t* p_uuid, uint16_t uuid_len,
-                             int nest_level) {
+static void collect_uuids_in_seq(uint8_t* p, uint32_t seq_len,
+                                 int nest_level, std::vector<Uuid>* p_uuids) {
   uint8_t* p_end = p + seq_len;
   uint8_t type;
   uint32_t len;
 
   /* A little safety check to avoid excessive recursion */
-  if (nest_level > 3) return (false);
+  if (nest_level > 3) return;
 
   while (p < p_end) {
     type = *p++;
@@ -124,16 +254,13 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
     }
     type = type >> 3;
     if (type == UUID_DESC_TYPE) {
-      if (sdpu_compare_uuid_arrays(p, len, p_uuid, uuid_len)) return (true);
+      Uuid uuid;
+      if (uuid_from_array(p, len, &uuid)) p_uuids->push_back(uuid);
     } else if (type == DATA_ELE_SEQ_DESC_TYPE) {
-      if (find_uuid_in_seq(p, len, p_uuid, uuid_len, nest_level + 1))
-        return (true);
+      collect_uuids_in_seq(p, len, nest_level + 1, p_uuids);
     }
     p = p + len;
   }
-
-  /* If here, failed to match */
-  return (false);
 }
 
 /*******************************************************************************
@@ -147,16 +274,48 @@ static bool find_uuid_in_seq(uint8_t* p, uint32_t seq_len,
  *
  ******************************************************************************/
 tSDP_RECORD* sdp_db_find_record(uint32_t handle) {
-  tSDP_RECORD* p_rec;
-  tSDP_RECORD* p_end = &sdp_cb.server_db.record[sdp_cb.server_db.num_records];
+  auto it = sdp_db_records.find(handle);
+  if (it == sdp_db_records.end()) return (NULL);
+  return (&it->second->record);
+}
 
-  /* Look through the records for the caller's handle */
-  for (p_rec = &sdp_cb.server_db.record[0]; p_rec < p_end; p_rec++) {
-    if (p_rec->record_handle == handle) return (p_rec);
+/*******************************************************************************
+ *
+ * Function         sdp_db_get_encoded_attrs
+ *
+ * Description      This function gets the attribute entries of a record
+ *                  encoded as they are sent to peers. They are encoded once
+ *                  and kept until an attribute of the record is added or
+ *                  deleted.
+ *
+ * Returns          true if found, false if the record is not part of the
+ *                  database.
+ *
+ ******************************************************************************/
+bool sdp_db_get_encoded_attrs(const tSDP_RECORD* p_rec,
+                              tSDP_ENCODED_ATTRS* p_encoded) {
+  tSDP_DB_ENTRY* p_entry = find_db_entry(p_rec);
+  if (p_entry == NULL) return (false);
+
+  if (!p_entry->encoded_valid) {
+    uint32_t len = 0;
+    for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++)
+      len += sdpu_get_attrib_entry_len(&p_rec->attribute[xx]);
+    p_entry->encoded.resize(len);
+
+    uint8_t* p_start = p_entry->encoded.data();
+    uint8_t* p = p_start;
+    for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++) {
+      p_entry->encoded_offsets[xx] = (uint16_t)(p - p_start);
+      p = sdpu_build_attrib_entry(p, &p_rec->attribute[xx]);
+    }
+    p_entry->encoded_offsets[p_rec->num_attributes] = (uint16_t)(p - p_start);
+    p_entry->encoded_valid = true;
   }
 
-  /* Record with that handle not found. */
-  return (NULL);
+  p_encoded->p_data = p_entry->encoded.data();
+  p_encoded->p_offsets = p_entry->encoded_offsets.data();
+  return (true);
 }
 
 /*******************************************************************************
@@ -247,39 +406,31 @@ static int sdp_compose_proto_list(uint8_t* p, uint16_t num_elem,
  *                  record is created empty, teh application should then call
  *                  "add_attribute" to add the record's attributes.
  *
- * Returns          Record handle if OK, else 0.
+ * Returns          Record handle.
  *
  ******************************************************************************/
 uint32_t SDP_CreateRecord(void) {
   uint32_t handle;
   uint8_t buf[4];
-  tSDP_DB* p_db = &sdp_cb.server_db;
 
-  /* First, check if there is a free record */
-  if (p_db->num_records < SDP_MAX_RECORDS) {
-    memset(&p_db->record[p_db->num_records], 0, sizeof(tSDP_RECORD));
+  /* We will use a handle of the first unreserved handle plus last record
+  ** handle + 1 */
+  if (!sdp_db_records.empty())
+    handle = sdp_db_records.rbegin()->first + 1;
+  else
+    handle = 0x10000;
 
-    /* We will use a handle of the first unreserved handle plus last record
-    ** number + 1 */
-    if (p_db->num_records)
-      handle = p_db->record[p_db->num_records - 1].record_handle + 1;
-    else
-      handle = 0x10000;
-
-    p_db->record[p_db->num_records].record_handle = handle;
-
-    p_db->num_records++;
-    SDP_TRACE_DEBUG("SDP_CreateRecord ok, num_records:%d", p_db->num_records);
-    /* Add the first attribute (the handle) automatically */
-    UINT32_TO_BE_FIELD(buf, handle);
-    SDP_AddAttribute(handle, ATTR_ID_SERVICE_RECORD_HDL, UINT_DESC_TYPE, 4,
-                     buf);
-
-    return (p_db->record[p_db->num_records - 1].record_handle);
-  } else
-    SDP_TRACE_ERROR("SDP_CreateRecord fail, exceed maximum records:%d",
-                    SDP_MAX_RECORDS);
-  return (0);
+  auto entry = std::make_unique<tSDP_DB_ENTRY>();
+  entry->record.record_handle = handle;
+  sdp_db_records.emplace(handle, std::move(entry));
+
+  SDP_TRACE_DEBUG("SDP_CreateRecord ok, num_records:%zu",
+                  sdp_db_records.size());
+  /* Add the first attribute (the handle) automatically */
+  UINT32_TO_BE_FIELD(buf, handle);
+  SDP_AddAttribute(handle, ATTR_ID_SERVICE_RECORD_HDL, UINT_DESC_TYPE, 4, buf);
+
+  return (handle);
 }
 
 /*******************************************************************************
@@ -296,45 +447,33 @@ uint32_t SDP_CreateRecord(void) {
  *
  ******************************************************************************/
 bool SDP_DeleteRecord(uint32_t handle) {
-  uint16_t xx, yy, zz;
-  tSDP_RECORD* p_rec = &sdp_cb.server_db.record[0];
-
-  if (handle == 0 || sdp_cb.server_db.num_records == 0) {
+  if (handle == 0 || sdp_db_records.empty()) {
     /* Delete all records in the database */
-    sdp_cb.server_db.num_records = 0;
+    sdp_db_records.clear();
+    sdp_db_uuid_index.clear();
 
     /* require new DI record to be created in SDP_SetLocalDiRecord */
     sdp_cb.server_db.di_primary_handle = 0;
 
     return (true);
-  } else {
-    /* Find the record in the database */
-    for (xx = 0; xx < sdp_cb.server_db.num_records; xx++, p_rec++) {
-      if (p_rec->record_handle == handle) {
-        /* Found it. Shift everything up one */
-        for (yy = xx; yy < sdp_cb.server_db.num_records - 1; yy++, p_rec++) {
-          *p_rec = *(p_rec + 1);
-
-          /* Adjust the attribute value pointer for each attribute */
-          for (zz = 0; zz < p_rec->num_attributes; zz++)
-            p_rec->attribute[zz].value_ptr -= sizeof(tSDP_RECORD);
-        }
+  }
 
-        sdp_cb.server_db.num_records--;
+  /* Find the record in the database */
+  auto it = sdp_db_records.find(handle);
+  if (it == sdp_db_records.end()) return (false);
 
-        SDP_TRACE_DEBUG("SDP_DeleteRecord ok, num_records:%d",
-                        sdp_cb.server_db.num_records);
-        /* if we're deleting the primary DI record, clear the */
-        /* value in the control block */
-        if (sdp_cb.server_db.di_primary_handle == handle) {
-          sdp_cb.server_db.di_primary_handle = 0;
-        }
+  unindex_db_entry(*it->second);
+  sdp_db_records.erase(it);
 
-        return (true);
-      }
-    }
+  SDP_TRACE_DEBUG("SDP_DeleteRecord ok, num_records:%zu",
+                  sdp_db_records.size());
+  /* if we're deleting the primary DI record, clear the */
+  /* value in the control block */
+  if (sdp_cb.server_db.di_primary_handle == handle) {
+    sdp_cb.server_db.di_primary_handle = 0;
   }
-  return (false);
+
+  return (true);
 }
 
 /*******************************************************************************
@@ -353,9 +492,6 @@ bool SDP_DeleteRecord(uint32_t handle) {
  ******************************************************************************/
 bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
                       uint32_t attr_len, uint8_t* p_val) {
-  uint16_t zz;
-  tSDP_RECORD* p_rec = &sdp_cb.server_db.record[0];
-
   if (p_val == nullptr) {
     SDP_TRACE_WARNING("Trying to add attribute with p_val == nullptr, skipped");
     return (false);
@@ -407,21 +543,17 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
   }
 
   /* Find the record in the database */
-  for (zz = 0; zz < sdp_cb.server_db.num_records; zz++, p_rec++) {
-    if (p_rec->record_handle == handle) {
-
-      // error out early, no need to look up
-      if (p_rec->free_pad_ptr >= SDP_MAX_PAD_LEN) {
-        SDP_TRACE_ERROR("the free pad for SDP record with handle %d is "
-                        "full, skip adding the attribute", handle);
-        return (false);
-      }
+  tSDP_RECORD* p_rec = sdp_db_find_record(handle);
+  if (p_rec == NULL) return (false);
 
-      return SDP_AddAttributeToRecord(p_rec, attr_id, attr_type, attr_len,
-                                      p_val);
-    }
+  // error out early, no need to look up
+  if (p_rec->free_pad_ptr >= SDP_MAX_PAD_LEN) {
+    SDP_TRACE_ERROR("the free pad for SDP record with handle %d is "
+                    "full, skip adding the attribute", handle);
+    return (false);
   }
-  return (false);
+
+  return SDP_AddAttributeToRecord(p_rec, attr_id, attr_type, attr_len, p_val);
 }
 
 /*******************************************************************************
@@ -441,6 +573,15 @@ bool SDP_AddAttribute(uint32_t handle, uint16_t attr_id, uint8_t attr_type,
 bool SDP_AddAttributeToRecord(tSDP_RECORD* p_rec, uint16_t attr_id,
                               uint8_t attr_type, uint32_t attr_len,
                               uint8_t* p_val) {
+  bool result =
+      add_attribute_to_record(p_rec, attr_id, attr_type, attr_len, p_val);
+  sdp_db_record_changed(p_rec);
+  return result;
+}
+
+static bool add_attribute_to_record(tSDP_RECORD* p_rec, uint16_t attr_id,
+                                    uint8_t attr_type, uint32_t attr_len,
+                                    uint8_t* p_val) {
   uint16_t xx, yy;
   tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
 
@@ -448,7 +589,7 @@ bool SDP_AddAttributeToRecord(tSDP_RECORD* p_rec, uint16_t attr_id,
   for (xx = 0; xx < p_rec->num_attributes; xx++, p_attr++) {
     /* The attribute exists. replace it */
     if (p_attr->id == attr_id) {
-      SDP_DeleteAttributeFromRecord(p_rec, attr_id);
+      delete_attribute_from_record(p_rec, attr_id);
       break;
     }
     if (p_attr->id > attr_id) break;
@@ -854,17 +995,12 @@ bool SDP_AddServiceClassIdList(uint32_t handle, uint16_t num_services,
  *
  ******************************************************************************/
 bool SDP_DeleteAttribute(uint32_t handle, uint16_t attr_id) {
-  tSDP_RECORD* p_rec = &sdp_cb.server_db.record[0];
-
   /* Find the record in the database */
-  for (uint16_t record_index = 0; record_index < sdp_cb.server_db.num_records; record_index++, p_rec++) {
-    if (p_rec->record_handle == handle) {
-      SDP_TRACE_API("Deleting attr_id 0x%04x for handle 0x%x", attr_id, handle);
-      return SDP_DeleteAttributeFromRecord(p_rec, attr_id);
-    }
-  }
-  /* If here, not found */
-  return (false);
+  tSDP_RECORD* p_rec = sdp_db_find_record(handle);
+  if (p_rec == NULL) return (false);
+
+  SDP_TRACE_API("Deleting attr_id 0x%04x for handle 0x%x", attr_id, handle);
+  return SDP_DeleteAttributeFromRecord(p_rec, attr_id);
 }
 
 /*******************************************************************************
@@ -880,6 +1016,13 @@ bool SDP_DeleteAttribute(uint32_t handle, uint16_t attr_id) {
  ******************************************************************************/
 
 bool SDP_DeleteAttributeFromRecord(tSDP_RECORD* p_rec, uint16_t attr_id) {
+  bool result = delete_attribute_from_record(p_rec, attr_id);
+  if (result) sdp_db_record_changed(p_rec);
+  return result;
+}
+
+static bool delete_attribute_from_record(tSDP_RECORD* p_rec,
+                                         uint16_t attr_id) {
   tSDP_ATTRIBUTE* p_attr = &p_rec->attribute[0];
   uint8_t* pad_ptr;
   uint32_t len; /* Number of bytes in the entry */
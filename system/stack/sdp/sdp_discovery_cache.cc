@@ -0,0 +1,420 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  This file contains the cache of service search attribute responses of
+ *  peers. Each response is kept as received, keyed by the UUID and attribute
+ *  filters of the request. Only bonded peers are cached: their cache is
+ *  stored with their config so it survives restarts, and it is dropped when
+ *  they are unbonded. Results of other peers are neither kept nor served, so
+ *  that the cache stays bounded by the bonded devices and an unauthenticated
+ *  peer cannot be answered with the records of the address it claims.
+ *
+ *  A result is used until it is SDP_DISC_CACHE_TTL_S old. The cache does not
+ *  ask the peer for its ServiceDatabaseState: the state is only seen when a
+ *  live result happens to hold the Service Discovery Server record, and a new
+ *  state then drops the other results of the peer. Profile searches don't ask
+ *  for that record, so for them the cache is bounded by the TTL alone.
+ *
+ ******************************************************************************/
+
+#define LOG_TAG "sdp_discovery_cache"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "bt_target.h"
+#include "btif/include/btif_config.h"
+#include "gd/common/init_flags.h"
+#include "main/shim/dumpsys.h"
+#include "osi/include/log.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/btm_api.h"
+#include "stack/include/sdp_api.h"
+#include "stack/include/sdpdefs.h"
+#include "stack/sdp/sdpint.h"
+#include "types/raw_address.h"
+
+#define DUMPSYS_TAG "shim::legacy::sdp"
+
+namespace {
+
+constexpr uint8_t kCacheFormatVersion = 1;
+
+struct tSDP_CACHE_ENTRY {
+  /* UUID and attribute filters of the request */
+  std::vector<uint8_t> request;
+  /* Wall clock time the response was received, in seconds */
+  uint64_t stored_time_s;
+  /* Attribute lists of the response */
+  std::vector<uint8_t> attr_lists;
+};
+
+struct tSDP_CACHE_PEER {
+  bool db_state_valid = false;
+  uint32_t db_state = 0;
+  /* Oldest first */
+  std::vector<tSDP_CACHE_ENTRY> entries;
+};
+
+/* Bonded peers whose cache was loaded from the config */
+std::map<RawAddress, tSDP_CACHE_PEER> sdp_cache_peers;
+
+/* Read from the dumpsys thread, while the stack thread updates them */
+struct {
+  std::atomic<size_t> peers;
+  std::atomic<uint64_t> hits;
+  std::atomic<uint64_t> misses;
+  std::atomic<uint64_t> expired;
+  /* Live discoveries that replaced a cached result with a different one */
+  std::atomic<uint64_t> changed;
+  /* Live discoveries that got the same result as the cache */
+  std::atomic<uint64_t> unchanged;
+  /* Peers whose ServiceDatabaseState changed */
+  std::atomic<uint64_t> db_state_changed;
+} sdp_cache_stats;
+
+uint64_t now_s() { return (uint64_t)time(nullptr); }
+
+}  // namespace
+
+/*******************************************************************************
+ *
+ * Function         build_request_key
+ *
+ * Description      This function builds the key of a cache entry from the
+ *                  filters of a discovery database. The attribute filters are
+ *                  kept sorted by SDP_InitDiscoveryDb.
+ *
+ * Returns          The key
+ *
+ ******************************************************************************/
+static std::vector<uint8_t> build_request_key(const tSDP_DISCOVERY_DB* p_db) {
+  std::vector<uint8_t> key;
+  key.push_back((uint8_t)p_db->num_uuid_filters);
+  for (uint16_t xx = 0; xx < p_db->num_uuid_filters; xx++) {
+    const auto& uuid = p_db->uuid_filters[xx].To128BitBE();
+    key.insert(key.end(), uuid.begin(), uuid.end());
+  }
+  key.push_back((uint8_t)p_db->num_attr_filters);
+  for (uint16_t xx = 0; xx < p_db->num_attr_filters; xx++) {
+    key.push_back((uint8_t)(p_db->attr_filters[xx] >> 8));
+    key.push_back((uint8_t)p_db->attr_filters[xx]);
+  }
+  return key;
+}
+
+/*******************************************************************************
+ *
+ * Function         save_peer
+ *
+ * Description      This function writes the cache of a peer to its config,
+ *                  if the peer is bonded.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void save_peer(const RawAddress& bd_addr, const tSDP_CACHE_PEER& peer) {
+  const std::string bda_string = bd_addr.ToString();
+
+  if (peer.entries.empty() || !btm_sec_is_a_bonded_dev(bd_addr)) {
+    if (btif_config_exist(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE))
+      btif_config_remove(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE);
+    return;
+  }
+
+  size_t len = 1 + 1 + 4 + 1;
+  for (const auto& entry : peer.entries)
+    len += 8 + 2 + entry.request.size() + 2 + entry.attr_lists.size();
+
+  std::vector<uint8_t> blob(len);
+  uint8_t* p = blob.data();
+  UINT8_TO_STREAM(p, kCacheFormatVersion);
+  UINT8_TO_STREAM(p, peer.db_state_valid);
+  UINT32_TO_STREAM(p, peer.db_state);
+  UINT8_TO_STREAM(p, peer.entries.size());
+  for (const auto& entry : peer.entries) {
+    UINT64_TO_BE_STREAM(p, entry.stored_time_s);
+    UINT16_TO_STREAM(p, entry.request.size());
+    ARRAY_TO_STREAM(p, entry.request.data(), (int)entry.request.size());
+    UINT16_TO_STREAM(p, entry.attr_lists.size());
+    ARRAY_TO_STREAM(p, entry.attr_lists.data(), (int)entry.attr_lists.size());
+  }
+
+  btif_config_set_bin(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE,
+                      blob.data(), blob.size());
+}
+
+/*******************************************************************************
+ *
+ * Function         load_peer
+ *
+ * Description      This function finds the cache of a bonded peer, reading it
+ *                  from the config the first time. A peer without a cache
+ *                  only gets one if |create| is set.
+ *
+ * Returns          The cache of the peer, or NULL if the peer is not bonded
+ *                  or has no cache
+ *
+ ******************************************************************************/
+static tSDP_CACHE_PEER* load_peer(const RawAddress& bd_addr, bool create) {
+  auto it = sdp_cache_peers.find(bd_addr);
+  if (!btm_sec_is_a_bonded_dev(bd_addr)) {
+    if (it != sdp_cache_peers.end()) {
+      sdp_cache_peers.erase(it);
+      sdp_cache_stats.peers = sdp_cache_peers.size();
+    }
+    return NULL;
+  }
+  if (it != sdp_cache_peers.end()) return &it->second;
+
+  const std::string bda_string = bd_addr.ToString();
+  size_t len =
+      btif_config_get_bin_length(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE);
+  std::vector<uint8_t> blob(len);
+  if (len != 0 &&
+      (!btif_config_get_bin(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE,
+                            blob.data(), &len) ||
+       len < 7 || blob[0] != kCacheFormatVersion)) {
+    LOG_WARN("Dropping unreadable SDP cache of %s",
+             ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+    btif_config_remove(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE);
+    len = 0;
+  }
+  if (len == 0 && !create) return NULL;
+
+  tSDP_CACHE_PEER& peer = sdp_cache_peers[bd_addr];
+  sdp_cache_stats.peers = sdp_cache_peers.size();
+  if (len == 0) return &peer;
+
+  uint8_t* p = blob.data() + 1;
+  uint8_t* p_end = blob.data() + len;
+  uint8_t valid, num_entries;
+  STREAM_TO_UINT8(valid, p);
+  STREAM_TO_UINT32(peer.db_state, p);
+  STREAM_TO_UINT8(num_entries, p);
+  peer.db_state_valid = valid;
+
+  for (uint8_t xx = 0; xx < num_entries; xx++) {
+    tSDP_CACHE_ENTRY entry;
+    uint16_t request_len, list_len;
+    if (p_end - p < 10) break;
+    BE_STREAM_TO_UINT64(entry.stored_time_s, p);
+    STREAM_TO_UINT16(request_len, p);
+    if (p_end - p < request_len + 2) break;
+    entry.request.assign(p, p + request_len);
+    p += request_len;
+    STREAM_TO_UINT16(list_len, p);
+    if (p_end - p < list_len) break;
+    entry.attr_lists.assign(p, p + list_len);
+    p += list_len;
+    peer.entries.push_back(std::move(entry));
+  }
+  return &peer;
+}
+
+/*******************************************************************************
+ *
+ * Function         find_db_state
+ *
+ * Description      This function looks for the ServiceDatabaseState of the
+ *                  peer in a discovery database. It is only there if the
+ *                  search asked for the Service Discovery Server record.
+ *
+ * Returns          true if found, else false
+ *
+ ******************************************************************************/
+static bool find_db_state(const tSDP_DISCOVERY_DB* p_db, uint32_t* p_state) {
+  tSDP_DISC_REC* p_rec = SDP_FindServiceInDb(
+      p_db, UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER, NULL);
+  if (p_rec == NULL) return false;
+
+  tSDP_DISC_ATTR* p_attr =
+      SDP_FindAttributeInRec(p_rec, ATTR_ID_SERVICE_DATABASE_STATE);
+  if (p_attr == NULL ||
+      SDP_DISC_ATTR_TYPE(p_attr->attr_len_type) != UINT_DESC_TYPE ||
+      SDP_DISC_ATTR_LEN(p_attr->attr_len_type) != 4)
+    return false;
+
+  *p_state = p_attr->attr_value.v.u32;
+  return true;
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_disc_cache_store
+ *
+ * Description      This function is called when a service search attribute
+ *                  request completed, to cache its response.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void sdp_disc_cache_store(const RawAddress& bd_addr,
+                          const tSDP_DISCOVERY_DB* p_db,
+                          const uint8_t* p_list, uint16_t list_len) {
+  if (!bluetooth::common::init_flags::sdp_discovery_cache_is_enabled()) return;
+  if (p_db == NULL || p_list == NULL) return;
+
+  tSDP_CACHE_PEER* p_peer = load_peer(bd_addr, true);
+  if (p_peer == NULL) return;
+  tSDP_CACHE_PEER& peer = *p_peer;
+
+  uint32_t db_state;
+  if (find_db_state(p_db, &db_state)) {
+    if (peer.db_state_valid && peer.db_state != db_state) {
+      LOG_INFO("Service records of %s changed, dropping cached results",
+               ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+      peer.entries.clear();
+      sdp_cache_stats.db_state_changed++;
+    }
+    peer.db_state_valid = true;
+    peer.db_state = db_state;
+  }
+
+  std::vector<uint8_t> request = build_request_key(p_db);
+  for (auto it = peer.entries.begin(); it != peer.entries.end(); it++) {
+    if (it->request != request) continue;
+    if (it->attr_lists.size() == list_len &&
+        std::equal(it->attr_lists.begin(), it->attr_lists.end(), p_list))
+      sdp_cache_stats.unchanged++;
+    else
+      sdp_cache_stats.changed++;
+    peer.entries.erase(it);
+    break;
+  }
+
+  if (list_len <= SDP_DISC_CACHE_MAX_LIST_LEN) {
+    if (peer.entries.size() >= SDP_DISC_CACHE_MAX_ENTRIES)
+      peer.entries.erase(peer.entries.begin());
+    peer.entries.push_back(
+        {std::move(request), now_s(),
+         std::vector<uint8_t>(p_list, p_list + list_len)});
+  }
+  save_peer(bd_addr, peer);
+}
+
+/*******************************************************************************
+ *
+ * Function         SDP_FindInDiscoveryCache
+ *
+ * Description      This function looks for the result of an earlier service
+ *                  search attribute request to the peer with the same UUID
+ *                  and attribute filters as the database, and fills the
+ *                  database with it.
+ *
+ * Returns          true if the database was filled from the cache, else false
+ *
+ ******************************************************************************/
+bool SDP_FindInDiscoveryCache(const RawAddress& bd_addr,
+                              tSDP_DISCOVERY_DB* p_db) {
+  if (!bluetooth::common::init_flags::sdp_discovery_cache_is_enabled())
+    return false;
+  /* Raw responses are not kept */
+  if (p_db == NULL || p_db->raw_data != NULL) return false;
+
+  tSDP_CACHE_PEER* p_peer = load_peer(bd_addr, false);
+  if (p_peer == NULL) {
+    sdp_cache_stats.misses++;
+    return false;
+  }
+  tSDP_CACHE_PEER& peer = *p_peer;
+  std::vector<uint8_t> request = build_request_key(p_db);
+
+  for (auto it = peer.entries.begin(); it != peer.entries.end(); it++) {
+    if (it->request != request) continue;
+
+    uint64_t now = now_s();
+    if (now < it->stored_time_s ||
+        now - it->stored_time_s >= SDP_DISC_CACHE_TTL_S) {
+      sdp_cache_stats.expired++;
+      peer.entries.erase(it);
+      save_peer(bd_addr, peer);
+      return false;
+    }
+
+    if (!sdp_disc_load_attr_lists(p_db, bd_addr, it->attr_lists.data(),
+                                  it->attr_lists.size())) {
+      LOG_WARN("Dropping cached result of %s that could not be loaded",
+               ADDRESS_TO_LOGGABLE_CSTR(bd_addr));
+      sdp_cache_stats.misses++;
+      peer.entries.erase(it);
+      save_peer(bd_addr, peer);
+      return false;
+    }
+
+    sdp_cache_stats.hits++;
+    return true;
+  }
+
+  sdp_cache_stats.misses++;
+  return false;
+}
+
+/*******************************************************************************
+ *
+ * Function         SDP_InvalidateDiscoveryCache
+ *
+ * Description      This function drops the cached discovery results of a
+ *                  peer.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void SDP_InvalidateDiscoveryCache(const RawAddress& bd_addr) {
+  sdp_cache_peers.erase(bd_addr);
+  sdp_cache_stats.peers = sdp_cache_peers.size();
+  const std::string bda_string = bd_addr.ToString();
+  if (btif_config_exist(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE))
+    btif_config_remove(bda_string, BT_CONFIG_KEY_SDP_DISCOVERY_CACHE);
+}
+
+/*******************************************************************************
+ *
+ * Function         SDP_Dumpsys
+ *
+ * Description      This function dumps the discovery cache statistics.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void SDP_Dumpsys(int fd) {
+  LOG_DUMPSYS_TITLE(fd, DUMPSYS_TAG);
+
+  LOG_DUMPSYS(fd, "Discovery cache enabled:%s peers:%zu",
+              bluetooth::common::init_flags::sdp_discovery_cache_is_enabled()
+                  ? "true"
+                  : "false",
+              sdp_cache_stats.peers.load());
+  LOG_DUMPSYS(fd,
+              "  hits:%llu misses:%llu expired:%llu changed:%llu "
+              "unchanged:%llu db_state_changed:%llu",
+              (unsigned long long)sdp_cache_stats.hits.load(),
+              (unsigned long long)sdp_cache_stats.misses.load(),
+              (unsigned long long)sdp_cache_stats.expired.load(),
+              (unsigned long long)sdp_cache_stats.changed.load(),
+              (unsigned long long)sdp_cache_stats.unchanged.load(),
+              (unsigned long long)sdp_cache_stats.db_state_changed.load());
+}
@@ -30,6 +30,7 @@
 #include <string.h>  // memcpy
 
 #include <cstdint>
+#include <vector>
 
 // include before bta_hfp_api for pre-defined variable
 #include "btif/include/btif_storage.h"
@@ -198,6 +199,70 @@ void hfp_fallback(bool& is_hfp_fallback, const tSDP_ATTRIBUTE* p_attr) {
   is_hfp_fallback = false;
 }
 
+/*******************************************************************************
+ *
+ * Function         sdp_has_peer_specific_attrs
+ *
+ * Description      Checks if attribute values of a record get rewritten for the
+ *                  peer while the response is built (AVRCP target version and
+ *                  features, HFP version), so that the encoded record can't be
+ *                  sent as is.
+ *
+ * Returns          BOOLEAN
+ *
+ ******************************************************************************/
+static bool sdp_has_peer_specific_attrs(
+    bool is_service_avrc_target,
+    const tSDP_ATTRIBUTE* p_attr_profile_desc_list_id) {
+  if (is_service_avrc_target) return true;
+  if (!bluetooth::common::init_flags::hfp_dynamic_version_is_enabled() ||
+      p_attr_profile_desc_list_id == nullptr ||
+      p_attr_profile_desc_list_id->len < SDP_PROFILE_DESC_LENGTH) {
+    return false;
+  }
+  return ((p_attr_profile_desc_list_id->value_ptr[3] << 8) |
+          (p_attr_profile_desc_list_id->value_ptr[4])) ==
+         UUID_SERVCLASS_HF_HANDSFREE;
+}
+
+/*******************************************************************************
+ *
+ * Function         sdp_copy_encoded_attr_range
+ *
+ * Description      Copies the entries of the attributes of a record that fall
+ *                  in an attribute range from the encoded record, as long as
+ *                  whole entries fit in rem_len bytes. The start of the range
+ *                  is moved to the first attribute left to send.
+ *
+ * Returns          true if no attribute of the range is left to send
+ *
+ ******************************************************************************/
+static bool sdp_copy_encoded_attr_range(const tSDP_RECORD* p_rec,
+                                        const tSDP_ENCODED_ATTRS& encoded,
+                                        tATT_ENT* p_range, uint8_t** pp_rsp,
+                                        uint16_t rem_len) {
+  uint16_t first = 0;
+  while (first < p_rec->num_attributes &&
+         p_rec->attribute[first].id < p_range->start)
+    first++;
+  uint16_t last = first;
+  while (last < p_rec->num_attributes &&
+         p_rec->attribute[last].id <= p_range->end &&
+         encoded.p_offsets[last + 1] - encoded.p_offsets[first] <= rem_len)
+    last++;
+
+  uint16_t len = encoded.p_offsets[last] - encoded.p_offsets[first];
+  memcpy(*pp_rsp, &encoded.p_data[encoded.p_offsets[first]], len);
+  *pp_rsp += len;
+
+  if (last == p_rec->num_attributes ||
+      p_rec->attribute[last].id > p_range->end)
+    return true;
+
+  p_range->start = p_rec->attribute[last].id;
+  return false;
+}
+
 /*******************************************************************************
  *
  * Function         sdp_server_handle_client_req
@@ -286,7 +351,7 @@ static void process_service_search(tCONN_CB* p_ccb, uint16_t trans_num,
   tSDP_UUID_SEQ uid_seq;
   uint8_t *p_rsp, *p_rsp_start, *p_rsp_param_len;
   uint16_t rsp_param_len, num_rsp_handles, xx;
-  uint32_t rsp_handles[SDP_MAX_RECORDS] = {0};
+  std::vector<uint32_t> rsp_handles;
   const tSDP_RECORD* p_rec = NULL;
   bool is_cont = false;
 
@@ -306,15 +371,14 @@ static void process_service_search(tCONN_CB* p_ccb, uint16_t trans_num,
   }
   BE_STREAM_TO_UINT16(max_replies, p_req);
 
-  if (max_replies > SDP_MAX_RECORDS) max_replies = SDP_MAX_RECORDS;
-
   /* Get a list of handles that match the UUIDs given to us */
   for (num_rsp_handles = 0; num_rsp_handles < max_replies;) {
-    p_rec = sdp_db_service_search(p_rec, &uid_seq);
+    p_rec = sdp_db_service_search(p_rec ? p_rec->record_handle : 0, &uid_seq);
 
-    if (p_rec)
-      rsp_handles[num_rsp_handles++] = p_rec->record_handle;
-    else
+    if (p_rec) {
+      rsp_handles.push_back(p_rec->record_handle);
+      num_rsp_handles++;
+    } else
       break;
   }
 
@@ -509,7 +573,7 @@ static void process_service_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     p_rsp = &p_ccb->rsp_list[3]; /* Leave space for data elem descr */
 
     /* Reset continuation parameters in p_ccb */
-    p_ccb->cont_info.prev_sdp_rec = NULL;
+    p_ccb->cont_info.prev_sdp_rec_handle = 0;
     p_ccb->cont_info.next_attr_index = 0;
     p_ccb->cont_info.attr_offset = 0;
   }
@@ -525,8 +589,21 @@ static void process_service_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
   if (p_attr_service_id) {
     is_service_avrc_target = sdpu_is_service_id_avrc_target(p_attr_service_id);
   }
+  tSDP_ENCODED_ATTRS encoded;
+  bool use_encoded = !sdp_has_peer_specific_attrs(
+                         is_service_avrc_target, p_attr_profile_desc_list_id) &&
+                     sdp_db_get_encoded_attrs(p_rec, &encoded);
   /* Search for attributes that match the list given to us */
   for (xx = p_ccb->cont_info.next_attr_index; xx < attr_seq.num_attr; xx++) {
+    /* Copy whole attributes straight from the encoded record if possible */
+    if (use_encoded && !p_ccb->cont_info.attr_offset) {
+      rem_len = max_list_len - (int16_t)(p_rsp - &p_ccb->rsp_list[0]);
+      if (rem_len > 0 &&
+          sdp_copy_encoded_attr_range(p_rec, encoded, &attr_seq.attr_entry[xx],
+                                      &p_rsp, rem_len))
+        continue;
+    }
+
     p_attr = sdp_db_find_attr_in_rec(p_rec, attr_seq.attr_entry[xx].start,
                                      attr_seq.attr_entry[xx].end);
     if (p_attr) {
@@ -774,15 +851,16 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     p_rsp = &p_ccb->rsp_list[3]; /* Leave space for data elem descr */
 
     /* Reset continuation parameters in p_ccb */
-    p_ccb->cont_info.prev_sdp_rec = NULL;
+    p_ccb->cont_info.prev_sdp_rec_handle = 0;
     p_ccb->cont_info.next_attr_index = 0;
     p_ccb->cont_info.last_attr_seq_desc_sent = false;
     p_ccb->cont_info.attr_offset = 0;
   }
 
   /* Get a list of handles that match the UUIDs given to us */
-  for (p_rec = sdp_db_service_search(p_ccb->cont_info.prev_sdp_rec, &uid_seq);
-       p_rec; p_rec = sdp_db_service_search(p_rec, &uid_seq)) {
+  for (p_rec = sdp_db_service_search(p_ccb->cont_info.prev_sdp_rec_handle,
+                                     &uid_seq);
+       p_rec; p_rec = sdp_db_service_search(p_rec->record_handle, &uid_seq)) {
     /* Store the actual record pointer which would be reused later */
     p_prev_rec = (tSDP_RECORD*)p_rec;
     if (bluetooth::common::init_flags::
@@ -818,8 +896,22 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
       is_service_avrc_target =
           sdpu_is_service_id_avrc_target(p_attr_service_id);
     }
+    tSDP_ENCODED_ATTRS encoded;
+    bool use_encoded =
+        !sdp_has_peer_specific_attrs(is_service_avrc_target,
+                                     p_attr_profile_desc_list_id) &&
+        sdp_db_get_encoded_attrs(p_rec, &encoded);
     /* Get a list of handles that match the UUIDs given to us */
     for (xx = p_ccb->cont_info.next_attr_index; xx < attr_seq.num_attr; xx++) {
+      /* Copy whole attributes straight from the encoded record if possible */
+      if (use_encoded && !p_ccb->cont_info.attr_offset) {
+        rem_len = max_list_len - (int16_t)(p_rsp - &p_ccb->rsp_list[0]);
+        if (rem_len > 0 && sdp_copy_encoded_attr_range(
+                               p_rec, encoded, &attr_seq.attr_entry[xx],
+                               &p_rsp, rem_len))
+          continue;
+      }
+
       p_attr = sdp_db_find_attr_in_rec(p_rec, attr_seq.attr_entry[xx].start,
                                        attr_seq.attr_entry[xx].end);
 
@@ -931,7 +1023,7 @@ static void process_service_search_attr_req(tCONN_CB* p_ccb, uint16_t trans_num,
     p_ccb->cont_info.next_attr_index = 0;
     /* restore the record pointer.*/
     p_rec = p_prev_rec;
-    p_ccb->cont_info.prev_sdp_rec = p_rec;
+    p_ccb->cont_info.prev_sdp_rec_handle = p_rec->record_handle;
     p_ccb->cont_info.last_attr_seq_desc_sent = false;
   }
 
@@ -1137,8 +1229,8 @@ static uint16_t sdp_pbap_pse_dynamic_attributes_len_update(
 
   int xx;
   tSDP_ATTRIBUTE attr;
-  for (p_rec = (tSDP_RECORD*)sdp_db_service_search(NULL, uid_seq); p_rec;
-       p_rec = (tSDP_RECORD*)sdp_db_service_search(p_rec, uid_seq)) {
+  for (p_rec = sdp_db_service_search(0, uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_rec->record_handle, uid_seq)) {
     attr = p_rec->attribute[1];
     if ((attr.id == ATTR_ID_SERVICE_CLASS_ID_LIST) &&
         (((attr.value_ptr[1] << 8) | (attr.value_ptr[2])) ==
@@ -1181,8 +1181,8 @@ uint16_t sdpu_get_list_len(tSDP_UUID_SEQ* uid_seq, tSDP_ATTR_SEQ* attr_seq) {
   uint16_t len = 0;
   uint16_t len1;
 
-  for (p_rec = sdp_db_service_search(NULL, uid_seq); p_rec;
-       p_rec = sdp_db_service_search(p_rec, uid_seq)) {
+  for (p_rec = sdp_db_service_search(0, uid_seq); p_rec;
+       p_rec = sdp_db_service_search(p_rec->record_handle, uid_seq)) {
     len += 3;
 
     len1 = sdpu_get_attrib_seq_len(p_rec, attr_seq);
@@ -1212,6 +1212,24 @@ uint16_t sdpu_get_attrib_seq_len(const tSDP_RECORD* p_rec,
   uint16_t xx;
   bool is_range = false;
   uint16_t start_id = 0, end_id = 0;
+  tSDP_ENCODED_ATTRS encoded;
+
+  /* Attributes are sorted by id, so the entries of each range are contiguous
+   * in the encoded record */
+  if (sdp_db_get_encoded_attrs(p_rec, &encoded)) {
+    for (xx = 0; xx < attr_seq->num_attr; xx++) {
+      uint16_t first = 0;
+      while (first < p_rec->num_attributes &&
+             p_rec->attribute[first].id < attr_seq->attr_entry[xx].start)
+        first++;
+      uint16_t last = first;
+      while (last < p_rec->num_attributes &&
+             p_rec->attribute[last].id <= attr_seq->attr_entry[xx].end)
+        last++;
+      len1 += encoded.p_offsets[last] - encoded.p_offsets[first];
+    }
+    return len1;
+  }
 
   for (xx = 0; xx < attr_seq->num_attr; xx++) {
     if (!is_range) {
@@ -103,21 +103,26 @@ typedef struct {
   uint8_t attr_pad[SDP_MAX_PAD_LEN];
 } tSDP_RECORD;
 
-/* Define the SDP database */
+/* Define the SDP database. The records themselves are kept by sdp_db.cc */
 typedef struct {
   uint32_t
       di_primary_handle; /* Device ID Primary record or NULL if nonexistent */
-  uint16_t num_records;
-  tSDP_RECORD record[SDP_MAX_RECORDS];
 } tSDP_DB;
 
+/* Attribute entries of a database record, encoded as sent to peers. Entry i
+ * of the record is p_data[p_offsets[i]] up to p_data[p_offsets[i + 1]] */
+typedef struct {
+  const uint8_t* p_data;
+  const uint16_t* p_offsets;
+} tSDP_ENCODED_ATTRS;
+
 /* Continuation information for the SDP server response */
 typedef struct {
   uint16_t next_attr_index;    /* attr index for next continuation response */
   uint16_t next_attr_start_id; /* attr id to start with for the attr index in
                                   next cont. response */
-  const tSDP_RECORD* prev_sdp_rec; /* last sdp record that was completely sent
-                                in the response */
+  uint32_t prev_sdp_rec_handle; /* last sdp record that was completely sent
+                                   in the response, 0 if none */
   bool last_attr_seq_desc_sent; /* whether attr seq length has been sent
                                    previously */
   uint16_t attr_offset; /* offset within the attr to keep trak of partial
@@ -319,9 +324,11 @@ void sdpu_callback(tCONN_CB& ccb, tSDP_REASON reason);
 
 /* Functions provided by sdp_db.cc
  */
-const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
+const tSDP_RECORD* sdp_db_service_search(uint32_t prev_handle,
                                          const tSDP_UUID_SEQ* p_seq);
 tSDP_RECORD* sdp_db_find_record(uint32_t handle);
+bool sdp_db_get_encoded_attrs(const tSDP_RECORD* p_rec,
+                              tSDP_ENCODED_ATTRS* p_encoded);
 const tSDP_ATTRIBUTE* sdp_db_find_attr_in_rec(const tSDP_RECORD* p_rec,
                                               uint16_t start_attr,
                                               uint16_t end_attr);
@@ -334,6 +341,15 @@ void sdp_server_handle_client_req(tCONN_CB* p_ccb, BT_HDR* p_msg);
  */
 void sdp_disc_connected(tCONN_CB* p_ccb);
 void sdp_disc_server_rsp(tCONN_CB* p_ccb, BT_HDR* p_msg);
+bool sdp_disc_load_attr_lists(tSDP_DISCOVERY_DB* p_db,
+                              const RawAddress& bd_addr, uint8_t* p_list,
+                              uint16_t list_len);
+
+/* Functions provided by sdp_discovery_cache.cc
+ */
+void sdp_disc_cache_store(const RawAddress& bd_addr,
+                          const tSDP_DISCOVERY_DB* p_db,
+                          const uint8_t* p_list, uint16_t list_len);
 
 void update_pce_entry_to_interop_database(RawAddress remote_addr);
 bool is_sdp_pbap_pce_disabled(RawAddress remote_addr);
@@ -26,7 +26,9 @@
 #pragma once
 
 #include <cstdbool>
-#include "p_256_multprecision.h"
+#include <cstdint>
+
+#define KEY_LENGTH_DWORDS_P256 8
 
 typedef struct {
   uint32_t x[KEY_LENGTH_DWORDS_P256];
@@ -58,8 +60,7 @@ extern elliptic_curve_t curve_p256;
 
 bool ECC_ValidatePoint(const Point& p);
 
-void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n);
-
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+/* Computes q = n * p in affine coordinates, see the GD security module */
+void ECC_PointMult(Point* q, const Point* p, const uint32_t* n);
 
 void p_256_init_curve();
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "stack/include/a2dp_rate_controller.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <string>
+
+namespace {
+
+constexpr size_t kCongested = A2dpRateController::kCongestedQueueLength;
+constexpr size_t kClear = A2dpRateController::kClearQueueLength;
+
+// Runs |ticks| ticks with the same link state, returns the number of changes
+size_t RunTicks(A2dpRateController* controller, unsigned ticks,
+                size_t queue_length, uint64_t queue_delay_us = 0) {
+  size_t changes = 0;
+  for (unsigned i = 0; i < ticks; i++) {
+    if (controller->Update(queue_length, queue_delay_us)) changes++;
+  }
+  return changes;
+}
+
+std::string DumpToString(const A2dpRateController& controller,
+                         uint64_t now_us) {
+  FILE* file = tmpfile();
+  controller.Dump(fileno(file), now_us);
+  std::string text;
+  rewind(file);
+  char buffer[256];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    text.append(buffer, n);
+  }
+  fclose(file);
+  return text;
+}
+
+}  // namespace
+
+TEST(A2dpRateControllerTest, starts_at_max_rate) {
+  A2dpRateController controller;
+  controller.Reset(35, 53, 6);
+  ASSERT_TRUE(controller.IsEnabled());
+  ASSERT_EQ(controller.Rate(), 53u);
+  ASSERT_EQ(RunTicks(&controller, 1000, 0), 0u);
+  ASSERT_EQ(controller.Rate(), 53u);
+}
+
+TEST(A2dpRateControllerTest, disabled_without_range) {
+  A2dpRateController controller;
+  controller.Reset(53, 53, 6);
+  ASSERT_FALSE(controller.IsEnabled());
+  ASSERT_EQ(RunTicks(&controller, 100, kCongested * 2), 0u);
+  ASSERT_EQ(controller.Rate(), 53u);
+
+  // A minimum above the configured rate is ignored
+  controller.Reset(200000, 128000, 32000);
+  ASSERT_FALSE(controller.IsEnabled());
+  ASSERT_EQ(controller.Rate(), 128000u);
+}
+
+TEST(A2dpRateControllerTest, steps_down_when_queue_builds_up) {
+  A2dpRateController controller;
+  controller.Reset(35, 53, 6);
+
+  // Waits for the hold-off before the first step as well
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepDownHoldoffTicks - 1,
+                     kCongested),
+            0u);
+  ASSERT_TRUE(controller.Update(kCongested, 0));
+  ASSERT_EQ(controller.Rate(), 47u);
+
+  // One step per hold-off, down to the minimum and no further
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepDownHoldoffTicks,
+                     kCongested),
+            1u);
+  ASSERT_EQ(controller.Rate(), 41u);
+  ASSERT_EQ(RunTicks(&controller, 100, kCongested), 1u);
+  ASSERT_EQ(controller.Rate(), 35u);
+}
+
+TEST(A2dpRateControllerTest, steps_down_when_link_stalls) {
+  A2dpRateController controller;
+  controller.Reset(128000, 320000, 32000);
+
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepDownHoldoffTicks, 1,
+                     A2dpRateController::kCongestedQueueDelayUs - 1),
+            0u);
+  ASSERT_TRUE(
+      controller.Update(1, A2dpRateController::kCongestedQueueDelayUs));
+  ASSERT_EQ(controller.Rate(), 288000u);
+}
+
+TEST(A2dpRateControllerTest, last_step_stops_at_min_rate) {
+  A2dpRateController controller;
+  controller.Reset(128000, 200000, 64000);
+  ASSERT_EQ(RunTicks(&controller, 100, kCongested), 2u);
+  ASSERT_EQ(controller.Rate(), 128000u);
+
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepUpTicks * 2, 0), 2u);
+  ASSERT_EQ(controller.Rate(), 200000u);
+}
+
+TEST(A2dpRateControllerTest, steps_up_after_link_keeps_up) {
+  A2dpRateController controller;
+  controller.Reset(35, 53, 6);
+  RunTicks(&controller, 100, kCongested);
+  ASSERT_EQ(controller.Rate(), 35u);
+
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepUpTicks - 1, kClear),
+            0u);
+  ASSERT_TRUE(controller.Update(kClear, 0));
+  ASSERT_EQ(controller.Rate(), 41u);
+
+  // A tick with a longer queue restarts the wait
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepUpTicks - 1, 0), 0u);
+  ASSERT_FALSE(controller.Update(kClear + 1, 0));
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepUpTicks - 1, 0), 0u);
+  ASSERT_TRUE(controller.Update(0, 0));
+  ASSERT_EQ(controller.Rate(), 47u);
+
+  ASSERT_EQ(RunTicks(&controller, A2dpRateController::kStepUpTicks * 3, 0), 1u);
+  ASSERT_EQ(controller.Rate(), 53u);
+}
+
+TEST(A2dpRateControllerTest, dump_timeline) {
+  A2dpRateController controller;
+  controller.Reset(35, 53, 6);
+  ASSERT_NE(DumpToString(controller, 0).find("timeline (ms ago: bps):\n"),
+            std::string::npos);
+
+  for (uint64_t i = 0; i < A2dpRateController::kTimelineSize + 2; i++) {
+    controller.RecordBitrate(i * 1000000, 100000 + i);
+  }
+  RunTicks(&controller, 100, kCongested);
+  RunTicks(&controller, A2dpRateController::kStepUpTicks, 0);
+
+  std::string dump = DumpToString(controller, 40 * 1000000);
+  EXPECT_NE(dump.find("(down/up)                 : 3 / 1\n"), std::string::npos)
+      << dump;
+  // Most recent first, the two oldest are gone
+  EXPECT_NE(dump.find("timeline (ms ago: bps): 7000: 100033 8000: 100032"),
+            std::string::npos)
+      << dump;
+  EXPECT_NE(dump.find(" 38000: 100002\n"), std::string::npos) << dump;
+  EXPECT_EQ(dump.find(": 100001"), std::string::npos) << dump;
+
+  controller.Reset(0, 0, 0);
+  ASSERT_TRUE(DumpToString(controller, 0).empty());
+}
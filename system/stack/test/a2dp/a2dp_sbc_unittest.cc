@@ -20,8 +20,10 @@
 #include <gtest/gtest.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <fstream>
 #include <future>
 #include <iomanip>
@@ -63,6 +65,52 @@ const uint8_t kCodecInfoSbcCapability[AVDT_CODEC_SIZE] = {
     9                    // Fake
 };
 uint8_t* Data(BT_HDR* packet) { return packet->data + packet->offset; }
+
+// Sends up to |capacity_bytes| of the queued media packets on every tick and
+// drops the oldest packet when the queue is full, as the A2DP source does
+struct FakeLink {
+  static constexpr size_t kQueueLimit = 8;
+
+  ~FakeLink() {
+    for (BT_HDR* p_buf : queue) osi_free(p_buf);
+  }
+
+  void Enqueue(BT_HDR* p_buf) {
+    if (queue.size() == kQueueLimit) {
+      osi_free(queue.front());
+      queue.pop_front();
+      dropped++;
+    }
+    // Every SBC frame header carries the bitpool in its third octet
+    bitpool = Data(p_buf)[2];
+    min_bitpool = std::min(min_bitpool, bitpool);
+    queue.push_back(p_buf);
+  }
+
+  void Send(uint64_t now_us) {
+    credit_bytes += capacity_bytes;
+    while (!queue.empty() && queue.front()->len <= credit_bytes) {
+      credit_bytes -= queue.front()->len;
+      osi_free(queue.front());
+      queue.pop_front();
+      last_send_us = now_us;
+    }
+    if (queue.empty()) credit_bytes = 0;
+  }
+
+  uint64_t QueueDelayUs(uint64_t now_us) const {
+    if (queue.empty() || last_send_us == 0) return 0;
+    return now_us - last_send_us;
+  }
+
+  std::deque<BT_HDR*> queue;
+  size_t capacity_bytes = 0;
+  size_t credit_bytes = 0;
+  uint64_t last_send_us = 0;
+  size_t dropped = 0;
+  uint8_t bitpool = 0;
+  uint8_t min_bitpool = UINT8_MAX;
+};
 }  // namespace
 
 namespace bluetooth {
@@ -308,5 +356,56 @@ TEST_F(A2dpSbcTest, get_track_bits_per_sample) {
   ASSERT_EQ(A2DP_GetTrackBitsPerSampleSbc(kCodecInfoSbcCapability), 16);
 }
 
+TEST_F(A2dpSbcTest, adaptive_bitpool_on_congested_link) {
+  static FakeLink* link;
+  auto read_cb = +[](uint8_t* p_buf, uint32_t len) -> uint32_t {
+    // A tone keeps the encoder from hitting the silence shortcuts
+    static uint32_t sample = 0;
+    int16_t* pcm = reinterpret_cast<int16_t*>(p_buf);
+    for (uint32_t i = 0; i < len / sizeof(int16_t); i++, sample++) {
+      pcm[i] = (sample % 100) * 300 - 15000;
+    }
+    return len;
+  };
+  auto enqueue_cb = +[](BT_HDR* p_buf, size_t frames_n, uint32_t len) -> bool {
+    link->Enqueue(p_buf);
+    return true;
+  };
+  FakeLink fake_link;
+  link = &fake_link;
+  InitializeEncoder(true, read_cb, enqueue_cb);
+
+  const uint64_t interval_us = encoder_iface_->get_encoder_interval_ms() * 1000;
+  uint64_t timestamp_us = interval_us;
+  auto run_ticks = [&](size_t ticks, size_t capacity_bytes) {
+    link->capacity_bytes = capacity_bytes;
+    for (size_t i = 0; i < ticks; i++, timestamp_us += interval_us) {
+      link->Send(timestamp_us);
+      encoder_iface_->set_transmit_queue_length(link->queue.size());
+      encoder_iface_->set_transmit_queue_delay(
+          link->QueueDelayUs(timestamp_us));
+      encoder_iface_->send_frames(timestamp_us);
+    }
+  };
+
+  // 53 is about 330 kbps, or 830 bytes per 20 ms tick
+  run_ticks(100, 2000);
+  ASSERT_EQ(link->bitpool, 53);
+  ASSERT_EQ(link->min_bitpool, 53);
+  ASSERT_EQ(link->dropped, 0u);
+
+  // Down to the bitpool of the 229 kbps of a link without EDR
+  run_ticks(100, 600);
+  ASSERT_EQ(link->bitpool, 35);
+  size_t dropped = link->dropped;
+  run_ticks(200, 600);
+  ASSERT_EQ(link->min_bitpool, 35);
+  ASSERT_EQ(link->dropped, dropped);
+
+  run_ticks(400, 2000);
+  ASSERT_EQ(link->bitpool, 53);
+  ASSERT_EQ(link->dropped, dropped);
+}
+
 }  // namespace testing
 }  // namespace bluetooth
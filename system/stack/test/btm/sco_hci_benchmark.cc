@@ -0,0 +1,211 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "btif/include/core_callbacks.h"
+#include "btif/include/stack_manager.h"
+#include "stack/btm/btm_sco.h"
+#include "stack/include/hfp_msbc_decoder.h"
+#include "stack/include/hfp_msbc_encoder.h"
+
+using ::benchmark::State;
+
+extern bluetooth::core::CoreInterface* GetInterfaceToProfiles();
+
+namespace {
+
+constexpr size_t kPktSize = 60;
+constexpr size_t kNumFrames = 1000;
+
+struct CodecInterface : bluetooth::core::CodecInterface {
+  CodecInterface() : bluetooth::core::CodecInterface(){};
+
+  void initialize() override {
+    hfp_msbc_decoder_init();
+    hfp_msbc_encoder_init();
+  }
+
+  void cleanup() override {
+    hfp_msbc_decoder_cleanup();
+    hfp_msbc_encoder_cleanup();
+  }
+
+  uint32_t encodePacket(int16_t* input, uint8_t* output) {
+    return hfp_msbc_encode_frames(input, output);
+  }
+
+  bool decodePacket(const uint8_t* i_buf, int16_t* o_buf, size_t out_len) {
+    return hfp_msbc_decoder_decode_packet(i_buf, o_buf, out_len);
+  }
+};
+
+// Sweeps from 200Hz to 2kHz at 16kHz over the samples, so that no two windows
+// of the history are alike and the pattern match has to find the closest one
+std::vector<int16_t> Chirp(size_t num_samples) {
+  const double kStartHz = 200, kEndHz = 2000, kRate = 16000;
+  const double duration = num_samples / kRate;
+  std::vector<int16_t> samples(num_samples);
+  for (size_t i = 0; i < num_samples; i++) {
+    double t = i / kRate;
+    samples[i] = 8000 * sin(2 * M_PI *
+                            (kStartHz * t +
+                             (kEndHz - kStartHz) / (2 * duration) * t * t));
+  }
+  return samples;
+}
+
+// The search before it was made incremental: the template energy, the
+// candidate energy and the dot product are all computed in float for every
+// offset
+float PreviousCrossCorrelation(const int16_t* x, const int16_t* y) {
+  float sum = 0, x2 = 0, y2 = 0;
+  for (int i = 0; i < BTM_PLC_TL; i++) {
+    sum += ((float)x[i]) * y[i];
+    x2 += ((float)x[i]) * x[i];
+    y2 += ((float)y[i]) * y[i];
+  }
+  return sum / sqrtf(x2 * y2);
+}
+
+int PreviousPatternMatch(const int16_t* hist) {
+  int best = 0;
+  float cn, max_cn = FLT_MIN;
+  for (int i = 0; i < BTM_PLC_WL; i++) {
+    cn = PreviousCrossCorrelation(&hist[BTM_PLC_HL - BTM_PLC_TL], &hist[i]);
+    if (cn > max_cn) {
+      best = i;
+      max_cn = cn;
+    }
+  }
+  return best;
+}
+
+// Histories of BTM_PLC_HL samples taken one frame apart along a chirp
+std::vector<std::vector<int16_t>> Histories() {
+  const size_t kNumHistories = 64;
+  std::vector<int16_t> chirp =
+      Chirp(BTM_PLC_HL + kNumHistories * BTM_MSBC_FS);
+  std::vector<std::vector<int16_t>> histories;
+  for (size_t i = 0; i < kNumHistories; i++) {
+    auto begin = chirp.begin() + i * BTM_MSBC_FS;
+    histories.emplace_back(begin, begin + BTM_PLC_HL);
+  }
+  return histories;
+}
+
+}  // namespace
+
+void BM_PlcPatternMatchIncremental(State& state) {
+  auto histories = Histories();
+  size_t i = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(bluetooth::audio::sco::wbs::plc_pattern_match(
+        histories[i++ % histories.size()].data()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_PlcPatternMatchPrevious(State& state) {
+  auto histories = Histories();
+  for (const auto& hist : histories) {
+    if (PreviousPatternMatch(hist.data()) !=
+        bluetooth::audio::sco::wbs::plc_pattern_match(hist.data())) {
+      state.SkipWithError("The searches picked different lags");
+      return;
+    }
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    ::benchmark::DoNotOptimize(
+        PreviousPatternMatch(histories[i++ % histories.size()].data()));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_PlcPatternMatchIncremental);
+BENCHMARK(BM_PlcPatternMatchPrevious);
+
+// Decodes a stream of mSBC packets with a lost packet every state.range(0)
+// frames, none if 0. The losses are far enough apart for the PLC to stay
+// enabled, so each of them runs the pattern search.
+class BM_WbsDecode : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    static auto codec = CodecInterface{};
+    GetInterfaceToProfiles()->msbcCodec = &codec;
+
+    bluetooth::audio::sco::wbs::init(kPktSize);
+    std::vector<int16_t> chirp = Chirp(kNumFrames * BTM_MSBC_FS);
+    for (size_t i = 0; i < kNumFrames; i++) {
+      const uint8_t* encoded = nullptr;
+      bluetooth::audio::sco::wbs::encode(&chirp[i * BTM_MSBC_FS],
+                                         BTM_MSBC_CODE_SIZE);
+      bluetooth::audio::sco::wbs::dequeue_packet(&encoded);
+      packets_.emplace_back(encoded, encoded + kPktSize);
+    }
+    bluetooth::audio::sco::wbs::cleanup();
+    bluetooth::audio::sco::wbs::init(kPktSize);
+  }
+
+  void TearDown(State& st) override {
+    bluetooth::audio::sco::wbs::cleanup();
+    packets_.clear();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  std::vector<std::vector<uint8_t>> packets_;
+};
+
+BENCHMARK_DEFINE_F(BM_WbsDecode, plc)(State& state) {
+  const size_t loss_period = state.range(0);
+  const uint8_t invalid_pkt[kPktSize] = {0};
+  size_t frame = 0;
+  for (auto _ : state) {
+    bool lost = loss_period != 0 && frame % loss_period == loss_period - 1;
+    const uint8_t* p_pkt =
+        lost ? invalid_pkt : packets_[frame % kNumFrames].data();
+    const uint8_t* decoded = nullptr;
+    if (bluetooth::audio::sco::wbs::enqueue_packet(p_pkt, kPktSize, false) !=
+            kPktSize ||
+        bluetooth::audio::sco::wbs::decode(&decoded) != BTM_MSBC_CODE_SIZE) {
+      state.SkipWithError("Frame not decoded");
+      break;
+    }
+    frame++;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(BM_WbsDecode, plc)
+    ->ArgName("loss_period")
+    ->Arg(0)
+    ->Arg(50)
+    ->Arg(6);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -20,8 +20,11 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cmath>
 #include <map>
 #include <memory>
+#include <set>
+#include <vector>
 
 #include "btif/include/core_callbacks.h"
 #include "btif/include/stack_manager.h"
@@ -108,6 +111,45 @@ class ScoHciWbsWithInitCleanTest : public ScoHciTest {
     bluetooth::audio::sco::wbs::init(60);
   }
   void TearDown() override { bluetooth::audio::sco::wbs::cleanup(); }
+
+  // Encodes |num_frames| frames of a linear chirp, loses the packets in
+  // |lost| and returns the decoded samples.
+  std::vector<int16_t> RunWbsStream(size_t num_frames,
+                                    const std::set<size_t>& lost) {
+    std::vector<int16_t> output;
+    uint8_t invalid_pkt[60] = {0};
+    int16_t data[120];
+    const uint8_t* encoded = nullptr;
+    const uint8_t* decoded = nullptr;
+
+    bluetooth::audio::sco::wbs::cleanup();
+    bluetooth::audio::sco::wbs::init(60);
+    // Sweeps from 200Hz to 2kHz at 16kHz over the stream, so that no two
+    // windows of the history are alike and the pattern match has to find the
+    // closest one
+    const double kStartHz = 200, kEndHz = 2000, kRate = 16000;
+    const double duration = num_frames * 120 / kRate;
+    for (size_t i = 0, sample_idx = 0; i < num_frames; i++) {
+      for (size_t j = 0; j < 120; j++, sample_idx++) {
+        double t = sample_idx / kRate;
+        data[j] = 8000 * sin(2 * M_PI *
+                             (kStartHz * t +
+                              (kEndHz - kStartHz) / (2 * duration) * t * t));
+      }
+      EXPECT_EQ(bluetooth::audio::sco::wbs::encode(data, sizeof(data)),
+                sizeof(data));
+      EXPECT_EQ(bluetooth::audio::sco::wbs::dequeue_packet(&encoded),
+                size_t(60));
+      EXPECT_EQ(bluetooth::audio::sco::wbs::enqueue_packet(
+                    lost.count(i) ? invalid_pkt : encoded, 60, false),
+                size_t(60));
+      EXPECT_EQ(bluetooth::audio::sco::wbs::decode(&decoded),
+                size_t(BTM_MSBC_CODE_SIZE));
+      output.insert(output.end(), (const int16_t*)decoded,
+                    (const int16_t*)(decoded + BTM_MSBC_CODE_SIZE));
+    }
+    return output;
+  }
 };
 
 TEST_F(ScoHciTest, ScoOverHciOpenFail) {
@@ -430,4 +472,32 @@ TEST_F(ScoHciWbsWithInitCleanTest, WbsPlc) {
   }
 }
 
+TEST_F(ScoHciWbsWithInitCleanTest, WbsPlcQuality) {
+  const size_t kNumFrames = 100;
+  // Isolated losses, and two consecutive ones that reuse the best match
+  const std::vector<size_t> kLost = {20, 33, 47, 48, 70, 91};
+  // SNR of each concealed frame against the loss-free stream, as produced by
+  // the float cross correlation search the PLC used before it was made
+  // incremental
+  const std::vector<double> kPreChangeSnrDb = {4.65, 6.67, 4.46, -4.26,
+                                               5.68, 4.20};
+
+  std::vector<int16_t> expected = RunWbsStream(kNumFrames, {});
+  std::vector<int16_t> concealed =
+      RunWbsStream(kNumFrames, std::set<size_t>(kLost.begin(), kLost.end()));
+  ASSERT_EQ(concealed.size(), expected.size());
+
+  for (size_t xx = 0; xx < kLost.size(); xx++) {
+    double signal = 0, noise = 0;
+    for (size_t i = kLost[xx] * 120; i < (kLost[xx] + 1) * 120; i++) {
+      signal += (double)expected[i] * expected[i];
+      noise += ((double)concealed[i] - expected[i]) *
+               ((double)concealed[i] - expected[i]);
+    }
+    double snr = 10 * log10(signal / std::max(noise, 1.0));
+    EXPECT_NEAR(snr, kPreChangeSnrDb[xx], 0.1)
+        << "Concealed frame " << kLost[xx];
+  }
+}
+
 }  // namespace
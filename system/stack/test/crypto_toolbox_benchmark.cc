@@ -0,0 +1,90 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "stack/crypto_toolbox/crypto_toolbox.h"
+#include "stack/include/bt_octets.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// An address that none of the random IRKs resolve, so every key is tried
+constexpr uint8_t kRpa[] = {0x70, 0x81, 0x94, 0x0d, 0xfb, 0xaa};
+
+std::vector<Octet16> RandomKeys(size_t num_keys) {
+  unsigned int seed = 1;
+  std::vector<Octet16> keys(num_keys);
+  for (Octet16& key : keys) {
+    for (uint8_t& byte : key) byte = rand_r(&seed);
+  }
+  return keys;
+}
+
+// Resolves the address with one aes_128() call per IRK, the way
+// btm_ble_resolve_random_addr() walked the security records
+void BM_RpaResolveOneKeyAtATime(State& state) {
+  std::vector<Octet16> irks = RandomKeys(state.range(0));
+  Octet16 prand{0};
+  prand[0] = kRpa[2];
+  prand[1] = kRpa[1];
+  prand[2] = kRpa[0];
+  const uint8_t hash[3] = {kRpa[5], kRpa[4], kRpa[3]};
+
+  for (auto _ : state) {
+    size_t found = irks.size();
+    for (size_t i = 0; i < irks.size(); i++) {
+      Octet16 output = crypto_toolbox::aes_128(irks[i], prand);
+      if (memcmp(output.data(), hash, sizeof(hash)) == 0) {
+        found = i;
+        break;
+      }
+    }
+    ::benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * irks.size());
+}
+
+void BM_RpaFindIrk(State& state) {
+  std::vector<Octet16> irks = RandomKeys(state.range(0));
+
+  for (auto _ : state) {
+    size_t found = crypto_toolbox::rpa_find_irk(kRpa, irks.data(), irks.size());
+    if (found != irks.size()) {
+      state.SkipWithError("Random IRK resolved the address");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * irks.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_RpaResolveOneKeyAtATime)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_RpaFindIrk)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -23,6 +23,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
 #include <vector>
 
 #include "stack/crypto_toolbox/aes.h"
@@ -399,4 +400,65 @@ TEST(CryptoToolboxTest, bt_spec_example_d_12_test) {
   EXPECT_EQ(expected_ltk, ltk);
 }
 
+// Encrypts |message| with each key using the software AES
+static std::vector<Octet16> aes_128_software(const std::vector<Octet16>& keys,
+                                             const Octet16& message) {
+  std::vector<Octet16> output;
+  Octet16 message_reversed;
+  std::reverse_copy(message.begin(), message.end(), message_reversed.begin());
+  for (const Octet16& key : keys) {
+    Octet16 key_reversed, out;
+    std::reverse_copy(key.begin(), key.end(), key_reversed.begin());
+    aes_context ctx;
+    aes_set_key(key_reversed.data(), key_reversed.size(), &ctx);
+    aes_encrypt(message_reversed.data(), out.data(), &ctx);
+    std::reverse(out.begin(), out.end());
+    output.push_back(out);
+  }
+  return output;
+}
+
+static std::vector<Octet16> random_keys(size_t num_keys, unsigned int seed) {
+  std::vector<Octet16> keys(num_keys);
+  for (Octet16& key : keys) {
+    for (uint8_t& byte : key) byte = rand_r(&seed);
+  }
+  return keys;
+}
+
+TEST(CryptoToolboxTest, aes_128_multi_key_test) {
+  Octet16 message{0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                  0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+  // Covers partial groups of keys and more keys than are encrypted at once
+  for (size_t num_keys : {1, 3, 4, 5, 16, 37}) {
+    std::vector<Octet16> keys = random_keys(num_keys, num_keys);
+    std::vector<Octet16> output(num_keys);
+    aes_128_multi_key(keys.data(), num_keys, message, output.data());
+    EXPECT_EQ(output, aes_128_software(keys, message)) << num_keys << " keys";
+  }
+}
+
+// BT Spec 5.0 | Vol 3, Part H D.7
+TEST(CryptoToolboxTest, rpa_find_irk_test) {
+  Octet16 irk{0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05,
+              0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+  // hash 0x0dfbaa with prand 0x708194
+  uint8_t rpa[] = {0x70, 0x81, 0x94, 0x0d, 0xfb, 0xaa};
+
+  // algorithm expect all input to be in little endian format, so reverse
+  std::reverse(std::begin(irk), std::end(irk));
+
+  std::vector<Octet16> irks = random_keys(20, 1);
+  EXPECT_EQ(rpa_find_irk(rpa, irks.data(), irks.size()), irks.size());
+  EXPECT_EQ(rpa_find_irk(rpa, irks.data(), 0), 0u);
+
+  irks[17] = irk;
+  EXPECT_EQ(rpa_find_irk(rpa, irks.data(), irks.size()), 17u);
+  EXPECT_EQ(rpa_find_irk(rpa, &irk, 1), 0u);
+
+  rpa[5] ^= 1;
+  EXPECT_EQ(rpa_find_irk(rpa, irks.data(), irks.size()), irks.size());
+}
+
 }  // namespace crypto_toolbox
@@ -0,0 +1,177 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+#include "mock_btm_layer.h"
+#include "mock_l2cap_layer.h"
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/btm_api.h"
+#include "stack/include/l2c_api.h"
+#include "stack/include/port_api.h"
+#include "stack/rfcomm/rfc_int.h"
+#include "stack_rfcomm_test_utils.h"
+#include "stack_test_packet_utils.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+using bluetooth::AllocateWrappedIncomingL2capAclPacket;
+using bluetooth::rfcomm::CreateQuickDataPacket;
+using bluetooth::rfcomm::CreateQuickMscPacket;
+using bluetooth::rfcomm::CreateQuickPnPacket;
+using bluetooth::rfcomm::CreateQuickSabmPacket;
+using bluetooth::rfcomm::GetDlci;
+
+namespace {
+
+constexpr uint16_t kAclHandle = 0x0009;
+constexpr uint16_t kLcid = 0x0054;
+constexpr uint16_t kUuid = 0x1112;
+constexpr uint8_t kScn = 8;
+constexpr uint16_t kMtu = 1600;
+const RawAddress kPeerAddress = {{0xAA, 0x00, 0x11, 0x22, 0x33, 0x00}};
+
+void port_mgmt_cback(uint32_t code, uint16_t port_handle) {}
+void port_event_cback(uint32_t code, uint16_t port_handle) {}
+
+}  // namespace
+
+// Moves data through an RFCOMM server port connected over the mock L2CAP
+// layer of net_test_stack_rfcomm. Frames written to L2CAP are released right
+// away, as the real L2CA_DataWrite() does.
+class BM_StackRfcomm : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    bluetooth::manager::SetMockSecurityInternalInterface(&btm_security_);
+    bluetooth::l2cap::SetMockInterface(&l2cap_);
+    ON_CALL(l2cap_, Register(BT_PSM_RFCOMM, _, _, _))
+        .WillByDefault(
+            DoAll(SaveArg<1>(&l2cap_appl_info_), Return(BT_PSM_RFCOMM)));
+    ON_CALL(l2cap_, ConnectResponse(_, _, _, _, _)).WillByDefault(Return(true));
+    ON_CALL(l2cap_, ConfigRequest(_, _)).WillByDefault(Return(true));
+    ON_CALL(l2cap_, ConfigResponse(_, _)).WillByDefault(Return(true));
+    ON_CALL(l2cap_, DataWrite(_, _))
+        .WillByDefault(Invoke([](uint16_t cid, BT_HDR* p_data) -> uint8_t {
+          osi_free(p_data);
+          return L2CAP_DW_SUCCESS;
+        }));
+    ON_CALL(btm_security_,
+            MultiplexingProtocolAccessRequest(_, _, _, _, _, _, _))
+        .WillByDefault(DoAll(SaveArg<5>(&security_callback_),
+                             SaveArg<6>(&p_port_), Return(BTM_SUCCESS)));
+    RFCOMM_Init();
+
+    RFCOMM_CreateConnectionWithSecurity(kUuid, kScn, true, kMtu,
+                                        RawAddress::kAny, &port_handle_,
+                                        port_mgmt_cback, 0);
+    PORT_SetEventMask(port_handle_, PORT_EV_RXCHAR);
+    PORT_SetEventCallback(port_handle_, port_event_cback);
+    ConnectServerPort();
+  }
+
+  void TearDown(State& st) override {
+    RFCOMM_RemoveServer(port_handle_);
+    bluetooth::l2cap::SetMockInterface(nullptr);
+    bluetooth::manager::SetMockSecurityInternalInterface(nullptr);
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  // Same steps as StackRfcommTest::ConnectServerL2cap() and
+  // StackRfcommTest::ConnectServerPort(), without the expectations.
+  void ConnectServerPort() {
+    tL2CAP_CFG_INFO cfg_req = {.mtu_present = true, .mtu = L2CAP_MTU_SIZE};
+    l2cap_appl_info_.pL2CA_ConnectInd_Cb(kPeerAddress, kLcid, BT_PSM_RFCOMM,
+                                         0x07);
+    cfg_req.mtu_present = false;
+    l2cap_appl_info_.pL2CA_ConfigCfm_Cb(kLcid, L2CAP_CFG_OK, {});
+    l2cap_appl_info_.pL2CA_ConfigInd_Cb(kLcid, &cfg_req);
+    ReceiveFromPeer(CreateQuickSabmPacket(RFCOMM_MX_DLCI, kLcid, kAclHandle));
+
+    uint8_t dlci = GetDlci(false, kScn);
+    ReceiveFromPeer(CreateQuickPnPacket(true, dlci, true, kMtu,
+                                        RFCOMM_PN_CONV_LAYER_CBFC_I >> 4, 0,
+                                        RFCOMM_K_MAX, kLcid, kAclHandle));
+    ReceiveFromPeer(CreateQuickSabmPacket(dlci, kLcid, kAclHandle));
+    security_callback_(&kPeerAddress, BT_TRANSPORT_BR_EDR, p_port_,
+                       BTM_SUCCESS);
+    ReceiveFromPeer(CreateQuickMscPacket(true, dlci, kLcid, kAclHandle, true,
+                                         false, true, true, false, true));
+    ReceiveFromPeer(CreateQuickMscPacket(true, dlci, kLcid, kAclHandle, false,
+                                         false, true, true, false, true));
+  }
+
+  void ReceiveFromPeer(const std::vector<uint8_t>& acl_packet) {
+    l2cap_appl_info_.pL2CA_DataInd_Cb(
+        kLcid, AllocateWrappedIncomingL2capAclPacket(acl_packet));
+  }
+
+  NiceMock<bluetooth::manager::MockBtmSecurityInternalInterface> btm_security_;
+  NiceMock<bluetooth::l2cap::MockL2capInterface> l2cap_;
+  tL2CAP_APPL_INFO l2cap_appl_info_ = {};
+  tBTM_SEC_CALLBACK* security_callback_ = nullptr;
+  void* p_port_ = nullptr;
+  uint16_t port_handle_ = 0;
+};
+
+// Each iteration receives one data frame of state.range(0) bytes, which also
+// returns one credit, reads it from the port and writes it back to the peer.
+BENCHMARK_DEFINE_F(BM_StackRfcomm, echo)(State& state) {
+  const uint16_t length = state.range(0);
+  std::vector<uint8_t> acl_packet = CreateQuickDataPacket(
+      GetDlci(false, kScn), true, kLcid, kAclHandle, 1,
+      std::vector<uint8_t>(length, 0x5a));
+  std::vector<char> buffer(kMtu);
+
+  for (auto _ : state) {
+    ReceiveFromPeer(acl_packet);
+    uint16_t read = 0;
+    PORT_ReadData(port_handle_, buffer.data(), buffer.size(), &read);
+    uint16_t written = 0;
+    PORT_WriteData(port_handle_, buffer.data(), read, &written);
+    if (read != length || written != length) {
+      state.SkipWithError("Data did not make it through the port");
+      break;
+    }
+  }
+  state.SetBytesProcessed(2 * state.iterations() * length);
+}
+
+// CreateRfcommPacket() only uses the two byte length field for lengths with
+// bit 6 set.
+BENCHMARK_REGISTER_F(BM_StackRfcomm, echo)->Arg(127)->Arg(990);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
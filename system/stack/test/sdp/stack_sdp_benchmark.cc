@@ -0,0 +1,153 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <stdlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "stack/include/sdp_api.h"
+#include "stack/include/sdpdefs.h"
+#include "stack/sdp/sdpint.h"
+#include "test/mock/mock_osi_allocator.h"
+#include "test/mock/mock_stack_l2cap_api.h"
+#include "types/bluetooth/uuid.h"
+
+using ::benchmark::State;
+using bluetooth::Uuid;
+
+namespace {
+
+constexpr char kServiceName[] = "serial port";
+
+uint32_t CreateRecord(uint16_t service_class) {
+  uint32_t handle = SDP_CreateRecord();
+  SDP_AddServiceClassIdList(handle, 1, &service_class);
+  SDP_AddAttribute(handle, ATTR_ID_SERVICE_NAME, TEXT_STR_DESC_TYPE,
+                   sizeof(kServiceName), (uint8_t*)kServiceName);
+  SDP_AddProfileDescriptorList(handle, service_class, 0x0102);
+  return handle;
+}
+
+std::vector<uint8_t> BuildSearchAttrReq(uint16_t uuid16,
+                                        uint16_t max_list_len) {
+  std::vector<uint8_t> params = {
+      // ServiceSearchPattern: one 16-bit UUID
+      0x35, 0x03, 0x19, (uint8_t)(uuid16 >> 8), (uint8_t)uuid16,
+      (uint8_t)(max_list_len >> 8), (uint8_t)max_list_len,
+      // AttributeIDList: all attributes
+      0x35, 0x05, 0x0a, 0x00, 0x00, 0xff, 0xff,
+      // No continuation state
+      0x00};
+  std::vector<uint8_t> pdu = {SDP_PDU_SERVICE_SEARCH_ATTR_REQ, 0x00, 0x01,
+                              (uint8_t)(params.size() >> 8),
+                              (uint8_t)params.size()};
+  pdu.insert(pdu.end(), params.begin(), params.end());
+  return pdu;
+}
+
+}  // namespace
+
+// A server database of state.range(0) records of other services, and one
+// serial port record the client looks for, registered last
+class BM_StackSdpServer : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    test::mock::osi_allocator::osi_malloc.body = [](size_t size) {
+      return malloc(size);
+    };
+    test::mock::osi_allocator::osi_free.body = [](void* ptr) { free(ptr); };
+    test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                          BT_HDR* p_data) {
+      free(p_data);
+      return 0;
+    };
+    SDP_DeleteRecord(0);
+    for (int i = 0; i < st.range(0); i++) {
+      CreateRecord(0x2000 + i);
+    }
+    handle_ = CreateRecord(UUID_SERVCLASS_SERIAL_PORT);
+    ccb_.connection_id = 0x40;
+    ccb_.rem_mtu_size = 672;
+  }
+
+  void TearDown(State& st) override {
+    free(ccb_.rsp_list);
+    ccb_ = {};
+    SDP_DeleteRecord(0);
+    test::mock::stack_l2cap_api::L2CA_DataWrite = {};
+    test::mock::osi_allocator::osi_malloc = {};
+    test::mock::osi_allocator::osi_free = {};
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  uint32_t handle_ = 0;
+  tCONN_CB ccb_ = {};
+};
+
+// Looks up the record in the database, as every service search request does
+BENCHMARK_DEFINE_F(BM_StackSdpServer, service_search)(State& state) {
+  tSDP_UUID_SEQ seq = {};
+  seq.num_uids = 1;
+  seq.uuid_entry[0].len = Uuid::kNumBytes16;
+  seq.uuid_entry[0].value[0] = UUID_SERVCLASS_SERIAL_PORT >> 8;
+  seq.uuid_entry[0].value[1] = UUID_SERVCLASS_SERIAL_PORT & 0xff;
+  for (auto _ : state) {
+    const tSDP_RECORD* p_rec = sdp_db_service_search(0, &seq);
+    if (p_rec == nullptr || p_rec->record_handle != handle_) {
+      state.SkipWithError("Serial port record not found");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Answers whole ServiceSearchAttribute requests for the record, from the
+// request PDU to the response handed to L2CAP
+BENCHMARK_DEFINE_F(BM_StackSdpServer, service_search_attr_request)
+(State& state) {
+  std::vector<uint8_t> pdu =
+      BuildSearchAttrReq(UUID_SERVCLASS_SERIAL_PORT, 600);
+  BT_HDR* p_msg = (BT_HDR*)malloc(sizeof(BT_HDR) + pdu.size());
+  for (auto _ : state) {
+    p_msg->offset = 0;
+    p_msg->len = pdu.size();
+    memcpy(p_msg + 1, pdu.data(), pdu.size());
+    sdp_server_handle_client_req(&ccb_, p_msg);
+  }
+  free(p_msg);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_REGISTER_F(BM_StackSdpServer, service_search)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+BENCHMARK_REGISTER_F(BM_StackSdpServer, service_search_attr_request)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "stack/include/sdp_api.h"
+#include "stack/include/sdpdefs.h"
+#include "stack/sdp/sdpint.h"
+#include "test/mock/mock_osi_allocator.h"
+#include "test/mock/mock_stack_l2cap_api.h"
+#include "types/bluetooth/uuid.h"
+
+using bluetooth::Uuid;
+
+namespace {
+
+tSDP_UUID_SEQ MakeUuidSeq(const std::vector<uint16_t>& uuids16) {
+  tSDP_UUID_SEQ seq = {};
+  for (uint16_t uuid16 : uuids16) {
+    tUID_ENT& entry = seq.uuid_entry[seq.num_uids++];
+    entry.len = Uuid::kNumBytes16;
+    entry.value[0] = uuid16 >> 8;
+    entry.value[1] = uuid16 & 0xff;
+  }
+  return seq;
+}
+
+uint32_t CreateRecordWithClasses(std::vector<uint16_t> classes) {
+  uint32_t handle = SDP_CreateRecord();
+  EXPECT_NE(handle, 0u);
+  EXPECT_TRUE(
+      SDP_AddServiceClassIdList(handle, classes.size(), classes.data()));
+  return handle;
+}
+
+std::vector<uint32_t> SearchAll(const tSDP_UUID_SEQ& seq) {
+  std::vector<uint32_t> handles;
+  uint32_t prev_handle = 0;
+  const tSDP_RECORD* p_rec;
+  while ((p_rec = sdp_db_service_search(prev_handle, &seq)) != nullptr) {
+    handles.push_back(p_rec->record_handle);
+    prev_handle = p_rec->record_handle;
+  }
+  return handles;
+}
+
+// Responses the server handed to L2CAP
+std::vector<std::vector<uint8_t>> sent_pdus;
+
+std::vector<uint8_t> BuildSearchAttrReq(uint16_t uuid16, uint16_t max_list_len,
+                                        uint16_t cont_offset) {
+  std::vector<uint8_t> params = {
+      // ServiceSearchPattern: one 16-bit UUID
+      0x35, 0x03, 0x19, (uint8_t)(uuid16 >> 8), (uint8_t)uuid16,
+      (uint8_t)(max_list_len >> 8), (uint8_t)max_list_len,
+      // AttributeIDList: all attributes
+      0x35, 0x05, 0x0a, 0x00, 0x00, 0xff, 0xff};
+  if (cont_offset) {
+    params.insert(params.end(), {SDP_CONTINUATION_LEN,
+                                 (uint8_t)(cont_offset >> 8),
+                                 (uint8_t)cont_offset});
+  } else {
+    params.push_back(0);
+  }
+  std::vector<uint8_t> pdu = {SDP_PDU_SERVICE_SEARCH_ATTR_REQ, 0x00, 0x01,
+                              (uint8_t)(params.size() >> 8),
+                              (uint8_t)params.size()};
+  pdu.insert(pdu.end(), params.begin(), params.end());
+  return pdu;
+}
+
+// What the per-attribute path sends for the records: a sequence of attribute
+// lists, one per record
+std::vector<uint8_t> ExpectedAttributeLists(
+    const std::vector<uint32_t>& handles) {
+  std::vector<uint8_t> lists;
+  for (uint32_t handle : handles) {
+    const tSDP_RECORD* p_rec = sdp_db_find_record(handle);
+    std::vector<uint8_t> entries;
+    for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++) {
+      uint8_t entry[SDP_MAX_ATTR_LEN + 8];
+      uint8_t* p_end = sdpu_build_attrib_entry(entry, &p_rec->attribute[xx]);
+      entries.insert(entries.end(), entry, p_end);
+    }
+    lists.insert(lists.end(),
+                 {(DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD,
+                  (uint8_t)(entries.size() >> 8), (uint8_t)entries.size()});
+    lists.insert(lists.end(), entries.begin(), entries.end());
+  }
+  std::vector<uint8_t> header;
+  if (lists.size() + 3 > 255) {
+    header = {(DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_WORD,
+              (uint8_t)(lists.size() >> 8), (uint8_t)lists.size()};
+  } else {
+    header = {(DATA_ELE_SEQ_DESC_TYPE << 3) | SIZE_IN_NEXT_BYTE,
+              (uint8_t)lists.size()};
+  }
+  lists.insert(lists.begin(), header.begin(), header.end());
+  return lists;
+}
+
+}  // namespace
+
+class StackSdpDbTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    test::mock::osi_allocator::osi_malloc.body = [](size_t size) {
+      return malloc(size);
+    };
+    test::mock::osi_allocator::osi_free.body = [](void* ptr) { free(ptr); };
+    SDP_DeleteRecord(0);
+  }
+
+  void TearDown() override {
+    SDP_DeleteRecord(0);
+    test::mock::osi_allocator::osi_malloc = {};
+    test::mock::osi_allocator::osi_free = {};
+  }
+};
+
+TEST_F(StackSdpDbTest, search_by_uuid) {
+  CreateRecordWithClasses({UUID_SERVCLASS_AUDIO_SOURCE});
+  uint32_t sink = CreateRecordWithClasses({UUID_SERVCLASS_AUDIO_SINK});
+  CreateRecordWithClasses({UUID_SERVCLASS_HF_HANDSFREE});
+
+  ASSERT_EQ(SearchAll(MakeUuidSeq({UUID_SERVCLASS_AUDIO_SINK})),
+            std::vector<uint32_t>({sink}));
+  ASSERT_TRUE(SearchAll(MakeUuidSeq({UUID_SERVCLASS_PANU})).empty());
+
+  // The 128-bit form of a 16-bit UUID matches too
+  tSDP_UUID_SEQ seq = {};
+  seq.num_uids = 1;
+  seq.uuid_entry[0].len = Uuid::kNumBytes128;
+  Uuid::UUID128Bit uuid128 =
+      Uuid::From16Bit(UUID_SERVCLASS_AUDIO_SINK).To128BitBE();
+  memcpy(seq.uuid_entry[0].value, uuid128.data(), Uuid::kNumBytes128);
+  ASSERT_EQ(SearchAll(seq), std::vector<uint32_t>({sink}));
+}
+
+TEST_F(StackSdpDbTest, search_requires_all_uuids) {
+  uint32_t both = CreateRecordWithClasses(
+      {UUID_SERVCLASS_HF_HANDSFREE, UUID_SERVCLASS_GENERIC_AUDIO});
+  uint32_t audio = CreateRecordWithClasses({UUID_SERVCLASS_GENERIC_AUDIO});
+
+  ASSERT_EQ(SearchAll(MakeUuidSeq({UUID_SERVCLASS_GENERIC_AUDIO})),
+            std::vector<uint32_t>({both, audio}));
+  ASSERT_EQ(SearchAll(MakeUuidSeq(
+                {UUID_SERVCLASS_GENERIC_AUDIO, UUID_SERVCLASS_HF_HANDSFREE})),
+            std::vector<uint32_t>({both}));
+  ASSERT_EQ(SearchAll(MakeUuidSeq({})), std::vector<uint32_t>({both, audio}));
+}
+
+TEST_F(StackSdpDbTest, search_follows_record_changes) {
+  uint32_t handle = CreateRecordWithClasses({UUID_SERVCLASS_PBAP_PSE});
+  tSDP_UUID_SEQ seq = MakeUuidSeq({UUID_SERVCLASS_PBAP_PSE});
+  ASSERT_EQ(SearchAll(seq), std::vector<uint32_t>({handle}));
+
+  ASSERT_TRUE(SDP_DeleteAttribute(handle, ATTR_ID_SERVICE_CLASS_ID_LIST));
+  ASSERT_TRUE(SearchAll(seq).empty());
+
+  uint16_t pse = UUID_SERVCLASS_PBAP_PSE;
+  ASSERT_TRUE(SDP_AddServiceClassIdList(handle, 1, &pse));
+  ASSERT_EQ(SearchAll(seq), std::vector<uint32_t>({handle}));
+
+  ASSERT_TRUE(SDP_DeleteRecord(handle));
+  ASSERT_TRUE(SearchAll(seq).empty());
+  ASSERT_EQ(sdp_db_find_record(handle), nullptr);
+}
+
+TEST_F(StackSdpDbTest, no_record_limit) {
+  std::vector<uint32_t> handles;
+  for (int i = 0; i < SDP_MAX_RECORDS * 4; i++) {
+    handles.push_back(CreateRecordWithClasses({UUID_SERVCLASS_SERIAL_PORT}));
+  }
+  ASSERT_EQ(SearchAll(MakeUuidSeq({UUID_SERVCLASS_SERIAL_PORT})), handles);
+}
+
+TEST_F(StackSdpDbTest, encoded_attrs) {
+  uint32_t handle = CreateRecordWithClasses({UUID_SERVCLASS_AUDIO_SINK});
+  uint8_t name[] = "sink";
+  ASSERT_TRUE(SDP_AddAttribute(handle, ATTR_ID_SERVICE_NAME, TEXT_STR_DESC_TYPE,
+                               sizeof(name), name));
+  const tSDP_RECORD* p_rec = sdp_db_find_record(handle);
+  ASSERT_NE(p_rec, nullptr);
+
+  auto check_encoding = [p_rec]() {
+    tSDP_ENCODED_ATTRS encoded;
+    ASSERT_TRUE(sdp_db_get_encoded_attrs(p_rec, &encoded));
+    for (uint16_t xx = 0; xx < p_rec->num_attributes; xx++) {
+      uint8_t expected[SDP_MAX_ATTR_LEN + 8];
+      uint16_t len =
+          sdpu_build_attrib_entry(expected, &p_rec->attribute[xx]) - expected;
+      ASSERT_EQ(encoded.p_offsets[xx + 1] - encoded.p_offsets[xx], len);
+      ASSERT_EQ(
+          memcmp(encoded.p_data + encoded.p_offsets[xx], expected, len), 0);
+    }
+  };
+  check_encoding();
+
+  // Adding an attribute drops the cached encoding
+  uint16_t version = 0x0103;
+  ASSERT_TRUE(SDP_AddProfileDescriptorList(
+      handle, UUID_SERVCLASS_ADV_AUDIO_DISTRIBUTION, version));
+  ASSERT_EQ(p_rec->num_attributes, 3);
+  check_encoding();
+
+  // A copy of a record is not part of the database
+  tSDP_RECORD copy = *p_rec;
+  tSDP_ENCODED_ATTRS encoded;
+  ASSERT_FALSE(sdp_db_get_encoded_attrs(&copy, &encoded));
+}
+
+class StackSdpServerTest : public StackSdpDbTest {
+ protected:
+  void SetUp() override {
+    StackSdpDbTest::SetUp();
+    test::mock::stack_l2cap_api::L2CA_DataWrite.body = [](uint16_t cid,
+                                                          BT_HDR* p_data) {
+      uint8_t* p = (uint8_t*)(p_data + 1) + p_data->offset;
+      sent_pdus.emplace_back(p, p + p_data->len);
+      free(p_data);
+      return 0;
+    };
+    sent_pdus.clear();
+    ccb_.connection_id = 0x40;
+    ccb_.rem_mtu_size = 672;
+  }
+
+  void TearDown() override {
+    free(ccb_.rsp_list);
+    test::mock::stack_l2cap_api::L2CA_DataWrite = {};
+    StackSdpDbTest::TearDown();
+  }
+
+  void HandleRequest(const std::vector<uint8_t>& pdu) {
+    BT_HDR* p_msg = (BT_HDR*)malloc(sizeof(BT_HDR) + pdu.size());
+    p_msg->offset = 0;
+    p_msg->len = pdu.size();
+    memcpy(p_msg + 1, pdu.data(), pdu.size());
+    sdp_server_handle_client_req(&ccb_, p_msg);
+    free(p_msg);
+  }
+
+  // Runs a ServiceSearchAttribute transaction to the end, following
+  // continuation states, and returns the reassembled attribute lists
+  std::vector<uint8_t> SearchAttr(uint16_t uuid16, uint16_t max_list_len,
+                                  size_t* num_responses) {
+    std::vector<uint8_t> lists;
+    uint16_t cont_offset = 0;
+    *num_responses = 0;
+    do {
+      HandleRequest(BuildSearchAttrReq(uuid16, max_list_len, cont_offset));
+      EXPECT_EQ(sent_pdus.size(), *num_responses + 1);
+      const std::vector<uint8_t>& rsp = sent_pdus.back();
+      EXPECT_EQ(rsp[0], SDP_PDU_SERVICE_SEARCH_ATTR_RSP);
+      if (rsp[0] != SDP_PDU_SERVICE_SEARCH_ATTR_RSP) return {};
+      uint16_t byte_count = (rsp[5] << 8) | rsp[6];
+      EXPECT_LE(byte_count, max_list_len);
+      lists.insert(lists.end(), rsp.begin() + 7,
+                   rsp.begin() + 7 + byte_count);
+      const uint8_t* p_cont = &rsp[7 + byte_count];
+      cont_offset = p_cont[0] ? (p_cont[1] << 8) | p_cont[2] : 0;
+      (*num_responses)++;
+    } while (cont_offset != 0 && *num_responses < 1000);
+    return lists;
+  }
+
+  uint32_t CreateNamedRecord(uint16_t service_class, const char* name) {
+    uint32_t handle = CreateRecordWithClasses({service_class});
+    EXPECT_TRUE(SDP_AddAttribute(handle, ATTR_ID_SERVICE_NAME,
+                                 TEXT_STR_DESC_TYPE, strlen(name) + 1,
+                                 (uint8_t*)name));
+    EXPECT_TRUE(SDP_AddProfileDescriptorList(handle, service_class, 0x0102));
+    return handle;
+  }
+
+  tCONN_CB ccb_ = {};
+};
+
+TEST_F(StackSdpServerTest, search_attr_multi_record_response) {
+  std::vector<uint32_t> handles = {
+      CreateNamedRecord(UUID_SERVCLASS_SERIAL_PORT, "serial port one"),
+      CreateNamedRecord(UUID_SERVCLASS_SERIAL_PORT, "serial port two"),
+      CreateNamedRecord(UUID_SERVCLASS_SERIAL_PORT, "serial port three")};
+  CreateNamedRecord(UUID_SERVCLASS_AUDIO_SINK, "sink");
+
+  size_t num_responses;
+  ASSERT_EQ(SearchAttr(UUID_SERVCLASS_SERIAL_PORT, 600, &num_responses),
+            ExpectedAttributeLists(handles));
+  ASSERT_EQ(num_responses, 1u);
+}
+
+TEST_F(StackSdpServerTest, search_attr_continuation_response) {
+  std::vector<uint32_t> handles;
+  for (int i = 0; i < 8; i++) {
+    handles.push_back(CreateNamedRecord(
+        UUID_SERVCLASS_SERIAL_PORT, "a service name that is split over PDUs"));
+  }
+  std::vector<uint8_t> expected = ExpectedAttributeLists(handles);
+  ASSERT_GT(expected.size(), 255u);
+
+  // Whole attributes are copied from the encoded records, the names that
+  // straddle a response boundary go through the partial attribute path
+  for (uint16_t max_list_len : {16, 37, 100}) {
+    size_t num_responses;
+    ASSERT_EQ(SearchAttr(UUID_SERVCLASS_SERIAL_PORT, max_list_len,
+                         &num_responses),
+              expected);
+    ASSERT_GE(num_responses, expected.size() / max_list_len);
+  }
+}
+
+TEST_F(StackSdpServerTest, search_attr_malformed_continuation) {
+  for (int i = 0; i < 4; i++) {
+    CreateNamedRecord(UUID_SERVCLASS_SERIAL_PORT, "serial port");
+  }
+  HandleRequest(BuildSearchAttrReq(UUID_SERVCLASS_SERIAL_PORT, 16, 0));
+  ASSERT_EQ(sent_pdus.back()[0], SDP_PDU_SERVICE_SEARCH_ATTR_RSP);
+
+  // A continuation state the server never handed out is rejected
+  HandleRequest(BuildSearchAttrReq(UUID_SERVCLASS_SERIAL_PORT, 16, 0x1234));
+  const std::vector<uint8_t>& rsp = sent_pdus.back();
+  ASSERT_EQ(rsp[0], SDP_PDU_ERROR_RESPONSE);
+  ASSERT_EQ((rsp[5] << 8) | rsp[6], SDP_INVALID_CONT_STATE);
+
+  // and a fresh request still gets the whole answer
+  size_t num_responses;
+  std::vector<uint32_t> handles =
+      SearchAll(MakeUuidSeq({UUID_SERVCLASS_SERIAL_PORT}));
+  sent_pdus.clear();
+  ASSERT_EQ(SearchAttr(UUID_SERVCLASS_SERIAL_PORT, 600, &num_responses),
+            ExpectedAttributeLists(handles));
+}
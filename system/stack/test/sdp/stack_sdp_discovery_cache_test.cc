@@ -0,0 +1,275 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/init_flags.h"
+#include "stack/include/sdp_api.h"
+#include "stack/include/sdpdefs.h"
+#include "stack/sdp/sdpint.h"
+#include "test/mock/mock_btif_config.h"
+#include "test/mock/mock_stack_btm_sec.h"
+#include "types/bluetooth/uuid.h"
+#include "types/raw_address.h"
+
+using bluetooth::Uuid;
+
+namespace {
+
+const char* test_flags_cache_enabled[] = {
+    "INIT_sdp_discovery_cache=true",
+    nullptr,
+};
+
+const char* test_flags_cache_disabled[] = {
+    "INIT_sdp_discovery_cache=false",
+    nullptr,
+};
+
+constexpr uint32_t kDbLen = 4096;
+const RawAddress kPeer = RawAddress({0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6});
+
+// A complete response holding one Audio Sink record with supported features
+// 0x0311
+const std::vector<uint8_t> kSinkResponse = {
+    0x35, 0x10,                    // sequence of records
+    0x35, 0x0e,                    // record
+    0x09, 0x00, 0x01,              // service class ID list
+    0x35, 0x03, 0x19, 0x11, 0x0b,  // Audio Sink
+    0x09, 0x03, 0x11,              // supported features
+    0x09, 0x03, 0x11,
+};
+
+// A complete response holding the Service Discovery Server record with
+// ServiceDatabaseState 0x00000001
+const std::vector<uint8_t> kSdsResponse = {
+    0x35, 0x12,                                // sequence of records
+    0x35, 0x10,                                // record
+    0x09, 0x00, 0x01,                          // service class ID list
+    0x35, 0x03, 0x19, 0x10, 0x00,              // Service Discovery Server
+    0x09, 0x02, 0x01,                          // service database state
+    0x0a, 0x00, 0x00, 0x00, 0x01,
+};
+
+std::map<std::pair<std::string, std::string>, std::vector<uint8_t>> config;
+
+}  // namespace
+
+class StackSdpDiscoveryCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    bluetooth::common::InitFlags::Load(test_flags_cache_enabled);
+    config.clear();
+    test::mock::btif_config::btif_config_exist.body =
+        [](const std::string& section, const std::string& key) {
+          return config.count({section, key}) != 0;
+        };
+    test::mock::btif_config::btif_config_remove.body =
+        [](const std::string& section, const std::string& key) {
+          return config.erase({section, key}) != 0;
+        };
+    test::mock::btif_config::btif_config_set_bin.body =
+        [](const std::string& section, const std::string& key,
+           const uint8_t* value, size_t length) {
+          config[{section, key}] = std::vector<uint8_t>(value, value + length);
+          return true;
+        };
+    test::mock::btif_config::btif_config_get_bin_length.body =
+        [](const std::string& section, const std::string& key) -> size_t {
+      auto it = config.find({section, key});
+      return it == config.end() ? 0 : it->second.size();
+    };
+    test::mock::btif_config::btif_config_get_bin.body =
+        [](const std::string& section, const std::string& key, uint8_t* value,
+           size_t* length) {
+          auto it = config.find({section, key});
+          if (it == config.end() || *length < it->second.size()) return false;
+          std::copy(it->second.begin(), it->second.end(), value);
+          *length = it->second.size();
+          return true;
+        };
+    test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev.body =
+        [](const RawAddress& bda) { return true; };
+    p_db_ = (tSDP_DISCOVERY_DB*)malloc(kDbLen);
+    InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  }
+
+  void TearDown() override {
+    SDP_InvalidateDiscoveryCache(kPeer);
+    free(p_db_);
+    test::mock::btif_config::btif_config_exist = {};
+    test::mock::btif_config::btif_config_remove = {};
+    test::mock::btif_config::btif_config_set_bin = {};
+    test::mock::btif_config::btif_config_get_bin_length = {};
+    test::mock::btif_config::btif_config_get_bin = {};
+    test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev = {};
+    bluetooth::common::InitFlags::Load(test_flags_cache_disabled);
+  }
+
+  void InitDb(uint16_t service_uuid,
+              uint16_t attr_id = ATTR_ID_SUPPORTED_FEATURES) {
+    Uuid uuid = Uuid::From16Bit(service_uuid);
+    uint16_t attrs[] = {ATTR_ID_SERVICE_CLASS_ID_LIST, attr_id};
+    ASSERT_TRUE(SDP_InitDiscoveryDb(p_db_, kDbLen, 1, &uuid, 2, attrs));
+  }
+
+  // Completes a live search of the Service Discovery Server record that
+  // reports the given ServiceDatabaseState
+  void StoreSdsResponse(uint8_t db_state) {
+    InitDb(UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER,
+           ATTR_ID_SERVICE_DATABASE_STATE);
+    std::vector<uint8_t> rsp = kSdsResponse;
+    rsp.back() = db_state;
+    ASSERT_TRUE(sdp_disc_load_attr_lists(p_db_, kPeer, rsp.data(), rsp.size()));
+    sdp_disc_cache_store(kPeer, p_db_, rsp.data(), rsp.size());
+  }
+
+  void StoreSinkResponse() {
+    std::vector<uint8_t> rsp = kSinkResponse;
+    sdp_disc_cache_store(kPeer, p_db_, rsp.data(), rsp.size());
+  }
+
+  // Drops the in-memory cache of the peer but keeps its config, as after a
+  // restart
+  void Restart() {
+    auto saved = config;
+    SDP_InvalidateDiscoveryCache(kPeer);
+    config = saved;
+  }
+
+  tSDP_DISCOVERY_DB* p_db_ = nullptr;
+};
+
+TEST_F(StackSdpDiscoveryCacheTest, miss_then_hit) {
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+
+  StoreSinkResponse();
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_TRUE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+
+  tSDP_DISC_REC* p_rec =
+      SDP_FindServiceInDb(p_db_, UUID_SERVCLASS_AUDIO_SINK, nullptr);
+  ASSERT_NE(p_rec, nullptr);
+  ASSERT_EQ(p_rec->remote_bd_addr, kPeer);
+  tSDP_DISC_ATTR* p_attr =
+      SDP_FindAttributeInRec(p_rec, ATTR_ID_SUPPORTED_FEATURES);
+  ASSERT_NE(p_attr, nullptr);
+  ASSERT_EQ(p_attr->attr_value.v.u16, 0x0311);
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, other_filters_miss) {
+  StoreSinkResponse();
+  InitDb(UUID_SERVCLASS_AUDIO_SOURCE);
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(
+      RawAddress({0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6}), p_db_));
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, disabled) {
+  bluetooth::common::InitFlags::Load(test_flags_cache_disabled);
+  StoreSinkResponse();
+  ASSERT_TRUE(config.empty());
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, loaded_from_config) {
+  StoreSinkResponse();
+  ASSERT_EQ(config.size(), 1u);
+  Restart();
+
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_TRUE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  ASSERT_NE(SDP_FindServiceInDb(p_db_, UUID_SERVCLASS_AUDIO_SINK, nullptr),
+            nullptr);
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, expired) {
+  StoreSinkResponse();
+  // Move the time the response was stored to 1970
+  std::vector<uint8_t>& blob = config.begin()->second;
+  std::fill(blob.begin() + 7, blob.begin() + 15, 0);
+  Restart();
+
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  ASSERT_TRUE(config.empty());
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, invalidate) {
+  StoreSinkResponse();
+  SDP_InvalidateDiscoveryCache(kPeer);
+  ASSERT_TRUE(config.empty());
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, bad_response_leaves_db_unchanged) {
+  std::vector<uint8_t> rsp = kSinkResponse;
+  rsp[3] = 0x20;  // record longer than the response
+  sdp_disc_cache_store(kPeer, p_db_, rsp.data(), rsp.size());
+
+  uint32_t mem_free = p_db_->mem_free;
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  ASSERT_EQ(p_db_->p_first_rec, nullptr);
+  ASSERT_EQ(p_db_->mem_free, mem_free);
+  ASSERT_TRUE(config.empty());
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, not_bonded_not_cached) {
+  test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev.body =
+      [](const RawAddress& bda) { return false; };
+  StoreSinkResponse();
+  ASSERT_TRUE(config.empty());
+
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, not_served_once_unbonded) {
+  StoreSinkResponse();
+  test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev.body =
+      [](const RawAddress& bda) { return false; };
+
+  // Whether it was loaded in memory or is still in the config
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  Restart();
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+}
+
+TEST_F(StackSdpDiscoveryCacheTest, ttl_only_until_database_state_seen) {
+  // Profile searches carry no ServiceDatabaseState, so a result stays in use
+  // whatever happened to the records of the peer
+  StoreSinkResponse();
+  StoreSdsResponse(1);
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_TRUE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+
+  // Once a live result reports a new state, the other results are dropped
+  StoreSdsResponse(2);
+  InitDb(UUID_SERVCLASS_AUDIO_SINK);
+  ASSERT_FALSE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+  InitDb(UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER,
+         ATTR_ID_SERVICE_DATABASE_STATE);
+  ASSERT_TRUE(SDP_FindInDiscoveryCache(kPeer, p_db_));
+}
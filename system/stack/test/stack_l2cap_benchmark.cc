@@ -0,0 +1,165 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+#include <vector>
+
+#include "common/init_flags.h"
+#include "internal_include/bt_trace.h"
+#include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/include/bt_hdr.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/l2cdefs.h"
+#include "stack/l2cap/l2c_int.h"
+
+using ::benchmark::State;
+
+tBTM_CB btm_cb;
+extern tL2C_CB l2cb;
+
+// Global trace level referred in the code under test
+uint8_t appl_trace_level = BT_TRACE_LEVEL_NONE;
+
+namespace {
+
+constexpr uint16_t kMps = 1010;
+constexpr uint8_t kTxWindow = 10;
+
+}  // namespace
+
+// Sends SDUs over an ERTM channel one transmit window at a time: segment them,
+// hand each I-frame to the "controller" the way l2c_link_send_to_lower() does,
+// keep it for retransmission, then ack the whole window.
+class BM_StackL2capErtm : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    bluetooth::common::InitFlags::SetAllForTesting();
+    l2c_init();
+    l2cb.l2cap_trace_level = BT_TRACE_LEVEL_NONE;
+    p_lcb_ = &l2cb.lcb_pool[0];
+    p_lcb_->in_use = true;
+    p_ccb_ = &l2cb.ccb_pool[0];
+    p_ccb_->in_use = true;
+    p_ccb_->p_lcb = p_lcb_;
+    p_ccb_->local_cid = L2CAP_BASE_APPL_CID;
+    p_ccb_->remote_cid = L2CAP_BASE_APPL_CID;
+    p_ccb_->peer_cfg.fcr.mode = L2CAP_FCR_ERTM_MODE;
+    p_ccb_->tx_mps = kMps;
+    p_ccb_->xmit_hold_q = fixed_queue_new(SIZE_MAX);
+    p_ccb_->fcrb.waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
+    p_ccb_->fcrb.retrans_q = fixed_queue_new(SIZE_MAX);
+    wire_.resize(HCI_DATA_PREAMBLE_SIZE + L2CAP_MAX_HEADER_FCS + kMps);
+  }
+
+  void TearDown(State& st) override {
+    fixed_queue_free(p_ccb_->xmit_hold_q, osi_free);
+    fixed_queue_free(p_ccb_->fcrb.waiting_for_ack_q, osi_free);
+    fixed_queue_free(p_ccb_->fcrb.retrans_q, osi_free);
+    p_ccb_->xmit_hold_q = nullptr;
+    p_ccb_->fcrb.waiting_for_ack_q = nullptr;
+    p_ccb_->fcrb.retrans_q = nullptr;
+    p_ccb_->in_use = false;
+    p_lcb_->in_use = false;
+    l2c_free();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void QueueSdu(uint16_t len) {
+    BT_HDR* p_buf = (BT_HDR*)osi_malloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET +
+                                        len + L2CAP_FCS_LEN);
+    p_buf->event = 0;
+    p_buf->offset = L2CAP_MIN_OFFSET;
+    p_buf->len = len;
+    p_buf->layer_specific = 0;
+    memset(p_buf->data + p_buf->offset, 0x5a, len);
+    fixed_queue_enqueue(p_ccb_->xmit_hold_q, p_buf);
+  }
+
+  // The copy made by ACL_WriteDataCopy() on the way to the controller
+  void CopyToController(BT_HDR* p_buf) {
+    p_buf->offset -= HCI_DATA_PREAMBLE_SIZE;
+    p_buf->len += HCI_DATA_PREAMBLE_SIZE;
+    memcpy(wire_.data(), p_buf->data + p_buf->offset, p_buf->len);
+  }
+
+  void AckWindow() {
+    while (!fixed_queue_is_empty(p_ccb_->fcrb.waiting_for_ack_q)) {
+      osi_free(fixed_queue_try_dequeue(p_ccb_->fcrb.waiting_for_ack_q));
+    }
+  }
+
+  tL2C_LCB* p_lcb_ = nullptr;
+  tL2C_CCB* p_ccb_ = nullptr;
+  std::vector<uint8_t> wire_;
+};
+
+// The sent I-frame itself is kept for retransmission.
+BENCHMARK_DEFINE_F(BM_StackL2capErtm, retain_sent_frame)(State& state) {
+  const uint16_t sdu_len = state.range(0);
+  for (auto _ : state) {
+    for (int i = 0; i < kTxWindow; i++) QueueSdu(sdu_len);
+    while (!fixed_queue_is_empty(p_ccb_->xmit_hold_q)) {
+      bool retain = false;
+      BT_HDR* p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb_, 0, &retain);
+      CopyToController(p_buf);
+      l2c_fcr_retain_sent_buf(p_lcb_, p_buf);
+    }
+    AckWindow();
+  }
+  state.SetBytesProcessed(state.iterations() * kTxWindow * sdu_len);
+}
+
+// A clone of each I-frame is kept for retransmission and the sent frame is
+// freed, as the stack did before l2c_fcr_retain_sent_buf().
+BENCHMARK_DEFINE_F(BM_StackL2capErtm, clone_sent_frame)(State& state) {
+  const uint16_t sdu_len = state.range(0);
+  for (auto _ : state) {
+    for (int i = 0; i < kTxWindow; i++) QueueSdu(sdu_len);
+    while (!fixed_queue_is_empty(p_ccb_->xmit_hold_q)) {
+      bool retain = false;
+      BT_HDR* p_buf = l2c_fcr_get_next_xmit_sdu_seg(p_ccb_, 0, &retain);
+      fixed_queue_enqueue(
+          p_ccb_->fcrb.waiting_for_ack_q,
+          l2c_fcr_clone_buf(p_buf, HCI_DATA_PREAMBLE_SIZE, p_buf->len));
+      CopyToController(p_buf);
+      osi_free(p_buf);
+    }
+    AckWindow();
+  }
+  state.SetBytesProcessed(state.iterations() * kTxWindow * sdu_len);
+}
+
+BENCHMARK_REGISTER_F(BM_StackL2capErtm, retain_sent_frame)
+    ->Arg(672)
+    ->Arg(kMps)
+    ->Arg(4000);
+BENCHMARK_REGISTER_F(BM_StackL2capErtm, clone_sent_frame)
+    ->Arg(672)
+    ->Arg(kMps)
+    ->Arg(4000);
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
@@ -28,8 +28,9 @@
 tBTM_CB btm_cb;
 extern tL2C_CB l2cb;
 
-void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf);
-void l2c_link_send_to_lower_ble(tL2C_LCB* p_lcb, BT_HDR* p_buf);
+void l2c_link_send_to_lower_br_edr(tL2C_LCB* p_lcb, BT_HDR* p_buf,
+                                   bool retain);
+void l2c_link_send_to_lower_ble(tL2C_LCB* p_lcb, BT_HDR* p_buf, bool retain);
 
 // Global trace level referred in the code under test
 uint8_t appl_trace_level = BT_TRACE_LEVEL_VERBOSE;
@@ -249,3 +250,66 @@ TEST_F(StackL2capTest, l2cap_result_code_text) {
           static_cast<tL2CAP_CONN>(std::numeric_limits<std::uint16_t>::max()))
           .c_str());
 }
+
+class StackL2capFcrTest : public StackL2capTest {
+ protected:
+  void SetUp() override {
+    StackL2capTest::SetUp();
+    p_lcb_ = &l2cb.lcb_pool[0];
+    p_lcb_->in_use = true;
+    p_ccb_ = &l2cb.ccb_pool[0];
+    p_ccb_->in_use = true;
+    p_ccb_->p_lcb = p_lcb_;
+    p_ccb_->local_cid = L2CAP_BASE_APPL_CID;
+    p_ccb_->peer_cfg.fcr.mode = L2CAP_FCR_ERTM_MODE;
+    p_ccb_->fcrb.waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
+  }
+
+  void TearDown() override {
+    fixed_queue_free(p_ccb_->fcrb.waiting_for_ack_q, osi_free);
+    p_ccb_->fcrb.waiting_for_ack_q = nullptr;
+    p_ccb_->in_use = false;
+    p_lcb_->in_use = false;
+    StackL2capTest::TearDown();
+  }
+
+  // An I-frame as handed to the lower layer: HCI header, L2CAP header,
+  // control word, payload and FCS.
+  BT_HDR* SentIFrame(uint16_t cid, uint16_t payload_len) {
+    uint16_t len = HCI_DATA_PREAMBLE_SIZE + L2CAP_PKT_OVERHEAD +
+                   L2CAP_FCR_OVERHEAD + payload_len + L2CAP_FCS_LEN;
+    BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET +
+                                        len);
+    p_buf->event = cid;
+    p_buf->offset = L2CAP_MIN_OFFSET - HCI_DATA_PREAMBLE_SIZE;
+    p_buf->len = len;
+    p_buf->layer_specific = L2CAP_FCR_UNSEG_SDU;
+    return p_buf;
+  }
+
+  tL2C_LCB* p_lcb_ = nullptr;
+  tL2C_CCB* p_ccb_ = nullptr;
+};
+
+TEST_F(StackL2capFcrTest, l2c_fcr_retain_sent_buf__ertm) {
+  BT_HDR* p_buf = SentIFrame(L2CAP_BASE_APPL_CID, 20);
+
+  l2c_fcr_retain_sent_buf(p_lcb_, p_buf);
+
+  ASSERT_EQ(1U, fixed_queue_length(p_ccb_->fcrb.waiting_for_ack_q));
+  BT_HDR* p_wack =
+      (BT_HDR*)fixed_queue_try_peek_first(p_ccb_->fcrb.waiting_for_ack_q);
+  ASSERT_EQ(p_buf, p_wack);
+  ASSERT_EQ(L2CAP_MIN_OFFSET, p_wack->offset);
+  ASSERT_EQ(L2CAP_PKT_OVERHEAD + L2CAP_FCR_OVERHEAD + 20, p_wack->len);
+  ASSERT_EQ(L2CAP_FCR_UNSEG_SDU, p_wack->layer_specific);
+}
+
+TEST_F(StackL2capFcrTest, l2c_fcr_retain_sent_buf__channel_gone) {
+  l2c_fcr_retain_sent_buf(p_lcb_, SentIFrame(L2CAP_BASE_APPL_CID + 1, 20));
+  ASSERT_TRUE(fixed_queue_is_empty(p_ccb_->fcrb.waiting_for_ack_q));
+
+  p_ccb_->peer_cfg.fcr.mode = L2CAP_FCR_BASIC_MODE;
+  l2c_fcr_retain_sent_buf(p_lcb_, SentIFrame(L2CAP_BASE_APPL_CID, 20));
+  ASSERT_TRUE(fixed_queue_is_empty(p_ccb_->fcrb.waiting_for_ack_q));
+}
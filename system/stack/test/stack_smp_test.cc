@@ -18,6 +18,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <string>
 
@@ -372,8 +373,8 @@ TEST(SmpEccValidationTest, test_valid_points) {
 
 TEST(SmpEccValidationTest, test_invalid_points) {
   Point p;
-  multiprecision_init(p.x);
-  multiprecision_init(p.y);
+  memset(p.x, 0, sizeof(p.x));
+  memset(p.y, 0, sizeof(p.y));
 
   EXPECT_FALSE(ECC_ValidatePoint(p));
 
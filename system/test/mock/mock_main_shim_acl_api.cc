@@ -58,6 +58,9 @@ void bluetooth::shim::ACL_ConfigureLePrivacy(bool is_le_privacy_enabled) {
 void bluetooth::shim::ACL_WriteData(uint16_t handle, BT_HDR* p_buf) {
   inc_func_call_count(__func__);
 }
+void bluetooth::shim::ACL_WriteDataCopy(uint16_t handle, const BT_HDR* p_buf) {
+  inc_func_call_count(__func__);
+}
 void bluetooth::shim::ACL_Disconnect(uint16_t handle, bool is_classic,
                                      tHCI_STATUS reason, std::string comment) {
   inc_func_call_count(__func__);
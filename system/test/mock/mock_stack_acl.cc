@@ -123,6 +123,8 @@ struct acl_process_supported_features acl_process_supported_features;
 struct acl_rcv_acl_data acl_rcv_acl_data;
 struct acl_reject_connection_request acl_reject_connection_request;
 struct acl_send_data_packet_ble acl_send_data_packet_ble;
+struct acl_send_data_packet_copy_br_edr acl_send_data_packet_copy_br_edr;
+struct acl_send_data_packet_copy_ble acl_send_data_packet_copy_ble;
 struct acl_set_disconnect_reason acl_set_disconnect_reason;
 struct acl_write_automatic_flush_timeout acl_write_automatic_flush_timeout;
 struct btm_acl_connected btm_acl_connected;
@@ -515,6 +517,16 @@ void acl_send_data_packet_ble(const RawAddress& bd_addr, BT_HDR* p_buf) {
   inc_func_call_count(__func__);
   test::mock::stack_acl::acl_send_data_packet_ble(bd_addr, p_buf);
 }
+void acl_send_data_packet_copy_br_edr(const RawAddress& bd_addr,
+                                      const BT_HDR* p_buf) {
+  inc_func_call_count(__func__);
+  test::mock::stack_acl::acl_send_data_packet_copy_br_edr(bd_addr, p_buf);
+}
+void acl_send_data_packet_copy_ble(const RawAddress& bd_addr,
+                                   const BT_HDR* p_buf) {
+  inc_func_call_count(__func__);
+  test::mock::stack_acl::acl_send_data_packet_copy_ble(bd_addr, p_buf);
+}
 void acl_set_disconnect_reason(tHCI_STATUS acl_disc_reason) {
   inc_func_call_count(__func__);
   test::mock::stack_acl::acl_set_disconnect_reason(acl_disc_reason);
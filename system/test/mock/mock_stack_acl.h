@@ -824,6 +824,28 @@ struct acl_send_data_packet_ble {
   };
 };
 extern struct acl_send_data_packet_ble acl_send_data_packet_ble;
+// Name: acl_send_data_packet_copy_br_edr
+// Params: const RawAddress& bd_addr, const BT_HDR* p_buf
+// Returns: void
+struct acl_send_data_packet_copy_br_edr {
+  std::function<void(const RawAddress& bd_addr, const BT_HDR* p_buf)> body{
+      [](const RawAddress& bd_addr, const BT_HDR* p_buf) { ; }};
+  void operator()(const RawAddress& bd_addr, const BT_HDR* p_buf) {
+    body(bd_addr, p_buf);
+  };
+};
+extern struct acl_send_data_packet_copy_br_edr acl_send_data_packet_copy_br_edr;
+// Name: acl_send_data_packet_copy_ble
+// Params: const RawAddress& bd_addr, const BT_HDR* p_buf
+// Returns: void
+struct acl_send_data_packet_copy_ble {
+  std::function<void(const RawAddress& bd_addr, const BT_HDR* p_buf)> body{
+      [](const RawAddress& bd_addr, const BT_HDR* p_buf) { ; }};
+  void operator()(const RawAddress& bd_addr, const BT_HDR* p_buf) {
+    body(bd_addr, p_buf);
+  };
+};
+extern struct acl_send_data_packet_copy_ble acl_send_data_packet_copy_ble;
 // Name: acl_set_disconnect_reason
 // Params: tHCI_STATUS acl_disc_reason
 // Returns: void
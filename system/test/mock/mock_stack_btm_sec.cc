@@ -114,6 +114,9 @@ bool BTM_SetSecurityLevel(bool is_originator, const char* p_name,
 }
 bool btm_sec_is_a_bonded_dev(const RawAddress& bda) {
   inc_func_call_count(__func__);
+  if (test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev.body) {
+    return test::mock::stack_btm_sec::btm_sec_is_a_bonded_dev.body(bda);
+  }
   return false;
 }
 bool is_sec_state_equal(void* data, void* context) {
@@ -155,6 +158,7 @@ namespace mock {
 namespace stack_btm_sec {
 
 struct BTM_SetEncryption BTM_SetEncryption;
+struct btm_sec_is_a_bonded_dev btm_sec_is_a_bonded_dev;
 
 }
 }  // namespace mock
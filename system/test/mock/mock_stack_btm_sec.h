@@ -41,6 +41,12 @@ struct BTM_SetEncryption {
 };
 extern struct BTM_SetEncryption BTM_SetEncryption;
 
+struct btm_sec_is_a_bonded_dev {
+  std::function<bool(const RawAddress& bda)> body{};
+  bool operator()(const RawAddress& bda) { return body(bda); };
+};
+extern struct btm_sec_is_a_bonded_dev btm_sec_is_a_bonded_dev;
+
 }  // namespace stack_btm_sec
 }  // namespace mock
 }  // namespace test
@@ -30,7 +30,7 @@
 #include "test/common/mock_functions.h"
 #include "types/raw_address.h"
 
-BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
+BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb, bool* p_retain) {
   inc_func_call_count(__func__);
   return nullptr;
 }
@@ -52,6 +52,9 @@ struct SDP_InitDiscoveryDb SDP_InitDiscoveryDb;
 struct SDP_ServiceSearchAttributeRequest SDP_ServiceSearchAttributeRequest;
 struct SDP_ServiceSearchAttributeRequest2 SDP_ServiceSearchAttributeRequest2;
 struct SDP_ServiceSearchRequest SDP_ServiceSearchRequest;
+struct SDP_FindInDiscoveryCache SDP_FindInDiscoveryCache;
+struct SDP_InvalidateDiscoveryCache SDP_InvalidateDiscoveryCache;
+struct SDP_Dumpsys SDP_Dumpsys;
 struct SDP_FindAttributeInRec SDP_FindAttributeInRec;
 struct SDP_FindServiceInDb SDP_FindServiceInDb;
 struct SDP_FindServiceInDb_128bit SDP_FindServiceInDb_128bit;
@@ -124,6 +127,19 @@ bool SDP_ServiceSearchRequest(const RawAddress& p_bd_addr,
   return test::mock::stack_sdp_api::SDP_ServiceSearchRequest(p_bd_addr, p_db,
                                                              p_cb);
 }
+bool SDP_FindInDiscoveryCache(const RawAddress& bd_addr,
+                              tSDP_DISCOVERY_DB* p_db) {
+  inc_func_call_count(__func__);
+  return test::mock::stack_sdp_api::SDP_FindInDiscoveryCache(bd_addr, p_db);
+}
+void SDP_InvalidateDiscoveryCache(const RawAddress& bd_addr) {
+  inc_func_call_count(__func__);
+  test::mock::stack_sdp_api::SDP_InvalidateDiscoveryCache(bd_addr);
+}
+void SDP_Dumpsys(int fd) {
+  inc_func_call_count(__func__);
+  test::mock::stack_sdp_api::SDP_Dumpsys(fd);
+}
 tSDP_DISC_ATTR* SDP_FindAttributeInRec(const tSDP_DISC_REC* p_rec,
                                        uint16_t attr_id) {
   inc_func_call_count(__func__);
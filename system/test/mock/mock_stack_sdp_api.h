@@ -178,6 +178,34 @@ struct SDP_ServiceSearchRequest {
   };
 };
 extern struct SDP_ServiceSearchRequest SDP_ServiceSearchRequest;
+// Name: SDP_FindInDiscoveryCache
+// Params: const RawAddress& bd_addr, tSDP_DISCOVERY_DB* p_db
+// Returns: bool
+struct SDP_FindInDiscoveryCache {
+  std::function<bool(const RawAddress& bd_addr, tSDP_DISCOVERY_DB* p_db)> body{
+      [](const RawAddress& bd_addr, tSDP_DISCOVERY_DB* p_db) { return false; }};
+  bool operator()(const RawAddress& bd_addr, tSDP_DISCOVERY_DB* p_db) {
+    return body(bd_addr, p_db);
+  };
+};
+extern struct SDP_FindInDiscoveryCache SDP_FindInDiscoveryCache;
+// Name: SDP_InvalidateDiscoveryCache
+// Params: const RawAddress& bd_addr
+// Returns: void
+struct SDP_InvalidateDiscoveryCache {
+  std::function<void(const RawAddress& bd_addr)> body{
+      [](const RawAddress& bd_addr) {}};
+  void operator()(const RawAddress& bd_addr) { body(bd_addr); };
+};
+extern struct SDP_InvalidateDiscoveryCache SDP_InvalidateDiscoveryCache;
+// Name: SDP_Dumpsys
+// Params: int fd
+// Returns: void
+struct SDP_Dumpsys {
+  std::function<void(int fd)> body{[](int fd) {}};
+  void operator()(int fd) { body(fd); };
+};
+extern struct SDP_Dumpsys SDP_Dumpsys;
 // Name: SDP_FindAttributeInRec
 // Params: tSDP_DISC_REC* p_rec, uint16_t attr_id
 // Returns: tSDP_DISC_ATTR*
@@ -92,11 +92,16 @@ tSDP_RECORD* sdp_db_find_record(uint32_t handle) {
   inc_func_call_count(__func__);
   return nullptr;
 }
-const tSDP_RECORD* sdp_db_service_search(const tSDP_RECORD* p_rec,
-                                         tSDP_UUID_SEQ* p_seq) {
+const tSDP_RECORD* sdp_db_service_search(uint32_t prev_handle,
+                                         const tSDP_UUID_SEQ* p_seq) {
   inc_func_call_count(__func__);
   return nullptr;
 }
+bool sdp_db_get_encoded_attrs(const tSDP_RECORD* p_rec,
+                              tSDP_ENCODED_ATTRS* p_encoded) {
+  inc_func_call_count(__func__);
+  return false;
+}
 uint32_t SDP_CreateRecord(void) {
   inc_func_call_count(__func__);
   return 0;
@@ -48,6 +48,13 @@ DEFINE_bool(enable_baseband_sniffer, false, "enable baseband sniffer");
 DEFINE_bool(enable_pcap_filter, false, "enable PCAP filter");
 DEFINE_bool(disable_address_reuse, false,
             "prevent rootcanal from reusing device addresses");
+DEFINE_bool(enable_virtual_time, false,
+            "run the devices on a virtual clock that skips ahead while the "
+            "hosts are idle");
+DEFINE_uint32(virtual_time_quiet_ticks,
+              rootcanal::TestModel::kVirtualTimeQuietTicks,
+              "number of consecutive ticks without host traffic after which "
+              "virtual time skips ahead");
 DEFINE_uint32(test_port, 6401, "test tcp port");
 DEFINE_uint32(hci_port, 6402, "hci server tcp port");
 DEFINE_uint32(link_port, 6403, "link server tcp port");
@@ -138,7 +145,8 @@ int main(int argc, char** argv) {
       static_cast<int>(FLAGS_link_port), static_cast<int>(FLAGS_link_ble_port),
       configuration_str, FLAGS_enable_hci_sniffer,
       FLAGS_enable_baseband_sniffer, FLAGS_enable_pcap_filter,
-      FLAGS_disable_address_reuse);
+      FLAGS_disable_address_reuse, FLAGS_enable_virtual_time,
+      FLAGS_virtual_time_quiet_ticks);
 
   std::promise<void> barrier;
   std::future<void> barrier_future = barrier.get_future();
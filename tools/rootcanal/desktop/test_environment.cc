@@ -51,7 +51,8 @@ TestEnvironment::TestEnvironment(
     int test_port, int hci_port, int link_port, int link_ble_port,
     const std::string& config_str,
     bool enable_hci_sniffer, bool enable_baseband_sniffer,
-    bool enable_pcap_filter, bool disable_address_reuse)
+    bool enable_pcap_filter, bool disable_address_reuse,
+    bool enable_virtual_time, unsigned virtual_time_quiet_ticks)
     : enable_hci_sniffer_(enable_hci_sniffer),
       enable_baseband_sniffer_(enable_baseband_sniffer),
       enable_pcap_filter_(enable_pcap_filter) {
@@ -60,6 +61,9 @@ TestEnvironment::TestEnvironment(
   link_ble_socket_server_ = open_server(&async_manager_, link_ble_port);
   connector_ = open_connector(&async_manager_);
   test_model_.SetReuseDeviceIds(!disable_address_reuse);
+  if (enable_virtual_time) {
+    test_model_.EnableVirtualTime(virtual_time_quiet_ticks);
+  }
 
   // Get a user ID for tasks scheduled within the test environment.
   socket_user_id_ = async_manager_.GetNextUserId();
@@ -56,7 +56,10 @@ class TestEnvironment {
       int test_port, int hci_port, int link_port, int link_ble_port,
       std::string const& config_str,
       bool enable_hci_sniffer = false, bool enable_baseband_sniffer = false,
-      bool enable_pcap_filter = false, bool disable_address_reuse = false);
+      bool enable_pcap_filter = false, bool disable_address_reuse = false,
+      bool enable_virtual_time = false,
+      unsigned virtual_time_quiet_ticks =
+          rootcanal::TestModel::kVirtualTimeQuietTicks);
 
   void initialize(std::promise<void> barrier);
   void close();
@@ -0,0 +1,66 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace rootcanal {
+
+// Clock of the simulated devices, used by the model in place of the steady
+// clock. It is the steady clock until virtual time is enabled, then it only
+// moves when the test model advances it (see TestModel::EnableVirtualTime).
+// The clock is shared by the whole process: only one test model at a time
+// may run on virtual time, and it resets the clock when it is destroyed.
+class ModelClock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr bool is_steady = true;
+
+  static time_point now() {
+    if (!virtual_time_) {
+      return std::chrono::steady_clock::now();
+    }
+    return time_point(duration(virtual_now_));
+  }
+
+  // Stops the clock at the current time, from then on it only moves by
+  // Advance().
+  static void EnableVirtualTime() {
+    virtual_now_ = std::chrono::steady_clock::now().time_since_epoch().count();
+    virtual_time_ = true;
+  }
+
+  // Goes back to the steady clock, for the next test model to start from.
+  static void Reset() {
+    virtual_time_ = false;
+    virtual_now_ = 0;
+  }
+
+  static bool IsVirtualTime() { return virtual_time_; }
+
+  static void Advance(duration delta) { virtual_now_ += delta.count(); }
+
+ private:
+  static inline std::atomic<bool> virtual_time_{false};
+  static inline std::atomic<rep> virtual_now_{0};
+};
+
+}  // namespace rootcanal
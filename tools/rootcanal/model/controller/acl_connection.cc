@@ -16,6 +16,8 @@
 
 #include "acl_connection.h"
 
+#include "model_clock.h"
+
 namespace rootcanal {
 AclConnection::AclConnection(AddressWithType address,
                              AddressWithType own_address,
@@ -26,7 +28,7 @@ AclConnection::AclConnection(AddressWithType address,
       resolved_address_(resolved_address),
       type_(phy_type),
       role_(role),
-      last_packet_timestamp_(std::chrono::steady_clock::now()),
+      last_packet_timestamp_(ModelClock::now()),
       timeout_(std::chrono::seconds(1)) {}
 
 void AclConnection::Encrypt() { encrypted_ = true; };
@@ -50,13 +52,12 @@ int8_t AclConnection::GetRssi() const { return rssi_; }
 void AclConnection::SetRssi(int8_t rssi) { rssi_ = rssi; }
 
 void AclConnection::ResetLinkTimer() {
-  last_packet_timestamp_ = std::chrono::steady_clock::now();
+  last_packet_timestamp_ = ModelClock::now();
 }
 
 std::chrono::steady_clock::duration AclConnection::TimeUntilNearExpiring()
     const {
-  return (last_packet_timestamp_ + timeout_ / 2) -
-         std::chrono::steady_clock::now();
+  return (last_packet_timestamp_ + timeout_ / 2) - ModelClock::now();
 }
 
 bool AclConnection::IsNearExpiring() const {
@@ -64,7 +65,7 @@ bool AclConnection::IsNearExpiring() const {
 }
 
 std::chrono::steady_clock::duration AclConnection::TimeUntilExpired() const {
-  return (last_packet_timestamp_ + timeout_) - std::chrono::steady_clock::now();
+  return (last_packet_timestamp_ + timeout_) - ModelClock::now();
 }
 
 bool AclConnection::HasExpired() const {
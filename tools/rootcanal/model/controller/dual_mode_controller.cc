@@ -45,6 +45,15 @@ void DualModeController::ReceiveLinkLayerPacket(
   link_layer_controller_.IncomingPacket(incoming, rssi);
 }
 
+bool DualModeController::CanReceive(model::packets::PacketType type) const {
+  return link_layer_controller_.CanReceive(type);
+}
+
+std::optional<ModelClock::time_point> DualModeController::GetNextEventTime()
+    const {
+  return link_layer_controller_.GetNextEventTime();
+}
+
 void DualModeController::Tick() { link_layer_controller_.Tick(); }
 
 void DualModeController::Close() {
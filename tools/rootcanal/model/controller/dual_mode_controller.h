@@ -61,6 +61,8 @@ class DualModeController : public Device {
 
   void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView incoming,
                               Phy::Type type, int8_t rssi) override;
+  bool CanReceive(model::packets::PacketType type) const override;
+  std::optional<ModelClock::time_point> GetNextEventTime() const override;
 
   void Tick() override;
   void Close() override;
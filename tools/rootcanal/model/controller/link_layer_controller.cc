@@ -22,6 +22,7 @@
 
 #include "crypto/crypto.h"
 #include "log.h"
+#include "model_clock.h"
 #include "packet/raw_builder.h"
 
 using namespace std::chrono;
@@ -1436,7 +1437,7 @@ ErrorCode LinkLayerController::LeSetExtendedScanEnable(
   scanner_.duration = duration_ms;
   scanner_.period = period_ms;
 
-  auto now = std::chrono::steady_clock::now();
+  auto now = ModelClock::now();
 
   // At the end of a single scan (Duration non-zero but Period zero), an
   // HCI_LE_Scan_Timeout event shall be generated.
@@ -4029,8 +4030,7 @@ void LinkLayerController::IncomingLePeriodicAdvertisingPdu(
              .advertising_sid = advertising_sid,
              .sync_handle = sync_handle,
              .sync_timeout = synchronizing_->sync_timeout,
-             .timeout = std::chrono::steady_clock::now() +
-                        synchronizing_->sync_timeout,
+             .timeout = ModelClock::now() + synchronizing_->sync_timeout,
          }});
 
     // Quit synchronizing state.
@@ -4081,7 +4081,7 @@ void LinkLayerController::IncomingLePeriodicAdvertisingPdu(
     }
 
     // Refresh the timeout for the sync disconnection.
-    sync.timeout = std::chrono::steady_clock::now() + sync.sync_timeout;
+    sync.timeout = ModelClock::now() + sync.sync_timeout;
   }
 }
 
@@ -5051,7 +5051,7 @@ void LinkLayerController::LeScanning() {
     return;
   }
 
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = ModelClock::now();
 
   // Extended Scanning Timeout
 
@@ -5093,7 +5093,7 @@ void LinkLayerController::LeScanning() {
 void LinkLayerController::LeSynchronization() {
   std::vector<uint16_t> removed_sync_handles;
   for (auto& [_, sync] : synchronized_) {
-    if (sync.timeout > std::chrono::steady_clock::now()) {
+    if (sync.timeout > ModelClock::now()) {
       LOG_INFO("Periodic advertising sync with handle 0x%x lost",
                sync.sync_handle);
       removed_sync_handles.push_back(sync.sync_handle);
@@ -5190,6 +5190,62 @@ void LinkLayerController::IncomingPageResponsePacket(
   }
 }
 
+bool LinkLayerController::CanReceive(model::packets::PacketType type) const {
+  switch (type) {
+    case model::packets::PacketType::LE_LEGACY_ADVERTISING_PDU:
+    case model::packets::PacketType::LE_EXTENDED_ADVERTISING_PDU:
+      return scanner_.IsEnabled() || initiator_.IsEnabled();
+    case model::packets::PacketType::LE_PERIODIC_ADVERTISING_PDU:
+      return scanner_.IsEnabled();
+    case model::packets::PacketType::INQUIRY:
+      return inquiry_scan_enable_;
+    case model::packets::PacketType::PAGE:
+      return page_scan_enable_;
+    default:
+      return true;
+  }
+}
+
+std::optional<std::chrono::steady_clock::time_point>
+LinkLayerController::GetNextEventTime() const {
+  std::chrono::steady_clock::time_point now = ModelClock::now();
+  if (inquiry_timer_task_id_ != kInvalidTaskId ||
+      !connections_.GetAclHandles().empty()) {
+    return now;
+  }
+
+  std::optional<std::chrono::steady_clock::time_point> next_event;
+  auto schedule =
+      [&next_event](std::optional<std::chrono::steady_clock::time_point> time) {
+        if (time.has_value() &&
+            (!next_event.has_value() || time.value() < next_event.value())) {
+          next_event = time;
+        }
+      };
+
+  if (!task_queue_.empty()) {
+    schedule(task_queue_.begin()->time);
+  }
+  if (legacy_advertiser_.IsEnabled()) {
+    schedule(legacy_advertiser_.next_event);
+    schedule(legacy_advertiser_.timeout);
+  }
+  for (auto const& [_, advertiser] : extended_advertisers_) {
+    if (advertiser.IsEnabled()) {
+      schedule(advertiser.next_event);
+      schedule(advertiser.timeout);
+    }
+    if (advertiser.IsPeriodicEnabled()) {
+      schedule(advertiser.next_periodic_event);
+    }
+  }
+  if (scanner_.IsEnabled()) {
+    schedule(scanner_.timeout);
+    schedule(scanner_.periodical_timeout);
+  }
+  return next_event;
+}
+
 void LinkLayerController::Tick() {
   RunPendingTasks();
   if (inquiry_timer_task_id_ != kInvalidTaskId) {
@@ -6128,7 +6184,7 @@ void LinkLayerController::Reset() {
   initiator_ = Initiator{};
   synchronizing_ = {};
   synchronized_ = {};
-  last_inquiry_ = steady_clock::now();
+  last_inquiry_ = ModelClock::now();
   inquiry_mode_ = InquiryType::STANDARD;
   inquiry_lap_ = 0;
   inquiry_max_responses_ = 0;
@@ -6186,7 +6242,7 @@ void LinkLayerController::SetInquiryMaxResponses(uint8_t max) {
 }
 
 void LinkLayerController::Inquiry() {
-  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point now = ModelClock::now();
   if (duration_cast<milliseconds>(now - last_inquiry_) < milliseconds(2000)) {
     return;
   }
@@ -6437,8 +6493,8 @@ TaskId LinkLayerController::NextTaskId() {
 TaskId LinkLayerController::ScheduleTask(std::chrono::milliseconds delay,
                                          TaskCallback task_callback) {
   TaskId task_id = NextTaskId();
-  task_queue_.emplace(std::chrono::steady_clock::now() + delay,
-                      std::move(task_callback), task_id);
+  task_queue_.emplace(ModelClock::now() + delay, std::move(task_callback),
+                      task_id);
   return task_id;
 }
 
@@ -6446,7 +6502,7 @@ TaskId LinkLayerController::SchedulePeriodicTask(
     std::chrono::milliseconds delay, std::chrono::milliseconds period,
     TaskCallback task_callback) {
   TaskId task_id = NextTaskId();
-  task_queue_.emplace(std::chrono::steady_clock::now() + delay, period,
+  task_queue_.emplace(ModelClock::now() + delay, period,
                       std::move(task_callback), task_id);
   return task_id;
 }
@@ -6462,7 +6518,7 @@ void LinkLayerController::CancelScheduledTask(TaskId task_id) {
 }
 
 void LinkLayerController::RunPendingTasks() {
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = ModelClock::now();
   while (!task_queue_.empty()) {
     auto it = task_queue_.begin();
     if (it->time > now) {
@@ -138,6 +138,16 @@ class LinkLayerController {
   void IncomingPacket(model::packets::LinkLayerPacketView incoming,
                       int8_t rssi);
 
+  // Return false for the packet types IncomingPacket() drops in the current
+  // state: advertising while neither scanning nor initiating, and inquiries
+  // and pages while not scanning for them.
+  bool CanReceive(model::packets::PacketType type) const;
+
+  // Return the time of the next scheduled task, advertising event or
+  // timeout, or now while inquiring or connected, as the link manager and
+  // the connections are polled from Tick().
+  std::optional<std::chrono::steady_clock::time_point> GetNextEventTime() const;
+
   void Tick();
 
   void Close();
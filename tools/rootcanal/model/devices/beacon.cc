@@ -17,6 +17,7 @@
 #include "beacon.h"
 
 #include "model/setup/device_boutique.h"
+#include "model_clock.h"
 
 namespace rootcanal {
 using namespace model::packets;
@@ -47,7 +48,7 @@ Beacon::Beacon(const std::vector<std::string>& args) : Beacon() {
 }
 
 void Beacon::Tick() {
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = ModelClock::now();
   if ((now - advertising_last_) >= advertising_interval_) {
     advertising_last_ = now;
     SendLinkLayerPacket(
@@ -43,6 +43,18 @@ class Beacon : public Device {
       model::packets::LinkLayerPacketView packet, Phy::Type type,
       int8_t rssi) override;
 
+  // Beacons only answer scan requests.
+  virtual bool CanReceive(model::packets::PacketType type) const override {
+    return type == model::packets::PacketType::LE_SCAN;
+  }
+  virtual bool ReceivesOnlyAddressedPackets() const override { return true; }
+
+  // The next advertisement.
+  virtual std::optional<ModelClock::time_point> GetNextEventTime()
+      const override {
+    return advertising_last_ + advertising_interval_;
+  }
+
  protected:
   model::packets::LegacyAdvertisingType advertising_type_{};
   std::array<uint8_t, 31> advertising_data_{};
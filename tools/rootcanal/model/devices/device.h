@@ -19,10 +19,12 @@
 #include <chrono>
 #include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "hci/address.h"
+#include "model_clock.h"
 #include "packets/link_layer_packets.h"
 #include "phy.h"
 
@@ -56,6 +58,29 @@ class Device {
       model::packets::LinkLayerPacketView packet, Phy::Type type,
       int8_t rssi){};
 
+  // Return false if the device drops every link layer packet of this type in
+  // its current state, so that the phy layers skip it.
+  virtual bool CanReceive(model::packets::PacketType /*type*/) const {
+    return true;
+  }
+
+  // Return true if the device drops every link layer packet not sent to its
+  // address, so that the phy layers only look it up by destination address.
+  virtual bool ReceivesOnlyAddressedPackets() const { return false; }
+
+  // Return false while the device has work queued with something outside of
+  // the model, like a host, so that virtual time does not run ahead of it.
+  virtual bool IsIdle() const { return true; }
+
+  // Return the time of the next event the device has scheduled, so that
+  // virtual time can skip to it. A time that is not in the future asks for
+  // the device to be ticked every period, which is the default for devices
+  // that poll their state from Tick(). std::nullopt means the device has
+  // nothing scheduled and only acts on the packets it receives.
+  virtual std::optional<ModelClock::time_point> GetNextEventTime() const {
+    return ModelClock::now();
+  }
+
   void SendLinkLayerPacket(
       std::shared_ptr<model::packets::LinkLayerPacketBuilder> packet,
       Phy::Type type, int8_t tx_power = 0);
@@ -20,6 +20,36 @@
 
 namespace rootcanal {
 
+// Reports streamed to the host while scanning or inquiring, which it does not
+// answer, unlike the other events.
+static bool IsReport(std::vector<uint8_t> const& event) {
+  static constexpr uint8_t kInquiryResult = 0x02;
+  static constexpr uint8_t kInquiryResultWithRssi = 0x22;
+  static constexpr uint8_t kExtendedInquiryResult = 0x2f;
+  static constexpr uint8_t kLeMetaEvent = 0x3e;
+  static constexpr uint8_t kLeAdvertisingReport = 0x02;
+  static constexpr uint8_t kLeDirectedAdvertisingReport = 0x0b;
+  static constexpr uint8_t kLeExtendedAdvertisingReport = 0x0d;
+  static constexpr uint8_t kLePeriodicAdvertisingReport = 0x0f;
+
+  if (event.empty()) {
+    return false;
+  }
+  switch (event[0]) {
+    case kInquiryResult:
+    case kInquiryResultWithRssi:
+    case kExtendedInquiryResult:
+      return true;
+    case kLeMetaEvent:
+      return event.size() > 2 && (event[2] == kLeAdvertisingReport ||
+                                  event[2] == kLeDirectedAdvertisingReport ||
+                                  event[2] == kLeExtendedAdvertisingReport ||
+                                  event[2] == kLePeriodicAdvertisingReport);
+    default:
+      return false;
+  }
+}
+
 HciDevice::HciDevice(std::shared_ptr<HciTransport> transport,
                      ControllerProperties const& properties)
     : DualModeController(ControllerProperties(properties)),
@@ -53,10 +83,16 @@ HciDevice::HciDevice(std::shared_ptr<HciTransport> transport,
       'i',
   }));
 
+  // Audio data and reports are streamed to the host without an answer, so
+  // they do not keep it busy.
   RegisterEventChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    if (!IsReport(*packet)) {
+      OnHostActivity();
+    }
     transport_->SendEvent(*packet);
   });
   RegisterAclChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
+    OnHostActivity();
     transport_->SendAcl(*packet);
   });
   RegisterScoChannel([this](std::shared_ptr<std::vector<uint8_t>> packet) {
@@ -68,15 +104,19 @@ HciDevice::HciDevice(std::shared_ptr<HciTransport> transport,
 
   transport_->RegisterCallbacks(
       [this](const std::shared_ptr<std::vector<uint8_t>> command) {
+        OnHostActivity();
         HandleCommand(command);
       },
       [this](const std::shared_ptr<std::vector<uint8_t>> acl) {
+        OnHostActivity();
         HandleAcl(acl);
       },
       [this](const std::shared_ptr<std::vector<uint8_t>> sco) {
+        OnHostActivity();
         HandleSco(sco);
       },
       [this](const std::shared_ptr<std::vector<uint8_t>> iso) {
+        OnHostActivity();
         HandleIso(iso);
       },
       [this]() {
@@ -86,10 +126,15 @@ HciDevice::HciDevice(std::shared_ptr<HciTransport> transport,
 }
 
 void HciDevice::Tick() {
+  host_packets_ = 0;
   transport_->Tick();
   DualModeController::Tick();
 }
 
+bool HciDevice::IsIdle() const {
+  return host_packets_ == 0 && !transport_->HasPartialPacket();
+}
+
 void HciDevice::Close() {
   transport_->Close();
   DualModeController::Close();
@@ -42,8 +42,18 @@ class HciDevice : public DualModeController {
 
   void Close() override;
 
+  // The host counts as busy while a packet from it is partly received, and
+  // until the tick after it last exchanged a packet with the controller,
+  // which gives it one period to answer.
+  bool IsIdle() const override;
+
  private:
+  void OnHostActivity() { host_packets_++; }
+
   std::shared_ptr<HciTransport> transport_;
+  // Packets exchanged with the host since the last tick, besides the
+  // streamed reports and audio data.
+  size_t host_packets_{0};
 };
 
 }  // namespace rootcanal
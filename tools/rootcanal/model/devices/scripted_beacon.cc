@@ -24,6 +24,7 @@
 #include "log.h"
 #include "model/devices/scripted_beacon_ble_payload.pb.h"
 #include "model/setup/device_boutique.h"
+#include "model_clock.h"
 
 #ifdef _WIN32
 #define F_OK 00
@@ -92,7 +93,7 @@ ScriptedBeacon::ScriptedBeacon(const vector<std::string>& args) : Beacon(args) {
 }
 
 bool has_time_elapsed(steady_clock::time_point time_point) {
-  return steady_clock::now() > time_point;
+  return ModelClock::now() > time_point;
 }
 
 static void populate_event(PlaybackEvent* event,
@@ -127,7 +128,7 @@ void ScriptedBeacon::Tick() {
       break;
     case PlaybackEvent::SCANNED_ONCE:
       next_check_time_ =
-          steady_clock::now() + steady_clock::duration(std::chrono::seconds(1));
+          ModelClock::now() + steady_clock::duration(std::chrono::seconds(1));
       set_state(PlaybackEvent::WAITING_FOR_FILE);
       break;
     case PlaybackEvent::WAITING_FOR_FILE:
@@ -135,7 +136,7 @@ void ScriptedBeacon::Tick() {
         return;
       }
       next_check_time_ =
-          steady_clock::now() + steady_clock::duration(std::chrono::seconds(1));
+          ModelClock::now() + steady_clock::duration(std::chrono::seconds(1));
       if (access(config_file_.c_str(), F_OK) == -1) {
         return;
       }
@@ -160,7 +161,7 @@ void ScriptedBeacon::Tick() {
       set_state(PlaybackEvent::PLAYBACK_STARTED);
       LOG_INFO("Starting Ble advertisement playback from file: %s",
                config_file_.c_str());
-      next_ad_.ad_time = steady_clock::now();
+      next_ad_.ad_time = ModelClock::now();
       get_next_advertisement();
       input.close();
       break;
@@ -47,6 +47,11 @@ class ScriptedBeacon : public Beacon {
   }
 
   void Tick() override;
+
+  // The playback polls its configuration file and the clock from Tick().
+  std::optional<ModelClock::time_point> GetNextEventTime() const override {
+    return ModelClock::now();
+  }
   void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView packet_view,
                               Phy::Type type, int8_t rssi) override;
 
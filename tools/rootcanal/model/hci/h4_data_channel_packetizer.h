@@ -44,6 +44,11 @@ class H4DataChannelPacketizer : public HciProtocol {
 
   void OnDataReady(std::shared_ptr<AsyncDataChannel> socket);
 
+  // Return true while the parser holds part of a packet.
+  bool HasPartialPacket() const {
+    return h4_parser_.CurrentState() != H4Parser::HCI_TYPE;
+  }
+
  private:
   std::shared_ptr<AsyncDataChannel> uart_socket_;
   H4Parser h4_parser_;
@@ -60,7 +60,7 @@ class H4Parser {
   // Resets the parser to the empty, initial state.
   void Reset();
 
-  State CurrentState() { return state_; };
+  State CurrentState() const { return state_; };
 
   void EnableRecovery() { enable_recovery_state_ = true; }
   void DisableRecovery() { enable_recovery_state_ = false; }
@@ -105,6 +105,10 @@ void HciSniffer::RegisterCallbacks(PacketCallback command_callback,
 
 void HciSniffer::Tick() { transport_->Tick(); }
 
+bool HciSniffer::HasPartialPacket() const {
+  return transport_->HasPartialPacket();
+}
+
 void HciSniffer::Close() {
   transport_->Close();
   if (output_ != nullptr) {
@@ -68,6 +68,8 @@ class HciSniffer : public HciTransport {
 
   void Tick() override;
 
+  bool HasPartialPacket() const override;
+
   void Close() override;
 
  private:
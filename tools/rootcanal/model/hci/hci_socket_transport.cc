@@ -59,6 +59,10 @@ void HciSocketTransport::RegisterCallbacks(PacketCallback command_callback,
 
 void HciSocketTransport::Tick() { h4_.OnDataReady(socket_); }
 
+bool HciSocketTransport::HasPartialPacket() const {
+  return h4_.HasPartialPacket();
+}
+
 void HciSocketTransport::SendHci(PacketType packet_type,
                                  const std::vector<uint8_t>& packet) {
   if (!socket_ || !socket_->Connected()) {
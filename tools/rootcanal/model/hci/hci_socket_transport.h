@@ -52,6 +52,8 @@ class HciSocketTransport : public HciTransport {
 
   void Tick() override;
 
+  bool HasPartialPacket() const override;
+
   void Close() override;
 
  private:
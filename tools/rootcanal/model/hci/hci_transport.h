@@ -46,6 +46,10 @@ class HciTransport {
 
   virtual void Tick() = 0;
 
+  // Return true while part of a packet from the host has been received,
+  // with the rest still to come.
+  virtual bool HasPartialPacket() const { return false; }
+
   virtual void Close() = 0;
 };
 
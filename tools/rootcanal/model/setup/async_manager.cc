@@ -21,6 +21,7 @@
 #include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "fcntl.h"
@@ -28,6 +29,10 @@
 #include "sys/select.h"
 #include "unistd.h"
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 namespace rootcanal {
 // Implementation of AsyncManager is divided between two classes, three if
 // AsyncManager itself is taken into account, but its only responsability
@@ -39,9 +44,10 @@ namespace rootcanal {
 // After construction of this objects nothing happens beyond some very simple
 // member initialization. When the first FD is set up for watching the object
 // starts a new thread which watches the given (and later provided) FDs using
-// select() inside a loop. A special FD (a pipe) is also watched which is
-// used to notify the thread of internal changes on the object state (like
-// the addition of new FDs to watch on). Every access to internal state is
+// epoll (select() where epoll is not available) inside a loop. A special FD
+// (a pipe) is also watched which is used to notify the thread of internal
+// changes on the object state (like the addition of new FDs to watch on when
+// using select()). Every access to internal state is
 // synchronized using a single internal mutex. The thread is only stopped on
 // destruction of the object, by modifying a flag, which is the only member
 // variable accessed without acquiring the lock (because the notification to
@@ -91,6 +97,12 @@ static inline AsyncTaskId NextAsyncTaskId(const AsyncTaskId id) {
 // no need to treat that case.
 static const int kNotificationBufferSize = 10;
 
+#ifdef __linux__
+// Events taken from the kernel by a single wait, more ready FDs are returned
+// by the next one.
+static const int kMaxEventsPerWait = 64;
+#endif
+
 // Async File Descriptor Watcher Implementation:
 class AsyncManager::AsyncFdWatcher {
  public:
@@ -99,7 +111,16 @@ class AsyncManager::AsyncFdWatcher {
     // add file descriptor and callback
     {
       std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-      watched_shared_fds_[file_descriptor] = on_read_fd_ready_callback;
+      watched_shared_fds_[file_descriptor] =
+          std::make_shared<ReadCallback>(on_read_fd_ready_callback);
+#ifdef __linux__
+      // the set is only there once the thread is started, which adds all the
+      // FDs watched so far
+      if (epoll_fd_ >= 0 && addToEpollSet(file_descriptor) != 0) {
+        watched_shared_fds_.erase(file_descriptor);
+        return -1;
+      }
+#endif
     }
 
     // start the thread if not started yet
@@ -109,8 +130,10 @@ class AsyncManager::AsyncFdWatcher {
       return started;
     }
 
+#ifndef __linux__
     // notify the thread so that it knows of the new FD
     notifyThread();
+#endif
 
     return 0;
   }
@@ -118,6 +141,12 @@ class AsyncManager::AsyncFdWatcher {
   void StopWatchingFileDescriptor(int file_descriptor) {
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
     watched_shared_fds_.erase(file_descriptor);
+#ifdef __linux__
+    // fails if the FD was closed already, which also removed it from the set
+    if (epoll_fd_ >= 0) {
+      epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, file_descriptor, nullptr);
+    }
+#endif
   }
 
   AsyncFdWatcher() = default;
@@ -143,6 +172,12 @@ class AsyncManager::AsyncFdWatcher {
     {
       std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
       watched_shared_fds_.clear();
+#ifdef __linux__
+      if (std::this_thread::get_id() != thread_.get_id()) {
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+      }
+#endif
     }
 
     return 0;
@@ -167,6 +202,13 @@ class AsyncManager::AsyncFdWatcher {
     notification_listen_fd_ = pipe_fds[0];
     notification_write_fd_ = pipe_fds[1];
 
+#ifdef __linux__
+    if (setUpEpollSet() != 0) {
+      LOG_ERROR("%s: Unable to set up the watched file descriptors", __func__);
+      return -1;
+    }
+#endif
+
     thread_ = std::thread([this]() { ThreadRoutine(); });
     if (!thread_.joinable()) {
       LOG_ERROR("%s: Unable to start reading thread", __func__);
@@ -184,6 +226,103 @@ class AsyncManager::AsyncFdWatcher {
     return 0;
   }
 
+  // read everything there is in the comm channel
+  void consumeThreadNotifications() const {
+    char buffer[kNotificationBufferSize];
+    while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
+                                   kNotificationBufferSize)) ==
+           kNotificationBufferSize) {
+    }
+  }
+
+  // call the callback of a FD if it is still watched, must be called with the
+  // lock held
+  void runCallback(int file_descriptor) {
+    auto it = watched_shared_fds_.find(file_descriptor);
+    if (it == watched_shared_fds_.end()) {
+      return;
+    }
+    // keep the callback alive even if it stops watching its own FD
+    std::shared_ptr<ReadCallback> callback = it->second;
+    (*callback)(file_descriptor);
+  }
+
+#ifdef __linux__
+  // The kernel keeps the set of watched FDs between waits, so the cost of a
+  // wait depends on the number of ready FDs and not on the number of watched
+  // ones, and there is no limit like FD_SETSIZE on the FD numbers.
+  int setUpEpollSet() {
+    std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      LOG_ERROR("%s: Unable to create the epoll set: %s", __func__,
+                strerror(errno));
+      return -1;
+    }
+    if (addToEpollSet(notification_listen_fd_) != 0) {
+      return -1;
+    }
+    for (auto& fdp : watched_shared_fds_) {
+      if (addToEpollSet(fdp.first) != 0) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+
+  int addToEpollSet(int file_descriptor) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = file_descriptor;
+    // the FD is already in the set when only its callback changes
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, file_descriptor, &event) != 0 &&
+        errno != EEXIST) {
+      LOG_ERROR("%s: Unable to watch fd %d: %s", __func__, file_descriptor,
+                strerror(errno));
+      return -1;
+    }
+    return 0;
+  }
+
+  // call the callbacks of the FDs with events
+  void runAppropriateCallbacks(const struct epoll_event* events, int nevents) {
+    std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
+    for (int i = 0; i < nevents; i++) {
+      if (events[i].data.fd != notification_listen_fd_) {
+        runCallback(events[i].data.fd);
+      }
+    }
+  }
+
+  void ThreadRoutine() {
+    struct epoll_event events[kMaxEventsPerWait];
+    while (running_) {
+      // wait until there is data available to read on some FD
+      int nevents = TEMP_FAILURE_RETRY(
+          epoll_wait(epoll_fd_, events, kMaxEventsPerWait, -1));
+      if (nevents <= 0) {  // there was some error
+        LOG_ERROR(
+            "%s: There was an error while waiting for data on the file "
+            "descriptors: %s",
+            __func__, strerror(errno));
+        continue;
+      }
+
+      for (int i = 0; i < nevents; i++) {
+        if (events[i].data.fd == notification_listen_fd_) {
+          consumeThreadNotifications();
+        }
+      }
+
+      // Do not read if there was a call to stop running
+      if (!running_) {
+        break;
+      }
+
+      runAppropriateCallbacks(events, nevents);
+    }
+  }
+#else
   int setUpFileDescriptorSet(fd_set& read_fds) {
     // add comm channel to the set
     FD_SET(notification_listen_fd_, &read_fds);
@@ -200,30 +339,17 @@ class AsyncManager::AsyncFdWatcher {
     return nfds;
   }
 
-  // check the comm channel and read everything there
-  bool consumeThreadNotifications(fd_set& read_fds) const {
-    if (FD_ISSET(notification_listen_fd_, &read_fds)) {
-      char buffer[kNotificationBufferSize];
-      while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
-                                     kNotificationBufferSize)) ==
-             kNotificationBufferSize) {
-      }
-      return true;
-    }
-    return false;
-  }
-
   // check all file descriptors and call callbacks if necesary
   void runAppropriateCallbacks(fd_set& read_fds) {
-    std::vector<decltype(watched_shared_fds_)::value_type> fds;
+    std::vector<int> fds;
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
     for (auto& fdc : watched_shared_fds_) {
       if (FD_ISSET(fdc.first, &read_fds)) {
-        fds.push_back(fdc);
+        fds.push_back(fdc.first);
       }
     }
-    for (auto& p : fds) {
-      p.second(p.first);
+    for (int fd : fds) {
+      runCallback(fd);
     }
   }
 
@@ -243,7 +369,9 @@ class AsyncManager::AsyncFdWatcher {
         continue;
       }
 
-      consumeThreadNotifications(read_fds);
+      if (FD_ISSET(notification_listen_fd_, &read_fds)) {
+        consumeThreadNotifications();
+      }
 
       // Do not read if there was a call to stop running
       if (!running_) {
@@ -253,16 +381,22 @@ class AsyncManager::AsyncFdWatcher {
       runAppropriateCallbacks(read_fds);
     }
   }
+#endif
 
   std::atomic_bool running_{false};
   std::thread thread_;
   std::recursive_mutex internal_mutex_;
 
-  std::map<int, ReadCallback> watched_shared_fds_;
+  std::unordered_map<int, std::shared_ptr<ReadCallback>> watched_shared_fds_;
 
   // A pair of FD to send information to the reading thread
   int notification_listen_fd_{};
   int notification_write_fd_{};
+
+#ifdef __linux__
+  // The set of FDs the reading thread waits on, the comm channel included
+  int epoll_fd_{-1};
+#endif
 };
 
 // Async task manager implementation
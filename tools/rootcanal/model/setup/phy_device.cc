@@ -33,10 +33,37 @@ void PhyDevice::Register(PhyLayer* phy) { phy_layers_.insert(phy); }
 
 void PhyDevice::Unregister(PhyLayer* phy) { phy_layers_.erase(phy); }
 
-void PhyDevice::Tick() { device_->Tick(); }
+void PhyDevice::Tick() {
+  device_->Tick();
+  // Devices like the beacon swarm change their address when they tick.
+  for (auto const& phy : phy_layers_) {
+    phy->UpdateAddress(this);
+  }
+}
 
 void PhyDevice::SetAddress(bluetooth::hci::Address address) {
   device_->SetAddress(std::move(address));
+  for (auto const& phy : phy_layers_) {
+    phy->UpdateAddress(this);
+  }
+}
+
+const bluetooth::hci::Address& PhyDevice::GetAddress() const {
+  return device_->GetAddress();
+}
+
+bool PhyDevice::CanReceive(model::packets::PacketType type) const {
+  return device_->CanReceive(type);
+}
+
+bool PhyDevice::ReceivesOnlyAddressedPackets() const {
+  return device_->ReceivesOnlyAddressedPackets();
+}
+
+bool PhyDevice::IsIdle() const { return device_->IsIdle(); }
+
+std::optional<ModelClock::time_point> PhyDevice::GetNextEventTime() const {
+  return device_->GetNextEventTime();
 }
 
 void PhyDevice::Receive(std::vector<uint8_t> const& packet, Phy::Type type,
@@ -48,12 +75,17 @@ void PhyDevice::Receive(std::vector<uint8_t> const& packet, Phy::Type type,
           bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(
               packet_copy));
   if (packet_view.IsValid()) {
-    device_->ReceiveLinkLayerPacket(std::move(packet_view), type, rssi);
+    Receive(packet_view, type, rssi);
   } else {
     LOG_WARN("received invalid LL packet");
   }
 }
 
+void PhyDevice::Receive(model::packets::LinkLayerPacketView const& packet,
+                        Phy::Type type, int8_t rssi) {
+  device_->ReceiveLinkLayerPacket(packet, type, rssi);
+}
+
 void PhyDevice::Send(std::vector<uint8_t> const& packet, Phy::Type type,
                      int8_t tx_power) {
   for (auto const& phy : phy_layers_) {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <unordered_set>
 
 #include "model/devices/device.h"
@@ -40,10 +41,21 @@ class PhyDevice {
 
   void Tick();
   void Receive(std::vector<uint8_t> const& packet, Phy::Type type, int8_t rssi);
+  void Receive(model::packets::LinkLayerPacketView const& packet,
+               Phy::Type type, int8_t rssi);
   void Send(std::vector<uint8_t> const& packet, Phy::Type type,
             int8_t tx_power);
 
   void SetAddress(bluetooth::hci::Address address);
+  const bluetooth::hci::Address& GetAddress() const;
+
+  // See Device::CanReceive and Device::ReceivesOnlyAddressedPackets.
+  bool CanReceive(model::packets::PacketType type) const;
+  bool ReceivesOnlyAddressedPackets() const;
+  // See Device::IsIdle and Device::GetNextEventTime.
+  bool IsIdle() const;
+  std::optional<ModelClock::time_point> GetNextEventTime() const;
+
   std::string ToString();
 
   // Id and type are public but immutable.
@@ -16,6 +16,7 @@
 
 #include "phy_layer.h"
 
+#include <algorithm>
 #include <sstream>
 
 namespace rootcanal {
@@ -24,6 +25,13 @@ PhyLayer::PhyLayer(Identifier id, Phy::Type type) : id(id), type(type) {}
 
 void PhyLayer::Register(std::shared_ptr<PhyDevice> device) {
   device->Register(this);
+  Receiver receiver{next_order_++, device.get()};
+  if (device->ReceivesOnlyAddressedPackets()) {
+    addressed_receivers_.emplace(device->GetAddress(), receiver);
+    receiver_addresses_[device->id] = device->GetAddress();
+  } else {
+    receivers_.push_back(receiver);
+  }
   phy_devices_.push_back(device);
 }
 
@@ -31,6 +39,22 @@ void PhyLayer::Unregister(PhyDevice::Identifier id) {
   for (auto& device : phy_devices_) {
     if (device->id == id) {
       device->Unregister(this);
+      receivers_.erase(std::remove_if(receivers_.begin(), receivers_.end(),
+                                      [&](Receiver const& receiver) {
+                                        return receiver.device == device.get();
+                                      }),
+                       receivers_.end());
+      auto address = receiver_addresses_.find(id);
+      if (address != receiver_addresses_.end()) {
+        auto [begin, end] = addressed_receivers_.equal_range(address->second);
+        for (auto it = begin; it != end; it++) {
+          if (it->second.device == device.get()) {
+            addressed_receivers_.erase(it);
+            break;
+          }
+        }
+        receiver_addresses_.erase(address);
+      }
       phy_devices_.remove(device);
       return;
     }
@@ -41,28 +65,91 @@ void PhyLayer::UnregisterAll() {
   for (auto& device : phy_devices_) {
     device->Unregister(this);
   }
+  receivers_.clear();
+  addressed_receivers_.clear();
+  receiver_addresses_.clear();
   phy_devices_.clear();
 }
 
+void PhyLayer::UpdateAddress(PhyDevice* device) {
+  auto address = receiver_addresses_.find(device->id);
+  if (address == receiver_addresses_.end() ||
+      address->second == device->GetAddress()) {
+    return;
+  }
+  auto [begin, end] = addressed_receivers_.equal_range(address->second);
+  for (auto it = begin; it != end; it++) {
+    if (it->second.device == device) {
+      Receiver receiver = it->second;
+      addressed_receivers_.erase(it);
+      address->second = device->GetAddress();
+      addressed_receivers_.emplace(address->second, receiver);
+      return;
+    }
+  }
+}
+
 int8_t PhyLayer::ComputeRssi(PhyDevice::Identifier sender_id,
                              PhyDevice::Identifier receiver_id,
                              int8_t tx_power) {
   // Perform no RSSI computation by default.
   // Clients overriding this function should use the TX power and
   // positional information to derive correct device-to-device RSSI.
-  static uint8_t rssi = 0;
-  rssi = (rssi + 5) % 128;
-  return static_cast<int8_t>(-rssi);
+  rssi_ = (rssi_ + 5) % 128;
+  return static_cast<int8_t>(-rssi_);
+}
+
+void PhyLayer::Deliver(PhyDevice* device,
+                       model::packets::LinkLayerPacketView const& packet,
+                       model::packets::PacketType packet_type,
+                       int8_t tx_power, PhyDevice::Identifier sender_id) {
+  // Do not send the packet back to the sender.
+  if (sender_id != device->id && device->CanReceive(packet_type)) {
+    device->Receive(packet, type, ComputeRssi(sender_id, device->id, tx_power));
+  }
 }
 
 void PhyLayer::Send(std::vector<uint8_t> const& packet, int8_t tx_power,
                     PhyDevice::Identifier sender_id) {
-  for (const auto& device : phy_devices_) {
-    // Do not send the packet back to the sender.
-    if (sender_id != device->id) {
-      device->Receive(packet, type,
-                      ComputeRssi(sender_id, device->id, tx_power));
+  // Parse the packet once, all the receivers share the view.
+  model::packets::LinkLayerPacketView packet_view =
+      model::packets::LinkLayerPacketView::Create(
+          bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(
+              std::make_shared<std::vector<uint8_t>>(packet)));
+  if (!packet_view.IsValid()) {
+    LOG_WARN("dropping invalid LL packet");
+    return;
+  }
+  model::packets::PacketType packet_type = packet_view.GetType();
+
+  auto [begin, end] =
+      addressed_receivers_.equal_range(packet_view.GetDestinationAddress());
+  std::vector<Receiver> addressed;
+  for (auto it = begin; it != end; it++) {
+    addressed.push_back(it->second);
+  }
+  std::sort(addressed.begin(), addressed.end(),
+            [](Receiver const& a, Receiver const& b) {
+              return a.order < b.order;
+            });
+
+  // The addressed devices are merged in so that all the devices receive the
+  // packet in the order they were registered in. Receivers may send packets
+  // in response, which can register more devices, so the receivers are not
+  // iterated over with iterators.
+  size_t next_addressed = 0;
+  for (size_t i = 0; i < receivers_.size(); i++) {
+    while (next_addressed < addressed.size() &&
+           addressed[next_addressed].order < receivers_[i].order) {
+      Deliver(addressed[next_addressed++].device, packet_view, packet_type,
+              tx_power, sender_id);
     }
+    Deliver(receivers_[i].device, packet_view, packet_type, tx_power,
+            sender_id);
+  }
+  for (; next_addressed < addressed.size(); next_addressed++) {
+    Deliver(addressed[next_addressed].device, packet_view, packet_type,
+            tx_power, sender_id);
   }
 }
 
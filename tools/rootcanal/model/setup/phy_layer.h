@@ -18,6 +18,7 @@
 
 #include <list>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "phy.h"
@@ -48,6 +49,10 @@ class PhyLayer {
   void Unregister(PhyDevice::Identifier device_id);
   void UnregisterAll();
 
+  // Look up the device by its new address from now on, if it only receives
+  // the packets sent to its address.
+  void UpdateAddress(PhyDevice* device);
+
   std::string ToString() const;
 
   // Id and type are public but immutable.
@@ -57,6 +62,33 @@ class PhyLayer {
  protected:
   // List of devices currently connected to the phy.
   std::list<std::shared_ptr<rootcanal::PhyDevice>> phy_devices_;
+
+ private:
+  // Hands the parsed packet to the device if it can receive it.
+  void Deliver(PhyDevice* device,
+               model::packets::LinkLayerPacketView const& packet,
+               model::packets::PacketType packet_type, int8_t tx_power,
+               PhyDevice::Identifier sender_id);
+
+  // A device of phy_devices_, with the rank it was registered in. Packets
+  // are delivered in that order, whichever index the device is in.
+  struct Receiver {
+    uint64_t order;
+    PhyDevice* device;
+  };
+
+  // The devices which receive every packet sent on the phy, by order.
+  std::vector<Receiver> receivers_;
+  // The others, which only receive the packets sent to their address,
+  // by the address they had when last registered or updated.
+  std::unordered_multimap<bluetooth::hci::Address, Receiver>
+      addressed_receivers_;
+  std::unordered_map<PhyDevice::Identifier, bluetooth::hci::Address>
+      receiver_addresses_;
+  uint64_t next_order_{0};
+  // Last RSSI returned by the default ComputeRssi, kept per phy so that the
+  // values a phy hands out do not depend on the traffic of the others.
+  uint8_t rssi_{0};
 };
 
 }  // namespace rootcanal
@@ -18,6 +18,7 @@
 
 #include <stdlib.h>  // for size_t
 
+#include <algorithm>    // for all_of
 #include <iomanip>      // for operator<<, setfill
 #include <iostream>     // for basic_ostream
 #include <memory>       // for shared_ptr, make...
@@ -27,6 +28,7 @@
 
 #include "include/phy.h"  // for Phy, Phy::Type
 #include "log.h"          // for LOG_WARN, LOG_INFO
+#include "model_clock.h"  // for ModelClock
 #include "phy_layer.h"
 
 namespace rootcanal {
@@ -58,6 +60,9 @@ TestModel::TestModel(
 
 TestModel::~TestModel() {
   StopTimer();
+  if (virtual_time_) {
+    ModelClock::Reset();
+  }
 }
 
 void TestModel::SetTimerPeriod(std::chrono::milliseconds new_period) {
@@ -72,13 +77,81 @@ void TestModel::SetTimerPeriod(std::chrono::milliseconds new_period) {
   StartTimer();
 }
 
+void TestModel::EnableVirtualTime(unsigned quiet_ticks) {
+  LOG_INFO("EnableVirtualTime(%u)", quiet_ticks);
+  ModelClock::EnableVirtualTime();
+  virtual_time_ = true;
+  virtual_time_quiet_ticks_ = quiet_ticks;
+  quiet_ticks_ = 0;
+
+  if (timer_tick_task_ != kInvalidTaskId) {
+    StopTimer();
+    StartTimer();
+  }
+}
+
 void TestModel::StartTimer() {
   LOG_INFO("StartTimer()");
+  if (virtual_time_) {
+    timer_tick_task_ =
+        schedule_task_(model_user_id_, std::chrono::milliseconds(0),
+                       [this]() { VirtualTick(); });
+    return;
+  }
   timer_tick_task_ =
       schedule_periodic_task_(model_user_id_, std::chrono::milliseconds(0),
                               timer_period_, [this]() { TestModel::Tick(); });
 }
 
+void TestModel::VirtualTick() {
+  Tick();
+
+  // Without a host there is nothing to wait for, but nothing to run ahead
+  // for either: keep the real pace.
+  bool idle = !hci_device_ids_.empty() &&
+              std::all_of(phy_devices_.begin(), phy_devices_.end(),
+                          [](auto const& it) { return it.second->IsIdle(); });
+  if (!idle) {
+    quiet_ticks_ = 0;
+  } else if (quiet_ticks_ < virtual_time_quiet_ticks_) {
+    quiet_ticks_++;
+  }
+
+  // Find the next event, and whether a device needs every tick.
+  ModelClock::time_point now = ModelClock::now();
+  std::optional<ModelClock::time_point> next_event;
+  bool every_tick = false;
+  for (auto const& [_, device] : phy_devices_) {
+    std::optional<ModelClock::time_point> time = device->GetNextEventTime();
+    if (!time.has_value()) {
+      continue;
+    }
+    if (time.value() <= now) {
+      every_tick = true;
+    } else if (!next_event.has_value() || time.value() < next_event.value()) {
+      next_event = time;
+    }
+  }
+
+  // Once the hosts have been idle long enough, skip to the next event but
+  // never past it, so that the events run in the order of their times. With
+  // nothing scheduled, wait for the hosts at the real pace rather than
+  // spinning.
+  ModelClock::duration step = timer_period_;
+  std::chrono::milliseconds delay = timer_period_;
+  if (idle && quiet_ticks_ >= virtual_time_quiet_ticks_ &&
+      (every_tick || next_event.has_value())) {
+    delay = std::chrono::milliseconds(0);
+    if (next_event.has_value() &&
+        (!every_tick || next_event.value() - now < step)) {
+      step = next_event.value() - now;
+    }
+  }
+  ModelClock::Advance(step);
+  timer_tick_task_ =
+      schedule_task_(model_user_id_, delay, [this]() { VirtualTick(); });
+}
+
 void TestModel::StopTimer() {
   LOG_INFO("StopTimer()");
   cancel_task_(timer_tick_task_);
@@ -129,6 +202,7 @@ void TestModel::RemoveDevice(PhyDevice::Identifier device_id) {
     phy_layer->Unregister(device_id);
   }
   phy_devices_.erase(device_id);
+  hci_device_ids_.erase(device_id);
 }
 
 // Add a phy to the test model.
@@ -214,6 +288,7 @@ PhyDevice::Identifier TestModel::AddHciConnection(
   for (auto& [_, phy_layer] : phy_layers_) {
     phy_layer->Register(phy_devices_[device_id]);
   }
+  hci_device_ids_.insert(device_id);
 
   AsyncUserId user_id = get_user_id_();
   device->RegisterCloseCallback([this, device_id, user_id] {
@@ -260,6 +335,8 @@ const std::string& TestModel::List() {
 }
 
 void TestModel::Tick() {
+  // The devices tick in the order of their identifiers, for runs to be
+  // reproducible.
   for (auto& [_, device] : phy_devices_) {
     device->Tick();
   }
@@ -273,6 +350,7 @@ void TestModel::Reset() {
       phy_layer->UnregisterAll();
     }
     phy_devices_.clear();
+    hci_device_ids_.clear();
     next_device_id_ = 0;
   });
 }
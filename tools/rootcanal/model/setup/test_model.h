@@ -21,6 +21,7 @@
 #include <functional>  // for function
 #include <map>
 #include <memory>      // for shared_ptr
+#include <set>
 #include <string>      // for string
 #include <vector>      // for vector
 
@@ -60,6 +61,22 @@ class TestModel {
     reuse_device_ids_ = reuse_device_ids;
   }
 
+  // Default number of quiet ticks before virtual time skips ahead.
+  static constexpr unsigned kVirtualTimeQuietTicks = 4;
+
+  // Run the devices on virtual time (see ModelClock). Once the hosts have
+  // been idle for |quiet_ticks| consecutive ticks, the clock skips to the next
+  // event the devices have scheduled and the tick runs right away. Otherwise
+  // each tick moves the clock forward by the timer period and waits for the
+  // period to pass, as in real time.
+  //
+  // A host is idle for a tick when it sent nothing during the tick, which
+  // does not tell a host that has nothing left to do from one that is still
+  // working on its answer. A host slower than |quiet_ticks| timer periods to
+  // answer sees the time jump ahead of it, so the window must cover the
+  // response time of the hosts under test.
+  void EnableVirtualTime(unsigned quiet_ticks = kVirtualTimeQuietTicks);
+
   // Allow derived classes to use custom phy layer.
   virtual std::unique_ptr<PhyLayer> CreatePhyLayer(PhyLayer::Identifier id,
                                                    Phy::Type type);
@@ -114,6 +131,9 @@ class TestModel {
   std::map<PhyDevice::Identifier, std::shared_ptr<PhyDevice>> phy_devices_;
   std::string list_string_;
 
+  // Devices connected to a host over HCI.
+  std::set<PhyDevice::Identifier> hci_device_ids_;
+
   // Generator for device identifiers.
   PhyDevice::Identifier next_device_id_{0};
   bool reuse_device_ids_{true};
@@ -138,6 +158,14 @@ class TestModel {
   AsyncUserId model_user_id_;
   AsyncTaskId timer_tick_task_{kInvalidTaskId};
   std::chrono::milliseconds timer_period_{};
+  bool virtual_time_{false};
+  // Consecutive ticks the hosts must be idle for before skipping ahead.
+  unsigned virtual_time_quiet_ticks_{kVirtualTimeQuietTicks};
+  // Consecutive ticks the hosts have been idle for.
+  unsigned quiet_ticks_{0};
+
+  // Tick and schedule the next tick on virtual time.
+  void VirtualTick();
 };
 
 }  // namespace rootcanal
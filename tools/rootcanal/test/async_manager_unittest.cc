@@ -21,11 +21,15 @@
 #include <netdb.h>        // for gethostbyname, h_addr, hostent
 #include <netinet/in.h>   // for sockaddr_in, in_addr, INADDR_ANY
 #include <stdio.h>        // for printf
+#include <sys/resource.h>  // for getrlimit, setrlimit, RLIMIT_NOFILE
+#include <sys/select.h>    // for FD_SETSIZE
 #include <sys/socket.h>   // for socket, AF_INET, accept, bind
 #include <sys/types.h>    // for in_addr_t
 #include <time.h>         // for NULL, size_t
 #include <unistd.h>       // for close, write, read
 
+#include <algorithm>           // for sort
+#include <chrono>              // for steady_clock
 #include <condition_variable>  // for condition_variable
 #include <cstdint>             // for uint16_t
 #include <cstring>             // for memset, strcmp, strcpy, strlen
@@ -34,6 +38,7 @@
 #include <string>              // for string
 #include <thread>
 #include <tuple>  // for tuple
+#include <vector>
 
 namespace rootcanal {
 
@@ -490,4 +495,100 @@ TEST_F(AsyncManagerTest, TestCancelAsyncTasksFromUser) {
   ASSERT_FALSE(async_manager_.CancelAsyncTask(task5_id));
 }
 
+// Raises the limit on open FDs to at least |count|, returns false if the
+// limit cannot be raised that high.
+static bool RaiseOpenFdLimit(rlim_t count) {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_max < count) {
+    return false;
+  }
+  limit.rlim_cur = std::max(limit.rlim_cur, count);
+  return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+}
+
+#ifdef __linux__
+TEST_F(AsyncManagerTest, TestFdAboveFdSetSize) {
+  static const int kHighFd = FD_SETSIZE + 8;
+  if (!RaiseOpenFdLimit(kHighFd + 1)) {
+    GTEST_SKIP() << "Not allowed to open fd " << kHighFd;
+  }
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0) << strerror(errno);
+  ASSERT_EQ(dup2(fds[0], kHighFd), kHighFd) << strerror(errno);
+  close(fds[0]);
+
+  Event read_ready;
+  ASSERT_EQ(async_manager_.WatchFdForNonBlockingReads(kHighFd,
+                                                      [&](int fd) {
+                                                        char c;
+                                                        read(fd, &c, 1);
+                                                        read_ready.set();
+                                                      }),
+            0);
+  ASSERT_EQ(write(fds[1], "x", 1), 1);
+  EXPECT_TRUE(read_ready.wait_for(std::chrono::seconds(1)));
+
+  async_manager_.StopWatchingFileDescriptor(kHighFd);
+  close(kHighFd);
+  close(fds[1]);
+}
+#endif
+
+// Time from a write on one of the watched sockets to its read callback, with
+// a growing number of idle sockets watched next to it.
+TEST_F(AsyncManagerTest, DISABLED_BenchmarkDispatchLatency) {
+  using clock = std::chrono::steady_clock;
+  static const int kRounds = 2000;
+
+  printf("sockets  mean latency  p99 latency\n");
+  for (size_t count : {10, 100, 500, 1000, 2000}) {
+    if (!RaiseOpenFdLimit(2 * count + 64)) {
+      printf("%7zu  not allowed to open enough fds\n", count);
+      continue;
+    }
+    std::vector<std::tuple<int, int>> sockets;
+    for (size_t i = 0; i < count; i++) {
+      int fds[2];
+      ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0) << strerror(errno);
+      sockets.emplace_back(fds[0], fds[1]);
+    }
+
+    Event read_ready;
+    clock::time_point read_time;
+    for (auto [watched_fd, peer_fd] : sockets) {
+      async_manager_.WatchFdForNonBlockingReads(watched_fd, [&](int fd) {
+        char c;
+        read(fd, &c, 1);
+        read_time = clock::now();
+        read_ready.set();
+      });
+    }
+
+    std::vector<double> latencies_us;
+    for (int round = 0; round < kRounds; round++) {
+      // spread the writes over all the sockets
+      int peer_fd = std::get<1>(sockets[(round * 7919) % count]);
+      read_ready.reset();
+      clock::time_point write_time = clock::now();
+      ASSERT_EQ(write(peer_fd, "x", 1), 1);
+      ASSERT_TRUE(read_ready.wait_for(std::chrono::seconds(1)));
+      latencies_us.push_back(
+          std::chrono::duration<double, std::micro>(read_time - write_time)
+              .count());
+    }
+    std::sort(latencies_us.begin(), latencies_us.end());
+    double mean_us = 0;
+    for (double latency_us : latencies_us) mean_us += latency_us;
+    mean_us /= latencies_us.size();
+    printf("%7zu  %10.1fus  %9.1fus\n", count, mean_us,
+           latencies_us[latencies_us.size() * 99 / 100]);
+
+    for (auto [watched_fd, peer_fd] : sockets) {
+      async_manager_.StopWatchingFileDescriptor(watched_fd);
+      close(watched_fd);
+      close(peer_fd);
+    }
+  }
+}
+
 }  // namespace rootcanal
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>  // for State, BENCHMARK
+#include <stdio.h>                // for snprintf
+
+#include <memory>  // for shared_ptr, make_shared
+#include <string>  // for string
+#include <vector>  // for vector
+
+#include "model/devices/beacon.h"
+#include "model/devices/device.h"
+#include "model/setup/phy_layer.h"
+
+using ::benchmark::State;
+
+namespace rootcanal {
+
+namespace {
+
+// Counts the link layer packets it receives.
+class Scanner : public Device {
+ public:
+  explicit Scanner(Address address) { SetAddress(address); }
+
+  std::string GetTypeString() const override { return "scanner"; }
+
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView /*packet*/,
+                              Phy::Type /*type*/, int8_t /*rssi*/) override {
+    received_++;
+  }
+
+  size_t received_{0};
+};
+
+const Address kScannerAddress{0x11, 0x11, 0x11, 0x11, 0x11, 0x11};
+
+}  // namespace
+
+// A swarm of state.range(0) beacons that each advertise on every tick, with
+// one scanner receiving all the advertisements. An iteration is one tick.
+static void BM_PhyLayerBeaconSwarm(State& state) {
+  const size_t count = state.range(0);
+  PhyLayer phy(1, Phy::Type::LOW_ENERGY);
+  auto scanner = std::make_shared<Scanner>(kScannerAddress);
+  phy.Register(std::make_shared<PhyDevice>(0, "scanner", scanner));
+  for (size_t i = 0; i < count; i++) {
+    char address[18];
+    snprintf(address, sizeof(address), "c0:00:00:00:%02zx:%02zx", i >> 8,
+             i & 0xff);
+    auto beacon = std::make_shared<Beacon>(
+        std::vector<std::string>{"beacon", address, "0"});
+    phy.Register(std::make_shared<PhyDevice>(i + 1, "beacon", beacon));
+  }
+
+  for (auto _ : state) {
+    phy.Tick();
+  }
+
+  if (scanner->received_ != count * state.iterations()) {
+    state.SkipWithError("An advertisement was not received");
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  phy.UnregisterAll();
+}
+BENCHMARK(BM_PhyLayerBeaconSwarm)->Arg(10)->Arg(100)->Arg(1000);
+
+}  // namespace rootcanal
+
+int main(int argc, char** argv) {
+  ::benchmark::Initialize(&argc, argv);
+  if (::benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+}
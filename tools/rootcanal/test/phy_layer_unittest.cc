@@ -0,0 +1,204 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/phy_layer.h"
+
+#include <gtest/gtest.h>  // for Message, TestPartResult, SuiteApi...
+
+#include <algorithm>  // for find
+#include <memory>     // for shared_ptr, make_shared
+#include <string>     // for string
+#include <vector>     // for vector
+
+#include "model/devices/device.h"
+
+namespace rootcanal {
+
+using model::packets::PacketType;
+
+// Counts the link layer packets it receives.
+class CountingDevice : public Device {
+ public:
+  CountingDevice(Address address, bool receives_only_addressed_packets = false,
+                 std::vector<PacketType> packet_types = {})
+      : receives_only_addressed_packets_(receives_only_addressed_packets),
+        packet_types_(std::move(packet_types)) {
+    SetAddress(address);
+  }
+
+  std::string GetTypeString() const override { return "counting_device"; }
+
+  void Tick() override {
+    if (next_address_ != Address::kEmpty) {
+      SetAddress(next_address_);
+    }
+  }
+
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView packet,
+                              Phy::Type /*type*/, int8_t /*rssi*/) override {
+    ASSERT_TRUE(packet.IsValid());
+    received_++;
+    if (receive_log_ != nullptr) {
+      receive_log_->push_back(this);
+    }
+  }
+
+  bool CanReceive(PacketType type) const override {
+    return packet_types_.empty() ||
+           std::find(packet_types_.begin(), packet_types_.end(), type) !=
+               packet_types_.end();
+  }
+
+  bool ReceivesOnlyAddressedPackets() const override {
+    return receives_only_addressed_packets_;
+  }
+
+  // Address to switch to on the next tick, like the beacon swarm does.
+  Address next_address_{Address::kEmpty};
+  size_t received_{0};
+  // Where to record the device on every packet it receives.
+  std::vector<Device*>* receive_log_{nullptr};
+
+ private:
+  bool receives_only_addressed_packets_;
+  std::vector<PacketType> packet_types_;
+};
+
+class PhyLayerTest : public ::testing::Test {
+ protected:
+  std::shared_ptr<CountingDevice> AddDevice(
+      Address address, bool receives_only_addressed_packets = false,
+      std::vector<PacketType> packet_types = {}) {
+    auto device = std::make_shared<CountingDevice>(
+        address, receives_only_addressed_packets, std::move(packet_types));
+    phy_devices_.push_back(
+        std::make_shared<PhyDevice>(next_id_++, "counting_device", device));
+    phy_.Register(phy_devices_.back());
+    return device;
+  }
+
+  void SendDisconnect(Device& sender, Address destination) {
+    sender.SendLinkLayerPacket(
+        model::packets::DisconnectBuilder::Create(sender.GetAddress(),
+                                                  destination, 0x13),
+        Phy::Type::LOW_ENERGY);
+  }
+
+  void SendLeScan(Device& sender, Address destination) {
+    sender.SendLinkLayerPacket(
+        model::packets::LeScanBuilder::Create(
+            sender.GetAddress(), destination,
+            model::packets::AddressType::PUBLIC,
+            model::packets::AddressType::PUBLIC),
+        Phy::Type::LOW_ENERGY);
+  }
+
+  const Address kAddress1{0x11, 0x11, 0x11, 0x11, 0x11, 0x11};
+  const Address kAddress2{0x22, 0x22, 0x22, 0x22, 0x22, 0x22};
+  const Address kAddress3{0x33, 0x33, 0x33, 0x33, 0x33, 0x33};
+
+  PhyLayer phy_{0, Phy::Type::LOW_ENERGY};
+  std::vector<std::shared_ptr<PhyDevice>> phy_devices_;
+  PhyDevice::Identifier next_id_{0};
+};
+
+TEST_F(PhyLayerTest, DeliversToAllButSender) {
+  auto sender = AddDevice(kAddress1);
+  auto receiver1 = AddDevice(kAddress2);
+  auto receiver2 = AddDevice(kAddress3);
+
+  SendDisconnect(*sender, Address::kEmpty);
+  SendDisconnect(*sender, kAddress2);
+
+  EXPECT_EQ(sender->received_, 0u);
+  EXPECT_EQ(receiver1->received_, 2u);
+  EXPECT_EQ(receiver2->received_, 2u);
+}
+
+TEST_F(PhyLayerTest, SkipsDevicesThatCannotReceive) {
+  auto sender = AddDevice(kAddress1);
+  auto scanned = AddDevice(kAddress2, false, {PacketType::LE_SCAN});
+
+  SendDisconnect(*sender, kAddress2);
+  EXPECT_EQ(scanned->received_, 0u);
+  SendLeScan(*sender, kAddress2);
+  EXPECT_EQ(scanned->received_, 1u);
+}
+
+TEST_F(PhyLayerTest, DeliversByAddress) {
+  auto sender = AddDevice(kAddress1);
+  auto addressed = AddDevice(kAddress2, true);
+  auto other = AddDevice(kAddress3, true);
+
+  SendDisconnect(*sender, Address::kEmpty);
+  SendDisconnect(*sender, kAddress2);
+
+  EXPECT_EQ(addressed->received_, 1u);
+  EXPECT_EQ(other->received_, 0u);
+}
+
+TEST_F(PhyLayerTest, FollowsAddressChanges) {
+  auto sender = AddDevice(kAddress1);
+  auto addressed = AddDevice(kAddress2, true);
+
+  // Changed by the test channel
+  phy_devices_.back()->SetAddress(kAddress3);
+  SendDisconnect(*sender, kAddress2);
+  SendDisconnect(*sender, kAddress3);
+  EXPECT_EQ(addressed->received_, 1u);
+
+  // Changed by the device itself
+  addressed->next_address_ = kAddress2;
+  phy_.Tick();
+  SendDisconnect(*sender, kAddress3);
+  SendDisconnect(*sender, kAddress2);
+  EXPECT_EQ(addressed->received_, 2u);
+}
+
+TEST_F(PhyLayerTest, DeliversInRegistrationOrder) {
+  auto sender = AddDevice(kAddress1);
+  auto addressed1 = AddDevice(kAddress3, true);
+  auto receiver = AddDevice(kAddress3);
+  auto addressed2 = AddDevice(kAddress2, true);
+  std::vector<Device*> receive_log;
+  for (auto device : {addressed1, receiver, addressed2}) {
+    device->receive_log_ = &receive_log;
+  }
+
+  // The address change does not move the device to the end
+  phy_devices_[1]->SetAddress(kAddress2);
+  SendDisconnect(*sender, kAddress2);
+
+  std::vector<Device*> expected{addressed1.get(), receiver.get(),
+                                addressed2.get()};
+  EXPECT_EQ(receive_log, expected);
+}
+
+TEST_F(PhyLayerTest, Unregister) {
+  auto sender = AddDevice(kAddress1);
+  auto receiver = AddDevice(kAddress2);
+  auto addressed = AddDevice(kAddress3, true);
+
+  phy_.Unregister(phy_devices_[1]->id);
+  phy_.Unregister(phy_devices_[2]->id);
+  SendDisconnect(*sender, kAddress2);
+  SendDisconnect(*sender, kAddress3);
+
+  EXPECT_EQ(receiver->received_, 0u);
+  EXPECT_EQ(addressed->received_, 0u);
+}
+
+}  // namespace rootcanal
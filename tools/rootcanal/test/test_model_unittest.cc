@@ -0,0 +1,193 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/test_model.h"
+
+#include <gtest/gtest.h>  // for Message, TestPartResult, SuiteApi...
+
+#include <chrono>   // for milliseconds
+#include <memory>   // for shared_ptr, make_shared
+#include <string>   // for string
+#include <utility>  // for pair
+#include <vector>   // for vector
+
+#include "model/devices/beacon.h"
+#include "model/devices/hci_device.h"
+#include "model/hci/hci_transport.h"
+#include "model_clock.h"
+
+namespace rootcanal {
+
+using namespace std::chrono_literals;
+
+// Transport of a host that only sends what the test tells it to, on the
+// next tick like the socket transport.
+class FakeTransport : public HciTransport {
+ public:
+  void SendEvent(const std::vector<uint8_t>& /*packet*/) override { events_++; }
+  void SendAcl(const std::vector<uint8_t>& /*packet*/) override {}
+  void SendSco(const std::vector<uint8_t>& /*packet*/) override {}
+  void SendIso(const std::vector<uint8_t>& /*packet*/) override {}
+
+  void RegisterCallbacks(PacketCallback command_callback,
+                         PacketCallback /*acl_callback*/,
+                         PacketCallback /*sco_callback*/,
+                         PacketCallback /*iso_callback*/,
+                         CloseCallback /*close_callback*/) override {
+    command_callback_ = std::move(command_callback);
+  }
+
+  void Tick() override {
+    for (auto& command : commands_) {
+      command_callback_(command);
+    }
+    commands_.clear();
+  }
+  bool HasPartialPacket() const override { return partial_packet_; }
+  void Close() override {}
+
+  PacketCallback command_callback_;
+  std::vector<std::shared_ptr<std::vector<uint8_t>>> commands_;
+  bool partial_packet_{false};
+  size_t events_{0};
+};
+
+class TestModelTest : public ::testing::Test {
+ protected:
+  TestModelTest()
+      : model_(
+            [] { return AsyncUserId(1); },
+            [this](AsyncUserId, std::chrono::milliseconds delay,
+                   const TaskCallback& task) {
+              tasks_.emplace_back(delay, task);
+              return AsyncTaskId(tasks_.size());
+            },
+            [](AsyncUserId, std::chrono::milliseconds,
+               std::chrono::milliseconds, const TaskCallback&) {
+              ADD_FAILURE() << "periodic timer on virtual time";
+              return kInvalidTaskId;
+            },
+            [](AsyncUserId) {}, [](AsyncTaskId) {},
+            [](const std::string&, int, Phy::Type) {
+              return std::shared_ptr<Device>();
+            }) {}
+
+  // Run the last scheduled task and return the delay of the one it schedules.
+  std::chrono::milliseconds RunLastTask() {
+    TaskCallback task = tasks_.back().second;
+    size_t scheduled = tasks_.size();
+    task();
+    EXPECT_EQ(tasks_.size(), scheduled + 1);
+    return tasks_.back().first;
+  }
+
+  std::vector<std::pair<std::chrono::milliseconds, TaskCallback>> tasks_;
+  TestModel model_;
+};
+
+TEST_F(TestModelTest, VirtualTimeSkipsAheadWhileHostsAreIdle) {
+  model_.SetTimerPeriod(10ms);
+  // Skip as soon as the hosts are idle for one tick.
+  model_.EnableVirtualTime(1);
+  model_.StartTimer();
+  ASSERT_EQ(tasks_.size(), 1u);
+  EXPECT_EQ(tasks_.back().first, 0ms);
+
+  // Without a host the ticks keep the real pace, and move the clock by one
+  // period.
+  ModelClock::time_point start = ModelClock::now();
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(ModelClock::now() - start, 10ms);
+
+  // With an idle host but nothing scheduled, the hosts are waited for at
+  // the real pace.
+  auto transport = std::make_shared<FakeTransport>();
+  model_.AddHciConnection(HciDevice::Create(transport, ControllerProperties()));
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(ModelClock::now() - start, 20ms);
+
+  // The clock skips from one advertisement of the beacon to the next.
+  model_.AddDevice(std::make_shared<Beacon>(
+      std::vector<std::string>{"beacon", "be:ac:01:55:00:01", "1000"}));
+  EXPECT_EQ(RunLastTask(), 0ms);
+  EXPECT_EQ(ModelClock::now() - start, 1020ms);
+  EXPECT_EQ(RunLastTask(), 0ms);
+  EXPECT_EQ(ModelClock::now() - start, 2020ms);
+
+  // Back to the real pace for the tick after the host talks to the
+  // controller.
+  transport->commands_.push_back(std::make_shared<std::vector<uint8_t>>(
+      std::vector<uint8_t>{0x03, 0x0c, 0x00}));  // HCI Reset
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_GT(transport->events_, 0u);
+  EXPECT_EQ(ModelClock::now() - start, 2030ms);
+  EXPECT_EQ(RunLastTask(), 0ms);
+  EXPECT_EQ(ModelClock::now() - start, 3020ms);
+
+  // And while it is sending a packet.
+  transport->partial_packet_ = true;
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(ModelClock::now() - start, 3030ms);
+
+  model_.StopTimer();
+}
+
+TEST_F(TestModelTest, VirtualTimeWaitsForQuietTicks) {
+  model_.SetTimerPeriod(10ms);
+  model_.EnableVirtualTime(3);
+  model_.StartTimer();
+  auto transport = std::make_shared<FakeTransport>();
+  model_.AddHciConnection(HciDevice::Create(transport, ControllerProperties()));
+  model_.AddDevice(std::make_shared<Beacon>(
+      std::vector<std::string>{"beacon", "be:ac:01:55:00:01", "1000"}));
+
+  // The hosts must be idle for three ticks at the real pace first.
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(RunLastTask(), 0ms);
+  EXPECT_EQ(RunLastTask(), 0ms);
+
+  // Any host traffic starts the count again.
+  transport->commands_.push_back(std::make_shared<std::vector<uint8_t>>(
+      std::vector<uint8_t>{0x03, 0x0c, 0x00}));  // HCI Reset
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(RunLastTask(), 10ms);
+  EXPECT_EQ(RunLastTask(), 0ms);
+
+  model_.StopTimer();
+}
+
+TEST_F(TestModelTest, VirtualTimeEndsWithTheModel) {
+  {
+    TestModel model(
+        [] { return AsyncUserId(1); },
+        [](AsyncUserId, std::chrono::milliseconds, const TaskCallback&) {
+          return AsyncTaskId(1);
+        },
+        [](AsyncUserId, std::chrono::milliseconds, std::chrono::milliseconds,
+           const TaskCallback&) { return AsyncTaskId(1); },
+        [](AsyncUserId) {}, [](AsyncTaskId) {},
+        [](const std::string&, int, Phy::Type) {
+          return std::shared_ptr<Device>();
+        });
+    model.EnableVirtualTime();
+    EXPECT_TRUE(ModelClock::IsVirtualTime());
+  }
+  EXPECT_FALSE(ModelClock::IsVirtualTime());
+}
+
+}  // namespace rootcanal